@@ -0,0 +1,107 @@
+// Arduino.h - host stand-in for the ESP32 Arduino core
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "esp_sleep.h"   // esp32-hal.h pulls it in on the ESP32 core
+
+using std::min;
+using std::max;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define ANALOG 0xC0
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#define PROGMEM
+#define PGM_P const char *
+#define pgm_read_byte(addr) (*(const unsigned char *)(addr))
+#define pgm_read_word(addr) (*(const unsigned short *)(addr))
+#define pgm_read_dword(addr) (*(const unsigned long *)(addr))
+#define IRAM_ATTR
+// RTC memory is a linker section that the simulator saves across a
+// simulated deep sleep (see sim_main.cpp)
+#define RTC_DATA_ATTR __attribute__((section("rtcdata")))
+#define RTC_FAST_ATTR __attribute__((section("rtcdata")))
+#define RTC_NOINIT_ATTR __attribute__((section("rtcnoinit")))
+
+#define MSBFIRST 1
+#define LSBFIRST 0
+
+#define pgm_read_byte_near(addr) pgm_read_byte(addr)
+#define strlen_P strlen
+#define memcpy_P memcpy
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+uint32_t esp_random();
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t val);
+void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder, uint8_t val);
+
+// Interrupts are raised by the simulator's wait loops (see sim.h)
+#define digitalPinToInterrupt(p) (p)
+void attachInterruptArg(uint8_t pin, void (*isr)(void *), void *arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+class HardwareSerial : public Stream {
+public:
+  // Input comes from SIM_SERIAL_INPUT, delivered once per boot
+  void begin(unsigned long);
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t c) override { return fwrite(&c, 1, 1, stdout); }
+  size_t write(const uint8_t *buf, size_t n) override { return fwrite(buf, 1, n, stdout); }
+  using Print::write;
+  operator bool() const { return true; }
+};
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+  [[noreturn]] void restart();
+  uint32_t getFreeHeap();
+  uint32_t getMinFreeHeap();
+  uint32_t getMaxAllocHeap();
+  uint32_t getHeapSize();
+};
+extern EspClass ESP;
+
+// avr-libc / newlib number formatting used by Print-style code
+char *itoa(int value, char *str, int base);
+char *ltoa(long value, char *str, int base);
+char *utoa(unsigned int value, char *str, int base);
+char *ultoa(unsigned long value, char *str, int base);
+char *dtostrf(double value, signed char width, unsigned char prec, char *buf);
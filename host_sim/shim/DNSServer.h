@@ -0,0 +1,12 @@
+// DNSServer.h - host stand-in (no-op)
+#pragma once
+
+#include <Arduino.h>
+#include "IPAddress.h"
+
+class DNSServer {
+public:
+  bool start(uint16_t port, const String &domain, const IPAddress &ip) { (void)port; (void)domain; (void)ip; return true; }
+  void processNextRequest() {}
+  void stop() {}
+};
@@ -0,0 +1,68 @@
+// FS.h - host stand-in for the Arduino filesystem API, backed by a
+// directory on the host (see LittleFS.h)
+#pragma once
+
+#include <Arduino.h>
+#include <memory>
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+class File : public Stream {
+public:
+  File() {}
+  File(FILE *f, const String &path) : _f(f, fclose), _path(path) {}
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t *buf, size_t size) override { return _f ? fwrite(buf, 1, size, _f.get()) : 0; }
+  using Print::write;
+  int available() override;
+  int read() override { return _f ? fgetc(_f.get()) : -1; }
+  size_t read(uint8_t *buf, size_t size) { return _f ? fread(buf, 1, size, _f.get()) : 0; }
+  size_t readBytes(char *buffer, size_t length) override { return read((uint8_t *)buffer, length); }
+  using Stream::readBytes;
+  int peek() override;
+  void flush() override { if (_f) fflush(_f.get()); }
+  bool seek(uint32_t pos, SeekMode mode = SeekSet) { return _f && fseek(_f.get(), (long)pos, (int)mode) == 0; }
+  size_t position() const { return _f ? (size_t)ftell(_f.get()) : 0; }
+  size_t size() const;
+  void close() { _f.reset(); }
+  operator bool() const { return (bool)_f; }
+  const char *path() const { return _path.c_str(); }
+
+private:
+  std::shared_ptr<FILE> _f;
+  String _path;
+};
+
+class FS {
+public:
+  explicit FS(const char *root = nullptr) : _root(root ? root : "") {}
+  File open(const char *path, const char *mode = FILE_READ, bool create = false);
+  File open(const String &path, const char *mode = FILE_READ, bool create = false) { return open(path.c_str(), mode, create); }
+  bool exists(const char *path);
+  bool exists(const String &path) { return exists(path.c_str()); }
+  bool remove(const char *path);
+  bool remove(const String &path) { return remove(path.c_str()); }
+  bool rename(const char *from, const char *to);
+  bool rename(const String &from, const String &to) { return rename(from.c_str(), to.c_str()); }
+  bool mkdir(const char *path);
+  bool mkdir(const String &path) { return mkdir(path.c_str()); }
+
+protected:
+  String hostPath(const char *path) const;
+  String _root;
+};
+
+}  // namespace fs
+
+using fs::FS;
+using fs::File;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
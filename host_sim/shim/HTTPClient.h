@@ -0,0 +1,97 @@
+// HTTPClient.h - host stand-in for the ESP32 HTTPClient.
+// Every URL, http or https, is sent to the local mock server
+// (SIM_HTTP_PORT); the original host travels in the Host header.
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <Arduino.h>
+#include "WiFiClient.h"
+
+#define HTTPC_ERROR_CONNECTION_REFUSED  (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED  (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED       (-4)
+#define HTTPC_ERROR_CONNECTION_LOST     (-5)
+#define HTTPC_ERROR_NO_STREAM           (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER      (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM        (-8)
+#define HTTPC_ERROR_ENCODING            (-9)
+#define HTTPC_ERROR_STREAM_WRITE        (-10)
+#define HTTPC_ERROR_READ_TIMEOUT        (-11)
+
+#define HTTPC_TCP_TIMEOUT (5000)
+
+typedef enum {
+  HTTP_CODE_OK = 200,
+  HTTP_CODE_NO_CONTENT = 204,
+  HTTP_CODE_PARTIAL_CONTENT = 206,
+  HTTP_CODE_MOVED_PERMANENTLY = 301,
+  HTTP_CODE_FOUND = 302,
+  HTTP_CODE_NOT_MODIFIED = 304,
+  HTTP_CODE_BAD_REQUEST = 400,
+  HTTP_CODE_UNAUTHORIZED = 401,
+  HTTP_CODE_FORBIDDEN = 403,
+  HTTP_CODE_NOT_FOUND = 404,
+  HTTP_CODE_RANGE_NOT_SATISFIABLE = 416,
+  HTTP_CODE_INTERNAL_SERVER_ERROR = 500
+} t_http_codes;
+
+class HTTPClient {
+public:
+  HTTPClient() {}
+  ~HTTPClient();
+
+  bool begin(WiFiClient &client, const String &url);
+  bool begin(const String &url);
+  void end();
+  bool connected();
+
+  void setReuse(bool reuse) { _reuse = reuse; }
+  void useHTTP10(bool usehttp10) { _useHTTP10 = usehttp10; }
+  void setTimeout(uint16_t timeout) { _tcpTimeout = timeout; }
+  void setConnectTimeout(int32_t) {}
+  void setUserAgent(const String &ua) { _userAgent = ua; }
+
+  void addHeader(const String &name, const String &value, bool first = false, bool replace = true);
+  void collectHeaders(const char *headerKeys[], const size_t headerKeysCount);
+  String header(const char *name);
+  String header(size_t i);
+  String headerName(size_t i);
+  int headers() { return (int)_collected.size(); }
+  bool hasHeader(const char *name);
+
+  int GET();
+  int POST(const String &payload);
+  int POST(uint8_t *payload, size_t size);
+  int PATCH(const String &payload);
+  int PUT(const String &payload);
+  int sendRequest(const char *type, const String &payload);
+  int sendRequest(const char *type, uint8_t *payload = nullptr, size_t size = 0);
+
+  int getSize() { return _size; }
+  WiFiClient &getStream() { return *_client; }
+  WiFiClient *getStreamPtr() { return _client; }
+  String getString();
+  int writeToStream(Stream *stream);
+
+  static String errorToString(int error);
+
+private:
+  bool connect();
+  int handleHeaderResponse();
+  void disconnect(bool preserveClient = false);
+
+  WiFiClient *_client = nullptr;
+  WiFiClient *_ownClient = nullptr;
+  String _host, _uri, _userAgent = "ESP32HTTPClient";
+  uint16_t _port = 80;
+  bool _reuse = true, _canReuse = false, _useHTTP10 = false;
+  uint16_t _tcpTimeout = HTTPC_TCP_TIMEOUT;
+  String _headers;
+  std::vector<std::pair<String, String>> _collected;
+  int _returnCode = 0;
+  int _size = -1;
+  bool _chunked = false;
+  String _connectedHost;
+};
@@ -0,0 +1,37 @@
+// IPAddress.h - host stand-in for the Arduino IPAddress class
+#pragma once
+
+#include "Print.h"
+
+class IPAddress : public Printable {
+public:
+  IPAddress() : _addr{0, 0, 0, 0} {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _addr{a, b, c, d} {}
+  IPAddress(uint32_t v) { memcpy(_addr, &v, 4); }
+
+  operator uint32_t() const { uint32_t v; memcpy(&v, _addr, 4); return v; }
+  uint8_t operator[](int i) const { return _addr[i]; }
+  uint8_t &operator[](int i) { return _addr[i]; }
+  bool operator==(const IPAddress &o) const { return memcmp(_addr, o._addr, 4) == 0; }
+  bool operator!=(const IPAddress &o) const { return !(*this == o); }
+
+  bool fromString(const char *s) {
+    unsigned a, b, c, d;
+    if (sscanf(s, "%u.%u.%u.%u", &a, &b, &c, &d) != 4) return false;
+    _addr[0] = a; _addr[1] = b; _addr[2] = c; _addr[3] = d;
+    return true;
+  }
+  bool fromString(const String &s) { return fromString(s.c_str()); }
+
+  String toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", _addr[0], _addr[1], _addr[2], _addr[3]);
+    return String(buf);
+  }
+  size_t printTo(Print &p) const override { return p.print(toString()); }
+
+private:
+  uint8_t _addr[4];
+};
+
+#define INADDR_NONE IPAddress(0, 0, 0, 0)
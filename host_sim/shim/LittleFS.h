@@ -0,0 +1,15 @@
+// LittleFS.h - host stand-in: LittleFS backed by a host directory
+// (SIM_FS_DIR, default "./fs")
+#pragma once
+
+#include "FS.h"
+
+class LittleFSFS : public fs::FS {
+public:
+  bool begin(bool formatOnFail = false, const char *basePath = "/littlefs",
+             uint8_t maxOpenFiles = 10, const char *partitionLabel = "spiffs");
+  bool format();
+  void end() {}
+};
+
+extern LittleFSFS LittleFS;
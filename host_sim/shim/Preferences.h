@@ -0,0 +1,56 @@
+// Preferences.h - host stand-in for the ESP32 NVS Preferences library.
+// Namespaces live in memory and are mirrored to SIM_NVS_FILE so that
+// settings survive simulated reboots and separate runs.
+#pragma once
+
+#include <Arduino.h>
+
+class Preferences {
+public:
+  bool begin(const char *name, bool readOnly = false, const char *partition = nullptr);
+  void end();
+
+  bool clear();
+  bool remove(const char *key);
+  bool isKey(const char *key);
+
+  size_t putString(const char *key, const char *value);
+  size_t putString(const char *key, const String &value) { return putString(key, value.c_str()); }
+  String getString(const char *key, const String &defaultValue = String());
+  size_t getString(const char *key, char *value, size_t maxLen);
+
+  size_t putBytes(const char *key, const void *value, size_t len);
+  size_t getBytes(const char *key, void *buf, size_t maxLen);
+  size_t getBytesLength(const char *key);
+
+  size_t putUInt(const char *key, uint32_t value) { return putBytes(key, &value, sizeof(value)); }
+  uint32_t getUInt(const char *key, uint32_t defaultValue = 0) { return getScalar(key, defaultValue); }
+  size_t putInt(const char *key, int32_t value) { return putBytes(key, &value, sizeof(value)); }
+  int32_t getInt(const char *key, int32_t defaultValue = 0) { return getScalar(key, defaultValue); }
+  size_t putULong(const char *key, uint32_t value) { return putUInt(key, value); }
+  uint32_t getULong(const char *key, uint32_t defaultValue = 0) { return getUInt(key, defaultValue); }
+  size_t putULong64(const char *key, uint64_t value) { return putBytes(key, &value, sizeof(value)); }
+  uint64_t getULong64(const char *key, uint64_t defaultValue = 0) { return getScalar(key, defaultValue); }
+  size_t putBool(const char *key, bool value) { uint8_t v = value; return putBytes(key, &v, 1); }
+  bool getBool(const char *key, bool defaultValue = false) { return getScalar<uint8_t>(key, defaultValue) != 0; }
+  size_t putUChar(const char *key, uint8_t value) { return putBytes(key, &value, 1); }
+  uint8_t getUChar(const char *key, uint8_t defaultValue = 0) { return getScalar(key, defaultValue); }
+
+  size_t freeEntries() { return 500; }
+
+private:
+  template <typename T> T getScalar(const char *key, T fallback) {
+    T v;
+    return getBytes(key, &v, sizeof(v)) == sizeof(v) ? v : fallback;
+  }
+
+  String _ns;
+  bool _started = false;
+  bool _readOnly = false;
+};
+
+namespace sim {
+// Number of NVS commits (writes) and namespace opens, for reporting
+struct NvsStats { uint32_t opens; uint32_t writes; };
+NvsStats nvsStats();
+}
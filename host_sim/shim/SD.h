@@ -0,0 +1,4 @@
+// SD.h - host stand-in (the simulator has no SD card)
+#pragma once
+
+#include "FS.h"
@@ -0,0 +1,41 @@
+// SPI.h - host stand-in: bytes go to the simulated e-ink controller
+#pragma once
+
+#include <Arduino.h>
+
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x01
+#define SPI_MODE2 0x02
+#define SPI_MODE3 0x03
+
+#define FSPI 1
+#define HSPI 2
+
+#define MOSI 11
+#define MISO 13
+#define SCK  12
+#define SS   10
+
+class SPISettings {
+public:
+  SPISettings() {}
+  SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode) : clock(clock) { (void)bitOrder; (void)dataMode; }
+  uint32_t clock = 1000000;
+};
+
+class SPIClass {
+public:
+  explicit SPIClass(uint8_t bus = FSPI) { (void)bus; }
+  void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) { (void)sck; (void)miso; (void)mosi; (void)ss; }
+  void end() {}
+
+  void beginTransaction(SPISettings settings);
+  void endTransaction();
+
+  uint8_t transfer(uint8_t data);
+  void transfer(void *buf, uint32_t count);
+  void transferBytes(const uint8_t *data, uint8_t *out, uint32_t size);
+  void writeBytes(const uint8_t *data, uint32_t size);
+};
+
+extern SPIClass SPI;
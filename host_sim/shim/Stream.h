@@ -0,0 +1,63 @@
+// Stream.h - host stand-in for the Arduino Stream class
+#pragma once
+
+#include "Print.h"
+
+unsigned long millis();
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long timeout) { _timeout = timeout; }
+  unsigned long getTimeout() const { return _timeout; }
+
+  virtual size_t readBytes(char *buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+      int c = timedRead();
+      if (c < 0) break;
+      *buffer++ = (char)c;
+      count++;
+    }
+    return count;
+  }
+  size_t readBytes(uint8_t *buffer, size_t length) { return readBytes((char *)buffer, length); }
+
+  String readString() {
+    String s;
+    int c;
+    while ((c = timedRead()) >= 0) s += (char)c;
+    return s;
+  }
+  String readStringUntil(char terminator) {
+    String s;
+    int c;
+    while ((c = timedRead()) >= 0 && c != terminator) s += (char)c;
+    return s;
+  }
+
+  bool find(const char *target) {
+    size_t len = strlen(target), matched = 0;
+    int c;
+    while ((c = timedRead()) >= 0) {
+      if (c == target[matched]) { if (++matched == len) return true; }
+      else matched = (c == target[0]) ? 1 : 0;
+    }
+    return false;
+  }
+
+protected:
+  int timedRead() {
+    unsigned long start = millis();
+    do {
+      int c = read();
+      if (c >= 0) return c;
+    } while (millis() - start < _timeout);
+    return -1;
+  }
+
+  unsigned long _timeout = 1000;
+};
@@ -0,0 +1,34 @@
+// Update.h - host stand-in for the ESP32 Update library.
+// The "inactive OTA slot" is the file SIM_OTA_FILE.
+#pragma once
+
+#include <Arduino.h>
+
+#define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF
+
+class UpdateClass {
+public:
+  bool begin(size_t size = UPDATE_SIZE_UNKNOWN, int command = 0, int ledPin = -1, uint8_t ledOn = LOW, const char *label = nullptr);
+  size_t write(uint8_t *data, size_t len);
+  size_t writeStream(Stream &data);
+  bool end(bool evenIfRemaining = false);
+  void abort();
+
+  bool isFinished() { return _finished; }
+  bool hasError() { return _error != 0; }
+  uint8_t getError() { return _error; }
+  const char *errorString();
+  size_t size() { return _size; }
+  size_t progress() { return _progress; }
+  size_t remaining() { return _size == UPDATE_SIZE_UNKNOWN ? 0 : _size - _progress; }
+  bool isRunning() { return _file != nullptr; }
+
+private:
+  FILE    *_file = nullptr;
+  size_t   _size = 0;
+  size_t   _progress = 0;
+  uint8_t  _error = 0;
+  bool     _finished = false;
+};
+
+extern UpdateClass Update;
@@ -0,0 +1,150 @@
+// WString.h - host stand-in for the Arduino String class
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+
+class String {
+public:
+  String() {}
+  String(const char *s) { if (s) _s = s; }
+  String(const char *s, size_t n) : _s(s, n) {}
+  String(const __FlashStringHelper *s) : String(reinterpret_cast<const char *>(s)) {}
+  String(const std::string &s) : _s(s) {}
+  explicit String(char c) : _s(1, c) {}
+  String(int v, unsigned char base = 10) { fromSigned(v, base); }
+  String(unsigned int v, unsigned char base = 10) { fromUnsigned(v, base); }
+  String(long v, unsigned char base = 10) { fromSigned(v, base); }
+  String(unsigned long v, unsigned char base = 10) { fromUnsigned(v, base); }
+  String(long long v, unsigned char base = 10) { fromSigned(v, base); }
+  String(unsigned long long v, unsigned char base = 10) { fromUnsigned(v, base); }
+  String(float v, unsigned int decimals = 2) { fromDouble(v, decimals); }
+  String(double v, unsigned int decimals = 2) { fromDouble(v, decimals); }
+
+  String &operator=(const char *s) { if (s) _s = s; else _s.clear(); return *this; }
+
+  unsigned int length() const { return (unsigned int)_s.size(); }
+  bool isEmpty() const { return _s.empty(); }
+  const char *c_str() const { return _s.c_str(); }
+  char *begin() { return &_s[0]; }
+  char *end() { return &_s[0] + _s.size(); }
+  bool reserve(unsigned int n) { _s.reserve(n); return true; }
+
+  bool concat(const String &s) { _s += s._s; return true; }
+  bool concat(const char *s) { if (!s) return false; _s += s; return true; }
+  bool concat(const char *s, unsigned int n) { if (!s) return false; _s.append(s, n); return true; }
+  bool concat(char c) { _s += c; return true; }
+  bool concat(int v) { return concat(String(v)); }
+  bool concat(unsigned int v) { return concat(String(v)); }
+  bool concat(long v) { return concat(String(v)); }
+  bool concat(unsigned long v) { return concat(String(v)); }
+  bool concat(long long v) { return concat(String(v)); }
+  bool concat(unsigned long long v) { return concat(String(v)); }
+  bool concat(double v) { return concat(String(v)); }
+  bool concat(const __FlashStringHelper *s) { return concat(reinterpret_cast<const char *>(s)); }
+
+  template <typename T> String &operator+=(const T &v) { concat(v); return *this; }
+
+  bool equals(const String &o) const { return _s == o._s; }
+  bool equals(const char *o) const { return o && _s == o; }
+  bool operator==(const String &o) const { return _s == o._s; }
+  bool operator==(const char *o) const { return o && _s == o; }
+  bool operator!=(const String &o) const { return _s != o._s; }
+  bool operator!=(const char *o) const { return !(*this == o); }
+  bool operator<(const String &o) const { return _s < o._s; }
+  bool operator>(const String &o) const { return _s > o._s; }
+  int compareTo(const String &o) const { return _s.compare(o._s); }
+  bool equalsIgnoreCase(const String &o) const { return strcasecmp(c_str(), o.c_str()) == 0; }
+
+  char operator[](unsigned int i) const { return i < _s.size() ? _s[i] : 0; }
+  char &operator[](unsigned int i) { return _s[i]; }
+  char charAt(unsigned int i) const { return (*this)[i]; }
+  void setCharAt(unsigned int i, char c) { if (i < _s.size()) _s[i] = c; }
+
+  bool startsWith(const String &p) const { return _s.compare(0, p._s.size(), p._s) == 0; }
+  bool endsWith(const String &p) const {
+    return _s.size() >= p._s.size() && _s.compare(_s.size() - p._s.size(), p._s.size(), p._s) == 0;
+  }
+
+  int indexOf(char c, unsigned int from = 0) const { return pos(_s.find(c, from)); }
+  int indexOf(const String &s, unsigned int from = 0) const { return pos(_s.find(s._s, from)); }
+  int lastIndexOf(char c) const { return pos(_s.rfind(c)); }
+  int lastIndexOf(char c, unsigned int from) const { return pos(_s.rfind(c, from)); }
+  int lastIndexOf(const String &s) const { return pos(_s.rfind(s._s)); }
+  int lastIndexOf(const String &s, unsigned int from) const { return pos(_s.rfind(s._s, from)); }
+
+  String substring(unsigned int from) const { return from >= _s.size() ? String() : String(_s.substr(from)); }
+  String substring(unsigned int from, unsigned int to) const {
+    if (from > to) { unsigned int t = from; from = to; to = t; }
+    if (from >= _s.size()) return String();
+    return String(_s.substr(from, to - from));
+  }
+
+  void replace(const String &a, const String &b) {
+    if (a._s.empty()) return;
+    size_t p = 0;
+    while ((p = _s.find(a._s, p)) != std::string::npos) { _s.replace(p, a._s.size(), b._s); p += b._s.size(); }
+  }
+  void replace(char a, char b) { for (auto &c : _s) if (c == a) c = b; }
+  void remove(unsigned int i) { if (i < _s.size()) _s.erase(i); }
+  void remove(unsigned int i, unsigned int n) { if (i < _s.size()) _s.erase(i, n); }
+  void toLowerCase() { for (auto &c : _s) c = (char)tolower((unsigned char)c); }
+  void toUpperCase() { for (auto &c : _s) c = (char)toupper((unsigned char)c); }
+  void trim() {
+    size_t a = _s.find_first_not_of(" \t\r\n");
+    if (a == std::string::npos) { _s.clear(); return; }
+    size_t b = _s.find_last_not_of(" \t\r\n");
+    _s = _s.substr(a, b - a + 1);
+  }
+
+  long toInt() const { return strtol(_s.c_str(), nullptr, 10); }
+  float toFloat() const { return strtof(_s.c_str(), nullptr); }
+  double toDouble() const { return strtod(_s.c_str(), nullptr); }
+
+  void getBytes(unsigned char *buf, unsigned int n, unsigned int index = 0) const {
+    if (!n) return;
+    size_t len = index < _s.size() ? std::min<size_t>(n - 1, _s.size() - index) : 0;
+    memcpy(buf, _s.data() + index, len);
+    buf[len] = 0;
+  }
+  void toCharArray(char *buf, unsigned int n, unsigned int index = 0) const {
+    getBytes((unsigned char *)buf, n, index);
+  }
+
+  const std::string &str() const { return _s; }
+
+private:
+  static int pos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+  template <typename T> void fromSigned(T v, unsigned char base) {
+    if (v < 0) { _s = "-"; fromUnsigned((unsigned long long)(-(long long)v), base, true); }
+    else fromUnsigned((unsigned long long)v, base);
+  }
+  void fromUnsigned(unsigned long long v, unsigned char base, bool append = false) {
+    char buf[72]; int i = 71; buf[i] = 0;
+    do { int d = (int)(v % base); buf[--i] = (char)(d < 10 ? '0' + d : 'a' + d - 10); v /= base; } while (v);
+    if (append) _s += &buf[i]; else _s = &buf[i];
+  }
+  void fromDouble(double v, unsigned int decimals) {
+    char buf[64]; snprintf(buf, sizeof(buf), "%.*f", decimals, v); _s = buf;
+  }
+
+  std::string _s;
+};
+
+inline String operator+(const String &a, const String &b) { String r(a); r.concat(b); return r; }
+inline String operator+(const String &a, const char *b) { String r(a); r.concat(b); return r; }
+inline String operator+(const char *a, const String &b) { String r(a); r.concat(b); return r; }
+inline String operator+(const String &a, char b) { String r(a); r.concat(b); return r; }
+inline String operator+(const String &a, int b) { String r(a); r.concat(b); return r; }
+inline String operator+(const String &a, unsigned int b) { String r(a); r.concat(b); return r; }
+inline String operator+(const String &a, long b) { String r(a); r.concat(b); return r; }
+inline String operator+(const String &a, unsigned long b) { String r(a); r.concat(b); return r; }
+inline String operator+(const String &a, double b) { String r(a); r.concat(b); return r; }
+inline String operator+(const String &a, const __FlashStringHelper *b) { String r(a); r.concat(b); return r; }
+inline bool operator==(const char *a, const String &b) { return b == a; }
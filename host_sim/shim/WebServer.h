@@ -0,0 +1,31 @@
+// WebServer.h - host stand-in for the provisioning portal.
+// handleClient() submits the /save form once, using SIM_PROV_* values.
+#pragma once
+
+#include <functional>
+#include <map>
+#include <Arduino.h>
+
+typedef enum { HTTP_ANY, HTTP_GET, HTTP_POST } HTTPMethod;
+
+class WebServer {
+public:
+  typedef std::function<void(void)> THandlerFunction;
+
+  explicit WebServer(int port = 80) { (void)port; }
+  void begin() {}
+  void on(const String &uri, THandlerFunction fn) { _handlers[uri.str()] = fn; }
+  void on(const String &uri, HTTPMethod, THandlerFunction fn) { on(uri, fn); }
+  void onNotFound(THandlerFunction fn) { _notFound = fn; }
+  void handleClient();
+
+  bool hasArg(const String &name) { return _args.count(name.str()) > 0; }
+  String arg(const String &name) { return hasArg(name) ? String(_args[name.str()]) : String(); }
+  void send(int code, const char *type, const String &content);
+
+private:
+  std::map<std::string, THandlerFunction> _handlers;
+  std::map<std::string, std::string> _args;
+  THandlerFunction _notFound;
+  bool _submitted = false;
+};
@@ -0,0 +1,110 @@
+// WiFi.h - host stand-in for the ESP32 WiFi library.
+// Association is simulated: it completes after a delay that depends on
+// whether a channel/BSSID hint was supplied, and fires the usual events.
+#pragma once
+
+#include <functional>
+#include <Arduino.h>
+#include "IPAddress.h"
+#include "WiFiClient.h"
+#include "WiFiClientSecure.h"
+
+typedef enum {
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6,
+  WL_NO_SHIELD = 255
+} wl_status_t;
+
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } wifi_mode_t;
+
+typedef enum {
+  ARDUINO_EVENT_WIFI_STA_START = 2,
+  ARDUINO_EVENT_WIFI_STA_STOP,
+  ARDUINO_EVENT_WIFI_STA_CONNECTED,
+  ARDUINO_EVENT_WIFI_STA_DISCONNECTED,
+  ARDUINO_EVENT_WIFI_STA_AUTHMODE_CHANGE,
+  ARDUINO_EVENT_WIFI_STA_GOT_IP,
+  ARDUINO_EVENT_WIFI_STA_LOST_IP,
+  ARDUINO_EVENT_MAX = 64
+} arduino_event_id_t;
+
+typedef struct {
+  struct {
+    uint8_t ssid[33];
+    uint8_t ssid_len;
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint8_t authmode;
+  } wifi_sta_connected;
+  struct {
+    uint8_t ssid[33];
+    uint8_t ssid_len;
+    uint8_t bssid[6];
+    uint8_t reason;
+  } wifi_sta_disconnected;
+  struct {
+    struct { struct { uint32_t addr; } ip, netmask, gw; } ip_info;
+  } got_ip;
+} arduino_event_info_t;
+
+typedef std::function<void(arduino_event_id_t, arduino_event_info_t)> WiFiEventFuncCb;
+typedef int wifi_event_id_t;
+
+class WiFiClass {
+public:
+  bool mode(wifi_mode_t m) { _mode = m; return true; }
+  wifi_mode_t getMode() const { return _mode; }
+
+  wl_status_t begin(const char *ssid, const char *pass = nullptr,
+                    int32_t channel = 0, const uint8_t *bssid = nullptr, bool connect = true);
+  bool config(IPAddress local, IPAddress gateway, IPAddress subnet,
+              IPAddress dns1 = IPAddress(), IPAddress dns2 = IPAddress());
+  bool reconnect();
+  bool disconnect(bool wifioff = false, bool eraseap = false);
+  wl_status_t status();
+  uint8_t waitForConnectResult(unsigned long timeoutLength = 60000);
+
+  bool setAutoReconnect(bool) { return true; }
+  bool persistent(bool) { return true; }
+  bool setSleep(bool) { return true; }
+
+  IPAddress localIP() const { return _ip; }
+  IPAddress gatewayIP() const { return _gw; }
+  IPAddress subnetMask() const { return _mask; }
+  IPAddress dnsIP(uint8_t = 0) const { return _dns; }
+  String SSID() const { return _ssid; }
+  uint8_t *BSSID() { return _bssid; }
+  String BSSIDstr() const;
+  int32_t channel() const { return _channel; }
+  int8_t RSSI() const { return -55; }
+  String macAddress() const { return "24:0A:C4:00:00:01"; }
+
+  bool softAP(const char *ssid, const char *pass = nullptr) { (void)ssid; (void)pass; _mode = WIFI_AP; return true; }
+  IPAddress softAPIP() const { return IPAddress(192, 168, 4, 1); }
+
+  wifi_event_id_t onEvent(WiFiEventFuncCb cb, arduino_event_id_t event = ARDUINO_EVENT_MAX);
+  void removeEvent(wifi_event_id_t id);
+
+  // Simulator: deliver pending association events
+  void simTick();
+
+private:
+  void fire(arduino_event_id_t event);
+
+  wifi_mode_t   _mode = WIFI_OFF;
+  wl_status_t   _status = WL_IDLE_STATUS;
+  String        _ssid;
+  uint8_t       _bssid[6] = {0x24, 0x0A, 0xC4, 0x11, 0x22, 0x33};
+  int32_t       _channel = 6;
+  bool          _static = false;
+  IPAddress     _ip, _gw, _mask, _dns;
+  unsigned long _connectAt = 0;
+  bool          _pending = false;
+};
+
+extern WiFiClass WiFi;
@@ -0,0 +1,41 @@
+// WiFiClient.h - host stand-in: a plain TCP socket
+#pragma once
+
+#include "Client.h"
+
+class WiFiClient : public Client {
+public:
+  WiFiClient() {}
+  virtual ~WiFiClient() { stop(); }
+  WiFiClient(const WiFiClient &) = delete;
+  WiFiClient &operator=(const WiFiClient &) = delete;
+
+  int connect(IPAddress ip, uint16_t port) override;
+  int connect(const char *host, uint16_t port) override;
+  uint8_t connected() override;
+  void stop() override;
+
+  int available() override;
+  int read() override;
+  int read(uint8_t *buf, size_t size) override;
+  int peek() override;
+  size_t readBytes(char *buffer, size_t length) override;
+  using Stream::readBytes;
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t *buf, size_t size) override;
+  using Print::write;
+  void flush() override {}
+
+  int fd() const { return _fd; }
+
+protected:
+  // Hook for the TLS stand-in: runs once the TCP connection is up
+  virtual bool onConnected(const char *host) { (void)host; return true; }
+
+  bool fill(bool wait);
+
+  int      _fd = -1;
+  uint8_t  _buf[1460];
+  size_t   _head = 0, _tail = 0;
+  bool     _eof = false;
+};
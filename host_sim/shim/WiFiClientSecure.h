@@ -0,0 +1,15 @@
+// WiFiClientSecure.h - host stand-in: TCP to the local mock server,
+// with a simulated handshake cost per new connection
+#pragma once
+
+#include "WiFiClient.h"
+
+class WiFiClientSecure : public WiFiClient {
+public:
+  void setInsecure() {}
+  void setCACert(const char *) {}
+  void setHandshakeTimeout(unsigned long) {}
+
+protected:
+  bool onConnected(const char *host) override;
+};
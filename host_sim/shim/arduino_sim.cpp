@@ -0,0 +1,320 @@
+// arduino_sim.cpp - core Arduino/ESP32 functions for the host build
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "sim.h"
+
+namespace sim {
+
+Stats stats;
+
+static std::atomic<unsigned long long> skippedUs{0};
+static PinReader pinReader = nullptr;
+
+// Static initialisation runs on the thread that goes on to run setup()
+static const std::thread::id clockThread = std::this_thread::get_id();
+static std::atomic<int> tasksAlive{0};
+static std::atomic<int> tasksRunning{0};
+
+long envLong(const char *name, long fallback) {
+  const char *v = getenv(name);
+  return v && *v ? strtol(v, nullptr, 0) : fallback;
+}
+
+const char *envStr(const char *name, const char *fallback) {
+  const char *v = getenv(name);
+  return v && *v ? v : fallback;
+}
+
+void advance(unsigned long ms) {
+  skippedUs += (unsigned long long)ms * 1000ULL;
+}
+
+void setPinReader(PinReader reader) {
+  pinReader = reader;
+}
+
+void tick() {
+  if (ownsClock()) WiFi.simTick();
+}
+
+bool ownsClock() {
+  return std::this_thread::get_id() == clockThread;
+}
+
+void taskStarted() {
+  tasksAlive++;
+  tasksRunning++;
+}
+
+void taskExited() {
+  tasksRunning--;
+  tasksAlive--;
+}
+
+void idle() {
+  pollInterrupts();
+  if (ownsClock()) {
+    if (tasksRunning == 0) advance(1);
+    // Give the tasks a moment, so a skip lands close to what they wait for
+    if (tasksAlive) std::this_thread::sleep_for(std::chrono::microseconds(20));
+    return;
+  }
+  tasksRunning--;
+  std::this_thread::sleep_for(std::chrono::microseconds(50));
+  tasksRunning++;
+}
+
+// Attached GPIO interrupts, with the level each pin had when last checked
+struct PinInterrupt {
+  uint8_t pin;
+  int     mode;
+  void  (*isr)(void *);
+  void   *arg;
+  int     level;
+};
+static std::mutex interruptLock;
+static std::vector<PinInterrupt> interrupts;
+static thread_local bool inInterruptCheck = false;
+
+bool checkingInterrupts() {
+  return inInterruptCheck;
+}
+
+static int pinLevel(uint8_t pin) {
+  inInterruptCheck = true;
+  int level = digitalRead(pin);
+  inInterruptCheck = false;
+  return level;
+}
+
+void pollInterrupts() {
+  std::lock_guard<std::mutex> hold(interruptLock);
+  for (PinInterrupt &irq : interrupts) {
+    int level = pinLevel(irq.pin);
+    bool rose = level == HIGH && irq.level == LOW;
+    bool fell = level == LOW && irq.level == HIGH;
+    irq.level = level;
+    if ((rose && (irq.mode & RISING)) || (fell && (irq.mode & FALLING))) irq.isr(irq.arg);
+  }
+}
+
+static void attachIsr(uint8_t pin, void (*isr)(void *), void *arg, int mode) {
+  std::lock_guard<std::mutex> hold(interruptLock);
+  interrupts.erase(std::remove_if(interrupts.begin(), interrupts.end(),
+                                  [pin](const PinInterrupt &irq) { return irq.pin == pin; }),
+                   interrupts.end());
+  interrupts.push_back({pin, mode, isr, arg, pinLevel(pin)});
+}
+
+static void detachIsr(uint8_t pin) {
+  std::lock_guard<std::mutex> hold(interruptLock);
+  interrupts.erase(std::remove_if(interrupts.begin(), interrupts.end(),
+                                  [pin](const PinInterrupt &irq) { return irq.pin == pin; }),
+                   interrupts.end());
+}
+
+void printStats() {
+  fprintf(stdout,
+          "[SIM] stats: tcp_connects=%u tls_handshakes=%u rx=%llu tx=%llu "
+          "spi_transactions=%u spi_bytes=%llu refreshes=%u reboots=%u slept_ms=%llu "
+          "spi_conflicts=%u busy_reads=%u\n",
+          stats.tcpConnects, stats.tlsHandshakes,
+          (unsigned long long)stats.bytesRx, (unsigned long long)stats.bytesTx,
+          stats.spiTransactions, (unsigned long long)stats.spiBytes,
+          stats.refreshes, stats.reboots, (unsigned long long)stats.sleptMs,
+          stats.spiConflicts, stats.busyReads);
+  fflush(stdout);
+}
+
+}  // namespace sim
+
+static const auto bootTime = std::chrono::steady_clock::now();
+
+unsigned long micros() {
+  auto real = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - bootTime).count();
+  return (unsigned long)(real + sim::skippedUs.load());
+}
+
+unsigned long millis() {
+  return micros() / 1000UL;
+}
+
+// Delays are skipped rather than slept, so long waits cost no wall time.
+// A task (another core) waits for the sketch's clock instead.
+void delay(unsigned long ms) {
+  if (!sim::ownsClock()) {
+    unsigned long start = millis();
+    while (millis() - start < ms) sim::idle();
+    return;
+  }
+  sim::advance(ms);
+  sim::tick();
+  std::this_thread::yield();
+}
+
+void delayMicroseconds(unsigned int us) {
+  if (!sim::ownsClock()) {
+    unsigned long start = micros();
+    while (micros() - start < us) std::this_thread::yield();
+    return;
+  }
+  sim::skippedUs += us;
+}
+
+void yield() {
+  if (!sim::ownsClock()) {
+    sim::idle();
+    return;
+  }
+  sim::tick();
+  std::this_thread::yield();
+}
+
+// Reproducible per run, but different on every simulated boot
+static std::mt19937 rng((uint32_t)sim::envLong("SIM_SEED", 1) * 1000003u + (uint32_t)sim::envLong("SIM_MAX_BOOTS", 1));
+
+long random(long max) {
+  if (max <= 0) return 0;
+  return (long)(rng() % (unsigned long)max);
+}
+
+long random(long min, long max) {
+  if (min >= max) return min;
+  return min + random(max - min);
+}
+
+void randomSeed(unsigned long seed) {
+  // Keep runs reproducible: SIM_SEED wins over the sketch's seed
+  (void)seed;
+}
+
+uint32_t esp_random() {
+  return rng();
+}
+
+static uint8_t pinLatch[64];
+static bool pinLatchInit = false;
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (!pinLatchInit) {
+    memset(pinLatch, 0, sizeof(pinLatch));
+    pinLatchInit = true;
+  }
+  if (pin < 64 && mode == INPUT_PULLUP) pinLatch[pin] = HIGH;
+}
+
+int digitalRead(uint8_t pin) {
+  int button = sim::buttonRead(pin);
+  if (button >= 0) return button;
+  if (sim::pinReader) {
+    int v = sim::pinReader(pin);
+    if (v >= 0) return v;
+  }
+  return pin < 64 ? pinLatch[pin] : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  if (pin < 64) pinLatch[pin] = val ? HIGH : LOW;
+}
+
+void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder, uint8_t val) {
+  for (int i = 0; i < 8; i++) {
+    int bit = bitOrder == LSBFIRST ? i : 7 - i;
+    digitalWrite(dataPin, (val >> bit) & 1);
+    digitalWrite(clockPin, HIGH);
+    digitalWrite(clockPin, LOW);
+  }
+}
+
+void attachInterruptArg(uint8_t pin, void (*isr)(void *), void *arg, int mode) {
+  sim::attachIsr(pin, isr, arg, mode);
+}
+
+void detachInterrupt(uint8_t pin) {
+  sim::detachIsr(pin);
+}
+
+HardwareSerial Serial;
+EspClass ESP;
+
+void EspClass::restart() {
+  fflush(stdout);
+  throw sim::Reboot{false};
+}
+
+// Heap figures come from the simulator's allocation tracker
+namespace sim {
+uint32_t heapFree();
+uint32_t heapMinFree();
+uint32_t heapLargestFree();
+uint32_t heapSize();
+}
+
+uint32_t EspClass::getFreeHeap() { return sim::heapFree(); }
+uint32_t EspClass::getMinFreeHeap() { return sim::heapMinFree(); }
+uint32_t EspClass::getMaxAllocHeap() { return sim::heapLargestFree(); }
+uint32_t EspClass::getHeapSize() { return sim::heapSize(); }
+
+// ----------------------------------------
+// Number formatting
+// ----------------------------------------
+
+char *ultoa(unsigned long value, char *str, int base) {
+  char tmp[sizeof(unsigned long) * 8 + 1];
+  int i = 0;
+  do {
+    int d = (int)(value % base);
+    tmp[i++] = (char)(d < 10 ? '0' + d : 'a' + d - 10);
+    value /= base;
+  } while (value);
+  int j = 0;
+  while (i) str[j++] = tmp[--i];
+  str[j] = '\0';
+  return str;
+}
+
+char *ltoa(long value, char *str, int base) {
+  if (value < 0 && base == 10) {
+    str[0] = '-';
+    ultoa((unsigned long)(-value), str + 1, base);
+    return str;
+  }
+  return ultoa((unsigned long)value, str, base);
+}
+
+char *itoa(int value, char *str, int base) { return ltoa(value, str, base); }
+char *utoa(unsigned int value, char *str, int base) { return ultoa(value, str, base); }
+
+char *dtostrf(double value, signed char width, unsigned char prec, char *buf) {
+  sprintf(buf, "%*.*f", width, prec, value);
+  return buf;
+}
+
+// ---- Serial input ----
+
+static const char *serialInput = nullptr;
+
+void HardwareSerial::begin(unsigned long) {
+  serialInput = getenv("SIM_SERIAL_INPUT");
+}
+
+int HardwareSerial::available() {
+  return serialInput ? (int)strlen(serialInput) : 0;
+}
+
+int HardwareSerial::read() {
+  if (!serialInput || !*serialInput) return -1;
+  return (unsigned char)*serialInput++;
+}
+
+int HardwareSerial::peek() {
+  return serialInput && *serialInput ? (unsigned char)*serialInput : -1;
+}
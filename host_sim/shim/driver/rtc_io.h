@@ -0,0 +1,14 @@
+// driver/rtc_io.h - host stand-in for the RTC GPIO driver
+#pragma once
+
+#include "../esp_err.h"
+#include "../../include/driver/gpio.h"
+
+inline esp_err_t rtc_gpio_pullup_en(gpio_num_t) { return ESP_OK; }
+inline esp_err_t rtc_gpio_pullup_dis(gpio_num_t) { return ESP_OK; }
+inline esp_err_t rtc_gpio_pulldown_en(gpio_num_t) { return ESP_OK; }
+inline esp_err_t rtc_gpio_pulldown_dis(gpio_num_t) { return ESP_OK; }
+inline esp_err_t rtc_gpio_hold_en(gpio_num_t) { return ESP_OK; }
+inline esp_err_t rtc_gpio_hold_dis(gpio_num_t) { return ESP_OK; }
+inline esp_err_t rtc_gpio_init(gpio_num_t) { return ESP_OK; }
+inline esp_err_t rtc_gpio_deinit(gpio_num_t) { return ESP_OK; }
@@ -0,0 +1,15 @@
+// freertos/queue.h - host stand-in for FreeRTOS queues (items copied
+// in and out by value, like the real thing). Blocking sends and
+// receives wait on the virtual clock.
+#pragma once
+
+#include "FreeRTOS.h"
+
+struct QueueDefinition;
+typedef QueueDefinition *QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+void vQueueDelete(QueueHandle_t queue);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticksToWait);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *buffer, TickType_t ticksToWait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
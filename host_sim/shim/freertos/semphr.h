@@ -0,0 +1,15 @@
+// freertos/semphr.h - host stand-in for FreeRTOS binary semaphores.
+// Taking one waits on the virtual clock, like a queue receive; giving
+// from an "ISR" is the same as giving from a task.
+#pragma once
+
+#include "FreeRTOS.h"
+
+struct SemaphoreDefinition;
+typedef SemaphoreDefinition *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t *higherPriorityTaskWoken);
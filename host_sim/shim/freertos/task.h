@@ -0,0 +1,18 @@
+// freertos/task.h - host stand-in for FreeRTOS tasks. Each task is a
+// thread; the core and priority are ignored (see sim.h for how tasks
+// share the virtual clock with the sketch).
+#pragma once
+
+#include "FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void *);
+struct tskTaskControlBlock;
+typedef tskTaskControlBlock *TaskHandle_t;
+
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char *name,
+                                   uint32_t stackDepth, void *param,
+                                   UBaseType_t priority, TaskHandle_t *created,
+                                   BaseType_t coreId);
+void vTaskDelay(TickType_t ticks);
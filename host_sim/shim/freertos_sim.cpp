@@ -0,0 +1,175 @@
+// freertos_sim.cpp - FreeRTOS primitives for the host build
+
+#include <Arduino.h>
+#include <freertos/event_groups.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "sim.h"
+
+struct EventGroupDef_t {
+  std::atomic<EventBits_t> bits{0};
+};
+
+EventGroupHandle_t xEventGroupCreate(void) {
+  return new EventGroupDef_t();
+}
+
+void vEventGroupDelete(EventGroupHandle_t group) {
+  delete group;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits) {
+  return group->bits |= bits;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits) {
+  return group->bits.fetch_and(~bits);
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group) {
+  return group->bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits,
+                                BaseType_t clearOnExit, BaseType_t waitForAll,
+                                TickType_t ticksToWait) {
+  unsigned long start = millis();
+  while (true) {
+    sim::tick();
+    EventBits_t now = group->bits;
+    bool done = waitForAll ? (now & bits) == bits : (now & bits) != 0;
+    if (done) {
+      if (clearOnExit) group->bits.fetch_and(~bits);
+      return now;
+    }
+    if (ticksToWait != portMAX_DELAY && millis() - start >= ticksToWait) return now;
+    sim::idle();
+  }
+}
+
+// ---- Tasks ----
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char *name,
+                                   uint32_t stackDepth, void *param,
+                                   UBaseType_t priority, TaskHandle_t *created,
+                                   BaseType_t coreId) {
+  (void)name;
+  (void)stackDepth;
+  (void)priority;
+  (void)coreId;
+  sim::taskStarted();   // counted as running before it is scheduled
+  std::thread([code, param] {
+    code(param);
+    sim::taskExited();
+  }).detach();
+  if (created) *created = nullptr;
+  return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks) {
+  delay(ticks * portTICK_PERIOD_MS);
+}
+
+// ---- Queues ----
+
+struct QueueDefinition {
+  std::mutex           lock;
+  std::vector<uint8_t> items;    // ring of `length` items
+  UBaseType_t          length;
+  UBaseType_t          itemSize;
+  UBaseType_t          head = 0;
+  UBaseType_t          count = 0;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+  QueueDefinition *q = new QueueDefinition();
+  q->items.resize((size_t)length * itemSize);
+  q->length = length;
+  q->itemSize = itemSize;
+  return q;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+  delete queue;
+}
+
+static bool tryPush(QueueHandle_t q, const void *item) {
+  std::lock_guard<std::mutex> hold(q->lock);
+  if (q->count == q->length) return false;
+  UBaseType_t slot = (q->head + q->count) % q->length;
+  memcpy(&q->items[(size_t)slot * q->itemSize], item, q->itemSize);
+  q->count++;
+  return true;
+}
+
+static bool tryPop(QueueHandle_t q, void *buffer) {
+  std::lock_guard<std::mutex> hold(q->lock);
+  if (q->count == 0) return false;
+  memcpy(buffer, &q->items[(size_t)q->head * q->itemSize], q->itemSize);
+  q->head = (q->head + 1) % q->length;
+  q->count--;
+  return true;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticksToWait) {
+  unsigned long start = millis();
+  while (!tryPush(queue, item)) {
+    if (ticksToWait != portMAX_DELAY && millis() - start >= ticksToWait) return pdFALSE;
+    sim::tick();
+    sim::idle();
+  }
+  return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *buffer, TickType_t ticksToWait) {
+  unsigned long start = millis();
+  while (!tryPop(queue, buffer)) {
+    if (ticksToWait != portMAX_DELAY && millis() - start >= ticksToWait) return pdFALSE;
+    sim::tick();
+    sim::idle();
+  }
+  return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+  std::lock_guard<std::mutex> hold(queue->lock);
+  return queue->count;
+}
+
+// ---- Semaphores ----
+
+struct SemaphoreDefinition {
+  std::atomic<bool> given{false};
+};
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+  return new SemaphoreDefinition();   // created empty, as on the device
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+  delete semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+  unsigned long start = millis();
+  while (!semaphore->given.exchange(false)) {
+    if (ticksToWait != portMAX_DELAY && millis() - start >= ticksToWait) return pdFALSE;
+    sim::tick();
+    sim::idle();
+  }
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+  return semaphore->given.exchange(true) ? pdFALSE : pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t *higherPriorityTaskWoken) {
+  if (higherPriorityTaskWoken) *higherPriorityTaskWoken = pdFALSE;
+  return xSemaphoreGive(semaphore);
+}
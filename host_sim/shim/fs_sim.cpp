@@ -0,0 +1,58 @@
+// fs_sim.cpp - host directory backed filesystem
+
+#include <FS.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs {
+
+int File::available() {
+  if (!_f) return 0;
+  long pos = ftell(_f.get());
+  return (int)(size() - (size_t)pos);
+}
+
+int File::peek() {
+  if (!_f) return -1;
+  int c = fgetc(_f.get());
+  if (c >= 0) ungetc(c, _f.get());
+  return c;
+}
+
+size_t File::size() const {
+  if (!_f) return 0;
+  struct stat st;
+  fflush(_f.get());
+  return fstat(fileno(_f.get()), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+String FS::hostPath(const char *path) const {
+  return _root + path;
+}
+
+File FS::open(const char *path, const char *mode, bool create) {
+  (void)create;
+  String host = hostPath(path);
+  const char *m = strcmp(mode, FILE_WRITE) == 0 ? "w+b" : strcmp(mode, FILE_APPEND) == 0 ? "a+b" : strcmp(mode, "r+") == 0 ? "r+b" : "rb";
+  FILE *f = fopen(host.c_str(), m);
+  return f ? File(f, path) : File();
+}
+
+bool FS::exists(const char *path) {
+  struct stat st;
+  return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char *path) {
+  return ::unlink(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const char *from, const char *to) {
+  return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+}
+
+bool FS::mkdir(const char *path) {
+  return ::mkdir(hostPath(path).c_str(), 0755) == 0;
+}
+
+}  // namespace fs
@@ -0,0 +1,83 @@
+// heap_sim.cpp - allocation tracker standing in for the ESP32 heap.
+// Wraps the glibc allocator so every malloc/new made by the sketch and
+// its libraries is counted against a simulated SIM_HEAP_SIZE budget.
+
+#include <malloc.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include "sim.h"
+
+extern "C" {
+void *__libc_malloc(size_t);
+void *__libc_calloc(size_t, size_t);
+void *__libc_realloc(void *, size_t);
+void __libc_free(void *);
+}
+
+static std::atomic<long> inUse{0};
+static std::atomic<long> peakUse{0};
+
+static void account(long delta) {
+  long now = inUse += delta;
+  long peak = peakUse.load();
+  while (now > peak && !peakUse.compare_exchange_weak(peak, now)) {
+  }
+}
+
+extern "C" {
+
+void *malloc(size_t n) {
+  void *p = __libc_malloc(n);
+  if (p) account((long)malloc_usable_size(p));
+  return p;
+}
+
+void *calloc(size_t n, size_t size) {
+  void *p = __libc_calloc(n, size);
+  if (p) account((long)malloc_usable_size(p));
+  return p;
+}
+
+void *realloc(void *old, size_t n) {
+  long before = old ? (long)malloc_usable_size(old) : 0;
+  void *p = __libc_realloc(old, n);
+  if (p) account((long)malloc_usable_size(p) - before);
+  else if (n == 0) account(-before);
+  return p;
+}
+
+void free(void *p) {
+  if (!p) return;
+  account(-(long)malloc_usable_size(p));
+  __libc_free(p);
+}
+
+}  // extern "C"
+
+namespace sim {
+
+static long heapTotal() {
+  return envLong("SIM_HEAP_SIZE", 320 * 1024);
+}
+
+uint32_t heapSize() { return (uint32_t)heapTotal(); }
+
+uint32_t heapFree() {
+  long f = heapTotal() - inUse.load();
+  return f > 0 ? (uint32_t)f : 0;
+}
+
+uint32_t heapMinFree() {
+  long f = heapTotal() - peakUse.load();
+  return f > 0 ? (uint32_t)f : 0;
+}
+
+// No fragmentation model: the largest block is all that is free
+uint32_t heapLargestFree() { return heapFree(); }
+
+uint32_t heapPeakUsed() { return (uint32_t)peakUse.load(); }
+
+void heapResetPeak() { peakUse = inUse.load(); }
+
+}  // namespace sim
@@ -0,0 +1,228 @@
+// http_client.cpp - HTTP/1.x client for the host build, modelled on the
+// ESP32 HTTPClient: keep-alive reuse, chunked bodies, collected headers.
+
+#include <HTTPClient.h>
+#include <WiFiClientSecure.h>
+#include "sim.h"
+
+HTTPClient::~HTTPClient() {
+  if (_client) _client->stop();
+  delete _ownClient;
+}
+
+bool HTTPClient::begin(WiFiClient &client, const String &url) {
+  if (_client != &client) {
+    disconnect();
+    _client = &client;
+  }
+
+  int schemeEnd = url.indexOf("://");
+  if (schemeEnd < 0) return false;
+  String scheme = url.substring(0, schemeEnd);
+  String rest = url.substring(schemeEnd + 3);
+
+  int slash = rest.indexOf('/');
+  String hostPort = slash < 0 ? rest : rest.substring(0, slash);
+  _uri = slash < 0 ? String("/") : rest.substring(slash);
+
+  int colon = hostPort.indexOf(':');
+  String host = colon < 0 ? hostPort : hostPort.substring(0, colon);
+  _port = colon < 0 ? (scheme == "https" ? 443 : 80) : (uint16_t)hostPort.substring(colon + 1).toInt();
+
+  // A different host can't share the open socket
+  if (_host.length() > 0 && host != _host && _client->connected()) _client->stop();
+  _host = host;
+
+  _headers = "";
+  _returnCode = 0;
+  _size = -1;
+  _chunked = false;
+  for (auto &h : _collected) h.second = "";
+  return true;
+}
+
+bool HTTPClient::begin(const String &url) {
+  if (!_ownClient) _ownClient = url.startsWith("https") ? new WiFiClientSecure() : new WiFiClient();
+  return begin(*_ownClient, url);
+}
+
+void HTTPClient::disconnect(bool preserveClient) {
+  (void)preserveClient;
+  if (!_client) return;
+  if (_client->connected()) {
+    if (_reuse && _canReuse) return;   // keep open for the next request
+    _client->stop();
+  }
+}
+
+void HTTPClient::end() {
+  disconnect(false);
+}
+
+bool HTTPClient::connected() {
+  return _client && _client->connected();
+}
+
+void HTTPClient::addHeader(const String &name, const String &value, bool first, bool replace) {
+  (void)replace;
+  String line = name + ": " + value + "\r\n";
+  if (first) _headers = line + _headers;
+  else _headers += line;
+}
+
+void HTTPClient::collectHeaders(const char *headerKeys[], const size_t headerKeysCount) {
+  _collected.clear();
+  for (size_t i = 0; i < headerKeysCount; i++) _collected.push_back({String(headerKeys[i]), String()});
+}
+
+String HTTPClient::header(const char *name) {
+  for (auto &h : _collected) {
+    if (h.first.equalsIgnoreCase(name)) return h.second;
+  }
+  return String();
+}
+
+String HTTPClient::header(size_t i) { return i < _collected.size() ? _collected[i].second : String(); }
+String HTTPClient::headerName(size_t i) { return i < _collected.size() ? _collected[i].first : String(); }
+
+bool HTTPClient::hasHeader(const char *name) {
+  for (auto &h : _collected) {
+    if (h.first.equalsIgnoreCase(name) && h.second.length() > 0) return true;
+  }
+  return false;
+}
+
+bool HTTPClient::connect() {
+  if (_client->connected()) {
+    return true;   // reuse the keep-alive socket
+  }
+  _client->setTimeout(_tcpTimeout);
+  return _client->connect(_host.c_str(), _port);
+}
+
+int HTTPClient::GET() { return sendRequest("GET"); }
+int HTTPClient::POST(const String &payload) { return sendRequest("POST", payload); }
+int HTTPClient::POST(uint8_t *payload, size_t size) { return sendRequest("POST", payload, size); }
+int HTTPClient::PATCH(const String &payload) { return sendRequest("PATCH", payload); }
+int HTTPClient::PUT(const String &payload) { return sendRequest("PUT", payload); }
+
+int HTTPClient::sendRequest(const char *type, const String &payload) {
+  return sendRequest(type, (uint8_t *)payload.c_str(), payload.length());
+}
+
+int HTTPClient::sendRequest(const char *type, uint8_t *payload, size_t size) {
+  if (!_client) return HTTPC_ERROR_NOT_CONNECTED;
+  if (!connect()) return HTTPC_ERROR_CONNECTION_REFUSED;
+
+  String req = String(type) + " " + _uri + (_useHTTP10 ? " HTTP/1.0\r\n" : " HTTP/1.1\r\n");
+  req += "Host: " + _host + "\r\n";
+  req += "User-Agent: " + _userAgent + "\r\n";
+  req += String("Connection: ") + (_reuse ? "keep-alive" : "close") + "\r\n";
+  if (!_useHTTP10) req += "Accept-Encoding: identity;q=1,chunked;q=0.1,*;q=0\r\n";
+  if (payload && size > 0) req += "Content-Length: " + String((unsigned long)size) + "\r\n";
+  else if (strcmp(type, "POST") == 0 || strcmp(type, "PATCH") == 0 || strcmp(type, "PUT") == 0)
+    req += "Content-Length: 0\r\n";
+  req += _headers;
+  req += "\r\n";
+
+  if (_client->write((const uint8_t *)req.c_str(), req.length()) != req.length()) {
+    return HTTPC_ERROR_SEND_HEADER_FAILED;
+  }
+  if (payload && size > 0 && _client->write(payload, size) != size) {
+    return HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+  }
+  return handleHeaderResponse();
+}
+
+int HTTPClient::handleHeaderResponse() {
+  _returnCode = 0;
+  _size = -1;
+  _chunked = false;
+  _canReuse = _reuse;
+
+  while (true) {
+    String line = _client->readStringUntil('\n');
+    if (line.length() == 0 && !_client->connected()) {
+      return _returnCode ? _returnCode : HTTPC_ERROR_CONNECTION_LOST;
+    }
+    line.trim();
+
+    if (line.startsWith("HTTP/1.")) {
+      if (_canReuse) _canReuse = line[7] != '0';
+      _returnCode = line.substring(9, line.indexOf(' ', 9)).toInt();
+    } else if (line.length() == 0) {
+      break;   // end of headers
+    } else {
+      int colon = line.indexOf(':');
+      if (colon < 0) continue;
+      String name = line.substring(0, colon);
+      String value = line.substring(colon + 1);
+      value.trim();
+
+      if (name.equalsIgnoreCase("Content-Length")) _size = value.toInt();
+      if (name.equalsIgnoreCase("Connection") && value.indexOf("close") >= 0 &&
+          value.indexOf("keep-alive") < 0) {
+        _canReuse = false;
+      }
+      if (name.equalsIgnoreCase("Transfer-Encoding") && value.equalsIgnoreCase("chunked")) {
+        _chunked = true;
+      }
+      for (auto &h : _collected) {
+        if (h.first.equalsIgnoreCase(name)) h.second = value;
+      }
+    }
+  }
+
+  if (_chunked) _size = -1;
+  return _returnCode ? _returnCode : HTTPC_ERROR_NO_HTTP_SERVER;
+}
+
+String HTTPClient::getString() {
+  String out;
+  if (!_client) return out;
+
+  if (_chunked) {
+    while (true) {
+      String sizeLine = _client->readStringUntil('\n');
+      long n = strtol(sizeLine.c_str(), nullptr, 16);
+      if (n <= 0) {
+        _client->readStringUntil('\n');   // trailer terminator
+        break;
+      }
+      std::string buf((size_t)n, '\0');
+      size_t got = _client->readBytes(&buf[0], (size_t)n);
+      out.concat(buf.data(), (unsigned int)got);
+      _client->readStringUntil('\n');
+      if (got < (size_t)n) break;
+    }
+  } else if (_size >= 0) {
+    std::string buf((size_t)_size, '\0');
+    size_t got = _size ? _client->readBytes(&buf[0], (size_t)_size) : 0;
+    out.concat(buf.data(), (unsigned int)got);
+  } else {
+    out = _client->readString();
+  }
+  return out;
+}
+
+int HTTPClient::writeToStream(Stream *stream) {
+  String body = getString();
+  return (int)stream->write((const uint8_t *)body.c_str(), body.length());
+}
+
+String HTTPClient::errorToString(int error) {
+  switch (error) {
+    case HTTPC_ERROR_CONNECTION_REFUSED: return "connection refused";
+    case HTTPC_ERROR_SEND_HEADER_FAILED: return "send header failed";
+    case HTTPC_ERROR_SEND_PAYLOAD_FAILED: return "send payload failed";
+    case HTTPC_ERROR_NOT_CONNECTED: return "not connected";
+    case HTTPC_ERROR_CONNECTION_LOST: return "connection lost";
+    case HTTPC_ERROR_NO_STREAM: return "no stream";
+    case HTTPC_ERROR_NO_HTTP_SERVER: return "no HTTP server";
+    case HTTPC_ERROR_TOO_LESS_RAM: return "too less ram";
+    case HTTPC_ERROR_ENCODING: return "Transfer-Encoding not supported";
+    case HTTPC_ERROR_STREAM_WRITE: return "Stream write error";
+    case HTTPC_ERROR_READ_TIMEOUT: return "read Timeout";
+    default: return String();
+  }
+}
@@ -0,0 +1,21 @@
+// littlefs_sim.cpp - LittleFS on a host directory
+
+#include <LittleFS.h>
+#include <sys/stat.h>
+#include <stdlib.h>
+
+LittleFSFS LittleFS;
+
+bool LittleFSFS::begin(bool formatOnFail, const char *, uint8_t, const char *) {
+  (void)formatOnFail;
+  const char *dir = getenv("SIM_FS_DIR");
+  _root = dir ? dir : "fs";
+  ::mkdir(_root.c_str(), 0755);
+  struct stat st;
+  return stat(_root.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+bool LittleFSFS::format() {
+  String cmd = "rm -rf '" + _root + "'/*";
+  return system(cmd.c_str()) == 0;
+}
@@ -0,0 +1,3 @@
+// pgmspace.h - host stand-in: program memory is ordinary memory
+#pragma once
+#include <Arduino.h>
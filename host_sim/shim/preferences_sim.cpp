@@ -0,0 +1,141 @@
+// preferences_sim.cpp - file-backed NVS for the host build
+
+#include <Preferences.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "sim.h"
+
+typedef std::map<std::string, std::vector<uint8_t>> Namespace;
+static std::map<std::string, Namespace> store;
+static bool loaded = false;
+static sim::NvsStats counters{0, 0};
+
+namespace sim {
+NvsStats nvsStats() { return counters; }
+}
+
+static std::string storePath() {
+  return sim::envStr("SIM_NVS_FILE", "sim_nvs.bin");
+}
+
+// Record format: ns \0 key \0 u32 len, bytes
+static void load() {
+  if (loaded) return;
+  loaded = true;
+  FILE *f = fopen(storePath().c_str(), "rb");
+  if (!f) return;
+  while (true) {
+    std::string ns, key;
+    int c;
+    while ((c = fgetc(f)) > 0) ns += (char)c;
+    if (c < 0) break;
+    while ((c = fgetc(f)) > 0) key += (char)c;
+    uint32_t len;
+    if (fread(&len, 4, 1, f) != 1) break;
+    std::vector<uint8_t> v(len);
+    if (len && fread(v.data(), 1, len, f) != len) break;
+    store[ns][key] = v;
+  }
+  fclose(f);
+}
+
+static void save() {
+  FILE *f = fopen(storePath().c_str(), "wb");
+  if (!f) return;
+  for (auto &ns : store) {
+    for (auto &kv : ns.second) {
+      fwrite(ns.first.c_str(), 1, ns.first.size() + 1, f);
+      fwrite(kv.first.c_str(), 1, kv.first.size() + 1, f);
+      uint32_t len = (uint32_t)kv.second.size();
+      fwrite(&len, 4, 1, f);
+      fwrite(kv.second.data(), 1, len, f);
+    }
+  }
+  fclose(f);
+}
+
+bool Preferences::begin(const char *name, bool readOnly, const char *partition) {
+  (void)partition;
+  load();
+  if (_started) return false;
+  _ns = name;
+  _readOnly = readOnly;
+  _started = true;
+  counters.opens++;
+  return true;
+}
+
+void Preferences::end() {
+  _started = false;
+}
+
+bool Preferences::clear() {
+  if (!_started || _readOnly) return false;
+  store[_ns.c_str()].clear();
+  counters.writes++;
+  save();
+  return true;
+}
+
+bool Preferences::remove(const char *key) {
+  if (!_started || _readOnly) return false;
+  bool had = store[_ns.c_str()].erase(key) > 0;
+  if (had) {
+    counters.writes++;
+    save();
+  }
+  return had;
+}
+
+bool Preferences::isKey(const char *key) {
+  if (!_started) return false;
+  Namespace &ns = store[_ns.c_str()];
+  return ns.find(key) != ns.end();
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t len) {
+  if (!_started || _readOnly || strlen(key) > 15) return 0;
+  const uint8_t *p = (const uint8_t *)value;
+  std::vector<uint8_t> v(p, p + len);
+  Namespace &ns = store[_ns.c_str()];
+  auto it = ns.find(key);
+  if (it == ns.end() || it->second != v) {   // NVS skips identical writes
+    ns[key] = v;
+    counters.writes++;
+    save();
+  }
+  return len;
+}
+
+size_t Preferences::getBytes(const char *key, void *buf, size_t maxLen) {
+  if (!_started) return 0;
+  Namespace &ns = store[_ns.c_str()];
+  auto it = ns.find(key);
+  if (it == ns.end() || it->second.size() > maxLen) return 0;
+  memcpy(buf, it->second.data(), it->second.size());
+  return it->second.size();
+}
+
+size_t Preferences::getBytesLength(const char *key) {
+  if (!_started) return 0;
+  Namespace &ns = store[_ns.c_str()];
+  auto it = ns.find(key);
+  return it == ns.end() ? 0 : it->second.size();
+}
+
+size_t Preferences::putString(const char *key, const char *value) {
+  return putBytes(key, value, strlen(value) + 1);
+}
+
+String Preferences::getString(const char *key, const String &defaultValue) {
+  if (!_started) return defaultValue;
+  Namespace &ns = store[_ns.c_str()];
+  auto it = ns.find(key);
+  if (it == ns.end() || it->second.empty()) return defaultValue;
+  return String((const char *)it->second.data());
+}
+
+size_t Preferences::getString(const char *key, char *value, size_t maxLen) {
+  return getBytes(key, value, maxLen);
+}
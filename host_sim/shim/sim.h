@@ -0,0 +1,71 @@
+// sim.h - simulator state shared by the shim implementations
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace sim {
+
+// Counters reported at the end of a run
+struct Stats {
+  uint32_t tcpConnects   = 0;
+  uint32_t tlsHandshakes = 0;
+  uint64_t bytesRx       = 0;
+  uint64_t bytesTx       = 0;
+  uint32_t spiTransactions = 0;
+  uint64_t spiBytes      = 0;
+  uint32_t spiConflicts  = 0;   // overlapping transactions, commands while BUSY
+  uint32_t busyReads     = 0;   // reads of the panel's BUSY pin
+  uint32_t refreshes     = 0;
+  uint32_t reboots       = 0;
+  uint64_t sleptMs       = 0;
+};
+extern Stats stats;
+
+// Environment-configurable knobs (see README.md)
+long envLong(const char *name, long fallback);
+const char *envStr(const char *name, const char *fallback);
+
+// Virtual time: real elapsed time plus skipped (delay / deep sleep) time
+void advance(unsigned long ms);
+
+// GPIO input override: returns -1 to fall through to the pin latch
+typedef int (*PinReader)(uint8_t pin);
+void setPinReader(PinReader reader);
+
+// GPIO interrupts (attachInterruptArg) are raised from the wait loops:
+// each idle() step checks the attached pins for an edge. Pin reads made
+// by that check are not the sketch's, so they are not counted.
+void pollInterrupts();
+bool checkingInterrupts();
+
+// Called from delay()/yield(): lets simulated peripherals make progress
+// (on the sketch's thread only)
+void tick();
+
+// FreeRTOS tasks other than the sketch's run on threads of their own.
+// Only the sketch's thread skips time; a task waits for the clock, and
+// while a task is running (not waiting) the sketch's waits pass in real
+// time instead of skipping ahead of it.
+bool ownsClock();
+void taskStarted();
+void taskExited();
+
+// One step of a wait loop: on the sketch's thread, skip 1 ms unless a
+// task is running; on a task's thread, sleep briefly as not running
+void idle();
+
+// Thrown by ESP.restart() and deep sleep, caught by the simulator main
+struct Reboot {
+  bool deepSleep;
+};
+
+void printStats();
+
+// Deep sleep length requested by esp_deep_sleep_start()
+extern unsigned long long pendingSleepUs;
+
+// Simulated push button (logout): level, or -1 if the pin isn't the button
+int buttonRead(uint8_t pin);
+
+}  // namespace sim
@@ -0,0 +1,171 @@
+// sim_main.cpp - entry point of the host simulator.
+//
+// Runs setup() and then loop() until SIM_RUN_MS of simulated time has
+// passed. ESP.restart() and deep sleep re-exec the binary, so every boot
+// starts from fresh globals, as on the device; RTC_DATA_ATTR variables
+// are carried across deep sleep through SIM_RTC_FILE.
+
+#include <Arduino.h>
+#include <Preferences.h>   // sim::nvsStats
+#include <sys/time.h>
+#include <unistd.h>
+#include <time.h>
+#include "sim.h"
+
+void setup();
+void loop();
+
+extern "C" {
+extern uint8_t __start_rtcdata[] __attribute__((weak));
+extern uint8_t __stop_rtcdata[] __attribute__((weak));
+}
+
+namespace sim {
+uint32_t heapPeakUsed();
+}
+
+static char **simArgv;
+static unsigned long long epochAtBootUs;
+
+static const char *rtcPath() {
+  return sim::envStr("SIM_RTC_FILE", "sim_rtc.bin");
+}
+
+static size_t rtcSize() {
+  return (__start_rtcdata && __stop_rtcdata) ? (size_t)(__stop_rtcdata - __start_rtcdata) : 0;
+}
+
+static void saveRtc() {
+  FILE *f = fopen(rtcPath(), "wb");
+  if (!f) return;
+  if (rtcSize()) fwrite(__start_rtcdata, 1, rtcSize(), f);
+  fclose(f);
+}
+
+static void restoreRtc() {
+  FILE *f = fopen(rtcPath(), "rb");
+  if (!f) return;
+  if (rtcSize()) {
+    size_t n = fread(__start_rtcdata, 1, rtcSize(), f);
+    (void)n;
+  }
+  fclose(f);
+}
+
+// Carry counters and the wall clock into the next boot
+static void carryState(unsigned long long sleepUs) {
+  char buf[256];
+  snprintf(buf, sizeof(buf), "%u,%u,%llu,%llu,%u,%llu,%u,%u,%llu,%u,%u",
+           sim::stats.tcpConnects, sim::stats.tlsHandshakes,
+           (unsigned long long)sim::stats.bytesRx, (unsigned long long)sim::stats.bytesTx,
+           sim::stats.spiTransactions, (unsigned long long)sim::stats.spiBytes,
+           sim::stats.refreshes, sim::stats.reboots + 1,
+           (unsigned long long)(sim::stats.sleptMs + sleepUs / 1000ULL),
+           sim::stats.spiConflicts, sim::stats.busyReads);
+  setenv("SIM_STATS_CARRY", buf, 1);
+
+  snprintf(buf, sizeof(buf), "%llu", epochAtBootUs + micros() + sleepUs);
+  setenv("SIM_EPOCH_US", buf, 1);
+}
+
+static void loadCarriedState() {
+  const char *carry = getenv("SIM_STATS_CARRY");
+  if (carry) {
+    unsigned long long rx, tx, spiBytes, slept;
+    sscanf(carry, "%u,%u,%llu,%llu,%u,%llu,%u,%u,%llu,%u,%u",
+           &sim::stats.tcpConnects, &sim::stats.tlsHandshakes, &rx, &tx,
+           &sim::stats.spiTransactions, &spiBytes,
+           &sim::stats.refreshes, &sim::stats.reboots, &slept,
+           &sim::stats.spiConflicts, &sim::stats.busyReads);
+    sim::stats.bytesRx = rx;
+    sim::stats.bytesTx = tx;
+    sim::stats.spiBytes = spiBytes;
+    sim::stats.sleptMs = slept;
+  }
+
+  const char *epoch = getenv("SIM_EPOCH_US");
+  if (epoch) {
+    epochAtBootUs = strtoull(epoch, nullptr, 10);
+  } else {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    epochAtBootUs = (unsigned long long)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+  }
+}
+
+// Wall clock: keeps running across simulated reboots and deep sleep
+extern "C" time_t time(time_t *t) {
+  time_t now = (time_t)((epochAtBootUs + micros()) / 1000000ULL);
+  if (t) *t = now;
+  return now;
+}
+
+extern "C" int gettimeofday(struct timeval *tv, void *tz) {
+  (void)tz;
+  unsigned long long us = epochAtBootUs + micros();
+  tv->tv_sec = (time_t)(us / 1000000ULL);
+  tv->tv_usec = (suseconds_t)(us % 1000000ULL);
+  return 0;
+}
+
+extern "C" int settimeofday(const struct timeval *tv, const struct timezone *tz) {
+  (void)tz;
+  unsigned long long us = (unsigned long long)tv->tv_sec * 1000000ULL + tv->tv_usec;
+  epochAtBootUs = us - micros();
+  return 0;
+}
+
+namespace sim {
+
+// Deep sleep / restart: re-exec ourselves as the next boot
+[[noreturn]] void rebootProcess(bool deepSleep, unsigned long long sleepUs) {
+  fprintf(stdout, "[SIM] heap peak used: %u bytes\n", heapPeakUsed());
+  NvsStats nvs = nvsStats();
+  fprintf(stdout, "[SIM] nvs this boot: %u opens, %u writes\n", nvs.opens, nvs.writes);
+  fflush(stdout);
+  long bootsLeft = envLong("SIM_MAX_BOOTS", 1) - 1;
+  if (bootsLeft <= 0) {
+    stats.sleptMs += sleepUs / 1000ULL;
+    fprintf(stdout, "[SIM] %s requested, boot limit reached.\n", deepSleep ? "Deep sleep" : "Restart");
+    printStats();
+    exit(0);
+  }
+
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%ld", bootsLeft);
+  setenv("SIM_MAX_BOOTS", buf, 1);
+  setenv("SIM_WAKE", deepSleep ? "deepsleep" : "reset", 1);
+  if (deepSleep) saveRtc();
+  carryState(sleepUs);
+
+  execv("/proc/self/exe", simArgv);
+  perror("execv");
+  exit(1);
+}
+
+unsigned long long pendingSleepUs = 0;
+
+}  // namespace sim
+
+int main(int argc, char **argv) {
+  (void)argc;
+  simArgv = argv;
+  setvbuf(stdout, nullptr, _IOLBF, 0);
+  loadCarriedState();
+
+  const char *wake = sim::envStr("SIM_WAKE", "");
+  if (strcmp(wake, "deepsleep") == 0) restoreRtc();
+
+  unsigned long runMs = (unsigned long)sim::envLong("SIM_RUN_MS", 60000);
+
+  try {
+    setup();
+    while (millis() < runMs) loop();
+  } catch (sim::Reboot &r) {
+    sim::rebootProcess(r.deepSleep, r.deepSleep ? sim::pendingSleepUs : 0);
+  }
+
+  fprintf(stdout, "[SIM] heap peak used: %u bytes\n", sim::heapPeakUsed());
+  sim::printStats();
+  return 0;
+}
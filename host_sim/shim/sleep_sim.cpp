@@ -0,0 +1,106 @@
+// sleep_sim.cpp - deep and light sleep for the host build.
+//
+// Deep sleep ends the process and re-executes it as the next boot
+// (see sim_main.cpp). A button wake can be injected with
+// SIM_BUTTON_WAKE_AFTER_MS: the first deep sleep with ext0 enabled that
+// lasts longer than that wakes by button instead, and the button then
+// reads pressed for SIM_BUTTON_HOLD_MS after boot.
+
+#include <Arduino.h>
+#include <esp_sleep.h>
+#include "sim.h"
+
+static uint64_t timerUs = 0;
+static int ext0Pin = -1;
+static int ext0Level = 0;
+static uint64_t gpioWakeMask = 0;
+static int gpioWakeLevel[64];
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t us) {
+  timerUs = us;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_ext0_wakeup(gpio_num_t pin, int level) {
+  ext0Pin = pin;
+  ext0Level = level;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_ext1_wakeup(uint64_t mask, esp_sleep_ext1_wakeup_mode_t) {
+  for (int i = 0; i < 64; i++) {
+    if (mask & (1ULL << i)) ext0Pin = i;
+  }
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup(void) { return ESP_OK; }
+
+esp_err_t esp_sleep_disable_wakeup_source(int) {
+  timerUs = 0;
+  ext0Pin = -1;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_pd_config(esp_sleep_pd_domain_t, esp_sleep_pd_option_t) { return ESP_OK; }
+esp_err_t gpio_hold_en(gpio_num_t) { return ESP_OK; }
+esp_err_t gpio_hold_dis(gpio_num_t) { return ESP_OK; }
+
+esp_err_t gpio_wakeup_enable(gpio_num_t pin, gpio_int_type_t type) {
+  if (pin >= 64) return ESP_ERR_INVALID_ARG;
+  gpioWakeMask |= 1ULL << pin;
+  gpioWakeLevel[pin] = type == GPIO_INTR_HIGH_LEVEL ? HIGH : LOW;
+  return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_disable(gpio_num_t pin) {
+  if (pin < 64) gpioWakeMask &= ~(1ULL << pin);
+  return ESP_OK;
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause(void) {
+  if (strcmp(sim::envStr("SIM_WAKE", ""), "deepsleep") != 0) return ESP_SLEEP_WAKEUP_UNDEFINED;
+  return strcmp(sim::envStr("SIM_WAKE_CAUSE", ""), "ext0") == 0 ? ESP_SLEEP_WAKEUP_EXT0
+                                                               : ESP_SLEEP_WAKEUP_TIMER;
+}
+
+void esp_deep_sleep_start(void) {
+  uint64_t us = timerUs;
+  long buttonAfterMs = sim::envLong("SIM_BUTTON_WAKE_AFTER_MS", -1);
+  bool byButton = ext0Pin >= 0 && buttonAfterMs >= 0 &&
+                  (us == 0 || (uint64_t)buttonAfterMs * 1000ULL < us);
+  if (byButton) {
+    us = (uint64_t)buttonAfterMs * 1000ULL;
+    unsetenv("SIM_BUTTON_WAKE_AFTER_MS");
+  }
+  setenv("SIM_WAKE_CAUSE", byButton ? "ext0" : "timer", 1);
+
+  fprintf(stdout, "[SIM] Deep sleep for %llu ms%s\n", (unsigned long long)(us / 1000ULL),
+          byButton ? " (woken by button)" : "");
+  sim::pendingSleepUs = us;
+  throw sim::Reboot{true};
+}
+
+// Advance virtual time until the timer expires or a wake-up GPIO
+// reaches its level
+esp_err_t esp_light_sleep_start(void) {
+  unsigned long start = millis();
+  while (true) {
+    for (int pin = 0; pin < 64; pin++) {
+      if ((gpioWakeMask & (1ULL << pin)) && digitalRead(pin) == gpioWakeLevel[pin]) return ESP_OK;
+    }
+    if (timerUs && (uint64_t)(millis() - start) * 1000ULL >= timerUs) return ESP_OK;
+    sim::idle();
+    sim::tick();
+  }
+}
+
+namespace sim {
+
+int buttonRead(uint8_t pin) {
+  if (pin != envLong("SIM_BUTTON_PIN", 21)) return -1;
+  if (esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_EXT0) return -1;
+  return millis() < (unsigned long)envLong("SIM_BUTTON_HOLD_MS", 4000) ? LOW : -1;
+}
+
+}  // namespace sim
@@ -0,0 +1,221 @@
+// spi_sim.cpp - SPI bus feeding a simulated Solomon Systech (SSD1680
+// style) e-ink controller, as used by the Vision Master E290 panel.
+// Tracks the RAM window/cursor, holds BUSY high for the refresh time
+// and writes each refreshed frame to SIM_FRAME_DIR as a PBM image.
+// Each refresh also reports the SPI traffic since the previous one,
+// with the time it would take on the wire at the transaction's clock
+// plus SIM_SPI_TXN_US of setup per transaction (CS, bus lock).
+//
+// Transactions may come from any task (the display driver's upload
+// task sends frames in the background). A transaction opened while
+// another is still open, or a command sent while the panel holds BUSY
+// (which the controller would ignore), is logged and counted as an SPI
+// conflict.
+
+#include <SPI.h>
+#include <atomic>
+#include "sim.h"
+
+SPIClass SPI;
+
+namespace {
+
+const int RAM_W = 32;    // bytes
+const int RAM_H = 320;   // rows
+
+struct Panel {
+  uint8_t bw[RAM_H][RAM_W];
+  uint8_t red[RAM_H][RAM_W];
+  uint8_t command = 0;
+  int     argIndex = 0;
+  uint8_t args[8];
+  int xs = 0, xe = RAM_W - 1, ys = 0, ye = RAM_H - 1;
+  int x = 0, y = 0;
+  uint8_t updateMode = 0xF7;
+  unsigned long busyUntil = 0;
+  bool inited = false;
+};
+Panel panel;
+
+// Traffic since the last refresh
+struct Traffic {
+  uint32_t transactions = 0;
+  uint64_t bytes = 0;
+  double   wireUs = 0;
+  uint32_t clock = 1000000;
+};
+Traffic traffic;
+
+std::atomic<bool> inTransaction{false};
+
+void conflict(const char *what) {
+  sim::stats.spiConflicts++;
+  fprintf(stdout, "[SIM] spi conflict: %s\n", what);
+}
+
+int pinDC()   { return (int)sim::envLong("SIM_PIN_DC", 4); }
+int pinBusy() { return (int)sim::envLong("SIM_PIN_BUSY", 6); }
+
+int readBusy(uint8_t pin) {
+  if (pin != pinBusy()) return -1;
+  if (!sim::checkingInterrupts()) sim::stats.busyReads++;
+  return millis() < panel.busyUntil ? HIGH : LOW;
+}
+
+void init() {
+  if (panel.inited) return;
+  panel.inited = true;
+  memset(panel.bw, 0xFF, sizeof(panel.bw));
+  memset(panel.red, 0xFF, sizeof(panel.red));
+  sim::setPinReader(readBusy);
+}
+
+void dumpFrame() {
+  const char *dir = sim::envStr("SIM_FRAME_DIR", "");
+  int w = (int)sim::envLong("SIM_PANEL_W", 128);
+  int h = (int)sim::envLong("SIM_PANEL_H", 296);
+  int xoff = (int)sim::envLong("SIM_PANEL_XOFF", 1);
+  if (!*dir) return;
+
+  char path[512];
+  snprintf(path, sizeof(path), "%s/frame_%04u.pbm", dir, sim::stats.refreshes);
+  FILE *f = fopen(path, "wb");
+  if (!f) return;
+
+  // Landscape view (rotation 1): panel column -> image row
+  bool landscape = sim::envLong("SIM_FRAME_LANDSCAPE", 1) != 0;
+  int outW = landscape ? h : w;
+  int outH = landscape ? w : h;
+  fprintf(f, "P1\n%d %d\n", outW, outH);
+  for (int oy = 0; oy < outH; oy++) {
+    for (int ox = 0; ox < outW; ox++) {
+      int px = landscape ? (w - 1 - oy) : ox;
+      int py = landscape ? ox : oy;
+      uint8_t byte = panel.bw[py][xoff + px / 8];
+      bool white = (byte >> (7 - (px % 8))) & 1;
+      fputc(white ? '0' : '1', f);
+    }
+    fputc('\n', f);
+  }
+  fclose(f);
+  fprintf(stdout, "[SIM] frame written: %s\n", path);
+}
+
+void writeRam(uint8_t (*ram)[RAM_W], uint8_t data) {
+  if (panel.y >= 0 && panel.y < RAM_H && panel.x >= 0 && panel.x < RAM_W) {
+    ram[panel.y][panel.x] = data;
+  }
+  if (++panel.x > panel.xe) {
+    panel.x = panel.xs;
+    panel.y++;
+  }
+}
+
+void onCommand(uint8_t cmd) {
+  if (millis() < panel.busyUntil) {
+    char what[48];
+    snprintf(what, sizeof(what), "command 0x%02X while the panel is busy", cmd);
+    conflict(what);
+  }
+  panel.command = cmd;
+  panel.argIndex = 0;
+
+  if (cmd == 0x12) {   // software reset
+    panel.busyUntil = millis() + 2;
+  } else if (cmd == 0x20) {   // master activation
+    bool full = panel.updateMode == 0xF7;
+    unsigned long cost = (unsigned long)(full ? sim::envLong("SIM_REFRESH_MS", 2000)
+                                              : sim::envLong("SIM_PARTIAL_MS", 500));
+    sim::stats.refreshes++;
+    if ((long)sim::stats.refreshes == sim::envLong("SIM_BUSY_STUCK_AT", 0)) {   // hung panel
+      cost = (unsigned long)sim::envLong("SIM_BUSY_STUCK_MS", 60000);
+    }
+    panel.busyUntil = millis() + cost;
+    fprintf(stdout, "[SIM] panel refresh #%u (%s, %lu ms)\n", sim::stats.refreshes, full ? "full" : "partial", cost);
+    double setupUs = traffic.transactions * (double)sim::envLong("SIM_SPI_TXN_US", 5);
+    fprintf(stdout, "[SIM] spi since last refresh: %u transactions, %llu bytes, ~%.1f ms on the bus\n",
+            traffic.transactions, (unsigned long long)traffic.bytes, (traffic.wireUs + setupUs) / 1000.0);
+    traffic.transactions = 0;
+    traffic.bytes = 0;
+    traffic.wireUs = 0;
+    dumpFrame();
+  }
+}
+
+void onData(uint8_t data) {
+  switch (panel.command) {
+    case 0x24: writeRam(panel.bw, data); return;
+    case 0x26: writeRam(panel.red, data); return;
+    default: break;
+  }
+
+  if (panel.argIndex < (int)sizeof(panel.args)) panel.args[panel.argIndex] = data;
+  panel.argIndex++;
+
+  switch (panel.command) {
+    case 0x44:
+      if (panel.argIndex == 2) { panel.xs = panel.args[0]; panel.xe = panel.args[1]; }
+      break;
+    case 0x45:
+      if (panel.argIndex == 4) {
+        panel.ys = panel.args[0] | (panel.args[1] << 8);
+        panel.ye = panel.args[2] | (panel.args[3] << 8);
+      }
+      break;
+    case 0x4E:
+      panel.x = data;
+      break;
+    case 0x4F:
+      if (panel.argIndex == 2) panel.y = panel.args[0] | (panel.args[1] << 8);
+      break;
+    case 0x22:
+      panel.updateMode = data;
+      break;
+    default:
+      break;
+  }
+}
+
+void onByte(uint8_t b) {
+  init();
+  sim::stats.spiBytes++;
+  traffic.bytes++;
+  traffic.wireUs += 8e6 / traffic.clock;
+  if (digitalRead(pinDC()) == LOW) onCommand(b);
+  else onData(b);
+}
+
+}  // namespace
+
+void SPIClass::beginTransaction(SPISettings settings) {
+  init();
+  if (inTransaction.exchange(true)) conflict("transaction opened inside another");
+  sim::stats.spiTransactions++;
+  traffic.transactions++;
+  traffic.clock = settings.clock ? settings.clock : 1000000;
+}
+
+void SPIClass::endTransaction() {
+  inTransaction = false;
+}
+
+uint8_t SPIClass::transfer(uint8_t data) {
+  onByte(data);
+  return 0;
+}
+
+void SPIClass::transfer(void *buf, uint32_t count) {
+  uint8_t *p = (uint8_t *)buf;
+  for (uint32_t i = 0; i < count; i++) onByte(p[i]);
+}
+
+void SPIClass::transferBytes(const uint8_t *data, uint8_t *out, uint32_t size) {
+  for (uint32_t i = 0; i < size; i++) {
+    onByte(data[i]);
+    if (out) out[i] = 0;
+  }
+}
+
+void SPIClass::writeBytes(const uint8_t *data, uint32_t size) {
+  transferBytes(data, nullptr, size);
+}
@@ -0,0 +1,128 @@
+// update_sim.cpp - file-backed Update and OTA partitions for the host build
+
+#include <Update.h>
+#include <esp_ota_ops.h>
+#include <string>
+#include "sim.h"
+
+UpdateClass Update;
+
+bool UpdateClass::begin(size_t size, int command, int ledPin, uint8_t ledOn, const char *label) {
+  (void)command; (void)ledPin; (void)ledOn; (void)label;
+  _file = fopen(sim::envStr("SIM_OTA_FILE", "sim_ota.bin"), "wb");
+  if (!_file) { _error = 1; return false; }
+  _size = size;
+  _progress = 0;
+  _error = 0;
+  _finished = false;
+  return true;
+}
+
+size_t UpdateClass::write(uint8_t *data, size_t len) {
+  if (!_file) return 0;
+  if (_size != UPDATE_SIZE_UNKNOWN && _progress + len > _size) { _error = 2; return 0; }
+  size_t n = fwrite(data, 1, len, _file);
+  _progress += n;
+  return n;
+}
+
+size_t UpdateClass::writeStream(Stream &data) {
+  uint8_t buf[1024];
+  size_t total = 0;
+  while (_size == UPDATE_SIZE_UNKNOWN || _progress < _size) {
+    size_t want = sizeof(buf);
+    if (_size != UPDATE_SIZE_UNKNOWN && _size - _progress < want) want = _size - _progress;
+    size_t got = data.readBytes((char *)buf, want);
+    if (got == 0) break;
+    total += write(buf, got);
+  }
+  return total;
+}
+
+bool UpdateClass::end(bool evenIfRemaining) {
+  if (!_file) return false;
+  fclose(_file);
+  _file = nullptr;
+  if (!evenIfRemaining && _size != UPDATE_SIZE_UNKNOWN && _progress != _size) {
+    _error = 3;
+    return false;
+  }
+  _finished = _error == 0;
+  return _finished;
+}
+
+void UpdateClass::abort() {
+  if (_file) fclose(_file);
+  _file = nullptr;
+  _finished = false;
+}
+
+const char *UpdateClass::errorString() {
+  switch (_error) {
+    case 0: return "No Error";
+    case 1: return "Could not open OTA file";
+    case 2: return "Image exceeds declared size";
+    case 3: return "Image incomplete";
+    default: return "Unknown";
+  }
+}
+
+// ----------------------------------------
+// OTA partitions: ota_0 is the running image (SIM_RUNNING_IMAGE),
+// ota_1 is the update slot (SIM_OTA_FILE).
+// ----------------------------------------
+
+static esp_partition_t partitions[2] = {
+  {0x10000, 0x300000, "ota_0"},
+  {0x310000, 0x300000, "ota_1"},
+};
+
+static const char *partitionPath(const esp_partition_t *p) {
+  return p == &partitions[0] ? sim::envStr("SIM_RUNNING_IMAGE", "sim_running.bin")
+                             : sim::envStr("SIM_OTA_FILE", "sim_ota.bin");
+}
+
+const esp_partition_t *esp_ota_get_running_partition(void) { return &partitions[0]; }
+
+const esp_partition_t *esp_ota_get_next_update_partition(const esp_partition_t *) { return &partitions[1]; }
+
+esp_err_t esp_ota_get_state_partition(const esp_partition_t *, esp_ota_img_states_t *state) {
+  *state = ESP_OTA_IMG_VALID;
+  return ESP_OK;
+}
+
+esp_err_t esp_ota_mark_app_valid_cancel_rollback(void) { return ESP_OK; }
+
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t *partition) {
+  fprintf(stdout, "[SIM] Boot partition set to %s\n", partition->label);
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *p, size_t off, void *dst, size_t size) {
+  FILE *f = fopen(partitionPath(p), "rb");
+  if (!f) return ESP_FAIL;
+  memset(dst, 0xFF, size);
+  fseek(f, (long)off, SEEK_SET);
+  fread(dst, 1, size, f);
+  fclose(f);
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *p, size_t off, const void *src, size_t size) {
+  FILE *f = fopen(partitionPath(p), "r+b");
+  if (!f) f = fopen(partitionPath(p), "w+b");
+  if (!f) return ESP_FAIL;
+  fseek(f, (long)off, SEEK_SET);
+  size_t n = fwrite(src, 1, size, f);
+  fclose(f);
+  return n == size ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *p, size_t off, size_t size) {
+  if (off == 0) {
+    FILE *f = fopen(partitionPath(p), "wb");   // erasing from 0 restarts the image
+    if (f) fclose(f);
+  }
+  (void)size;
+  return ESP_OK;
+}
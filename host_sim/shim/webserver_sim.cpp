@@ -0,0 +1,31 @@
+// webserver_sim.cpp - scripted provisioning for the host build
+
+#include <WebServer.h>
+#include "sim.h"
+
+void WebServer::handleClient() {
+  if (_submitted) {
+    fprintf(stdout, "[SIM] Provisioning portal idle; set SIM_PROV_SSID to auto-provision.\n");
+    throw sim::Reboot{false};
+  }
+  _submitted = true;
+
+  const char *ssid = sim::envStr("SIM_PROV_SSID", "");
+  if (!*ssid) {
+    fprintf(stdout, "[SIM] Provisioning portal started and nothing to submit. Exiting.\n");
+    sim::printStats();
+    exit(2);
+  }
+  _args["wifi_ssid"] = ssid;
+  _args["wifi_password"] = sim::envStr("SIM_PROV_PASS", "");
+  _args["fb_email"] = sim::envStr("SIM_PROV_EMAIL", "sim@example.com");
+  _args["fb_password"] = sim::envStr("SIM_PROV_FB_PASS", "secret");
+
+  auto it = _handlers.find("/save");
+  if (it != _handlers.end()) it->second();
+}
+
+void WebServer::send(int code, const char *type, const String &content) {
+  (void)type; (void)content;
+  fprintf(stdout, "[SIM] Portal responded %d\n", code);
+}
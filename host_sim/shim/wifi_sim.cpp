@@ -0,0 +1,291 @@
+// wifi_sim.cpp - sockets and simulated association for the host build
+
+#include <WiFi.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+#include "sim.h"
+
+WiFiClass WiFi;
+
+// ----------------------------------------
+// WiFiClient
+// ----------------------------------------
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+  return connect(ip.toString().c_str(), port);
+}
+
+// Every host resolves to the local mock server
+int WiFiClient::connect(const char *host, uint16_t port) {
+  (void)port;
+  stop();
+
+  if (WiFi.status() != WL_CONNECTED) return 0;
+
+  const char *serverHost = sim::envStr("SIM_HTTP_HOST", "127.0.0.1");
+  uint16_t serverPort = (uint16_t)sim::envLong("SIM_HTTP_PORT", 8080);
+
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return 0;
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(serverPort);
+  inet_pton(AF_INET, serverHost, &addr.sin_addr);
+  if (::connect(fd, (sockaddr *)&addr, sizeof(addr)) != 0) {
+    ::close(fd);
+    return 0;
+  }
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+  _fd = fd;
+  _head = _tail = 0;
+  _eof = false;
+  sim::stats.tcpConnects++;
+
+  if (!onConnected(host)) {
+    stop();
+    return 0;
+  }
+  return 1;
+}
+
+uint8_t WiFiClient::connected() {
+  if (_fd < 0) return 0;
+  if (_head < _tail) return 1;
+  fill(false);
+  return (_fd >= 0 && !_eof) || _head < _tail;
+}
+
+void WiFiClient::stop() {
+  if (_fd >= 0) {
+    ::close(_fd);
+    _fd = -1;
+  }
+  _head = _tail = 0;
+  _eof = false;
+}
+
+// Pull more bytes into the buffer; optionally wait up to the timeout
+bool WiFiClient::fill(bool wait) {
+  if (_fd < 0 || _eof) return false;
+  if (_head == _tail) _head = _tail = 0;
+  if (_tail == sizeof(_buf)) return true;
+
+  pollfd p{_fd, POLLIN, 0};
+  int ready = poll(&p, 1, wait ? (int)_timeout : 0);
+  if (ready <= 0) return false;
+
+  ssize_t n = ::recv(_fd, _buf + _tail, sizeof(_buf) - _tail, 0);
+  if (n <= 0) {
+    _eof = true;
+    return false;
+  }
+  _tail += (size_t)n;
+  sim::stats.bytesRx += (uint64_t)n;
+  return true;
+}
+
+int WiFiClient::available() {
+  if (_head == _tail) fill(false);
+  return (int)(_tail - _head);
+}
+
+int WiFiClient::read() {
+  if (_head == _tail && !fill(false)) return -1;
+  return _buf[_head++];
+}
+
+int WiFiClient::read(uint8_t *buf, size_t size) {
+  if (_head == _tail && !fill(false)) return -1;
+  size_t n = std::min(size, _tail - _head);
+  memcpy(buf, _buf + _head, n);
+  _head += n;
+  return (int)n;
+}
+
+int WiFiClient::peek() {
+  if (_head == _tail && !fill(false)) return -1;
+  return _buf[_head];
+}
+
+size_t WiFiClient::readBytes(char *buffer, size_t length) {
+  size_t got = 0;
+  while (got < length) {
+    if (_head == _tail && !fill(true)) break;
+    size_t n = std::min(length - got, _tail - _head);
+    memcpy(buffer + got, _buf + _head, n);
+    _head += n;
+    got += n;
+  }
+  return got;
+}
+
+size_t WiFiClient::write(const uint8_t *buf, size_t size) {
+  if (_fd < 0) return 0;
+  size_t sent = 0;
+  while (sent < size) {
+    ssize_t n = ::send(_fd, buf + sent, size - sent, MSG_NOSIGNAL);
+    if (n <= 0) {
+      stop();
+      break;
+    }
+    sent += (size_t)n;
+  }
+  sim::stats.bytesTx += sent;
+  return sent;
+}
+
+// Each new TLS session costs a simulated handshake
+bool WiFiClientSecure::onConnected(const char *host) {
+  unsigned long cost = (unsigned long)sim::envLong("SIM_TLS_HANDSHAKE_MS", 900);
+  sim::stats.tlsHandshakes++;
+  sim::advance(cost);
+  fprintf(stdout, "[SIM] TLS handshake with %s (%lu ms)\n", host, cost);
+  return true;
+}
+
+// ----------------------------------------
+// WiFiClass
+// ----------------------------------------
+
+struct EventHandler {
+  wifi_event_id_t id;
+  WiFiEventFuncCb cb;
+  arduino_event_id_t event;
+};
+static std::vector<EventHandler> handlers;
+static wifi_event_id_t nextHandlerId = 1;
+
+// SIM_WIFI_DOWN=a-b: the AP is out of reach on boots a to b, counted
+// from 1 across reboots ("a" alone is one boot)
+static bool apDown() {
+  unsigned long from = 0, to = 0;
+  int n = sscanf(sim::envStr("SIM_WIFI_DOWN", ""), "%lu-%lu", &from, &to);
+  if (n < 1) return false;
+  if (n == 1) to = from;
+  unsigned long boot = sim::stats.reboots + 1;
+  return boot >= from && boot <= to;
+}
+
+wl_status_t WiFiClass::begin(const char *ssid, const char *pass, int32_t channel,
+                             const uint8_t *bssid, bool connect) {
+  (void)pass;
+  _ssid = ssid;
+  if (!connect) return _status;
+
+  // A full scan is slow; a known channel + BSSID skips it
+  bool hinted = channel > 0 && bssid != nullptr;
+  long cost = hinted ? sim::envLong("SIM_WIFI_FAST_MS", 250)
+                     : sim::envLong("SIM_WIFI_SCAN_MS", 2500);
+  if (hinted) {
+    _channel = channel;
+    memcpy(_bssid, bssid, 6);
+  }
+
+  const char *expected = sim::envStr("SIM_WIFI_SSID", "");
+  _status = WL_DISCONNECTED;
+  _connectAt = millis() + (unsigned long)cost;
+  _pending = (expected[0] == '\0' || _ssid == expected) && !apDown();
+  return _status;
+}
+
+bool WiFiClass::config(IPAddress local, IPAddress gateway, IPAddress subnet,
+                       IPAddress dns1, IPAddress dns2) {
+  (void)dns2;
+  _static = (uint32_t)local != 0;
+  _ip = local;
+  _gw = gateway;
+  _mask = subnet;
+  _dns = dns1;
+  return true;
+}
+
+bool WiFiClass::reconnect() {
+  begin(_ssid.c_str(), nullptr, _channel, _bssid);
+  return true;
+}
+
+bool WiFiClass::disconnect(bool wifioff, bool eraseap) {
+  (void)eraseap;
+  bool was = _status == WL_CONNECTED;
+  _status = WL_DISCONNECTED;
+  _pending = false;
+  if (wifioff) _mode = WIFI_OFF;
+  if (was) fire(ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+  return true;
+}
+
+void WiFiClass::simTick() {
+  if (!_pending || millis() < _connectAt) return;
+  _pending = false;
+  _status = WL_CONNECTED;
+  fire(ARDUINO_EVENT_WIFI_STA_CONNECTED);
+
+  // DHCP takes a little longer than a static lease
+  if (!_static) {
+    sim::advance((unsigned long)sim::envLong("SIM_DHCP_MS", 400));
+    _ip = IPAddress(192, 168, 1, 50);
+    _gw = IPAddress(192, 168, 1, 1);
+    _mask = IPAddress(255, 255, 255, 0);
+    _dns = IPAddress(192, 168, 1, 1);
+  }
+  fire(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+}
+
+wl_status_t WiFiClass::status() {
+  simTick();
+  return _status;
+}
+
+uint8_t WiFiClass::waitForConnectResult(unsigned long timeoutLength) {
+  unsigned long start = millis();
+  while (status() != WL_CONNECTED && millis() - start < timeoutLength) {
+    delay(100);
+  }
+  return _status;
+}
+
+String WiFiClass::BSSIDstr() const {
+  char buf[18];
+  snprintf(buf, sizeof(buf), "%02X:%02X:%02X:%02X:%02X:%02X",
+           _bssid[0], _bssid[1], _bssid[2], _bssid[3], _bssid[4], _bssid[5]);
+  return String(buf);
+}
+
+wifi_event_id_t WiFiClass::onEvent(WiFiEventFuncCb cb, arduino_event_id_t event) {
+  handlers.push_back({nextHandlerId, cb, event});
+  return nextHandlerId++;
+}
+
+void WiFiClass::removeEvent(wifi_event_id_t id) {
+  for (size_t i = 0; i < handlers.size(); i++) {
+    if (handlers[i].id == id) {
+      handlers.erase(handlers.begin() + i);
+      return;
+    }
+  }
+}
+
+void WiFiClass::fire(arduino_event_id_t event) {
+  arduino_event_info_t info{};
+  memcpy(info.wifi_sta_connected.bssid, _bssid, 6);
+  info.wifi_sta_connected.channel = (uint8_t)_channel;
+  info.got_ip.ip_info.ip.addr = (uint32_t)_ip;
+  info.got_ip.ip_info.gw.addr = (uint32_t)_gw;
+  info.got_ip.ip_info.netmask.addr = (uint32_t)_mask;
+
+  std::vector<EventHandler> copy = handlers;
+  for (auto &h : copy) {
+    if (h.event == ARDUINO_EVENT_MAX || h.event == event) h.cb(event, info);
+  }
+}
@@ -0,0 +1,24 @@
+// secrets.h - simulator configuration (the device build uses its own,
+// untracked secrets.h in quote_eink_app/)
+#ifndef SECRETS_H
+#define SECRETS_H
+
+#ifndef FW_VERSION
+#define FW_VERSION "1.0.6"
+#endif
+
+#define PREFS_NAMESPACE "quote_app"
+
+#define AP_SSID "QuoteDisplay-Setup"
+#define AP_PASS "setup1234"
+
+#define FIREBASE_API_KEY    "sim-api-key"
+#define FIREBASE_PROJECT_ID "sim-project"
+
+#define GITHUB_OTA_META_URL \
+  "https://raw.githubusercontent.com/canza89/quote-eink-firmware/main/ota/firmware.json"
+
+#define QUOTE_INTERVAL_MS       (30UL * 60UL * 1000UL)
+#define WIFI_CONNECT_TIMEOUT_MS 15000UL
+
+#endif
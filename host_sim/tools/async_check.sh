@@ -0,0 +1,61 @@
+#!/bin/sh
+# async_check.sh - the display driver's async update against the
+# simulated SPI bus, which flags overlapping transactions and commands
+# sent while the panel is BUSY. Logs go to run/async_<scenario>.log.
+#
+#   same      quote_sim_sync (DISPLAY_ASYNC_UPDATE=0, every refresh in
+#             the render task) and quote_sim must write the same frames
+#   slow      quote_sim with 8 s refreshes, so frames are composed and
+#             queued while the upload task still holds the panel: no
+#             SPI conflicts
+#   stuck     the second refresh holds BUSY for a minute: the wait
+#             times out, the app logs it and every boot still completes
+#
+# The first two use tools/bench.sh --check, which fails on a conflict.
+# The stuck run is allowed one: the driver gives up on the hung panel
+# and resets it while BUSY is still asserted.
+
+set -u
+cd "$(dirname "$0")/.."
+
+BOOTS=${BOOTS:-4}
+export BOOTS
+
+[ -x ./quote_sim ] && [ -x ./quote_sim_sync ] ||
+  { echo "async_check: build the simulators first (make check-async)"; exit 2; }
+
+fail=0
+mkdir -p run.async
+
+frames() {
+  (cd run/frames && md5sum *.pbm)
+}
+
+SIM=quote_sim_sync tools/bench.sh --check > /dev/null || { echo "async_check: sync run failed"; fail=1; }
+frames > run.async/sync.md5
+cp run/sim.log run.async/async_sync.log
+
+tools/bench.sh --check > /dev/null || { echo "async_check: async run failed"; fail=1; }
+frames > run.async/async.md5
+cp run/sim.log run.async/async_same.log
+grep -qF 'during the refresh' run/sim.log ||
+  { echo "async_check: nothing was composed during a refresh"; fail=1; }
+cmp -s run.async/sync.md5 run.async/async.md5 ||
+  { echo "async_check: frames differ from the sync build"; diff run.async/sync.md5 run.async/async.md5; fail=1; }
+
+SIM_REFRESH_MS=8000 tools/bench.sh --check > /dev/null || { echo "async_check: slow run failed"; fail=1; }
+cp run/sim.log run.async/async_slow.log
+grep -F '[SIM] spi conflict' run/sim.log | head -n 5
+
+SIM_BUSY_STUCK_AT=2 SIM_BUSY_STUCK_MS=60000 tools/bench.sh > /dev/null
+cp run/sim.log run.async/async_stuck.log
+grep -qF 'gave up waiting' run/sim.log ||
+  { echo "async_check: the stuck panel was not timed out"; fail=1; }
+grep -qF "[PROF] Wake #$((BOOTS - 1)) " run/sim.log ||
+  { echo "async_check: stuck run did not finish its boots"; fail=1; }
+
+mv run.async/*.log run/
+rm -rf run.async
+
+[ $fail -eq 0 ] && echo "async_check: OK"
+exit $fail
@@ -0,0 +1,99 @@
+#!/bin/sh
+# bench.sh - end-to-end run of the host build against the mock server.
+#
+# Starts tools/mock_server.py, provisions a fresh device and lets it run
+# BOOTS boots (provisioning restart, cold boot with full sync, then
+# timer wakes), writing frames and logs to run/. Prints per-wake timing
+# from the profiler, panel refreshes, heap peaks and the traffic totals.
+#
+#   tools/bench.sh [--check]
+#
+# With --check, exits non-zero unless the quotes synced (every page of
+# the collection fetched, in order, and all QUOTES cached) and a quote
+# was rendered and no SPI conflicts were logged. PORT, BOOTS and QUOTES
+# override the defaults; SIM picks another build of the simulator.
+
+set -u
+cd "$(dirname "$0")/.."
+
+PORT=${PORT:-18088}
+BOOTS=${BOOTS:-4}
+QUOTES=${QUOTES:-230}
+SIM=${SIM:-quote_sim}
+CHECK=0
+[ "${1:-}" = "--check" ] && CHECK=1
+
+[ -x "./$SIM" ] || { echo "bench: build ./$SIM first (make)"; exit 2; }
+
+rm -rf run
+mkdir -p run/frames
+
+python3 tools/mock_server.py --port "$PORT" --quotes "$QUOTES" --chunked \
+  > run/mock.log 2>&1 &
+MOCK=$!
+trap 'kill $MOCK 2>/dev/null' EXIT INT TERM
+
+# Wait for the mock to listen
+i=0
+until python3 -c "import socket; socket.create_connection(('127.0.0.1', $PORT), 1)" 2>/dev/null; do
+  i=$((i + 1))
+  if [ $i -ge 50 ]; then
+    echo "bench: mock server did not start"; cat run/mock.log; exit 2
+  fi
+  sleep 0.1
+done
+
+(
+  cd run &&
+  SIM_HTTP_PORT=$PORT \
+  SIM_WIFI_SSID=home SIM_PROV_SSID=home SIM_PROV_PASS=pw \
+  SIM_NVS_FILE=nvs.bin SIM_RTC_FILE=rtc.bin SIM_FS_DIR=fs \
+  SIM_OTA_FILE=ota.bin SIM_RUNNING_IMAGE=running.bin \
+  SIM_FRAME_DIR=frames SIM_MAX_BOOTS=$((BOOTS + 1)) \
+  "../$SIM"
+) > run/sim.log 2>&1
+STATUS=$?
+
+echo "== wakes (profiler, ms)"
+grep -F '[PROF] Wake #' run/sim.log
+echo "== sync"
+grep -E '^\[QUOTE\] (Synced|Delta|Cache up to date)' run/sim.log
+echo "== panel"
+grep -F '[SIM] panel refresh' run/sim.log
+grep -F '[SIM] spi since last refresh' run/sim.log
+grep -F '[DISPLAY] Wake:' run/sim.log
+echo "== heap peak per boot"
+grep -F '[SIM] heap peak used' run/sim.log | awk '{ print "  boot " NR ": " $5 " bytes" }'
+echo "== nvs per boot"
+grep -F '[SIM] nvs this boot' run/sim.log | awk '{ print "  boot " NR ": " $5 " opens, " $7 " writes" }'
+echo "== totals"
+grep -F '[SIM] stats:' run/sim.log | tail -n 1
+
+[ $CHECK -eq 1 ] || exit $STATUS
+
+fail=0
+[ $STATUS -eq 0 ] || { echo "check: simulator exited with $STATUS"; fail=1; }
+grep -qE '^\[QUOTE\] Synced [1-9]' run/sim.log || { echo "check: no full sync"; fail=1; }
+
+# The first full listing in the mock's log: pages in order, no gaps, up
+# to the page without a nextPageToken
+listing=$(awk '
+  /^list start=/ {
+    split($2, s, "="); split($3, d, "="); split($4, n, "=")
+    if (s[2] == 0) { expect = 0; listed = 0; pages = 0; gap = 0 }
+    if (s[2] != expect) gap = 1
+    expect = s[2] + d[2]; listed += d[2]; pages++
+    if (n[2] == "") { print (gap ? "gap" : listed " " pages); exit }
+  }' run/mock.log)
+synced=$(sed -n 's/^\[QUOTE\] Synced \([0-9]*\) quotes in \([0-9]*\) pages.*/\1 \2/p' run/sim.log | head -n 1)
+case "$listing" in
+  "$QUOTES "*) ;;
+  *) echo "check: listing fetched ${listing:-nothing}, expected $QUOTES quotes"; fail=1 ;;
+esac
+[ -n "$synced" ] && [ "$synced" = "$listing" ] ||
+  { echo "check: app synced ${synced:-nothing} (quotes pages), the mock served $listing"; fail=1; }
+grep -qF '[QUOTE] Selected quote:' run/sim.log || { echo "check: no quote selected"; fail=1; }
+ls run/frames/*.pbm > /dev/null 2>&1 || { echo "check: no frames rendered"; fail=1; }
+grep -qF '[SIM] spi conflict' run/sim.log && { echo "check: SPI conflicts"; fail=1; }
+[ $fail -eq 0 ] && echo "check: OK"
+exit $fail
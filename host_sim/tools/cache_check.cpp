@@ -0,0 +1,326 @@
+// cache_check.cpp - quote_cache.cpp against the host LittleFS
+//
+//   cache_check
+//
+// Runs the quote cache over shim/littlefs_sim.cpp in run/cache_check/
+// and checks what a sync and the quote wakes see: a staged copy is
+// invisible until it is committed, and a discarded one changes nothing;
+// staged copies resume across wakes and keep selected records; a
+// commit that cannot replace quotes.dat keeps the old cache; quotes
+// read back by index and at random; and a missing, truncated, corrupt
+// or stale quotes.idx is rebuilt from quotes.dat. A reboot is simulated
+// by dropping the RAM state. Exits non-zero on a failure.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+// Built into this file so a reboot can reset its state
+#include "quote_cache.cpp"
+
+#define CHECK_DIR "run/cache_check"
+
+HardwareSerial Serial;
+void HardwareSerial::begin(unsigned long) {}
+int HardwareSerial::available() { return 0; }
+int HardwareSerial::read() { return -1; }
+int HardwareSerial::peek() { return -1; }
+unsigned long millis() { return 0; }
+void profileEnter(ProfilePhase) {}
+void profileLeave(ProfilePhase) {}
+
+static uint32_t rngState = 12345;
+
+// xorshift32; the cache picks with random(count)
+long random(long max) {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return max > 0 ? (long)(rngState % (uint32_t)max) : 0;
+}
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                          \
+  do {                                            \
+    if (!(cond)) {                                \
+      printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__);                        \
+      printf("\n");                               \
+      failures++;                                 \
+    }                                             \
+  } while (0)
+
+static void reboot() {
+  stageFile.close();
+  mounted = false;
+  quoteCount = 0;
+  CHECK(quoteCacheBegin(), "mount failed");
+}
+
+static std::string hostPath(const char *path) {
+  return std::string(CHECK_DIR) + path;
+}
+
+static std::string readFile(const char *path) {
+  std::string data;
+  FILE *f = fopen(hostPath(path).c_str(), "rb");
+  if (!f) return data;
+  char buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.append(buf, n);
+  fclose(f);
+  return data;
+}
+
+static void writeFile(const char *path, const std::string &data) {
+  FILE *f = fopen(hostPath(path).c_str(), "wb");
+  if (!f) return;
+  fwrite(data.data(), 1, data.size(), f);
+  fclose(f);
+}
+
+static bool fileExists(const char *path) {
+  struct stat st;
+  return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+// Quote `n` of generation `gen`: odd lengths, empty fields, UTF-8 and a
+// text longer than 255 bytes now and then
+static Quote makeQuote(uint32_t n, uint32_t gen = 0) {
+  Quote q;
+  char id[24];
+  snprintf(id, sizeof(id), "g%uq%05u", gen, n);
+  q.id = id;
+  q.text = "Quote " + String(n) + " \xE2\x80\x94 ";
+  for (uint32_t i = 0; i < (n * 37) % 300; i++) q.text += (char)('a' + (n + i) % 26);
+  q.author = n % 5 == 0 ? "" : "Author " + String(n % 7);
+  q.tagsLine = n % 3 == 0 ? "" : "#tag" + String(n % 4) + "   #caf\xC3\xA9";
+  return q;
+}
+
+static bool sameQuote(const Quote &a, const Quote &b) {
+  return a.id == b.id && a.text == b.text && a.author == b.author && a.tagsLine == b.tagsLine;
+}
+
+// The cache holds exactly `want`, in order
+static void checkContents(const char *what, const std::vector<Quote> &want) {
+  CHECK(quoteCacheCount() == want.size(), "%s: %u quotes, expected %zu", what, quoteCacheCount(),
+        want.size());
+  Quote q;
+  for (uint32_t i = 0; i < want.size() && i < quoteCacheCount(); i++) {
+    CHECK(quoteCacheGet(i, q), "%s: quote %u unreadable", what, i);
+    CHECK(sameQuote(q, want[i]), "%s: quote %u is \"%s\", expected \"%s\"", what, i, q.id.c_str(),
+          want[i].id.c_str());
+  }
+  CHECK(!quoteCacheGet(want.size(), q), "%s: read past the end", what);
+
+  std::vector<std::string> ids;
+  CHECK(quoteCacheForEachId(
+          [](uint32_t i, const String &id, void *ctx) {
+            auto *ids = static_cast<std::vector<std::string> *>(ctx);
+            if (i == ids->size()) ids->push_back(id.c_str());
+          },
+          &ids),
+        "%s: ID pass failed", what);
+  CHECK(ids.size() == want.size(), "%s: ID pass saw %zu quotes", what, ids.size());
+  for (size_t i = 0; i < ids.size() && i < want.size(); i++) {
+    CHECK(ids[i] == want[i].id.c_str(), "%s: ID %zu is \"%s\"", what, i, ids[i].c_str());
+  }
+}
+
+// A full sync of `quotes`
+static bool stage(const std::vector<Quote> &quotes) {
+  if (!quoteCacheStageBegin(0)) return false;
+  for (const Quote &q : quotes) {
+    if (!quoteCacheStageAdd(q)) return false;
+  }
+  return quoteCacheStageCommit();
+}
+
+static std::vector<Quote> generation(uint32_t count, uint32_t gen) {
+  std::vector<Quote> quotes;
+  for (uint32_t i = 0; i < count; i++) quotes.push_back(makeQuote(i, gen));
+  return quotes;
+}
+
+static void checkEmpty() {
+  Quote q;
+  CHECK(quoteCacheCount() == 0, "empty: %u quotes", quoteCacheCount());
+  CHECK(!quoteCacheGet(0, q), "empty: read quote 0");
+  CHECK(!quoteCacheRandom(q), "empty: read a random quote");
+  checkContents("empty", {});
+
+  // An empty collection commits to an empty cache
+  CHECK(stage({}), "empty: commit failed");
+  reboot();
+  checkContents("empty commit", {});
+}
+
+// Nothing changes until the commit; a discard leaves the cache as it was
+static void checkStaging() {
+  std::vector<Quote> first = generation(40, 1);
+  CHECK(stage(first), "commit failed");
+  checkContents("commit", first);
+  CHECK(!fileExists(CACHE_STAGE_PATH), "commit: staged copy left behind");
+
+  std::string index = readFile(CACHE_INDEX_PATH);
+  reboot();
+  checkContents("commit after reboot", first);
+  CHECK(readFile(CACHE_INDEX_PATH) == index, "commit: index rewritten at mount");
+
+  // Staged but not committed, then thrown away
+  std::vector<Quote> second = generation(25, 2);
+  CHECK(quoteCacheStageBegin(0), "discard: stage failed");
+  for (const Quote &q : second) quoteCacheStageAdd(q);
+  checkContents("staged", first);
+  quoteCacheStageDiscard();
+  CHECK(!fileExists(CACHE_STAGE_PATH), "discard: staged copy left behind");
+  checkContents("discard", first);
+  reboot();
+  checkContents("discard after reboot", first);
+
+  // Staged across two wakes: resumes only at the exact size
+  CHECK(quoteCacheStageBegin(0), "resume: stage failed");
+  for (size_t i = 0; i < 10; i++) quoteCacheStageAdd(second[i]);
+  uint32_t bytes = quoteCacheStageBytes();
+  quoteCacheStageClose();
+  reboot();
+  checkContents("resume, old copy", first);
+  CHECK(!quoteCacheStageBegin(bytes + 1), "resume: resumed at the wrong size");
+  CHECK(quoteCacheStageBegin(bytes), "resume: resume failed");
+  for (size_t i = 10; i < second.size(); i++) quoteCacheStageAdd(second[i]);
+  CHECK(quoteCacheStageCommit(), "resume: commit failed");
+  checkContents("resume", second);
+
+  // The rename fails (here: the staged copy vanished): the old cache
+  // and its index stay as they were
+  index = readFile(CACHE_INDEX_PATH);
+  CHECK(quoteCacheStageBegin(0), "failed commit: stage failed");
+  for (const Quote &q : first) quoteCacheStageAdd(q);
+  unlink(hostPath(CACHE_STAGE_PATH).c_str());
+  CHECK(!quoteCacheStageCommit(), "failed commit: committed");
+  checkContents("failed commit", second);
+  CHECK(readFile(CACHE_INDEX_PATH) == index, "failed commit: index changed");
+  reboot();
+  checkContents("failed commit after reboot", second);
+
+  // A delta: keep every third record, then add new ones
+  std::vector<uint8_t> keep((second.size() + 7) / 8, 0);
+  std::vector<Quote> third;
+  for (size_t i = 0; i < second.size(); i += 3) {
+    keep[i / 8] |= 1 << (i % 8);
+    third.push_back(second[i]);
+  }
+  std::vector<Quote> added = generation(4, 3);
+  third.insert(third.end(), added.begin(), added.end());
+  CHECK(quoteCacheStageBegin(0) && quoteCacheStageCopy(keep.data()), "delta: copy failed");
+  for (const Quote &q : added) quoteCacheStageAdd(q);
+  CHECK(quoteCacheStageCommit(), "delta: commit failed");
+  checkContents("delta", third);
+  reboot();
+  checkContents("delta after reboot", third);
+}
+
+// Reads by index in random order, and random picks over the whole cache
+static void checkRandomReads() {
+  std::vector<Quote> quotes = generation(60, 4);
+  CHECK(stage(quotes), "random: commit failed");
+
+  Quote q;
+  for (int n = 0; n < 500; n++) {
+    uint32_t i = random(quotes.size());
+    CHECK(quoteCacheGet(i, q) && sameQuote(q, quotes[i]), "random: quote %u read back wrong", i);
+  }
+  CHECK(!quoteCacheGet(quotes.size() + 1000, q), "random: read out of range");
+
+  std::vector<int> seen(quotes.size(), 0);
+  for (int n = 0; n < 3000; n++) {
+    CHECK(quoteCacheRandom(q), "random: pick %d failed", n);
+    uint32_t i = 0;
+    while (i < quotes.size() && !sameQuote(q, quotes[i])) i++;
+    CHECK(i < quotes.size(), "random: pick \"%s\" is not cached", q.id.c_str());
+    if (i < quotes.size()) seen[i]++;
+  }
+  for (uint32_t i = 0; i < quotes.size(); i++) {
+    CHECK(seen[i] > 10, "random: quote %u picked %d times in 3000", i, seen[i]);
+  }
+}
+
+// quotes.idx damaged while the device was off: rebuilt from quotes.dat
+static void checkIndexRecovery() {
+  std::vector<Quote> quotes = generation(30, 5);
+  CHECK(stage(quotes), "recovery: commit failed");
+  const std::string good = readFile(CACHE_INDEX_PATH);
+
+  struct Damage {
+    const char *what;
+    std::string index;
+  };
+  std::string badMagic = good;
+  badMagic[0] ^= 0x01;
+  std::string badCount = good;
+  badCount[4] += 1;
+  std::string badSize = good;
+  badSize[8] += 1;
+  std::string longer = good + std::string(4, '\0');
+  const Damage damage[] = {
+    {"missing", ""},
+    {"empty", ""},
+    {"short header", good.substr(0, 5)},
+    {"truncated", good.substr(0, CACHE_INDEX_HEADER + 4 * 10)},
+    {"bad magic", badMagic},
+    {"bad count", badCount},
+    {"bad data size", badSize},
+    {"extra entry", longer},
+  };
+
+  for (const Damage &d : damage) {
+    if (strcmp(d.what, "missing") == 0) {
+      unlink(hostPath(CACHE_INDEX_PATH).c_str());
+    } else {
+      writeFile(CACHE_INDEX_PATH, d.index);
+    }
+    reboot();
+    checkContents(d.what, quotes);
+    CHECK(readFile(CACHE_INDEX_PATH) == good, "%s: index not rebuilt", d.what);
+  }
+
+  // Power cut part way through the last record of quotes.dat: the index
+  // is stale and the partial record is dropped
+  std::string data = readFile(CACHE_DATA_PATH);
+  writeFile(CACHE_DATA_PATH, data.substr(0, data.size() - 3));
+  reboot();
+  std::vector<Quote> cut(quotes.begin(), quotes.end() - 1);
+  checkContents("cut data", cut);
+
+  // Logout
+  quoteCacheClear();
+  CHECK(quoteCacheCount() == 0, "clear: %u quotes", quoteCacheCount());
+  reboot();
+  checkContents("clear", {});
+  CHECK(!fileExists(CACHE_DATA_PATH) && !fileExists(CACHE_INDEX_PATH), "clear: files left behind");
+}
+
+int main() {
+  ::mkdir("run", 0755);
+  CHECK(system("rm -rf " CHECK_DIR) == 0, "cannot clear " CHECK_DIR);
+  setenv("SIM_FS_DIR", CHECK_DIR, 1);
+  reboot();
+
+  checkEmpty();
+  checkStaging();
+  checkRandomReads();
+  checkIndexRecovery();
+
+  if (failures) {
+    printf("cache_check: %d failures\n", failures);
+    return 1;
+  }
+  printf("cache_check: OK\n");
+  return 0;
+}
@@ -0,0 +1,213 @@
+// config_check.cpp - app_prefs.cpp against an in-memory NVS
+//
+//   config_check
+//
+// Runs the settings store over tools/prefs_mem/Preferences.h and
+// checks what reaches "flash": values survive a reboot, a commit only
+// writes the groups that changed (and nothing when none did), keys
+// from older firmware are moved into the blobs, and short, cut or
+// unwritable blobs are handled. A reboot is simulated by dropping the
+// RAM copy. Exits non-zero on a failure.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// Built into this file so a reboot can reset its state
+#include "app_prefs.cpp"
+
+HardwareSerial Serial;
+void HardwareSerial::begin(unsigned long) {}
+int HardwareSerial::available() { return 0; }
+int HardwareSerial::read() { return -1; }
+int HardwareSerial::peek() { return -1; }
+unsigned long millis() { return 0; }
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                          \
+  do {                                            \
+    if (!(cond)) {                                \
+      printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__);                        \
+      printf("\n");                               \
+      failures++;                                 \
+    }                                             \
+  } while (0)
+
+static void reboot() {
+  loaded = false;
+  memprefs::opens = memprefs::writes = 0;
+}
+
+static memprefs::Namespace &flash() {
+  return memprefs::store[PREFS_NAMESPACE];
+}
+
+// Nothing stored yet: defaults, and reading writes nothing
+static void checkFresh() {
+  memprefs::reset();
+  reboot();
+  CHECK(!isProvisioned(), "fresh device provisioned");
+  CHECK(config().wifiSsid.length() == 0, "fresh SSID \"%s\"", config().wifiSsid.c_str());
+  CHECK(config().quoteWatermark == 0, "fresh watermark %lld", (long long)config().quoteWatermark);
+  CHECK(memprefs::writes == 0, "reading wrote %u entries", memprefs::writes);
+  CHECK(configCommit(), "commit of defaults failed");
+}
+
+static void provision() {
+  AppConfig &cfg = configEdit();
+  cfg.wifiSsid     = "home";
+  cfg.wifiPassword = "";   // open network
+  cfg.fbEmail      = "a@b.c";
+  cfg.fbPassword   = "secret";
+  cfg.provisioned  = true;
+  configCommit();
+}
+
+// One open and only the changed group per commit; nothing for no change
+static void checkCommit() {
+  memprefs::reset();
+  reboot();
+  provision();
+  CHECK(memprefs::writes == 1, "provisioning wrote %u entries", memprefs::writes);
+
+  reboot();
+  CHECK(isProvisioned(), "not provisioned after reboot");
+  CHECK(config().wifiSsid == "home", "SSID \"%s\"", config().wifiSsid.c_str());
+  CHECK(config().fbPassword == "secret", "password \"%s\"", config().fbPassword.c_str());
+  CHECK(memprefs::opens == 1, "load took %u opens", memprefs::opens);
+
+  configEdit().wifiSsid = "home";   // same value
+  CHECK(configCommit(), "unchanged commit failed");
+  CHECK(memprefs::opens == 1 && memprefs::writes == 0,
+        "unchanged commit: %u opens, %u writes", memprefs::opens, memprefs::writes);
+
+  std::vector<uint8_t> creds = flash()["cfg_creds"];
+  AppConfig &cfg = configEdit();
+  cfg.fbIdToken   = "token";
+  cfg.fbUid       = "uid";
+  cfg.fbIdExpires = 1700000000LL;
+  cfg.fbRefresh   = "refresh";
+  configCommit();
+  CHECK(memprefs::opens == 2 && memprefs::writes == 1,
+        "session commit: %u opens, %u writes", memprefs::opens, memprefs::writes);
+  CHECK(flash()["cfg_creds"] == creds, "session commit rewrote the credentials");
+
+  configEdit().quoteSync = "1,2,3,abc";
+  configEdit().quoteWatermark = -5;
+  configCommit();
+  reboot();
+  CHECK(config().fbIdExpires == 1700000000LL, "expiry %lld", (long long)config().fbIdExpires);
+  CHECK(config().fbRefresh == "refresh", "refresh \"%s\"", config().fbRefresh.c_str());
+  CHECK(config().quoteSync == "1,2,3,abc", "sync state \"%s\"", config().quoteSync.c_str());
+  CHECK(config().quoteWatermark == -5, "watermark %lld", (long long)config().quoteWatermark);
+
+  clearAllCredentials();
+  reboot();
+  CHECK(!isProvisioned(), "provisioned after clearing");
+  CHECK(config().fbIdToken.length() == 0 && config().quoteSync.length() == 0,
+        "session or sync state left after clearing");
+}
+
+// Per-key settings of older firmware move into the blobs, once
+static void checkLegacy() {
+  memprefs::reset();
+  Preferences p;
+  p.begin(PREFS_NAMESPACE, false);
+  p.putString("wifi_ssid", "old");
+  p.putString("wifi_password", "");
+  p.putString("fb_email", "x@y.z");
+  p.putString("fb_password", "pw");
+  p.putString("fb_id_exp", "1712345678");
+  p.putString("q_wm", "1711111111");
+  p.putString("ota_meta", "1.0.5\n\"etag\"\n");
+  p.end();
+
+  reboot();
+  CHECK(isProvisioned(), "legacy keys: not provisioned");
+  CHECK(config().wifiSsid == "old", "legacy SSID \"%s\"", config().wifiSsid.c_str());
+  CHECK(config().fbIdExpires == 1712345678LL, "legacy expiry %lld", (long long)config().fbIdExpires);
+  CHECK(config().quoteWatermark == 1711111111LL, "legacy watermark %lld",
+        (long long)config().quoteWatermark);
+  CHECK(config().otaManifest == "1.0.5\n\"etag\"\n", "legacy manifest \"%s\"",
+        config().otaManifest.c_str());
+  for (const char *key : LEGACY_KEYS) {
+    CHECK(!flash().count(key), "legacy key %s left behind", key);
+  }
+
+  reboot();
+  CHECK(config().wifiSsid == "old", "SSID after migration \"%s\"", config().wifiSsid.c_str());
+  CHECK(memprefs::writes == 0, "second boot wrote %u entries", memprefs::writes);
+
+  // Without the Wi-Fi password key the old firmware was not provisioned
+  memprefs::reset();
+  p.begin(PREFS_NAMESPACE, false);
+  p.putString("wifi_ssid", "old");
+  p.putString("fb_email", "x@y.z");
+  p.putString("fb_password", "pw");
+  p.end();
+  reboot();
+  CHECK(!isProvisioned(), "legacy keys without a password: provisioned");
+}
+
+// A blob from an older version lacks the later fields; one cut in half
+// is dropped without touching the other groups
+static void checkBlobs() {
+  memprefs::reset();
+  reboot();
+  provision();
+  configEdit().wifiAp = "AABBCCDDEEFF,6";
+  configEdit().otaDownload = "abc,1,2,0";
+  configCommit();
+
+  std::vector<uint8_t> &state = flash()["cfg_state"];
+  state.resize(1 + 2 + strlen("AABBCCDDEEFF,6"));   // version + wifiAp only
+  reboot();
+  CHECK(config().wifiAp == "AABBCCDDEEFF,6", "short blob: AP \"%s\"", config().wifiAp.c_str());
+  CHECK(config().otaDownload.length() == 0, "short blob: download \"%s\"",
+        config().otaDownload.c_str());
+
+  state.resize(5);   // wifiAp cut in half
+  reboot();
+  CHECK(config().wifiAp.length() == 0, "cut blob: AP \"%s\"", config().wifiAp.c_str());
+  CHECK(config().wifiSsid == "home", "cut blob: SSID \"%s\"", config().wifiSsid.c_str());
+
+  // A newer version's fields after ours are skipped
+  configEdit().wifiAp = "112233445566,1";
+  configCommit();
+  state.insert(state.end(), 16, 0xAB);
+  reboot();
+  CHECK(config().wifiAp == "112233445566,1", "long blob: AP \"%s\"", config().wifiAp.c_str());
+}
+
+// A failed write is reported and retried by the next commit
+static void checkWriteFailure() {
+  memprefs::reset();
+  reboot();
+  provision();
+  memprefs::failWrites = true;
+  configEdit().wifiAp = "AABBCCDDEEFF,6";
+  CHECK(!configCommit(), "failed write reported as saved");
+  CHECK(config().wifiAp == "AABBCCDDEEFF,6", "failed write lost the RAM copy");
+
+  memprefs::failWrites = false;
+  CHECK(configCommit(), "retry failed");
+  reboot();
+  CHECK(config().wifiAp == "AABBCCDDEEFF,6", "retried AP \"%s\"", config().wifiAp.c_str());
+}
+
+int main() {
+  checkFresh();
+  checkCommit();
+  checkLegacy();
+  checkBlobs();
+  checkWriteFailure();
+
+  if (failures) {
+    printf("config_check: %d failures\n", failures);
+    return 1;
+  }
+  printf("config_check: OK\n");
+  return 0;
+}
@@ -0,0 +1,165 @@
+#!/bin/sh
+# delta_check.sh - delta sync of the quote cache against the mock
+# server. One device (run/delta/) is powered on again and again while
+# the collection is edited through /mock/mutate in between. Logs go to
+# run/delta_<step>.log.
+#
+#   full      first power-on: provisioning and a full sync
+#   edit      3 added, 2 edited, 1 deleted: a delta fetching 5 quotes
+#   same      nothing changed: the cache is up to date
+#   collide   two new IDs whose FNV-1a hashes are equal
+#   collide2  nothing changed: both of them are kept
+#   flood     QUOTE_DELTA_MAX_CHANGES + 1 added: a full sync instead
+#
+# After every step the cache in run/delta/fs/ must hold exactly the
+# mock's collection, edited texts included. The collection is edited
+# an hour before each power-on, on both the mock's clock and the
+# device's, so a sync never overlaps an edit within the watermark
+# margin (which would fetch the edited quotes once more on the next).
+
+set -u
+cd "$(dirname "$0")/.."
+
+PORT=${PORT:-18090}
+QUOTES=${QUOTES:-230}
+MAX_CHANGES=200   # QUOTE_DELTA_MAX_CHANGES
+
+[ -x ./quote_sim ] || { echo "delta_check: build ./quote_sim first (make)"; exit 2; }
+
+rm -rf run/delta run/delta_*.log
+mkdir -p run/delta
+
+python3 tools/mock_server.py --port "$PORT" --quotes "$QUOTES" --chunked > run/delta_mock.log 2>&1 &
+MOCK=$!
+trap 'kill $MOCK 2>/dev/null' EXIT INT TERM
+
+i=0
+until python3 -c "import socket; socket.create_connection(('127.0.0.1', $PORT), 1)" 2>/dev/null; do
+  i=$((i + 1))
+  if [ $i -ge 50 ]; then
+    echo "delta_check: mock server did not start"; cat run/delta_mock.log; exit 2
+  fi
+  sleep 0.1
+done
+
+OFFSET=0   # seconds the mock's clock runs ahead
+
+# power_on NAME BOOTS
+power_on() {
+  epoch=$(python3 -c "import time; print(int((time.time() + $OFFSET) * 1000000))")
+  (
+    cd run/delta &&
+    SIM_EPOCH_US=$epoch SIM_HTTP_PORT=$PORT \
+    SIM_WIFI_SSID=home SIM_PROV_SSID=home SIM_PROV_PASS=pw \
+    SIM_NVS_FILE=nvs.bin SIM_RTC_FILE=rtc.bin SIM_FS_DIR=fs \
+    SIM_OTA_FILE=ota.bin SIM_RUNNING_IMAGE=running.bin SIM_MAX_BOOTS=$2 \
+    ../../quote_sim
+  ) > "run/delta_$1.log" 2>&1 || { echo "delta_check: $1: simulator exited with $?"; fail=1; }
+
+  echo "== $1"
+  grep -E '^\[QUOTE\] (Synced|Delta|Too many|Cache up to date)' "run/delta_$1.log"
+}
+
+# mutate JSON
+mutate() {
+  python3 - "$PORT" "$1" <<'EOF'
+import sys, urllib.request
+req = urllib.request.Request("http://127.0.0.1:%s/mock/mutate" % sys.argv[1],
+                             data=sys.argv[2].encode(), method="POST")
+urllib.request.urlopen(req).read()
+EOF
+}
+
+# an_hour_later [MEMBERS]: edit the collection (JSON members of a
+# mutation), then move the clocks an hour ahead
+an_hour_later() {
+  [ -n "${1:-}" ] && mutate "{$1}"
+  OFFSET=$((OFFSET + 3600))
+  mutate '{"advance": 3600}'
+}
+
+expect() {
+  grep -qF "$2" "run/delta_$1.log" || { echo "delta_check: $1: missing \"$2\""; fail=1; }
+}
+
+# The cached quotes (run/delta/fs/quotes.dat, see quote_cache.h) must
+# be the mock's collection: the same IDs, each with its current text
+check_cache() {
+  python3 - "$PORT" "$1" <<'EOF' || fail=1
+import json, struct, sys, urllib.request
+
+port, name = sys.argv[1], sys.argv[2]
+req = urllib.request.Request(
+    "http://127.0.0.1:%s/v1/projects/sim/databases/(default)/documents/users/simuser/quotes"
+    "?pageSize=100000" % port, headers={"Authorization": "Bearer sim-id-token"})
+data = urllib.request.urlopen(req).read()
+want = {}
+for doc in json.loads(data).get("documents", []):
+    want[doc["name"].rsplit("/", 1)[1]] = doc["fields"]["text"]["stringValue"]
+
+have = {}
+raw = open("run/delta/fs/quotes.dat", "rb").read()
+pos = 0
+while pos < len(raw):
+    id_len, text_len, author_len, tags_len = struct.unpack_from("<BHBH", raw, pos)
+    pos += 6
+    qid = raw[pos:pos + id_len].decode()
+    pos += id_len
+    have[qid] = raw[pos:pos + text_len].decode()
+    pos += text_len + author_len + tags_len
+
+missing = sorted(set(want) - set(have))
+extra = sorted(set(have) - set(want))
+stale = sorted(k for k in want if k in have and have[k] != want[k])
+for what, ids in (("missing", missing), ("not in the collection", extra), ("stale", stale)):
+    if ids:
+        print("delta_check: %s: %d cached quotes %s: %s" % (name, len(ids), what, " ".join(ids[:5])))
+if missing or extra or stale:
+    sys.exit(1)
+print("  cache: %d quotes, as in the collection" % len(have))
+EOF
+}
+
+fail=0
+
+# Boots: provisioning, cold boot with a full sync
+power_on full 2
+expect full "[QUOTE] Synced $QUOTES quotes"
+check_cache full
+
+an_hour_later '"add": 3, "update": ["q00003", "q00010"], "delete": ["q00007"]'
+power_on edit 1
+expect edit "[QUOTE] Delta: $((QUOTES + 2)) listed, 3 new, 2 updated, 1 deleted"
+expect edit '[QUOTE] Delta applied: 5 fetched, 1 deleted'
+check_cache edit
+
+an_hour_later
+power_on same 1
+expect same "[QUOTE] Delta: $((QUOTES + 2)) listed, 0 new, 0 updated, 0 deleted"
+expect same '[QUOTE] Cache up to date'
+check_cache same
+
+# FNV-1a("fTSAuI32NJLkXq41FmD0") == FNV-1a("Doc4kO2LGYmweXkEKS5g"):
+# each must still be matched to its own cached record
+an_hour_later '"add": ["fTSAuI32NJLkXq41FmD0", "Doc4kO2LGYmweXkEKS5g"], "delete": ["q00020"]'
+power_on collide 1
+expect collide "[QUOTE] Delta: $((QUOTES + 3)) listed, 2 new, 0 updated, 1 deleted"
+check_cache collide
+
+an_hour_later
+power_on collide2 1
+expect collide2 "[QUOTE] Delta: $((QUOTES + 3)) listed, 0 new, 0 updated, 0 deleted"
+expect collide2 '[QUOTE] Cache up to date'
+check_cache collide2
+
+# More changes than a delta fetches: full sync, which may take a few
+# wakes within its per-wake budget
+an_hour_later "\"add\": $((MAX_CHANGES + 1))"
+power_on flood 4
+expect flood "[QUOTE] Delta: $((QUOTES + MAX_CHANGES + 4)) listed, $((MAX_CHANGES + 1)) new, 0 updated, 0 deleted"
+expect flood '[QUOTE] Too many changes, doing a full sync.'
+expect flood "[QUOTE] Synced $((QUOTES + MAX_CHANGES + 4)) quotes"
+check_cache flood
+
+[ $fail -eq 0 ] && echo "delta_check: OK"
+exit $fail
@@ -0,0 +1,424 @@
+// gfx_bench.cpp - heltec drawing primitives, without the app
+//
+//   gfx_bench                    fillRect() and drawPixel() throughput
+//   gfx_bench --check [golden]   compare against the golden images
+//   gfx_bench --write [golden]   record the golden images
+//
+// The check draws a fixed scene (rectangles on and off the edges, lines,
+// circles, text, an inverted region, then again inside a window) on
+// every display class, for each of the 4 rotations and 4 flips, and
+// compares a hash of the pagefiles with tools/gfx_golden.txt, recorded
+// from the pixel-by-pixel drawing. It also draws the same random
+// rectangles with fillRect() and with GFX::fillRect() (one drawPixel()
+// call per pixel) on two displays, which must end up identical. Exits
+// non-zero on a difference.
+//
+// The benchmark times both on the app's panel (DEPG0290BNS800, landscape)
+// for a few rectangle shapes: the whole screen, a block, a row, a column
+// and the 2x2 cells of size-2 text. Then, on every display class, it
+// times text and outline shapes (drawn pixel by pixel) with drawPixel()
+// and with the generic drawPixel() it replaced, kept here as
+// Probe::slowPixel().
+//
+// Built for Wireless Paper, the one board whose build has every display
+// class: the SPI modules and the all-in-one boards' panels.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <map>
+#include <string>
+
+#include <heltec-eink-modules.h>
+#include "Fonts/FreeSans9pt7b.h"
+
+#define GOLDEN_PATH "tools/gfx_golden.txt"
+#define RANDOM_RECTS 3000
+#define BENCH_SECONDS 0.25
+
+// Normally in sim_main.cpp, which is not linked: there is no sketch
+namespace sim {
+unsigned long long pendingSleepUs = 0;
+}
+
+// The virtual calculatePixelPageOffset(), which some displays make private
+struct PageOffset : BaseDisplay {
+  static void of(BaseDisplay &d, uint16_t x, uint16_t y, uint16_t &byte_offset, uint8_t &bit_offset) {
+    (d.*&PageOffset::calculatePixelPageOffset)(x, y, byte_offset, bit_offset);
+  }
+};
+
+// Opens up the pagefiles. Display modules take their pins (any will
+// do), the all-in-one boards' displays take none
+template <class Display>
+class Probe : public Display {
+public:
+  template <typename... Pins>
+  Probe(Pins... pins) : Display(pins...) {}
+
+  uint32_t hash() {
+    uint32_t h = 2166136261UL;
+    mix(h, this->page_black);
+    if (this->supportsColor(RED)) mix(h, this->page_red);
+    return h;
+  }
+
+  // Route drawPixel() through slowPixel()
+  bool slow = false;
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if (slow) slowPixel(x, y, color);
+    else Display::drawPixel(x, y, color);
+  }
+
+  bool same(Probe &other) {
+    if (memcmp(this->page_black, other.page_black, this->page_bytecount)) return false;
+    return !this->supportsColor(RED) || !memcmp(this->page_red, other.page_red, this->page_bytecount);
+  }
+
+private:
+  // drawPixel() before it was specialized: rotation, flip, color support
+  // and the page layout decided for every pixel
+  void slowPixel(int16_t x, int16_t y, uint16_t color) {
+    int16_t x1 = 0, y1 = 0;
+    switch (this->rotation) {
+      case 0: x1 = x; y1 = y; break;
+      case 1: x1 = (this->BaseDisplay::drawing_width - 1) - y; y1 = x; break;
+      case 2: x1 = (this->BaseDisplay::drawing_width - 1) - x; y1 = (this->BaseDisplay::drawing_height - 1) - y; break;
+      case 3: x1 = y; y1 = (this->BaseDisplay::drawing_height - 1) - x; break;
+    }
+    x = x1;
+    y = y1;
+    if (this->imgflip & HORIZONTAL) {
+      if (this->rotation % 2) y = (this->BaseDisplay::drawing_height - 1) - y;
+      else x = (this->BaseDisplay::drawing_width - 1) - x;
+    }
+    if (this->imgflip & VERTICAL) {
+      if (this->rotation % 2) x = (this->BaseDisplay::drawing_width - 1) - x;
+      else y = (this->BaseDisplay::drawing_height - 1) - y;
+    }
+    if ((uint16_t)x >= this->winrot_left && (uint16_t)y >= this->page_top &&
+        (uint16_t)y <= this->page_bottom && (uint16_t)x <= this->winrot_right) {
+      uint16_t byte_offset;
+      uint8_t bit_offset;
+      PageOffset::of(*this, x, y, byte_offset, bit_offset);
+      uint8_t bitmask = ~(1 << bit_offset);
+      this->page_black[byte_offset] &= bitmask;
+      this->page_black[byte_offset] |= (color & WHITE) << bit_offset;
+      if (this->supportsColor(RED)) {
+        this->page_red[byte_offset] &= bitmask;
+        this->page_red[byte_offset] |= (color >> 1) << bit_offset;
+      }
+    }
+  }
+
+  void mix(uint32_t &h, const uint8_t *buf) {
+    for (uint16_t i = 0; i < this->page_bytecount; i++) {
+      h ^= buf[i];
+      h *= 16777619UL;
+    }
+  }
+};
+
+static const Flip FLIPS[] = {NONE, HORIZONTAL, VERTICAL, (Flip)(HORIZONTAL | VERTICAL)};
+
+static uint32_t rngState = 2463534242UL;
+
+static int32_t nextRandom(int32_t lo, int32_t hi) {   // [lo, hi)
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return lo + (int32_t)(((uint64_t)rngState * (uint32_t)(hi - lo)) >> 32);
+}
+
+static void configure(BaseDisplay &d, int rotation, Flip flip) {
+  d.setFlip(NONE);
+  d.setRotation(rotation);
+  d.setFlip(flip);
+  d.fullscreen();
+  d.setFont();
+  d.setTextSize(1);
+}
+
+static void drawScene(BaseDisplay &d) {
+  int16_t w = d.width(), h = d.height();
+  d.fillScreen(WHITE);
+  d.fillRect(0, 0, w / 2, h / 3, BLACK);           // from the corner
+  d.fillRect(3, 5, 17, 9, WHITE);                  // inside it, off the byte grid
+  d.fillRect(w - 10, h - 7, 30, 30, BLACK);        // off the far edges
+  d.fillRect(-6, h / 2, 20, 3, BLACK);             // off the near edge
+  d.fillRect(5, -4, 2, 10, RED);
+  d.fillRect(10, 10, 0, 5, BLACK);                 // empty
+  d.fillRect(10, 10, 5, -3, BLACK);
+  d.fillRect(-50, -50, w + 100, 2, BLACK);         // all outside
+  d.drawLine(0, h - 1, w - 1, h - 1, BLACK);
+  d.drawLine(w - 1, 0, w - 1, h - 1, BLACK);
+  d.drawRect(7, h / 2 + 5, w - 14, 21, RED);
+  d.fillCircle(w / 2, h / 2, min(w, h) / 4, BLACK);
+  d.fillRoundRect(4, h - 40, w / 3, 30, 6, RED);
+  d.fillTriangle(w - 1, h / 3, w / 2, h / 2, w - 20, h - 1, WHITE);
+  d.drawLine(0, 0, w - 1, h - 1, BLACK);
+
+  d.setFont(&FreeSans9pt7b);
+  d.setTextColor(BLACK);
+  d.setCursor(2, h / 3 + 14);
+  d.print("Span 08/15");
+  d.setFont();
+  d.setTextSize(2);
+  d.setTextColor(RED, WHITE);
+  d.setCursor(w / 3, h - 20);
+  d.print("Ag");
+  d.setTextSize(1);
+
+  d.invert(w / 4, h / 4, w / 3, 13);
+}
+
+// Same again, inside a window off the byte grid
+static void drawWindowScene(BaseDisplay &d) {
+  int16_t w = d.width(), h = d.height();
+  d.setWindow(9, 11, w / 2, h / 3);
+  d.fillScreen(BLACK);
+  d.fillRect(0, 0, w, 4, WHITE);
+  d.fillRect(12, 14, 7, 30, WHITE);
+  d.fillRect(w / 2 - 3, 15, 10, 10, RED);
+  d.drawRect(9, 11, w / 2, h / 3, WHITE);
+  d.fillCircle(9 + w / 4, 11 + h / 6, 9, WHITE);
+  d.fullscreen();
+}
+
+// ---- Golden images ----
+
+typedef std::map<std::string, uint32_t> Golden;
+
+static bool readGolden(const char *path, Golden &golden) {
+  FILE *f = fopen(path, "r");
+  if (!f) return false;
+  char line[128], key[96];
+  unsigned long h;
+  while (fgets(line, sizeof(line), f)) {
+    if (line[0] == '#') continue;
+    if (sscanf(line, "%95s %lx", key, &h) == 2) golden[key] = (uint32_t)h;
+  }
+  fclose(f);
+  return true;
+}
+
+struct Checker {
+  bool     write;
+  Golden   golden;
+  Golden   seen;
+  int      failures = 0;
+
+  void image(const char *display, int rotation, Flip flip, const char *scene, uint32_t h) {
+    char key[96];
+    snprintf(key, sizeof(key), "%s/r%d/f%d/%s", display, rotation, (int)flip, scene);
+    seen[key] = h;
+    if (write) return;
+    auto it = golden.find(key);
+    if (it == golden.end()) {
+      printf("FAIL %s: no golden image\n", key);
+      failures++;
+    } else if (it->second != h) {
+      printf("FAIL %s: %08lx, golden %08lx\n", key, (unsigned long)h, (unsigned long)it->second);
+      failures++;
+    }
+  }
+};
+
+template <class Display, typename... Pins>
+static void checkDisplay(const char *name, Checker &c, Pins... pins) {
+  Probe<Display> *span = new Probe<Display>(pins...);
+  Probe<Display> *pixels = new Probe<Display>(pins...);
+
+  for (int rotation = 0; rotation < 4; rotation++) {
+    for (Flip flip : FLIPS) {
+      configure(*span, rotation, flip);
+      drawScene(*span);
+      c.image(name, rotation, flip, "scene", span->hash());
+      drawWindowScene(*span);
+      c.image(name, rotation, flip, "window", span->hash());
+
+      // Random rectangles, both ways
+      configure(*span, rotation, flip);
+      configure(*pixels, rotation, flip);
+      span->fillScreen(WHITE);
+      pixels->fillScreen(WHITE);
+      int16_t w = span->width(), h = span->height();
+      for (int i = 0; i < RANDOM_RECTS; i++) {
+        int16_t x = nextRandom(-20, w + 20), y = nextRandom(-20, h + 20);
+        int16_t rw = nextRandom(-2, 70), rh = nextRandom(-2, 70);
+        uint16_t color = (i % 3 == 0) ? BLACK : (i % 3 == 1) ? WHITE : RED;
+        span->fillRect(x, y, rw, rh, color);
+        pixels->GFX::fillRect(x, y, rw, rh, color);
+      }
+      if (!span->same(*pixels)) {
+        printf("FAIL %s/r%d/f%d: fillRect() differs from drawing pixel by pixel\n", name, rotation, (int)flip);
+        c.failures++;
+      }
+    }
+  }
+  delete span;
+  delete pixels;
+}
+
+static int check(bool write, const char *path) {
+  Checker c;
+  c.write = write;
+  if (!write && !readGolden(path, c.golden)) {
+    printf("gfx_bench: no golden images in %s (record them with --write)\n", path);
+    return 2;
+  }
+
+  checkDisplay<DEPG0150BNS810>("DEPG0150BNS810", c, 2, 4, 5);
+  checkDisplay<DEPG0154BNS800>("DEPG0154BNS800", c, 2, 4, 5);
+  checkDisplay<DEPG0213BNS800>("DEPG0213BNS800", c);
+  checkDisplay<DEPG0290BNS75A>("DEPG0290BNS75A", c, 2, 4, 5);
+  checkDisplay<DEPG0290BNS800>("DEPG0290BNS800", c, 2, 4, 5);
+  checkDisplay<E0213A367>("E0213A367", c);
+  checkDisplay<GDE029A1>("GDE029A1", c, 2, 4, 5);
+  checkDisplay<GDEP015OC1>("GDEP015OC1", c, 2, 4, 5);
+  checkDisplay<LCMEN2R13EFC1>("LCMEN2R13EFC1", c);
+  checkDisplay<QYEG0213RWS800>("QYEG0213RWS800", c, 2, 4, 5);
+
+  if (write) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+      printf("gfx_bench: cannot write %s\n", path);
+      return 2;
+    }
+    fprintf(f, "# gfx_golden.txt - pagefile hashes of gfx_bench's scenes, per\n"
+               "# display/rotation/flip, recorded with gfx_bench --write\n");
+    for (auto &kv : c.seen) fprintf(f, "%s %08lx\n", kv.first.c_str(), (unsigned long)kv.second);
+    fclose(f);
+    printf("gfx_bench: %u golden images written to %s\n", (unsigned)c.seen.size(), path);
+    return 0;
+  }
+
+  if (c.failures) {
+    printf("gfx_bench: %d failures\n", c.failures);
+    return 1;
+  }
+  printf("gfx_bench: %u images match, fillRect() matches drawPixel()\n", (unsigned)c.seen.size());
+  return 0;
+}
+
+// ---- Benchmark ----
+
+struct Shape {
+  const char *name;
+  int16_t x, y, w, h;
+};
+
+typedef std::chrono::steady_clock Clock;
+
+// Pixels per second, drawing `shape` over and over
+template <class Display>
+static double rate(Probe<Display> &d, const Shape &s, bool span) {
+  uint64_t pixels = 0;
+  uint16_t color = BLACK;
+  Clock::time_point start = Clock::now();
+  double elapsed = 0;
+  while (elapsed < BENCH_SECONDS) {
+    for (int i = 0; i < 16; i++) {
+      if (span) d.fillRect(s.x, s.y, s.w, s.h, color);
+      else d.GFX::fillRect(s.x, s.y, s.w, s.h, color);
+      color = color == BLACK ? WHITE : BLACK;
+      pixels += (uint64_t)s.w * s.h;
+    }
+    elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+  }
+  return pixels / elapsed;
+}
+
+static void benchFillRect() {
+  Probe<DEPG0290BNS800> *d = new Probe<DEPG0290BNS800>(2, 4, 5);
+  configure(*d, 1, NONE);
+  int16_t w = d->width(), h = d->height();
+  const Shape shapes[] = {
+    {"fillScreen", 0, 0, w, h},
+    {"block 100x40", 13, 7, 100, 40},
+    {"row 200x1", 5, 60, 200, 1},
+    {"column 1x100", 77, 3, 1, 100},
+    {"text cell 2x2", 31, 17, 2, 2},
+  };
+
+  printf("fillRect() on %s, %dx%d landscape (Mpixel/s)\n", "DEPG0290BNS800", w, h);
+  printf("  %-16s %12s %12s %9s\n", "shape", "per pixel", "spans", "speedup");
+  for (const Shape &s : shapes) {
+    double before = rate(*d, s, false);
+    double after = rate(*d, s, true);
+    printf("  %-16s %12.2f %12.2f %8.1fx\n", s.name, before / 1e6, after / 1e6, after / before);
+  }
+  delete d;
+}
+
+static void drawText(BaseDisplay &d) {
+  d.setFont(&FreeSans9pt7b);
+  d.setTextColor(BLACK);
+  d.setCursor(0, 14);
+  d.print("The quick brown fox jumps over the lazy dog. 0123456789 \"quotes\" (and) more.");
+}
+
+static void drawShapes(BaseDisplay &d) {
+  int16_t w = d.width(), h = d.height();
+  for (int16_t r = 6; r < min(w, h) / 2; r += 6) d.drawCircle(w / 2, h / 2, r, BLACK);
+  d.drawLine(0, 0, w - 1, h - 1, BLACK);
+  d.drawLine(0, h - 1, w - 1, 0, BLACK);
+  d.drawTriangle(3, h - 4, w / 2, 5, w - 4, h / 2, BLACK);
+}
+
+// Microseconds per call of `draw`
+static double drawTime(BaseDisplay &d, void (*draw)(BaseDisplay &)) {
+  uint32_t calls = 0;
+  Clock::time_point start = Clock::now();
+  double elapsed = 0;
+  while (elapsed < BENCH_SECONDS / 2) {
+    for (int i = 0; i < 8; i++) draw(d);
+    calls += 8;
+    elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+  }
+  return elapsed * 1e6 / calls;
+}
+
+template <class Display, typename... Pins>
+static void benchPixels(const char *name, Pins... pins) {
+  Probe<Display> *d = new Probe<Display>(pins...);
+  configure(*d, 1, NONE);
+  d->fillScreen(WHITE);
+  double t[4];
+  for (int slow = 0; slow < 2; slow++) {
+    d->slow = !slow;
+    t[slow * 2] = drawTime(*d, drawText);
+    t[slow * 2 + 1] = drawTime(*d, drawShapes);
+  }
+  d->slow = false;
+  printf("  %-16s %8.1f %8.1f %6.1fx %8.1f %8.1f %6.1fx\n", name, t[0], t[2], t[0] / t[2], t[1], t[3],
+         t[1] / t[3]);
+  delete d;
+}
+
+static int bench() {
+  benchFillRect();
+
+  printf("\ndrawPixel() per display class, landscape (us per draw: generic, specialized)\n");
+  printf("  %-16s %8s %8s %7s %8s %8s %7s\n", "display", "text", "", "", "shapes", "", "");
+  benchPixels<DEPG0150BNS810>("DEPG0150BNS810", 2, 4, 5);
+  benchPixels<DEPG0154BNS800>("DEPG0154BNS800", 2, 4, 5);
+  benchPixels<DEPG0213BNS800>("DEPG0213BNS800");
+  benchPixels<DEPG0290BNS75A>("DEPG0290BNS75A", 2, 4, 5);
+  benchPixels<DEPG0290BNS800>("DEPG0290BNS800", 2, 4, 5);
+  benchPixels<E0213A367>("E0213A367");
+  benchPixels<GDE029A1>("GDE029A1", 2, 4, 5);
+  benchPixels<GDEP015OC1>("GDEP015OC1", 2, 4, 5);
+  benchPixels<LCMEN2R13EFC1>("LCMEN2R13EFC1");
+  benchPixels<QYEG0213RWS800>("QYEG0213RWS800", 2, 4, 5);
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  if (argc > 1 && !strcmp(argv[1], "--check")) return check(false, argc > 2 ? argv[2] : GOLDEN_PATH);
+  if (argc > 1 && !strcmp(argv[1], "--write")) return check(true, argc > 2 ? argv[2] : GOLDEN_PATH);
+  return bench();
+}
@@ -0,0 +1,205 @@
+// layout_bench.cpp - text_layout.cpp over a corpus of quotes
+//
+//   layout_bench [corpus.tsv]
+//
+// Lays out every quote of the corpus (one "text<TAB>author<TAB>tags"
+// per line, or LAYOUT_BENCH_QUOTES generated ones of English-like
+// words) and prints the time per layout and how well the quotes fit:
+// the font each one got, how much of the text area it fills, how even
+// its lines are, and how many had to be cut short. For comparison it
+// counts the quotes the old fixed 24-characters-a-line layout ran off
+// the panel with. Exits non-zero if a line falls outside the panel.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include <vector>
+
+#include "text_layout.h"
+
+struct Sample {
+  std::string text, author, tags;
+};
+
+static uint32_t rngState = 2463534242UL;
+
+static uint32_t nextRandom(uint32_t bound) {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return (uint32_t)(((uint64_t)rngState * bound) >> 32);
+}
+
+static const char *const WORDS[] = {
+  "the", "of", "and", "to", "a", "in", "is", "you", "that", "it", "he", "was",
+  "for", "on", "are", "as", "with", "his", "they", "I", "at", "be", "this",
+  "have", "from", "or", "one", "had", "by", "word", "but", "not", "what",
+  "all", "were", "we", "when", "your", "can", "said", "there", "use", "an",
+  "each", "which", "she", "do", "how", "their", "if", "will", "up", "other",
+  "about", "out", "many", "then", "them", "these", "so", "some", "her",
+  "would", "make", "like", "him", "into", "time", "has", "look", "two",
+  "more", "write", "go", "see", "number", "no", "way", "could", "people",
+  "life", "love", "nothing", "everything", "courage", "imagination",
+  "happiness", "understanding", "yourself", "remember", "tomorrow",
+  "knowledge", "possible", "beautiful", "experience", "opportunity",
+  "responsibility", "extraordinary", "never", "always", "world", "heart",
+};
+static const size_t WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+static std::string words(size_t targetLen) {
+  std::string s;
+  while (s.size() < targetLen) {
+    if (!s.empty()) s += nextRandom(12) == 0 ? ", " : " ";
+    s += WORDS[nextRandom(WORD_COUNT)];
+  }
+  if (!s.empty()) s[0] = (char)toupper((unsigned char)s[0]);
+  return s + ".";
+}
+
+// Lengths skewed like real quote collections: mostly one or two
+// sentences, a long tail up to a paragraph
+static std::vector<Sample> generate(size_t n) {
+  std::vector<Sample> corpus;
+  for (size_t i = 0; i < n; i++) {
+    Sample q;
+    uint32_t r = nextRandom(100);
+    size_t len = r < 60 ? 20 + nextRandom(100)
+               : r < 90 ? 120 + nextRandom(120)
+               : 240 + nextRandom(360);
+    q.text = words(len);
+    q.author = words(5 + nextRandom(30));
+    q.author.pop_back();
+    int tags = nextRandom(4);
+    for (int t = 0; t < tags; t++) {
+      if (t) q.tags += "   ";
+      q.tags += "#";
+      q.tags += WORDS[nextRandom(WORD_COUNT)];
+    }
+    corpus.push_back(q);
+  }
+  return corpus;
+}
+
+static std::vector<Sample> load(const char *path) {
+  std::vector<Sample> corpus;
+  FILE *f = fopen(path, "r");
+  if (!f) {
+    perror(path);
+    exit(2);
+  }
+  char line[8192];
+  while (fgets(line, sizeof(line), f)) {
+    line[strcspn(line, "\r\n")] = 0;
+    Sample q;
+    char *author = strchr(line, '\t');
+    char *tags = author ? strchr(author + 1, '\t') : nullptr;
+    if (author) *author++ = 0;
+    if (tags) *tags++ = 0;
+    q.text = line;
+    q.author = author ? author : "";
+    q.tags = tags ? tags : "";
+    if (!q.text.empty()) corpus.push_back(q);
+  }
+  fclose(f);
+  return corpus;
+}
+
+// Lines the old layout needed: 24 characters a line, 20 px apart,
+// from y = 6, then the author and tags lines
+static bool oldLayoutOverflows(const Sample &q) {
+  size_t len = q.text.size(), start = 0;
+  int y = 6;
+  while (start < len) {
+    size_t end = start + 24 < len ? start + 24 : len;
+    size_t brk = end;
+    if (end < len) {
+      size_t sp = q.text.rfind(' ', end);
+      brk = (sp != std::string::npos && sp > start) ? sp : end;
+    }
+    y += 20;
+    start = brk;
+    while (start < len && q.text[start] == ' ') start++;
+  }
+  y += 4 + (q.author.empty() ? 0 : 12);
+  return y > LAYOUT_HEIGHT - 14;   // ran into the tags line
+}
+
+static double nowUs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+int main(int argc, char **argv) {
+  const char *env = getenv("LAYOUT_BENCH_QUOTES");
+  std::vector<Sample> corpus = argc > 1 ? load(argv[1])
+                                        : generate(env ? strtoul(env, nullptr, 10) : 5000);
+  const uint16_t badge = 40;
+
+  std::vector<QuoteLayout> layouts(corpus.size());
+  const int passes = 5;
+  double start = nowUs();
+  for (int p = 0; p < passes; p++) {
+    for (size_t i = 0; i < corpus.size(); i++) {
+      const Sample &q = corpus[i];
+      layoutQuote(q.text.data(), q.text.size(), q.author.data(), q.author.size(),
+                  q.tags.data(), q.tags.size(), badge, layouts[i]);
+    }
+  }
+  double perLayout = (nowUs() - start) / passes / corpus.size();
+
+  int fontUse[8] = {0};
+  int truncated = 0, oldOverflow = 0, bad = 0;
+  double fill = 0, evenness = 0;
+  int multiLine = 0;
+  size_t chars = 0;
+  for (size_t i = 0; i < corpus.size(); i++) {
+    const Sample &q = corpus[i];
+    const QuoteLayout &l = layouts[i];
+    const LayoutFont &font = layoutTextFonts[l.textFont];
+    chars += q.text.size();
+    fontUse[l.textFont]++;
+    truncated += l.truncated;
+    oldOverflow += oldLayoutOverflows(q);
+    fill += (double)l.usedHeight / (LAYOUT_HEIGHT - 8 - 2 * 4);
+
+    uint16_t minW = 0xFFFF, maxW = 0;
+    for (int j = 0; j < l.lineCount; j++) {
+      const LayoutLine &line = l.lines[j];
+      uint16_t w = layoutMeasure(font, q.text.data() + line.start, line.len);
+      if (line.x < 0 || line.x + w > LAYOUT_WIDTH || line.y < 0 || line.y > LAYOUT_HEIGHT) {
+        if (bad++ < 5) printf("FAIL quote %zu line %d at (%d,%d) width %u\n", i, j, line.x, line.y, w);
+      }
+      if (w < minW) minW = w;
+      if (w > maxW) maxW = w;
+    }
+    if (l.lineCount > 1 && maxW) {
+      evenness += (double)minW / maxW;
+      multiLine++;
+    }
+  }
+
+  size_t n = corpus.size();
+  printf("layout_bench: %zu quotes, %.0f chars on average\n", n, (double)chars / n);
+  printf("  layout: %.2f us per quote on this host\n", perLayout);
+  for (int f = 0; f < layoutTextFontCount; f++) {
+    const LayoutFont &font = layoutTextFonts[f];
+    printf("  font %d (%s): %d quotes\n", f,
+           font.gfx ? (font.gfx->yAdvance > 35 ? "18pt" : font.gfx->yAdvance > 25 ? "12pt" : "9pt")
+                    : "6x8", fontUse[f]);
+  }
+  printf("  text area filled: %.0f%% on average\n", 100.0 * fill / n);
+  printf("  shortest / longest line: %.0f%% on average\n",
+         multiLine ? 100.0 * evenness / multiLine : 100.0);
+  printf("  cut short: %d\n", truncated);
+  printf("  old fixed-width layout ran off the text area: %d\n", oldOverflow);
+
+  if (bad) {
+    printf("layout_bench: %d lines off the panel\n", bad);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,151 @@
+// lzss_bench.cpp - decompression throughput and RAM for OTA images
+//
+//   lzss_bench IMAGE.hs IMAGE.bin [...]
+//
+// Streams each compressed image through lzss_decoder.cpp the way
+// ota_manager.cpp does (OTA_PACKED_READ bytes in, OTA_BUF_SIZE bytes
+// out, stopping at every block), checks the output against the raw image
+// and reports MB/s and the heap the decoder allocated at its peak.
+// Linked with --wrap=malloc/free so the count is measured, not assumed.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include <time.h>
+#include <vector>
+
+#include "lzss_decoder.h"
+
+#define READ_SIZE 512
+#define OUT_SIZE  4096
+#define ROUNDS    5
+
+extern "C" {
+void *__real_malloc(size_t n);
+void __real_free(void *p);
+
+static bool   tracking;
+static size_t heapNow, heapPeak;
+
+void *__wrap_malloc(size_t n) {
+  void *p = __real_malloc(n);
+  if (p && tracking) {
+    heapNow += malloc_usable_size(p);
+    if (heapNow > heapPeak) heapPeak = heapNow;
+  }
+  return p;
+}
+
+void __wrap_free(void *p) {
+  if (p && tracking) heapNow -= malloc_usable_size(p);
+  __real_free(p);
+}
+}
+
+static std::vector<uint8_t> readFile(const char *path) {
+  std::vector<uint8_t> data;
+  FILE *f = fopen(path, "rb");
+  if (!f) return data;
+  uint8_t buf[65536];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.insert(data.end(), buf, buf + n);
+  fclose(f);
+  return data;
+}
+
+static uint32_t le32(const uint8_t *p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static double nowSec() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Decode `packed` into `out`; false on a stream error or size mismatch
+static bool decodeImage(const std::vector<uint8_t> &packed, std::vector<uint8_t> &out) {
+  uint8_t wbits = packed[4], lbits = packed[5];
+  uint32_t size = le32(&packed[8]), block = le32(&packed[12]);
+
+  LzssDecoder d;
+  if (!lzssBegin(d, wbits, lbits, block)) return false;
+  uint8_t *outBuf = (uint8_t *)malloc(OUT_SIZE);
+  out.resize(size);
+
+  size_t src = 16;
+  uint32_t pos = 0;
+  uint8_t in[READ_SIZE];
+  size_t inPos = 0, inLen = 0;
+  bool ok = true;
+  while (pos < size && ok) {
+    if (inPos == inLen) {
+      inLen = packed.size() - src < READ_SIZE ? packed.size() - src : READ_SIZE;
+      if (inLen == 0) {
+        ok = false;
+        break;
+      }
+      memcpy(in, &packed[src], inLen);
+      src += inLen;
+      inPos = 0;
+    }
+    uint32_t blockEnd = (pos / block + 1) * block;
+    size_t outMax = (blockEnd < size ? blockEnd : size) - pos;
+    if (outMax > OUT_SIZE) outMax = OUT_SIZE;
+    size_t used;
+    size_t n = lzssDecode(d, in + inPos, inLen - inPos, used, outBuf, outMax);
+    inPos += used;
+    memcpy(&out[pos], outBuf, n);
+    pos += n;
+    ok = !d.error;
+  }
+  ok = ok && pos == size && src == packed.size() && inPos == inLen;
+
+  free(outBuf);
+  lzssEnd(d);
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 3 || argc % 2 == 0) {
+    fprintf(stderr, "usage: %s IMAGE.hs IMAGE.bin [...]\n", argv[0]);
+    return 2;
+  }
+
+  int fail = 0;
+  printf("%-28s %9s %9s %7s %9s %9s\n", "image", "raw", "packed", "ratio", "MB/s", "peak RAM");
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::vector<uint8_t> packed = readFile(argv[i]);
+    std::vector<uint8_t> raw = readFile(argv[i + 1]);
+    const char *name = strrchr(argv[i], '/') ? strrchr(argv[i], '/') + 1 : argv[i];
+    if (packed.size() < 16 || memcmp(packed.data(), "QHS1", 4) != 0) {
+      printf("%-28s not a QHS1 image\n", name);
+      fail = 1;
+      continue;
+    }
+
+    std::vector<uint8_t> out;
+    out.reserve(raw.size());
+    double best = 0;
+    bool ok = true;
+    for (int r = 0; r < ROUNDS && ok; r++) {
+      heapNow = heapPeak = 0;
+      tracking = true;
+      double t0 = nowSec();
+      ok = decodeImage(packed, out);
+      double dt = nowSec() - t0;
+      tracking = false;
+      if (dt > 0 && raw.size() / dt / 1e6 > best) best = raw.size() / dt / 1e6;
+    }
+    ok = ok && out == raw;
+
+    // Decoder state and the stack buffers are not on the heap
+    size_t ram = heapPeak + sizeof(LzssDecoder) + READ_SIZE;
+    printf("%-28s %9zu %9zu %6.1f%% %9.1f %9zu %s\n", name, raw.size(), packed.size(),
+           100.0 * packed.size() / raw.size(), best, ram, ok ? "OK" : "MISMATCH");
+    if (!ok) fail = 1;
+  }
+  return fail;
+}
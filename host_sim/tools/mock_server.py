@@ -0,0 +1,349 @@
+#!/usr/bin/env python3
+"""Local stand-in for the cloud services the firmware talks to.
+
+All hostnames resolve here in the simulator, so requests are routed by
+path: Identity Toolkit / Secure Token sign-in, Firestore listDocuments
+and batchGet for users/<uid>/quotes, and the OTA manifest and images
+under /ota and /bin (served from the repository).
+
+    python3 mock_server.py --port 8088 --quotes 230 [--chunked]
+
+Scripted mutations for sync tests (new/updated documents get the
+current time as updateTime; "advance" first moves the mock's clock,
+which also dates its responses, that many seconds ahead):
+
+    curl -X POST localhost:8088/mock/mutate \
+         -d '{"add": 2, "update": ["q00003"], "delete": ["q00007"]}'
+
+"add" is a count of generated IDs, or a list of the IDs to add.
+
+OTA tests: --ota-version overrides the manifest version (so the sim
+firmware sees an update), and --drop-after N cuts the first --drops
+firmware image responses after N body bytes, like a flaky link.
+--no-compressed leaves the compressed image out of the manifest and
+--corrupt-hs N flips byte N of compressed images.
+"""
+
+import argparse
+import hashlib
+import json
+import os
+import re
+import time
+from email.utils import formatdate, parsedate_to_datetime
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from urllib.parse import parse_qs, unquote, urlparse
+
+REPO = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", ".."))
+
+STATE = {
+    "quotes": [],
+    "chunked": False,
+    "uid": "simuser",
+    "requests": [],
+    "token_ttl": 3600,
+    "update_time": {},
+    "ota_version": None,
+    "drop_after": 0,
+    "drops_left": 0,
+    "no_compressed": False,
+    "corrupt_hs": -1,
+    "started": 0,
+    "clock_offset": 0,
+}
+
+IMAGE_SUFFIXES = (".bin", ".hs")
+
+
+def now():
+    return time.time() + STATE["clock_offset"]
+
+
+def make_quotes(n):
+    quotes = []
+    for i in range(n):
+        quotes.append({
+            "id": "q%05d" % i,
+            "text": "Quote number %d: the quick brown fox jumps over the lazy dog." % i,
+            "author": "Author %d" % (i % 17),
+            "tags": ["tag%d" % (i % 5), "set%d" % (i % 3)],
+            "updateTime": "2025-01-01T00:00:%02d.000000Z" % (i % 60),
+        })
+    return quotes
+
+
+def doc_json(q, uid, mask=None):
+    name = "projects/sim-project/databases/(default)/documents/users/%s/quotes/%s" % (uid, q["id"])
+    fields = {
+        "text": {"stringValue": q["text"]},
+        "author": {"stringValue": q["author"]},
+        "tagNames": {"arrayValue": {"values": [{"stringValue": t} for t in q["tags"]]}},
+        "createdAt": {"timestampValue": "2024-06-01T12:00:00Z"},
+    }
+    if mask is not None:
+        fields = {k: v for k, v in fields.items() if k in mask}
+    return {
+        "name": name,
+        "fields": fields,
+        "createTime": "2024-06-01T12:00:00.000000Z",
+        "updateTime": q["updateTime"],
+    }
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    def date_time_string(self, timestamp=None):
+        return formatdate(now() if timestamp is None else timestamp, usegmt=True)
+
+    def log_message(self, fmt, *args):
+        STATE["requests"].append(self.command + " " + self.path)
+        if os.environ.get("MOCK_VERBOSE"):
+            super().log_message(fmt, *args)
+
+    # --- helpers -----------------------------------------------------
+
+    def send_body(self, code, body, ctype="application/json", headers=None):
+        if isinstance(body, str):
+            body = body.encode()
+        self.send_response(code)
+        self.send_header("Content-Type", ctype)
+        for k, v in (headers or {}).items():
+            self.send_header(k, v)
+        if STATE["chunked"] and ctype == "application/json" and code == 200:
+            self.send_header("Transfer-Encoding", "chunked")
+            self.end_headers()
+            step = 1000
+            for i in range(0, len(body), step):
+                part = body[i:i + step]
+                self.wfile.write(b"%x\r\n" % len(part) + part + b"\r\n")
+            self.wfile.write(b"0\r\n\r\n")
+        else:
+            self.send_header("Content-Length", str(len(body)))
+            self.end_headers()
+            if self.command != "HEAD":
+                self.wfile.write(body)
+
+    def read_body(self):
+        n = int(self.headers.get("Content-Length") or 0)
+        return self.rfile.read(n) if n else b""
+
+    def authorized(self):
+        auth = self.headers.get("Authorization", "")
+        return auth.startswith("Bearer sim-id-token")
+
+    # --- routes ------------------------------------------------------
+
+    def do_POST(self):
+        url = urlparse(self.path)
+        body = self.read_body()
+        if url.path.endswith("accounts:signInWithPassword"):
+            return self.sign_in()
+        if url.path == "/v1/token":
+            return self.sign_in(refresh=True)
+        if url.path.endswith("documents:batchGet"):
+            return self.batch_get(json.loads(body or b"{}"))
+        if url.path == "/mock/mutate":
+            return self.mutate(json.loads(body or b"{}"))
+        if url.path.startswith("/metrics"):
+            return self.send_body(204, b"")
+        self.send_body(404, '{"error":"not found"}')
+
+    def do_PATCH(self):
+        url = urlparse(self.path)
+        body = json.loads(self.read_body() or b"{}")
+        if "/devices/" in url.path:
+            if not self.authorized():
+                return self.send_body(401, '{"error":{"code":401}}')
+            STATE.setdefault("devices", {})[url.path.rsplit("/", 1)[1]] = body
+            if os.environ.get("MOCK_VERBOSE"):
+                print("device update:", json.dumps(body)[:300], flush=True)
+            return self.send_body(200, json.dumps(body))
+        self.send_body(404, '{"error":"not found"}')
+
+    def do_HEAD(self):
+        self.do_GET()
+
+    def do_GET(self):
+        url = urlparse(self.path)
+        if "/documents/users/" in url.path and url.path.endswith("/quotes"):
+            return self.list_documents(url)
+        if url.path.startswith("/ota/") or url.path.startswith("/bin/") or "/main/" in url.path:
+            return self.static_file(url.path)
+        self.send_body(404, '{"error":"not found"}')
+
+    def sign_in(self, refresh=False):
+        resp = {
+            "idToken" if not refresh else "id_token": "sim-id-token-%d" % int(time.time()),
+            "refreshToken" if not refresh else "refresh_token": "sim-refresh-token",
+            "localId" if not refresh else "user_id": STATE["uid"],
+            "expiresIn" if not refresh else "expires_in": str(STATE["token_ttl"]),
+        }
+        self.send_body(200, json.dumps(resp))
+
+    def list_documents(self, url):
+        if not self.authorized():
+            return self.send_body(401, '{"error":{"code":401}}')
+        qs = parse_qs(url.query)
+        size = int(qs.get("pageSize", ["20"])[0])
+        token = qs.get("pageToken", [""])[0]
+        start = int(token[4:]) if token.startswith("tok-") else 0
+        mask = qs.get("mask.fieldPaths")
+        page = STATE["quotes"][start:start + size]
+        resp = {}
+        if page:
+            resp["documents"] = [doc_json(q, STATE["uid"], mask) for q in page]
+        if start + size < len(STATE["quotes"]):
+            resp["nextPageToken"] = "tok-%d" % (start + size)
+        # bench.sh --check follows the pages a sync fetched
+        print("list start=%d docs=%d next=%s" % (start, len(page), resp.get("nextPageToken", "")),
+              flush=True)
+        self.send_body(200, json.dumps(resp, indent=2))
+
+    def batch_get(self, req):
+        if not self.authorized():
+            return self.send_body(401, '{"error":{"code":401}}')
+        mask = req.get("mask", {}).get("fieldPaths")
+        by_name = {doc_json(q, STATE["uid"])["name"]: q for q in STATE["quotes"]}
+        out = []
+        for name in req.get("documents", []):
+            q = by_name.get(name)
+            if q:
+                out.append({"found": doc_json(q, STATE["uid"], mask), "readTime": "2025-01-01T00:00:00Z"})
+            else:
+                out.append({"missing": name, "readTime": "2025-01-01T00:00:00Z"})
+        self.send_body(200, json.dumps(out, indent=2))
+
+    def mutate(self, req):
+        STATE["clock_offset"] += req.get("advance", 0)
+        t = now()
+        stamp = time.strftime("%Y-%m-%dT%H:%M:%S", time.gmtime(t)) + ".%06dZ" % (t % 1 * 1e6)
+        quotes = STATE["quotes"]
+        for qid in req.get("update", []):
+            for q in quotes:
+                if q["id"] == qid:
+                    q["text"] = q["text"] + " (edited)"
+                    q["updateTime"] = stamp
+        drop = set(req.get("delete", []))
+        quotes[:] = [q for q in quotes if q["id"] not in drop]
+        add = req.get("add", 0)
+        for qid in add if isinstance(add, list) else [None] * add:
+            STATE["next_id"] = STATE.get("next_id", len(quotes) + len(drop)) + 1
+            quotes.append({
+                "id": qid or "n%05d" % STATE["next_id"],
+                "text": "New quote %d." % STATE["next_id"],
+                "author": "Someone",
+                "tags": ["new"],
+                "updateTime": stamp,
+            })
+        self.send_body(200, json.dumps({"quotes": len(quotes)}))
+
+    def static_file(self, path):
+        # raw.githubusercontent.com/<owner>/<repo>/main/<path> maps to the repo
+        m = re.search(r"/main/(.*)$", path)
+        rel = m.group(1) if m else path.lstrip("/")
+        full = os.path.normpath(os.path.join(REPO, unquote(rel)))
+        if not full.startswith(REPO) or not os.path.isfile(full):
+            return self.send_body(404, "not found", "text/plain")
+        with open(full, "rb") as f:
+            data = f.read()
+        if full.endswith("firmware.json") and (STATE["ota_version"] or STATE["no_compressed"]):
+            manifest = json.loads(data)
+            if STATE["ota_version"]:
+                manifest["version"] = STATE["ota_version"]
+            if STATE["no_compressed"]:
+                manifest.pop("compressed", None)
+            data = json.dumps(manifest, indent=2).encode()
+        if full.endswith(".hs") and 0 <= STATE["corrupt_hs"] < len(data):
+            data = bytearray(data)
+            data[STATE["corrupt_hs"]] ^= 0xFF
+            data = bytes(data)
+        etag = '"%s"' % hashlib.sha1(data).hexdigest()[:16]
+        mtime = int(os.path.getmtime(full))
+        if full.endswith("firmware.json") and STATE["ota_version"]:
+            mtime = max(mtime, STATE["started"])   # rewritten at startup
+        last_modified = formatdate(mtime, usegmt=True)
+        # If-None-Match wins over If-Modified-Since (RFC 9110)
+        inm = self.headers.get("If-None-Match")
+        ims = self.headers.get("If-Modified-Since")
+        if inm is not None:
+            not_modified = inm == etag
+        elif ims is not None:
+            try:
+                not_modified = mtime <= parsedate_to_datetime(ims).timestamp()
+            except (TypeError, ValueError):
+                not_modified = False
+        else:
+            not_modified = False
+        if not_modified:
+            self.send_response(304)
+            self.send_header("ETag", etag)
+            self.send_header("Last-Modified", last_modified)
+            self.send_header("Content-Length", "0")
+            self.end_headers()
+            return
+        rng = self.headers.get("Range")
+        ctype = "application/json" if full.endswith(".json") else "application/octet-stream"
+        if rng and rng.startswith("bytes="):
+            a, _, b = rng[6:].partition("-")
+            a = int(a)
+            b = int(b) if b else len(data) - 1
+            part = data[a:b + 1]
+            self.send_response(206)
+            self.send_header("Content-Type", ctype)
+            self.send_header("Content-Range", "bytes %d-%d/%d" % (a, a + len(part) - 1, len(data)))
+            self.send_header("Content-Length", str(len(part)))
+            self.send_header("ETag", etag)
+            self.end_headers()
+            if self.command != "HEAD":
+                self.write_image(full, part)
+            return
+        if full.endswith(IMAGE_SUFFIXES) and self.command != "HEAD":
+            self.send_response(200)
+            self.send_header("Content-Type", ctype)
+            self.send_header("Content-Length", str(len(data)))
+            self.send_header("ETag", etag)
+            self.end_headers()
+            return self.write_image(full, data)
+        self.send_body(200, data, ctype, {"ETag": etag, "Last-Modified": last_modified})
+
+    def write_image(self, full, body):
+        # Injected disconnect: headers promise the whole body, then the
+        # socket closes part way through
+        if full.endswith(IMAGE_SUFFIXES) and STATE["drops_left"] > 0 and STATE["drop_after"] < len(body):
+            STATE["drops_left"] -= 1
+            self.wfile.write(body[:STATE["drop_after"]])
+            self.wfile.flush()
+            self.close_connection = True
+            return
+        self.wfile.write(body)
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--port", type=int, default=8088)
+    ap.add_argument("--quotes", type=int, default=120)
+    ap.add_argument("--chunked", action="store_true")
+    ap.add_argument("--ota-version")
+    ap.add_argument("--drop-after", type=int, default=0)
+    ap.add_argument("--drops", type=int, default=3)
+    ap.add_argument("--no-compressed", action="store_true")
+    ap.add_argument("--corrupt-hs", type=int, default=-1)
+    args = ap.parse_args()
+
+    STATE["ota_version"] = args.ota_version
+    STATE["started"] = int(time.time())
+    STATE["drop_after"] = args.drop_after
+    STATE["drops_left"] = args.drops if args.drop_after > 0 else 0
+    STATE["no_compressed"] = args.no_compressed
+    STATE["corrupt_hs"] = args.corrupt_hs
+
+    STATE["quotes"] = make_quotes(args.quotes)
+    STATE["chunked"] = args.chunked
+    srv = ThreadingHTTPServer(("127.0.0.1", args.port), Handler)
+    print("mock server on 127.0.0.1:%d with %d quotes" % (args.port, args.quotes), flush=True)
+    srv.serve_forever()
+
+
+if __name__ == "__main__":
+    main()
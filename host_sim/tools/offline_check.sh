@@ -0,0 +1,93 @@
+#!/bin/sh
+# offline_check.sh - a provisioned device with its Wi-Fi out of reach.
+# quote_sim_short (sync every 90 min) runs in run/offline/ against the
+# mock server; SIM_WIFI_DOWN takes the AP away for some boots. Logs go
+# to run/offline_<step>.log.
+#
+#   wakes   provisioning, a cold boot, then timer wakes with the AP
+#           down for the first sync wake and its retry: each of them
+#           shows a cached quote, retries the sync (and the OTA check
+#           that rides with it) at the next quote interval and sleeps;
+#           the next wake with the AP back syncs
+#   cold    powered on again with the AP down: a cached quote and
+#           sleep, as on a timer wake
+#
+# Neither may start the provisioning portal again.
+
+set -u
+cd "$(dirname "$0")/.."
+
+PORT=${PORT:-18091}
+
+[ -x ./quote_sim_short ] || { echo "offline_check: build ./quote_sim_short first (make check-offline)"; exit 2; }
+
+rm -rf run/offline run/offline_*.log
+mkdir -p run/offline
+
+python3 tools/mock_server.py --port "$PORT" --quotes 20 > run/offline_mock.log 2>&1 &
+MOCK=$!
+trap 'kill $MOCK 2>/dev/null' EXIT INT TERM
+
+i=0
+until python3 -c "import socket; socket.create_connection(('127.0.0.1', $PORT), 1)" 2>/dev/null; do
+  i=$((i + 1))
+  if [ $i -ge 50 ]; then
+    echo "offline_check: mock server did not start"; cat run/offline_mock.log; exit 2
+  fi
+  sleep 0.1
+done
+
+# power_on NAME BOOTS DOWN
+power_on() {
+  (
+    cd run/offline &&
+    SIM_HTTP_PORT=$PORT SIM_WIFI_DOWN=$3 \
+    SIM_WIFI_SSID=home SIM_PROV_SSID=home SIM_PROV_PASS=pw \
+    SIM_NVS_FILE=nvs.bin SIM_RTC_FILE=rtc.bin SIM_FS_DIR=fs \
+    SIM_OTA_FILE=ota.bin SIM_RUNNING_IMAGE=running.bin SIM_MAX_BOOTS=$2 \
+    ../../quote_sim_short
+  ) > "run/offline_$1.log" 2>&1 || { echo "offline_check: $1: simulator exited with $?"; fail=1; }
+
+  echo "== $1"
+  grep -E '^\[SCHED\] Wake|^\[WIFI\] (Connected|Failed)|^\[QUOTE\] (Synced|Delta|Cache up to date)|^\[PROVISIONING\] Starting' "run/offline_$1.log"
+}
+
+expect() {
+  grep -qF "$2" "run/offline_$1.log" || { echo "offline_check: $1: missing \"$2\""; fail=1; }
+}
+
+# expect_count NAME COUNT TEXT
+expect_count() {
+  n=$(grep -cF "$3" "run/offline_$1.log")
+  [ "$n" -eq "$2" ] || { echo "offline_check: $1: \"$3\" $n times, expected $2"; fail=1; }
+}
+
+fail=0
+
+# Boots: provisioning, cold boot, wakes #1-#6 (sync due on #3; the AP
+# is down on boots 5 and 6, wakes #3 and #4)
+power_on wakes 8 5-6
+expect_count wakes 1 '[PROVISIONING] Starting AP mode'
+expect_count wakes 2 '[WIFI] Failed after'
+expect_count wakes 7 '[QUOTE] Selected quote:'
+expect_count wakes 0 '[DISPLAY] Error'
+expect wakes '[SCHED] Wake #3 (timer), jobs due: quote sync'
+expect wakes '[SCHED] Wake #4 (timer), jobs due: quote ota sync'
+expect wakes '[SCHED] Wake #5 (timer), jobs due: quote ota sync'
+expect wakes '[QUOTE] Cache up to date'
+expect wakes '[SIM] Deep sleep requested, boot limit reached.'
+
+# The third sync wake is the first with the AP back
+awk '/^\[SCHED\] Wake #/ { wake = $3 }
+     /^\[WIFI\] Failed/ && wake != "#3" && wake != "#4" { print "offline_check: wakes: Wi-Fi failed on wake " wake; bad = 1 }
+     /^\[QUOTE\] Cache up to date/ && wake != "#5" { print "offline_check: wakes: synced on wake " wake; bad = 1 }
+     END { exit bad }' run/offline_wakes.log || fail=1
+
+power_on cold 1 1
+expect_count cold 0 '[PROVISIONING] Starting AP mode'
+expect cold '[WIFI] Failed after'
+expect cold '[QUOTE] Selected quote:'
+expect cold '[SIM] Deep sleep requested, boot limit reached.'
+
+[ $fail -eq 0 ] && echo "offline_check: OK"
+exit $fail
@@ -0,0 +1,153 @@
+#!/bin/sh
+# ota_check.sh - OTA scenarios against the mock server. Logs go to
+# run/ota_<scenario>.log.
+#
+#   resume    the mock advertises a newer version and cuts the image
+#             response after DROP_AFTER bytes for the first DROPS
+#             requests; the compressed download must resume with Range
+#             requests (within a wake and on the next wake) and decode
+#             to the newest image byte for byte
+#   raw       same with no compressed image in the manifest
+#   packed-corrupt  a compressed image with a flipped byte must be
+#             dropped for the raw image in the same check
+#   delta     quote_sim_base runs bin/ image BASE_VERSION and must
+#             rebuild the newest image byte for byte from its patch
+#   fallback  same with a corrupted running image: the delta must be
+#             refused and the full image downloaded instead
+#   manifest  power on three times against an unchanged, unchanged and
+#             then edited manifest: 200, 304, 200
+#   ride      quote_sim_short over a few wakes: the OTA check only runs
+#             on wakes that sync anyway. Powered on with the clock at
+#             the epoch, like the board: later sync wakes must still
+#             reuse the DHCP lease of the cold boot
+
+set -u
+cd "$(dirname "$0")/.."
+
+PORT=${PORT:-18089}
+DROP_AFTER=${DROP_AFTER:-200000}
+DROPS=${DROPS:-5}
+BASE_VERSION=${BASE_VERSION:-1.0.5}
+
+[ -x ./quote_sim ] && [ -x ./quote_sim_base ] && [ -x ./quote_sim_short ] ||
+  { echo "ota_check: build the simulators first (make check-ota)"; exit 2; }
+
+BASE_BIN=../bin/quote_eink_app_$(echo "$BASE_VERSION" | tr . _).bin
+NEW_BIN=$(ls ../bin/quote_eink_app_*.bin | sort -V | tail -n 1)
+MOCK=
+
+stop_mock() {
+  [ -n "$MOCK" ] && kill "$MOCK" 2>/dev/null
+  MOCK=
+}
+trap stop_mock EXIT INT TERM
+
+# run_scenario NAME SIM BOOTS RUNNING_IMAGE MOCK_ARGS...
+# With DIR set, runs in that directory and keeps what an earlier run
+# left there (NVS, filesystem), like powering the same device on again.
+run_scenario() {
+  name=$1 sim=$2 boots=$3 running=$4
+  shift 4
+  dir=${DIR:-run/ota_$name}
+  [ -n "${DIR:-}" ] || rm -rf "$dir"
+  mkdir -p "$dir"
+  [ -n "$running" ] && cp "$running" "$dir/running.bin"
+
+  python3 tools/mock_server.py --port "$PORT" --quotes 20 "$@" > "$dir/mock.log" 2>&1 &
+  MOCK=$!
+  i=0
+  until python3 -c "import socket; socket.create_connection(('127.0.0.1', $PORT), 1)" 2>/dev/null; do
+    i=$((i + 1))
+    if [ $i -ge 50 ]; then
+      echo "ota_check: mock server did not start"; cat "$dir/mock.log"; exit 2
+    fi
+    sleep 0.1
+  done
+
+  (
+    cd "$dir" &&
+    SIM_HTTP_PORT=$PORT \
+    SIM_WIFI_SSID=home SIM_PROV_SSID=home SIM_PROV_PASS=pw \
+    SIM_NVS_FILE=nvs.bin SIM_RTC_FILE=rtc.bin SIM_FS_DIR=fs \
+    SIM_OTA_FILE=ota.bin SIM_RUNNING_IMAGE=running.bin SIM_MAX_BOOTS=$boots \
+    "../../$sim"
+  ) > "run/ota_$name.log" 2>&1
+  stop_mock
+
+  echo "== $name"
+  grep -E '^\[OTA\] ([0-9]|Connection|Retry|Resuming|Giving|Downloaded|Patched|Delta|Running|SHA|Corrupt|Compressed|Manifest|Firmware)' "run/ota_$name.log"
+}
+
+expect() {
+  grep -qF "$2" "run/ota_$1.log" || { echo "ota_check: $1: missing \"$2\""; fail=1; }
+}
+
+fail=0
+
+# Boots: provisioning, cold boot (gives up part way), timer wake (resumes)
+run_scenario resume quote_sim 3 "" --ota-version 99.0.0 \
+  --drop-after "$DROP_AFTER" --drops "$DROPS"
+expect resume '[OTA] Retry 1/'
+expect resume '[OTA] Resuming at'
+expect resume '[OTA] SHA-256 verified.'
+expect resume '[SIM] Boot partition set to'
+expect resume '[OTA] Downloading compressed image'
+cmp -s "$NEW_BIN" run/ota_resume/ota.bin || { echo "ota_check: resume: image differs from $NEW_BIN"; fail=1; }
+
+run_scenario raw quote_sim 3 "" --ota-version 99.0.0 --no-compressed \
+  --drop-after "$DROP_AFTER" --drops "$DROPS"
+expect raw '[OTA] Retry 1/'
+expect raw '[OTA] Resuming at'
+expect raw '[OTA] SHA-256 verified.'
+cmp -s "$NEW_BIN" run/ota_raw/ota.bin || { echo "ota_check: raw: image differs from $NEW_BIN"; fail=1; }
+
+# Boots: provisioning, cold boot (falls back and restarts)
+run_scenario packed-corrupt quote_sim 2 "" --ota-version 99.0.0 --corrupt-hs 300000
+expect packed-corrupt '[OTA] Compressed update failed'
+expect packed-corrupt '[OTA] SHA-256 verified.'
+cmp -s "$NEW_BIN" run/ota_packed-corrupt/ota.bin || { echo "ota_check: packed-corrupt: image differs from $NEW_BIN"; fail=1; }
+
+# Boots: provisioning, cold boot (patches and restarts)
+run_scenario delta quote_sim_base 2 "$BASE_BIN"
+expect delta '[OTA] Patched'
+expect delta '[OTA] SHA-256 verified.'
+cmp -s "$NEW_BIN" run/ota_delta/ota.bin || { echo "ota_check: delta: image differs from $NEW_BIN"; fail=1; }
+
+# Same base with one byte flipped
+python3 -c "
+import sys
+d = bytearray(open(sys.argv[1], 'rb').read()); d[4096] ^= 0xFF
+open(sys.argv[2], 'wb').write(d)" "$BASE_BIN" run/corrupt_base.bin
+run_scenario fallback quote_sim_base 2 run/corrupt_base.bin
+expect fallback '[OTA] Running image is not the patch base.'
+expect fallback '[OTA] Downloaded'
+expect fallback '[OTA] SHA-256 verified.'
+cmp -s "$NEW_BIN" run/ota_fallback/ota.bin || { echo "ota_check: fallback: image differs from $NEW_BIN"; fail=1; }
+
+# Boots: provisioning, cold boot. Then two more power-ons, the last
+# one after the manifest changed (an older version: still no update).
+rm -rf run/ota_manifest
+DIR=run/ota_manifest
+run_scenario manifest1 quote_sim 2 ""
+run_scenario manifest2 quote_sim 1 ""
+run_scenario manifest3 quote_sim 1 "" --ota-version 1.0.5
+DIR=
+expect manifest1 '[OTA] Firmware up to date.'
+expect manifest2 '[OTA] Manifest not modified'
+expect manifest3 '[OTA] Firmware up to date.'
+grep -qF '[OTA] Meta JSON:' run/ota_manifest2.log &&
+  { echo "ota_check: manifest2: manifest fetched again"; fail=1; }
+
+# Boots: provisioning, cold boot, then timer wakes every 30 min with a
+# sync every 90 min and the OTA check due after 2 h
+SIM_EPOCH_US=0 run_scenario ride quote_sim_short 9 ""
+grep -E '^\[SCHED\] Wake' run/ota_ride.log
+[ "$(grep -cE '^\[SCHED\] Wake .*ota' run/ota_ride.log)" -ge 2 ] ||
+  { echo "ota_check: ride: OTA check did not run again"; fail=1; }
+grep -E '^\[SCHED\] Wake .*ota' run/ota_ride.log | grep -qv sync &&
+  { echo "ota_check: ride: OTA check woke without a sync"; fail=1; }
+expect ride '[OTA] Manifest not modified'
+expect ride ', cached lease'
+
+[ $fail -eq 0 ] && echo "ota_check: OK"
+exit $fail
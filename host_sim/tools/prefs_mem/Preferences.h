@@ -0,0 +1,93 @@
+// Preferences.h - in-memory Preferences for config_check
+//
+// Same calls as the ESP32 library (the ones app_prefs.cpp uses), over
+// a map the check can seed, inspect and make fail. Like NVS, opening a
+// namespace read-only fails until something was written to it, and a
+// write of identical bytes is skipped.
+#pragma once
+
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace memprefs {
+typedef std::map<std::string, std::vector<uint8_t>> Namespace;
+
+inline std::map<std::string, Namespace> store;
+inline uint32_t opens      = 0;
+inline uint32_t writes     = 0;   // entries written or removed
+inline bool     failWrites = false;
+
+inline void reset() {
+  store.clear();
+  opens = writes = 0;
+  failWrites = false;
+}
+}  // namespace memprefs
+
+class Preferences {
+public:
+  bool begin(const char *name, bool readOnly = false, const char *partition = nullptr) {
+    (void)partition;
+    if (_ns || (readOnly && !memprefs::store.count(name))) return false;
+    _ns = &memprefs::store[name];
+    _readOnly = readOnly;
+    memprefs::opens++;
+    return true;
+  }
+  void end() { _ns = nullptr; }
+
+  bool isKey(const char *key) { return _ns && _ns->count(key); }
+
+  bool remove(const char *key) {
+    if (!writable() || !_ns->erase(key)) return false;
+    memprefs::writes++;
+    return true;
+  }
+
+  size_t putBytes(const char *key, const void *value, size_t len) {
+    if (!writable() || strlen(key) > 15) return 0;
+    const uint8_t *p = (const uint8_t *)value;
+    std::vector<uint8_t> v(p, p + len);
+    auto it = _ns->find(key);
+    if (it == _ns->end() || it->second != v) {
+      (*_ns)[key] = v;
+      memprefs::writes++;
+    }
+    return len;
+  }
+  size_t putString(const char *key, const String &value) {
+    return putBytes(key, value.c_str(), value.length() + 1);
+  }
+
+  size_t getBytesLength(const char *key) {
+    auto it = find(key);
+    return it ? it->size() : 0;
+  }
+  size_t getBytes(const char *key, void *buf, size_t maxLen) {
+    auto it = find(key);
+    if (!it || it->size() > maxLen) return 0;
+    memcpy(buf, it->data(), it->size());
+    return it->size();
+  }
+  String getString(const char *key, const String &defaultValue = String()) {
+    auto it = find(key);
+    if (!it || it->empty()) return defaultValue;
+    return String((const char *)it->data());
+  }
+
+private:
+  bool writable() {
+    if (!_ns || _readOnly) return false;
+    return !memprefs::failWrites;
+  }
+  const std::vector<uint8_t> *find(const char *key) {
+    if (!_ns) return nullptr;
+    auto it = _ns->find(key);
+    return it == _ns->end() ? nullptr : &it->second;
+  }
+
+  memprefs::Namespace *_ns = nullptr;
+  bool _readOnly = false;
+};
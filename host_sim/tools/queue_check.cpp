@@ -0,0 +1,159 @@
+// queue_check.cpp - quote_queue.cpp against a fake clock
+//
+//   queue_check
+//
+// Fills and drains queues the way quote_rotation.cpp does, with a
+// seeded random source and a clock that only moves when told to, and
+// checks the picks (distinct, in range, uniformly spread and ordered)
+// and when the queue asks for a sync. Exits non-zero on a failure.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "quote_queue.h"
+
+static uint32_t rngState = 12345;
+static int failures = 0;
+
+// xorshift32, reduced to [0, bound)
+static uint32_t testRandom(uint32_t bound) {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return (uint32_t)(((uint64_t)rngState * bound) >> 32);
+}
+
+#define CHECK(cond, ...)                          \
+  do {                                            \
+    if (!(cond)) {                                \
+      printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__);                        \
+      printf("\n");                               \
+      failures++;                                 \
+    }                                             \
+  } while (0)
+
+static const uint64_t HOUR = 3600000ULL;
+
+// Fill, then take everything: distinct, in range, then drained
+static void checkDrain(uint32_t cacheCount, uint16_t k) {
+  QuoteQueue q;
+  queueClear(q);
+  queueFill(q, cacheCount, k, testRandom, 0);
+
+  uint16_t want = k;
+  if (want > QUOTE_QUEUE_MAX) want = QUOTE_QUEUE_MAX;
+  if (want > cacheCount) want = cacheCount;
+  CHECK(q.size == want, "fill %u of %u: size %u", k, cacheCount, q.size);
+  CHECK(queueLeft(q) == want, "fill %u of %u: left %u", k, cacheCount, queueLeft(q));
+
+  static uint8_t seen[1024];
+  memset(seen, 0, sizeof(seen));
+  uint32_t pos;
+  for (uint16_t i = 0; i < want; i++) {
+    uint32_t peeked = 0xFFFFFFFFUL;
+    CHECK(!queueWantsSync(q, 0, HOUR), "fill %u of %u: sync wanted at %u", k, cacheCount, i);
+    CHECK(queuePeek(q, cacheCount, peeked), "fill %u of %u: peek %u failed", k, cacheCount, i);
+    CHECK(queueTake(q, cacheCount, pos), "fill %u of %u: take %u failed", k, cacheCount, i);
+    CHECK(pos == peeked, "fill %u of %u: peeked %u, took %u", k, cacheCount, peeked, pos);
+    CHECK(pos < cacheCount, "fill %u of %u: position %u out of range", k, cacheCount, pos);
+    CHECK(pos >= sizeof(seen) || !seen[pos], "fill %u of %u: %u picked twice", k, cacheCount, pos);
+    if (pos < sizeof(seen)) seen[pos] = 1;
+  }
+  CHECK(!queueTake(q, cacheCount, pos), "fill %u of %u: take after drain", k, cacheCount);
+  CHECK(!queuePeek(q, cacheCount, pos), "fill %u of %u: peek after drain", k, cacheCount);
+  CHECK(queueWantsSync(q, 0, HOUR), "fill %u of %u: drained but no sync wanted", k, cacheCount);
+}
+
+// A queue that is not drained asks for a sync once it is old
+static void checkAge() {
+  QuoteQueue q;
+  queueClear(q);
+  uint64_t now = 10 * HOUR;
+  queueFill(q, 230, 12, testRandom, now);
+
+  uint32_t pos;
+  for (int wake = 0; wake < 6; wake++) {
+    CHECK(!queueWantsSync(q, now, 6 * HOUR), "sync wanted at %llu ms",
+          (unsigned long long)now);
+    CHECK(queueTake(q, 230, pos), "take at wake %d", wake);
+    now += HOUR / 2;
+  }
+  now = 10 * HOUR + 6 * HOUR - 1;
+  CHECK(!queueWantsSync(q, now, 6 * HOUR), "sync wanted 1 ms early");
+  now += 1;
+  CHECK(queueWantsSync(q, now, 6 * HOUR), "no sync at max age");
+  CHECK(queueLeft(q) == 6, "left %u after 6 takes", queueLeft(q));
+}
+
+// Picks made for one cache size are not used for another
+static void checkCacheChange() {
+  QuoteQueue q;
+  queueClear(q);
+  queueFill(q, 100, 5, testRandom, 0);
+  uint32_t pos;
+  CHECK(!queueTake(q, 99, pos), "take after the cache shrank");
+  CHECK(queueTake(q, 100, pos), "take with the same cache");
+
+  queueClear(q);
+  CHECK(!queueTake(q, 100, pos), "take from a cleared queue");
+  CHECK(queueWantsSync(q, 0, HOUR), "cleared queue wants no sync");
+
+  queueFill(q, 0, 12, testRandom, 0);
+  CHECK(q.size == 0 && !queueTake(q, 0, pos), "fill from an empty cache");
+}
+
+// The last quote shown is never the first of the next fill
+static void checkNoRepeat() {
+  QuoteQueue q;
+  queueClear(q);
+  uint32_t last = 0xFFFFFFFFUL;
+  for (int round = 0; round < 2000; round++) {
+    queueFill(q, 3, 2, testRandom, 0);
+    uint32_t first, second;
+    CHECK(queueTake(q, 3, first), "take first");
+    CHECK(first != last, "round %d repeats %u", round, first);
+    CHECK(queueTake(q, 3, second), "take second");
+    last = second;
+  }
+}
+
+// Every position is equally likely to be picked, and to come first
+static void checkUniform() {
+  const uint32_t n = 10;
+  const int rounds = 50000;
+  uint32_t picked[n] = {0};
+  uint32_t first[n] = {0};
+  QuoteQueue q;
+  for (int round = 0; round < rounds; round++) {
+    queueClear(q);
+    queueFill(q, n, 3, testRandom, 0);
+    for (uint16_t i = 0; i < q.size; i++) picked[q.pick[i]]++;
+    first[q.pick[0]]++;
+  }
+  for (uint32_t i = 0; i < n; i++) {
+    double p = (double)picked[i] / rounds;   // expect 0.3
+    double f = (double)first[i] / rounds;    // expect 0.1
+    CHECK(p > 0.28 && p < 0.32, "position %u picked with p=%.3f", i, p);
+    CHECK(f > 0.09 && f < 0.11, "position %u first with p=%.3f", i, f);
+  }
+}
+
+int main() {
+  checkDrain(230, 12);
+  checkDrain(5, 12);      // fewer quotes than the queue
+  checkDrain(1, 12);
+  checkDrain(1000, 100);  // clipped to QUOTE_QUEUE_MAX
+  checkAge();
+  checkCacheChange();
+  checkNoRepeat();
+  checkUniform();
+
+  if (failures) {
+    printf("queue_check: %d failures\n", failures);
+    return 1;
+  }
+  printf("queue_check: OK\n");
+  return 0;
+}
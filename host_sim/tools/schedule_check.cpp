@@ -0,0 +1,276 @@
+// schedule_check.cpp - job_schedule.cpp against a fake clock
+//
+//   schedule_check
+//
+// Runs the wake/sleep loop of scheduler.cpp on a clock that only moves
+// when told to, with the firmware's slack, coalescing and minimum sleep,
+// and checks which jobs run on each wake and how long the device sleeps:
+// jobs coming due (early timer wakes included), coalescing, a retry
+// waking the device by itself, the OTA check riding on sync wakes
+// (also on a sync the app adds to a wake) without ever arming the
+// timer, and the clock jumping forwards and backwards between wakes.
+// Exits non-zero on a failure.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "job_schedule.h"
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                          \
+  do {                                            \
+    if (!(cond)) {                                \
+      printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__);                        \
+      printf("\n");                               \
+      failures++;                                 \
+    }                                             \
+  } while (0)
+
+static const uint64_t SEC  = 1000ULL;
+static const uint64_t MIN  = 60 * SEC;
+static const uint64_t HOUR = 60 * MIN;
+
+// As in scheduler.cpp
+static const uint64_t SLACK_MS    = 30 * SEC;
+static const uint64_t COALESCE_MS = 10 * MIN;
+static const uint64_t MIN_SLEEP   = 5 * SEC;
+
+static const uint32_t QUOTE = 1UL << JOB_QUOTE;
+static const uint32_t OTA   = 1UL << JOB_OTA_CHECK;
+static const uint32_t SYNC  = 1UL << JOB_SYNC;
+
+// The firmware's schedule: OTA checks ride on sync wakes
+static void init(JobSchedule &s, uint64_t quoteMs, uint64_t otaMs, uint64_t syncMs) {
+  const uint64_t intervals[JOB_COUNT] = {quoteMs, otaMs, syncMs};
+  scheduleInit(s, intervals);
+  scheduleRideWith(s, JOB_OTA_CHECK, JOB_SYNC);
+}
+
+static uint32_t jobsAt(const JobSchedule &s, uint64_t nowMs) {
+  return scheduleJobsToRun(s, nowMs, SLACK_MS, COALESCE_MS);
+}
+
+// Every job in `run` finished
+static void markRun(JobSchedule &s, uint32_t run, uint64_t nowMs) {
+  for (int i = 0; i < JOB_COUNT; i++) {
+    if (run & (1UL << i)) scheduleMarkRun(s, (SchedJob)i, nowMs);
+  }
+}
+
+static void checkColdBoot() {
+  JobSchedule s;
+  init(s, HOUR, 24 * HOUR, 6 * HOUR);
+  CHECK(jobsAt(s, 0) == (QUOTE | OTA | SYNC), "cold boot: ran %#x", jobsAt(s, 0));
+  markRun(s, QUOTE | OTA | SYNC, 0);
+  CHECK(scheduleSleepMs(s, 0, MIN_SLEEP) == HOUR, "cold boot: slept %llu",
+        (unsigned long long)scheduleSleepMs(s, 0, MIN_SLEEP));
+  CHECK(jobsAt(s, 1) == 0, "cold boot: ran %#x again", jobsAt(s, 1));
+}
+
+// A job runs once it is due, or within the slack of it (the RTC timer
+// fires early), and not before
+static void checkComingDue() {
+  JobSchedule s;
+  init(s, HOUR, 24 * HOUR, 6 * HOUR);
+  markRun(s, QUOTE | OTA | SYNC, 0);
+
+  CHECK(jobsAt(s, HOUR - SLACK_MS - 1) == 0, "due: ran %#x before the slack",
+        jobsAt(s, HOUR - SLACK_MS - 1));
+  CHECK(jobsAt(s, HOUR - SLACK_MS) == QUOTE, "due: early wake ran %#x", jobsAt(s, HOUR - SLACK_MS));
+  CHECK(jobsAt(s, HOUR) == QUOTE, "due: ran %#x", jobsAt(s, HOUR));
+  CHECK(jobsAt(s, HOUR + 5 * MIN) == QUOTE, "due: late wake ran %#x", jobsAt(s, HOUR + 5 * MIN));
+
+  // Woken early: the next sleep counts from the early wake
+  uint64_t now = HOUR - 20 * SEC;
+  markRun(s, jobsAt(s, now), now);
+  CHECK(scheduleSleepMs(s, now, MIN_SLEEP) == HOUR, "due: slept %llu after an early wake",
+        (unsigned long long)scheduleSleepMs(s, now, MIN_SLEEP));
+
+  // Sync comes due on a quote wake: both run, and the OTA check with it
+  s.dueMs[JOB_QUOTE] = 6 * HOUR;
+  CHECK(jobsAt(s, 6 * HOUR) == (QUOTE | SYNC), "due: sync wake ran %#x", jobsAt(s, 6 * HOUR));
+  s.dueMs[JOB_OTA_CHECK] = 6 * HOUR - MIN;
+  CHECK(jobsAt(s, 6 * HOUR) == (QUOTE | OTA | SYNC), "due: sync wake ran %#x with the OTA check due",
+        jobsAt(s, 6 * HOUR));
+}
+
+// Jobs due shortly after a wake run with it, saving a wake
+static void checkCoalesce() {
+  JobSchedule s;
+  init(s, HOUR, 24 * HOUR, 6 * HOUR);
+  markRun(s, QUOTE | OTA | SYNC, 0);
+  s.dueMs[JOB_SYNC] = HOUR + COALESCE_MS;
+
+  CHECK(jobsAt(s, HOUR) == (QUOTE | SYNC), "coalesce: ran %#x", jobsAt(s, HOUR));
+  s.dueMs[JOB_SYNC] = HOUR + COALESCE_MS + 1;
+  CHECK(jobsAt(s, HOUR) == QUOTE, "coalesce: ran %#x past the window", jobsAt(s, HOUR));
+
+  // Nothing due: nothing is pulled forward
+  CHECK(jobsAt(s, HOUR - COALESCE_MS) == 0, "coalesce: ran %#x with nothing due",
+        jobsAt(s, HOUR - COALESCE_MS));
+}
+
+// A failed job is retried after its delay, waking the device for it even
+// when it rides on another job; finishing puts it back on its interval
+static void checkRetry() {
+  JobSchedule s;
+  init(s, HOUR, 24 * HOUR, 6 * HOUR);
+  markRun(s, QUOTE | SYNC, 0);
+  scheduleRetryIn(s, JOB_OTA_CHECK, 0, MIN);
+
+  CHECK(scheduleSleepMs(s, 0, MIN_SLEEP) == MIN, "retry: slept %llu",
+        (unsigned long long)scheduleSleepMs(s, 0, MIN_SLEEP));
+  CHECK(jobsAt(s, MIN) == OTA, "retry: ran %#x", jobsAt(s, MIN));
+
+  // Backing off: 1, 2, 4, 8 minutes, each its own wake
+  uint64_t now = MIN;
+  for (uint64_t delay = 2 * MIN; delay <= 8 * MIN; delay *= 2) {
+    scheduleRetryIn(s, JOB_OTA_CHECK, now, delay);
+    uint64_t sleepMs = scheduleSleepMs(s, now, MIN_SLEEP);
+    CHECK(sleepMs == delay, "retry: slept %llu for a %llu ms backoff", (unsigned long long)sleepMs,
+          (unsigned long long)delay);
+    CHECK(jobsAt(s, now + delay / 2) == 0, "retry: ran %#x halfway through the backoff",
+          jobsAt(s, now + delay / 2));
+    now += sleepMs;
+    CHECK(jobsAt(s, now) == OTA, "retry: ran %#x after the backoff", jobsAt(s, now));
+  }
+
+  // Finished: riding again, so the timer is armed for the quote only
+  scheduleMarkRun(s, JOB_OTA_CHECK, now);
+  CHECK(!(s.retrying & OTA), "retry: still retrying");
+  CHECK(scheduleSleepMs(s, now, MIN_SLEEP) == HOUR - now, "retry: slept %llu after finishing",
+        (unsigned long long)scheduleSleepMs(s, now, MIN_SLEEP));
+
+  // A backoff shorter than the minimum sleep still sleeps the minimum
+  scheduleRetryIn(s, JOB_SYNC, now, 1);
+  CHECK(scheduleSleepMs(s, now, MIN_SLEEP) == MIN_SLEEP, "retry: slept %llu for a 1 ms backoff",
+        (unsigned long long)scheduleSleepMs(s, now, MIN_SLEEP));
+  CHECK(jobsAt(s, now + MIN_SLEEP) == SYNC, "retry: ran %#x after the minimum sleep",
+        jobsAt(s, now + MIN_SLEEP));
+}
+
+// Two simulated days with the OTA check due every hour: it never sets
+// the timer, runs on every sync wake and on no other
+static void checkRiding() {
+  JobSchedule s;
+  init(s, 2 * HOUR, HOUR, 6 * HOUR);
+
+  uint64_t now = 0;
+  int wakes = 0, otaRuns = 0, syncRuns = 0;
+  while (now < 48 * HOUR) {
+    uint32_t run = jobsAt(s, now);
+    CHECK(run & (QUOTE | SYNC), "riding: wake at %llu s ran %#x", (unsigned long long)(now / SEC), run);
+    CHECK(!(run & OTA) || (run & SYNC), "riding: OTA check without a sync at %llu s",
+          (unsigned long long)(now / SEC));
+    CHECK(!(run & SYNC) || (run & OTA), "riding: sync without the OTA check at %llu s",
+          (unsigned long long)(now / SEC));
+    if (run & OTA) otaRuns++;
+    if (run & SYNC) syncRuns++;
+    markRun(s, run, now);
+    wakes++;
+    now += scheduleSleepMs(s, now, MIN_SLEEP);
+  }
+  CHECK(wakes == 24, "riding: %d wakes in two days", wakes);
+  CHECK(syncRuns == 8 && otaRuns == 8, "riding: %d syncs, %d OTA checks", syncRuns, otaRuns);
+
+  // Due in a minute, yet the device sleeps until the quote
+  markRun(s, jobsAt(s, now), now);
+  s.dueMs[JOB_OTA_CHECK] = now + MIN;
+  CHECK(scheduleSleepMs(s, now, MIN_SLEEP) == s.dueMs[JOB_QUOTE] - now, "riding: slept %llu",
+        (unsigned long long)scheduleSleepMs(s, now, MIN_SLEEP));
+  CHECK(jobsAt(s, now + MIN) == 0, "riding: ran %#x on its own", jobsAt(s, now + MIN));
+
+  // No host, or itself as host: wakes by itself
+  scheduleRideWith(s, JOB_OTA_CHECK, JOB_NONE);
+  CHECK(scheduleSleepMs(s, now, MIN_SLEEP) == MIN, "riding: slept %llu without a host",
+        (unsigned long long)scheduleSleepMs(s, now, MIN_SLEEP));
+  scheduleRideWith(s, JOB_OTA_CHECK, JOB_OTA_CHECK);
+  CHECK(s.rideWith[JOB_OTA_CHECK] == JOB_NONE, "riding: rides with itself");
+  scheduleRideWith(s, JOB_OTA_CHECK, JOB_COUNT);
+  CHECK(s.rideWith[JOB_OTA_CHECK] == JOB_NONE, "riding: rides with job %d", s.rideWith[JOB_OTA_CHECK]);
+}
+
+// A sync the app starts on a quote wake (cache empty, queue used up)
+// brings the OTA check along, as a sync coming due would
+static void checkAddedHost() {
+  JobSchedule s;
+  init(s, HOUR, 24 * HOUR, 6 * HOUR);
+  markRun(s, QUOTE | OTA | SYNC, 0);
+  s.dueMs[JOB_OTA_CHECK] = 3 * HOUR + 5 * MIN;
+
+  uint64_t now = 3 * HOUR;
+  CHECK(jobsAt(s, now) == QUOTE, "added host: ran %#x", jobsAt(s, now));
+  uint32_t riders = scheduleRidersOf(s, JOB_SYNC, now, COALESCE_MS);
+  CHECK(riders == OTA, "added host: riders %#x", riders);
+  riders = scheduleRidersOf(s, JOB_QUOTE, now, COALESCE_MS);
+  CHECK(riders == 0, "added host: quote riders %#x", riders);
+
+  // Not due within the window: stays for a later sync
+  s.dueMs[JOB_OTA_CHECK] = now + COALESCE_MS + 1;
+  riders = scheduleRidersOf(s, JOB_SYNC, now, COALESCE_MS);
+  CHECK(riders == 0, "added host: riders %#x past the window", riders);
+
+  // A retry wakes by itself rather than riding
+  scheduleRetryIn(s, JOB_OTA_CHECK, now, MIN);
+  riders = scheduleRidersOf(s, JOB_SYNC, now, COALESCE_MS);
+  CHECK(riders == 0, "added host: retry rode as %#x", riders);
+}
+
+// The clock between wakes comes from system time, which can be set from
+// an HTTP Date while asleep. Forwards: everything overdue runs once and
+// the schedule restarts from the new time. Backwards: nothing runs early
+// and the timer is armed for what is left.
+static void checkClockJumps() {
+  JobSchedule s;
+  init(s, HOUR, 24 * HOUR, 6 * HOUR);
+  markRun(s, QUOTE | OTA | SYNC, 0);
+
+  uint64_t now = 30 * 24 * HOUR;
+  uint32_t run = jobsAt(s, now);
+  CHECK(run == (QUOTE | OTA | SYNC), "jump forwards: ran %#x", run);
+  markRun(s, run, now);
+  CHECK(jobsAt(s, now + SEC) == 0, "jump forwards: ran %#x again", jobsAt(s, now + SEC));
+  CHECK(scheduleSleepMs(s, now, MIN_SLEEP) == HOUR, "jump forwards: slept %llu",
+        (unsigned long long)scheduleSleepMs(s, now, MIN_SLEEP));
+
+  // Back by three hours: the quote is four hours away, the sync nine
+  uint64_t back = now - 3 * HOUR;
+  CHECK(jobsAt(s, back) == 0, "jump backwards: ran %#x", jobsAt(s, back));
+  CHECK(scheduleSleepMs(s, back, MIN_SLEEP) == 4 * HOUR, "jump backwards: slept %llu",
+        (unsigned long long)scheduleSleepMs(s, back, MIN_SLEEP));
+  CHECK(scheduleMsUntil(s, JOB_SYNC, back) == 9 * HOUR, "jump backwards: sync in %llu",
+        (unsigned long long)scheduleMsUntil(s, JOB_SYNC, back));
+
+  // Back to zero (scheduler.cpp clamps a negative sleep): the same
+  // schedule, measured from the start
+  CHECK(jobsAt(s, 0) == 0, "jump to zero: ran %#x", jobsAt(s, 0));
+  CHECK(scheduleSleepMs(s, 0, MIN_SLEEP) == now + HOUR, "jump to zero: slept %llu",
+        (unsigned long long)scheduleSleepMs(s, 0, MIN_SLEEP));
+
+  // A retry set before a forward jump runs on the first wake after it
+  init(s, HOUR, 24 * HOUR, 6 * HOUR);
+  markRun(s, QUOTE | OTA | SYNC, 0);
+  scheduleRetryIn(s, JOB_SYNC, 0, 5 * MIN);
+  run = jobsAt(s, 7 * HOUR);
+  CHECK(run == (QUOTE | SYNC), "jump with a retry: ran %#x", run);
+}
+
+int main() {
+  checkColdBoot();
+  checkComingDue();
+  checkCoalesce();
+  checkRetry();
+  checkRiding();
+  checkAddedHost();
+  checkClockJumps();
+
+  if (failures) {
+    printf("schedule_check: %d failures\n", failures);
+    return 1;
+  }
+  printf("schedule_check: OK\n");
+  return 0;
+}
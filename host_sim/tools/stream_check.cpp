@@ -0,0 +1,307 @@
+// stream_check.cpp - quote_stream.cpp against recorded Firestore bodies
+//
+//   stream_check [dir]
+//
+// Feeds the listDocuments and batchGet bodies in tools/firestore/ to
+// parseQuoteList() and parseBatchGet() through HttpBodyStream, framed
+// the three ways a response arrives: bounded by Content-Length, chunked
+// (odd chunk sizes, an extension and a trailer) and read until the peer
+// closes. Each body is followed by the start of the next response on
+// the same connection, which must be left unread. Checks the parsed
+// quotes and nextPageToken, then cuts every body short at each byte and
+// malforms it, which must fail rather than pass for a shorter page.
+// Exits non-zero on a failure.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "quote_stream.h"
+
+#define FIXTURE_DIR "tools/firestore"
+
+// The next response on a reused connection
+#define NEXT_RESPONSE "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\n{}"
+
+HardwareSerial Serial;
+void HardwareSerial::begin(unsigned long) {}
+int HardwareSerial::available() { return 0; }
+int HardwareSerial::read() { return -1; }
+int HardwareSerial::peek() { return -1; }
+
+// Every look at the clock moves it, so read timeouts end
+static unsigned long fakeMs = 0;
+unsigned long millis() { return fakeMs++; }
+void delay(unsigned long ms) { fakeMs += ms; }
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                          \
+  do {                                            \
+    if (!(cond)) {                                \
+      printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__);                        \
+      printf("\n");                               \
+      failures++;                                 \
+    }                                             \
+  } while (0)
+
+// The socket: bytes received so far, then nothing (a stalled or closed peer)
+class MemStream : public Stream {
+public:
+  explicit MemStream(const std::string &data) : _data(data) {}
+
+  int available() override { return _data.size() - _pos; }
+  int read() override { return _pos < _data.size() ? (unsigned char)_data[_pos++] : -1; }
+  int peek() override { return _pos < _data.size() ? (unsigned char)_data[_pos] : -1; }
+  size_t readBytes(char *buffer, size_t length) override {
+    size_t n = _data.size() - _pos;
+    if (n > length) n = length;
+    memcpy(buffer, _data.data() + _pos, n);
+    _pos += n;
+    return n;
+  }
+  size_t write(uint8_t) override { return 0; }
+
+  std::string rest() const { return _data.substr(_pos); }
+
+private:
+  std::string _data;
+  size_t      _pos = 0;
+};
+
+enum Framing { FRAME_LENGTH, FRAME_CHUNKED, FRAME_CLOSE };
+static const char *const FRAMING_NAMES[] = {"content-length", "chunked", "close"};
+
+// `at` (optional) receives where each body byte lands in the output
+static std::string chunked(const std::string &body, std::vector<size_t> *at = nullptr) {
+  static const size_t sizes[] = {1, 7, 100, 1000, 3};
+  std::string out;
+  size_t pos = 0;
+  for (int i = 0; pos < body.size(); i++) {
+    size_t n = sizes[i % 5];
+    if (n > body.size() - pos) n = body.size() - pos;
+    char head[32];
+    snprintf(head, sizeof(head), i == 2 ? "%zx;ext=1\r\n" : "%zX\r\n", n);
+    out += head;
+    for (size_t i = 0; at && i < n; i++) at->push_back(out.size() + i);
+    out += body.substr(pos, n);
+    out += "\r\n";
+    pos += n;
+  }
+  return out + "0\r\nX-Trailer: yes\r\n\r\n";
+}
+
+// What arrives on the socket for `body`
+static std::string framed(const std::string &body, Framing f) {
+  switch (f) {
+    case FRAME_LENGTH:  return body + NEXT_RESPONSE;
+    case FRAME_CHUNKED: return chunked(body) + NEXT_RESPONSE;
+    default:            return body;
+  }
+}
+
+struct Parsed {
+  std::vector<Quote> quotes;
+  String             token;
+  String             err;
+  bool               ok;
+  size_t             consumed;
+  std::string        rest;   // left on the socket
+};
+
+static void collect(const Quote &quote, void *ctx) {
+  static_cast<std::vector<Quote> *>(ctx)->push_back(quote);
+}
+
+// `sent` is what reached the socket, `length` the Content-Length header
+static Parsed parse(const std::string &sent, long length, Framing f, bool batch) {
+  MemStream socket(sent);
+  HttpBodyStream body(socket, f == FRAME_LENGTH ? length : -1, f == FRAME_CHUNKED);
+  Parsed p;
+  p.ok = batch ? parseBatchGet(body, collect, &p.quotes, p.err)
+               : parseQuoteList(body, collect, &p.quotes, &p.token, p.err);
+  body.drain();
+  p.consumed = body.consumed();
+  p.rest = socket.rest();
+  return p;
+}
+
+static std::string readFixture(const char *dir, const char *name) {
+  std::string path = std::string(dir) + "/" + name;
+  FILE *f = fopen(path.c_str(), "rb");
+  if (!f) {
+    printf("stream_check: cannot read %s\n", path.c_str());
+    exit(2);
+  }
+  std::string data;
+  char buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.append(buf, n);
+  fclose(f);
+  return data;
+}
+
+struct Expected {
+  const char *id, *text, *author, *tags, *updateTime;
+};
+
+static void checkQuotes(const char *what, const Parsed &p, const Expected *want, size_t count) {
+  CHECK(p.quotes.size() == count, "%s: %zu quotes, expected %zu", what, p.quotes.size(), count);
+  for (size_t i = 0; i < count && i < p.quotes.size(); i++) {
+    const Quote &q = p.quotes[i];
+    CHECK(q.id == want[i].id, "%s #%zu: id \"%s\"", what, i, q.id.c_str());
+    CHECK(q.text == want[i].text, "%s #%zu: text \"%s\"", what, i, q.text.c_str());
+    CHECK(q.author == want[i].author, "%s #%zu: author \"%s\"", what, i, q.author.c_str());
+    CHECK(q.tagsLine == want[i].tags, "%s #%zu: tags \"%s\"", what, i, q.tagsLine.c_str());
+    CHECK(q.updateTime == want[i].updateTime, "%s #%zu: updateTime \"%s\"", what, i,
+          q.updateTime.c_str());
+  }
+}
+
+static const Expected PAGE1[] = {
+  {"3kQ9vL1aZ0",
+   "The only thing that makes life possible is permanent, intolerable uncertainty; not knowing what comes next.",
+   "Ursula K. Le Guin", "#life   #uncertainty", "2025-02-17T18:40:55.102934Z"},
+  {"8fTmW2c0Yd",
+   "\"Simplicity is prerequisite for reliability.\"\nAnd {braces}, [brackets], commas: all inside a string.",
+   "Edsger W. Dijkstra", "", "2024-12-24T20:01:11.004502Z"},
+  {"Q1Zr5nVbXe", "It\xE2\x80\x99s always coffee o\xE2\x80\x99" "clock somewhere.", "", "#caf\xC3\xA9",
+   "2025-03-05T11:02:47.918260Z"},
+};
+
+static const Expected PAGE2[] = {
+  {"ZZ0a1b2c3d", "The most dangerous phrase in the language is: we've always done it this way.",
+   "Grace Hopper", "#change", "2025-01-09T15:00:00.120000Z"},
+};
+
+// batchGet asks for a field mask, and skips the missing document
+static const Expected BATCH[] = {
+  {"3kQ9vL1aZ0", PAGE1[0].text, PAGE1[0].author, PAGE1[0].tags, PAGE1[0].updateTime},
+  {"ZZ0a1b2c3d", PAGE2[0].text, PAGE2[0].author, "", PAGE2[0].updateTime},
+};
+
+struct Fixture {
+  const char     *name;
+  bool            batch;
+  const Expected *quotes;
+  size_t          count;
+  const char     *token;
+  std::string     body;
+};
+
+// Whole bodies, every framing: the quotes, the token, and the connection
+// left at the next response
+static void checkWhole(const Fixture &fx) {
+  for (int f = FRAME_LENGTH; f <= FRAME_CLOSE; f++) {
+    char what[64];
+    snprintf(what, sizeof(what), "%s/%s", fx.name, FRAMING_NAMES[f]);
+    Parsed p = parse(framed(fx.body, (Framing)f), fx.body.size(), (Framing)f, fx.batch);
+    CHECK(p.ok, "%s: failed: %s", what, p.err.c_str());
+    checkQuotes(what, p, fx.quotes, fx.count);
+    CHECK(p.token == fx.token, "%s: nextPageToken \"%s\"", what, p.token.c_str());
+    CHECK(p.consumed == fx.body.size(), "%s: consumed %zu of %zu body bytes", what, p.consumed,
+          fx.body.size());
+    if (f != FRAME_CLOSE) {
+      CHECK(p.rest == NEXT_RESPONSE, "%s: next response not left intact (%zu bytes left)", what,
+            p.rest.size());
+    }
+  }
+}
+
+// The peer stalls or closes after `cut` bytes of the body. The body
+// ends with a newline; every cut before its closing bracket is short.
+static void checkTruncated(const Fixture &fx) {
+  size_t complete = fx.body.find_last_not_of("\n") + 1;
+  for (int f = FRAME_LENGTH; f <= FRAME_CLOSE; f++) {
+    std::vector<size_t> at;
+    std::string sent = f == FRAME_CHUNKED ? chunked(fx.body, &at) : fx.body;
+    // A chunked body holds the whole JSON before its last chunk arrives
+    size_t whole = f == FRAME_CHUNKED ? at[complete - 1] + 1 : complete;
+    int passed = 0;
+    size_t firstPass = 0;
+    for (size_t cut = 0; cut < whole; cut++) {
+      Parsed p = parse(sent.substr(0, cut), fx.body.size(), (Framing)f, fx.batch);
+      if (p.ok) {
+        if (!passed++) firstPass = cut;
+      } else {
+        CHECK(p.err.length() > 0, "%s/%s cut at %zu: failed with no reason", fx.name,
+              FRAMING_NAMES[f], cut);
+      }
+    }
+    CHECK(passed == 0, "%s/%s: %d short bodies parsed, first cut at %zu", fx.name,
+          FRAMING_NAMES[f], passed, firstPass);
+  }
+}
+
+struct Malformed {
+  const char *what;
+  bool        batch;
+  const char *body;
+};
+
+static const Malformed MALFORMED[] = {
+  {"documents not an array", false, "{\"documents\": {\"name\": \"x\"}}"},
+  {"junk after a document", false, "{\"documents\": [{\"name\": \"a/b\"} {\"name\": \"a/c\"}]}"},
+  {"broken document", false, "{\"documents\": [{\"name\": \"a/b\", \"fields\": {]}"},
+  {"junk after the documents", false, "{\"documents\": [{\"name\": \"a/b\"}] \"nextPageToken\": \"t\"}"},
+  {"unterminated token", false, "{\"documents\": [{\"name\": \"a/b\"}], \"nextPageToken\": \"t}"},
+  {"token not a string", false, "{\"nextPageToken\": 5, \"documents\": []}"},
+  {"member with no value", false, "{\"documents\": [], \"partial\": }"},
+  {"member name not a string", false, "{documents: []}"},
+  {"no colon after a name", false, "{\"readTime\" \"t\", \"documents\": []}"},
+  {"trailing comma", false, "{\"documents\": [],}"},
+  {"empty body", false, ""},
+  {"not an object", false, "[]"},
+  {"batchGet not an array", true, "{\"error\": {\"code\": 400}}"},
+  {"junk after a result", true, "[{\"missing\": \"a/b\"}; {\"missing\": \"a/c\"}]"},
+  {"empty batchGet body", true, ""},
+};
+
+static void checkMalformed() {
+  for (const Malformed &m : MALFORMED) {
+    std::string body = m.body;
+    Parsed p = parse(body + NEXT_RESPONSE, body.size(), FRAME_LENGTH, m.batch);
+    CHECK(!p.ok, "%s: parsed", m.what);
+    CHECK(!p.ok || p.err.length() > 0, "%s: failed with no reason", m.what);
+  }
+
+  // Still valid: an empty batchGet, and pages with no documents
+  const char *valid[][2] = {{"[]", "b"},
+                            {" [ ] ", "b"},
+                            {"{\"documents\": []}", "l"},
+                            {"{\"readTime\": \"t\"}", "l"},
+                            {"{\"documents\":[],\"partial\":true,\"n\":-1}", "l"}};
+  for (auto &v : valid) {
+    std::string body = v[0];
+    Parsed p = parse(body, body.size(), FRAME_LENGTH, v[1][0] == 'b');
+    CHECK(p.ok && p.quotes.empty(), "\"%s\": %s", v[0], p.ok ? "quotes found" : p.err.c_str());
+  }
+}
+
+int main(int argc, char **argv) {
+  const char *dir = argc > 1 ? argv[1] : FIXTURE_DIR;
+  Fixture fixtures[] = {
+    {"list_page1", false, PAGE1, 3, "AFTOeJzjYGBgYGQAAmYWBhBgBAAAHwAD/w==", readFixture(dir, "list_page1.json")},
+    {"list_page2", false, PAGE2, 1, "", readFixture(dir, "list_page2.json")},
+    {"list_empty", false, nullptr, 0, "", readFixture(dir, "list_empty.json")},
+    // Other members, of every type, and nextPageToken before the documents
+    {"list_reordered", false, PAGE2, 1, "AFTOeJwz/nJjYGBkYGRgAJ=", readFixture(dir, "list_reordered.json")},
+    {"batch_get", true, BATCH, 2, "", readFixture(dir, "batch_get.json")},
+  };
+
+  for (const Fixture &fx : fixtures) {
+    checkWhole(fx);
+    checkTruncated(fx);
+  }
+  checkMalformed();
+
+  if (failures) {
+    printf("stream_check: %d failures\n", failures);
+    return 1;
+  }
+  printf("stream_check: OK\n");
+  return 0;
+}
@@ -56,6 +56,7 @@ void BaseDisplay::initBMP(const char* filename) {
 
     // Open for writing
     sd = new SDWrapper();
+    awaitUpdate();   // The card shares the SPI bus with the display: let an async update finish first
     sd->begin(pin_cs_card, display_spi);
     sd->openFile(filename, true);
 
@@ -177,6 +178,7 @@ void BaseDisplay::drawMonoBMP(int16_t left, int16_t top, const char* filename, C
     sd = new SDWrapper();
 
     // Open card
+    awaitUpdate();
     sd->begin(pin_cs_card, display_spi);
 
     // Open image
@@ -282,6 +284,7 @@ void BaseDisplay::drawMonoBMP(int16_t left, int16_t top, const char* filename, C
         sd = new SDWrapper();
 
         // Open card
+        awaitUpdate();
         sd->begin(pin_cs_card, display_spi);
 
         // Open image
@@ -398,6 +401,7 @@ void BaseDisplay::loadFullscreenBMP(const char* filename) {
     sd = new SDWrapper();
 
     // Open card
+    awaitUpdate();
     sd->begin(pin_cs_card, display_spi);
 
     // Open image
@@ -421,13 +425,13 @@ void BaseDisplay::loadFullscreenBMP(const char* filename) {
         send24BitBMP(supportsColor(RED) ? RED : BLACK);
 
         // Display the result
-        activate();
+        refresh();
     }
 
     // If fastmodeON
     else if (fastmode_state == ON) {
         // Update the display first,
-        activate();        
+        refresh();        
 
         // Then send the data again, before final update
         // setMemoryArea(sx, sy, ex, ey);
@@ -438,7 +442,7 @@ void BaseDisplay::loadFullscreenBMP(const char* filename) {
 
     // If fastmode TURBO, for some reason
     else if (fastmode_state == TURBO)
-        activate();
+        refresh();
 
     // Free memory from SD instance
     delete sd;
@@ -530,6 +534,9 @@ void BaseDisplay::send24BitBMP(Color target) {
     uint16_t height = sd->BMPHeight();
     uint16_t image_start = sd->BMPStart();
 
+    // One row of display data, sent as a single SPI transaction (the card shares the bus, so not the whole image)
+    uint8_t *row = new uint8_t[(width + 7) / 8];
+
     // Rows
     for(int16_t y = (int16_t) height - 1; y >= 0; y--) {    // Cast to suppress warning, signed so y can be < 0
 
@@ -541,6 +548,7 @@ void BaseDisplay::send24BitBMP(Color target) {
         sd->seek(row_start);
 
         // Columns
+        uint16_t row_bytes = 0;
         for(uint16_t x = 0; x < width; x+=8) {
 
             // Clear byte
@@ -574,10 +582,15 @@ void BaseDisplay::send24BitBMP(Color target) {
                     break;  // Accept the rest of the byte as blank
                 }
             }
-            // Transfer 8 pixels to the screen
-            sendData(display_data);
+            // Store 8 pixels for the screen
+            row[row_bytes++] = display_data;
         }
+
+        // Transfer the row
+        sendData(row, row_bytes);
     }
+
+    delete[] row;
 }
 
 // Decide which of the available display colors best matches a 24bit Bitmap pixel
@@ -597,6 +610,7 @@ void BaseDisplay::writePageToBMP() {
     sd = new SDWrapper();                   // Needs to be deleted at end of method
 
     // Open card
+    awaitUpdate();
     sd->begin(pin_cs_card, display_spi);
 
     // Open image. Filename stored in savingBMP()
@@ -689,6 +703,7 @@ bool BaseDisplay::SDCardFound() {
 
     // Create SD, check card, delete SD
     sd = new SDWrapper();
+    awaitUpdate();
     bool card_result = sd->begin(pin_cs_card, display_spi);
     delete sd;
 
@@ -700,6 +715,7 @@ bool BaseDisplay::SDFileExists(const char* filename) {
 
     // Create SD, open card, check file, delete SD
     sd = new SDWrapper();
+    awaitUpdate();
     sd->begin(pin_cs_card, display_spi);
     bool file_result = sd->exists(filename);
     delete sd;
@@ -721,6 +737,7 @@ bool BaseDisplay::fullscreenBMPValid(const char* filename, bool purge) {
 
     // Create SD, open card
     sd = new SDWrapper();
+    awaitUpdate();
     sd->begin(pin_cs_card, display_spi);
     
     // Might as well check if file exists first
@@ -762,6 +779,7 @@ uint16_t BaseDisplay::getBMPWidth(const char* filename) {
 
     // Create SD, open card, open image
     sd = new SDWrapper();
+    awaitUpdate();
     sd->begin(pin_cs_card, display_spi);
     sd->openFile(filename);
 
@@ -776,6 +794,7 @@ uint16_t BaseDisplay::getBMPHeight(const char* filename) {
 
     // Create SD, open card, open image
     sd = new SDWrapper();
+    awaitUpdate();
     sd->begin(pin_cs_card, display_spi);
     sd->openFile(filename);
 
@@ -19,6 +19,17 @@
 #include "Bounds/bounds.h"
 #include "Displays/BaseDisplay/enums.h"
 
+#if CAN_UPLOAD_ASYNC || CAN_WAIT_ON_INTERRUPT
+    #include <freertos/FreeRTOS.h>
+#endif
+#if CAN_UPLOAD_ASYNC
+    #include <freertos/queue.h>
+    #include <freertos/task.h>
+#endif
+#if CAN_WAIT_ON_INTERRUPT
+    #include <freertos/semphr.h>
+#endif
+
 class BaseDisplay: public GFX {
 
     public:
@@ -27,7 +38,13 @@ class BaseDisplay: public GFX {
 
         // Destructor
         ~BaseDisplay() {
+            awaitUpdate();
             freePageMemory();
+            freeUploadMemory();
+            #if CAN_WAIT_ON_INTERRUPT
+                if (busy_signal)
+                    vSemaphoreDelete(busy_signal);
+            #endif
         }
 
         void begin();                                               // Called from derived-class' constructor: gets access to derived-class parameters, and runs hardware init                              
@@ -35,6 +52,7 @@ class BaseDisplay: public GFX {
 
         // Drawing params & AdafruitGFX overrides                                                    
         void drawPixel(int16_t x, int16_t y, uint16_t color);       // Where pixel output of AdafruitGFX is intercepted
+        void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);     // Lines, shapes and text all end up here. Written as byte spans, not pixel by pixel
         void setBackgroundColor(uint16_t bgcolor);                  // Set default background color for drawing
         void setRotation(int16_t r);                                // Store rotation val, and recalculate window dimensions
         void landscape();                                           // Alias for setRotation(3) or setRotation(1), depending on platform
@@ -73,11 +91,19 @@ class BaseDisplay: public GFX {
 
 
         // Paging and Refresh
+        typedef void (*UpdateCallback)(void *context);              // Called when an async update has finished
         void clear();                                               // Public clear() method. Obligatory refresh
         bool calculating();                                         // Main method controlling paging. while( calculating() )
         #define DRAW(display) while(display.calculating())          // Macro to call while(.calculating())
+        bool updating();                                            // Is an async update still running?
+        void awaitUpdate();                                         // Block until the async update (if any) has finished
+        bool isBusy();                                              // Is the display hardware busy (refreshing)? Does not block
+        void onRefreshComplete(UpdateCallback on_refresh, void *context = nullptr);    // Called after every refresh, from whichever task ran it. nullptr to remove
+        void setBusyTimeout(uint32_t ms);                           // Give up waiting for a busy display after this long. 0 waits forever (default)
+        bool busyTimedOut();                                        // Did the last wait for the display time out? Check after update() or in onRefreshComplete()
         #if PRESERVE_IMAGE
             void update();                                          // Non-paged: display the result of drawing.
+            void update(UpdateCallback on_complete, void *context = nullptr);  // Non-paged, async: returns once the image is copied. Keep drawing; on_complete runs when the panel is done
             void clearMemory();                                     // Non-paged: clear the pagefile (which is full screen-height)
             void overwrite()        { update(); }                   // DEPRECATION
             void startOver()        { clearMemory(); }              // DEPRECATION
@@ -219,9 +245,12 @@ class BaseDisplay: public GFX {
 
         // Display interaction
         virtual void reset();                           // Reset the display. Overriden for Fitipower ICs
-        virtual void wait();                            // Pause until the display can accept new commands. Overriden for Fitipower ICs
+        void wait();                                    // Pause until the display can accept new commands. Sleeps on the BUSY edge, if CAN_WAIT_ON_INTERRUPT
         void sendCommand(uint8_t command);              // Send SPI Command to display (see datasheets)
         void sendData(uint8_t data);                    // Send SPI data to display
+        void sendData(const uint8_t *data, uint16_t length);        // Send a span of SPI data, as one transaction
+        void sendData_P(const uint8_t *data, uint16_t length);      // Same, from PROGMEM (LUTs)
+        void sendDataFill(uint8_t value, uint16_t count);           // Send one byte value, repeated, as one transaction
         virtual void sendImageData();                   // Send image over SPI to display's memory. Overriden for Fitipower ICs
         virtual void sendBlankImageData();              // Send a full frame of black data over SPI to display's memory. Overriden for Fitipower ICs
 
@@ -232,6 +261,7 @@ class BaseDisplay: public GFX {
         void setWindow(uint16_t left, uint16_t top, uint16_t width, uint16_t height, bool clear_page);      // (hide final parameter from user)
         virtual void setMemoryArea(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey);                     // Inform the display of selected memory area. Overriden if no "partial window" support
         void writePage();                                                                                   // Send image data to display memory (no refresh)
+        void refresh();                                                                                     // activate(), then the onRefreshComplete() hook
         void clearPage();                                                                                   // Fill the pagefile(s) with default_color. Overriden if no "partial window" support
         virtual void clearPageWindow();                                                                     // If controller has no "partial window" support, this behaviour needs to be separated. By default: a wrapper for clearPage
         void clearAllMemories();                                                                            // Clears the display memory, and if PRESERVE_IMAGE, the pagefile too
@@ -239,6 +269,31 @@ class BaseDisplay: public GFX {
         void restoreDrawingConfig();
 
 
+        // Drawing
+        typedef void (BaseDisplay::*PixelSetter)(int16_t x, int16_t y, uint16_t color);
+        template <bool swap_xy, bool flip_x, bool flip_y, bool in_place, bool red>
+        void setPixel(int16_t x, int16_t y, uint16_t color);                                               // drawPixel(), with rotation, flip, page layout and color support fixed at compile time
+        void selectPixelSetter();                                                                           // Point drawPixel() at the setPixel() for current rotation and flip. Called by setRotation() and setFlip()
+        void rotatePoint(int32_t &x, int32_t &y);                                                           // Apply rotation and flip: drawing coords to panel coords
+        void fillPageRect(uint8_t *page, uint8_t value, uint16_t left, uint16_t top, uint16_t right, uint16_t bottom);   // Set a clipped panel-coords rect in one pagefile
+
+
+        // Async update
+        void freeUploadMemory();                                                                            // Release the copy of the image used by async updates
+        #if CAN_UPLOAD_ASYNC
+            bool grabUploadMemory();                                                                        // Allocate the copy of the image (once). False if out of memory
+            bool startUploadTask();                                                                         // Create the upload task (once). False on failure
+            static void uploadTask(void *display);                                                          // Runs runUpload() for each update(callback)
+            void runUpload();                                                                               // Send the copied image, refresh, then call back
+        #endif
+
+
+        // BUSY wait
+        #if CAN_WAIT_ON_INTERRUPT
+            static void busyISR(void *display);                                                             // BUSY pin edge: wake wait()
+        #endif
+
+
         // SD card
         #ifndef DISABLE_SDCARD  // optimization.h, WirelessPaper.h
             void send24BitBMP(Color target);                                    // Feed .bmp into sendData()
@@ -260,7 +315,7 @@ class BaseDisplay: public GFX {
         virtual void configPingPong() {};                                                                                               // Configure for "TURBO" fastmode - single pass partial refresh (only relevant for Uno)
         virtual void activate() = 0;                                                                                                    // Perform the display update, "master activation"
         virtual void endImageTxQuiet();                                                                                                 // Finish the transmission of image data without activation - for differential update
-        virtual void calculatePixelPageOffset(uint16_t x, uint16_t y, uint16_t &byte_offset, uint8_t &bit_offset);                      // Calculate byte location of pixel in pagefile. Overriden if no "partial window" support
+        virtual void calculatePixelPageOffset(uint16_t x, uint16_t y, uint16_t &byte_offset, uint8_t &bit_offset);                      // Calculate byte location of pixel in pagefile. Overriden if no "partial window" support, with window_in_place
         virtual void calculateMemoryArea( int16_t &sx, int16_t &sy, int16_t &ex, int16_t &ey,                                           // Calculate area of display memory to accept data
                                             int16_t region_left, int16_t region_top, int16_t region_right, int16_t region_bottom ) = 0;           
 
@@ -269,12 +324,14 @@ class BaseDisplay: public GFX {
         uint8_t pin_dc;                                             // Display / Command
         uint8_t pin_cs;                                             // Chip Select
         uint8_t pin_busy;                                           // Can display accept new commands
+        uint8_t busy_level = HIGH;                                  // Level of pin_busy while busy. LOW for Fitipower ICs
         uint8_t pin_sdi;                                            // "MOSI". Unless CAN_MOVE_SPI_PINS, value is -1
         uint8_t pin_clk;                                            // "SCK". Unless CAN_MOVE_SPI_PINS, value is -1
         uint16_t pagefile_height;                                   // How many vertical lines per page
         uint16_t panel_width, panel_height;                         // True dimensions
         uint16_t drawing_width, drawing_height;                     // Usable dimensions
         Color supported_colors;                                     // Colors supported by the display
+        bool window_in_place = false;                               // Window kept at its fullscreen position in the pagefile. For ICs with no "partial window" support
 
 
         // SPI
@@ -300,6 +357,7 @@ class BaseDisplay: public GFX {
         // Drawing parameters
         uint16_t default_color = WHITE;                             // Background color of the canvas, before drawing           
         Flip imgflip = NONE;                                        // Along which Axes to mirror the display
+        PixelSetter pixel_setter = nullptr;                         // Chosen by selectPixelSetter()
         int16_t cursor_placed_x = 0;                                // X value of last setCursor() call (re: println, text wrapping)
 
 
@@ -310,6 +368,27 @@ class BaseDisplay: public GFX {
         uint16_t page_top, page_bottom;                             // Which rows to be considered when drawing on current page
         uint8_t *page_black;                                        // Dynamic memory which stores black image bits
         uint8_t *page_red;                                          // Dynamic memory which stores red image bits (if required)
+        uint8_t *tx_black;                                          // Pagefile sent by writePage(): page_black, or its copy during an async update
+        uint8_t *tx_red;                                            // Same, for red
+
+        // Async update
+        #if CAN_UPLOAD_ASYNC
+            uint8_t *upload_black = nullptr;                        // Copy of the image, sent by the upload task while drawing continues
+            uint8_t *upload_red = nullptr;
+            volatile bool upload_busy = false;                      // Is an async update running?
+            UpdateCallback upload_done = nullptr;                   // Called by the upload task, once finished
+            void *upload_context = nullptr;
+            QueueHandle_t upload_queue = nullptr;                   // Wakes the upload task
+        #endif
+
+        // BUSY wait
+        uint32_t busy_timeout = 0;                                  // ms. 0: wait forever
+        bool busy_timed_out = false;                                // Did the last wait() time out?
+        UpdateCallback refresh_done = nullptr;                      // onRefreshComplete() hook
+        void *refresh_context = nullptr;
+        #if CAN_WAIT_ON_INTERRUPT
+            SemaphoreHandle_t busy_signal = nullptr;                // Given by busyISR()
+        #endif
         
         // Paging: drawing state at start of loop 
         GFXfont* before_paging_font;                                // Font
@@ -8,16 +8,123 @@
 #include "base.h"
 
 // Draw a single pixel. 
-// Virtual method from AdafruitGFX. All other drawing methods pass through here
-
+// Virtual method from AdafruitGFX. All other drawing methods pass through here (except fillRect)
 void BaseDisplay::drawPixel(int16_t x, int16_t y, uint16_t color) {
-    // Rotate the pixel
-    int16_t x1=0, y1=0;
+    (this->*pixel_setter)(x, y, color);
+}
+
+// Draw a single pixel, for one combination of rotation and flip
+// Every rotation + flip is one of 8 mappings: maybe swap x and y, then maybe mirror each axis
+// in_place: window is not packed at the start of the pagefile (see LCMEN2R13EFC1::calculatePixelPageOffset)
+// red: display has a red pagefile
+template <bool swap_xy, bool flip_x, bool flip_y, bool in_place, bool red>
+void BaseDisplay::setPixel(int16_t x, int16_t y, uint16_t color) {
+    // Rotate and flip the pixel
+    int16_t x1 = swap_xy ? y : x;
+    int16_t y1 = swap_xy ? x : y;
+    if (flip_x)
+        x1 = (drawing_width - 1) - x1;
+    if (flip_y)
+        y1 = (drawing_height - 1) - y1;
+
+    // Check if pixel falls in our page
+    if ((uint16_t) x1 < winrot_left || (uint16_t) y1 < page_top || (uint16_t) y1 > page_bottom || (uint16_t) x1 > winrot_right)
+        return;
+
+    // Position of pixel within the page files. Same as calculatePixelPageOffset()
+    uint16_t byte_offset;
+    if (in_place)
+        byte_offset = (uint16_t) y1 * (panel_width / 8) + (uint16_t) x1 / 8;
+    else
+        byte_offset = ((uint16_t) y1 - page_top) * ((winrot_right - winrot_left + 1) / 8) + ((uint16_t) x1 - winrot_left) / 8;
+    uint8_t bit = 0x80 >> (x1 & 7);     // MSB is the leftmost pixel
+
+    // Insert the correct color values into the appropriate location
+    page_black[byte_offset] = (page_black[byte_offset] & ~bit) | (bit & -(uint8_t)(color & WHITE));
+
+    // Red, if display supports
+    if (red)
+        page_red[byte_offset] = (page_red[byte_offset] & ~bit) | (bit & -(uint8_t)((color >> 1) & 1));
+}
+
+// One setPixel() for each mapping, page layout and color support
+#define PIXEL_SETTERS(swap_xy, flip_x, flip_y)                          \
+    &BaseDisplay::setPixel<swap_xy, flip_x, flip_y, false, false>,      \
+    &BaseDisplay::setPixel<swap_xy, flip_x, flip_y, false, true>,       \
+    &BaseDisplay::setPixel<swap_xy, flip_x, flip_y, true, false>,       \
+    &BaseDisplay::setPixel<swap_xy, flip_x, flip_y, true, true>
+
+// Decide, once, how drawPixel() will place pixels
+void BaseDisplay::selectPixelSetter() {
+    static const PixelSetter setters[] = {
+        PIXEL_SETTERS(false, false, false),
+        PIXEL_SETTERS(false, false, true),
+        PIXEL_SETTERS(false, true, false),
+        PIXEL_SETTERS(false, true, true),
+        PIXEL_SETTERS(true, false, false),
+        PIXEL_SETTERS(true, false, true),
+        PIXEL_SETTERS(true, true, false),
+        PIXEL_SETTERS(true, true, true),
+    };
+
+    // Rotation
+    bool swap_xy = rotation % 2;
+    bool flip_x = (rotation == 1 || rotation == 2);
+    bool flip_y = (rotation == 2 || rotation == 3);
+
+    // Flip
+    if (imgflip & Flip::HORIZONTAL) {
+        if (rotation % 2)   // If landscape
+        flip_y = !flip_y;
+        else                    // If portrait
+        flip_x = !flip_x;
+    }
+    if (imgflip & Flip::VERTICAL) {
+        if (rotation % 2)   // If landscape
+        flip_x = !flip_x;
+        else                    // If portrait
+        flip_y = !flip_y;
+    }
+
+    uint8_t index = (swap_xy << 4) | (flip_x << 3) | (flip_y << 2) | (window_in_place << 1) | supportsColor(RED);
+    pixel_setter = setters[index];
+}
+
+#undef PIXEL_SETTERS
+
+// Fill a rectangle. Virtual method from AdafruitGFX: lines, shapes and text are made of these
+// Clipped once, then written a byte at a time (pixel by pixel only at the ends of each row)
+void BaseDisplay::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    if (w <= 0 || h <= 0)
+        return;
+
+    // Opposite corners, rotated and flipped as drawPixel() would
+    int32_t left = x, top = y;
+    int32_t right = (int32_t) x + w - 1, bottom = (int32_t) y + h - 1;
+    rotatePoint(left, top);
+    rotatePoint(right, bottom);
+    if (left > right) { int32_t t = left; left = right; right = t; }
+    if (top > bottom) { int32_t t = top; top = bottom; bottom = t; }
+
+    // Clip to the window and page
+    if (left < winrot_left)     left = winrot_left;
+    if (right > winrot_right)   right = winrot_right;
+    if (top < page_top)         top = page_top;
+    if (bottom > page_bottom)   bottom = page_bottom;
+    if (left > right || top > bottom)
+        return;
+
+    fillPageRect(page_black, (color & WHITE) ? 0xFF : 0x00, left, top, right, bottom);
+
+    // Red, if display supports
+    if (supportsColor(RED))
+        fillPageRect(page_red, (color >> 1) ? 0xFF : 0x00, left, top, right, bottom);
+}
+
+// Same transformation as drawPixel(), in a wider type: the corners of a rectangle may be far off-screen
+void BaseDisplay::rotatePoint(int32_t &x, int32_t &y) {
+    int32_t x1 = x, y1 = y;
     switch(rotation) {
-        case 0:         // No rotation
-        x1=x;
-        y1=y;
-        break;
         case 1:         // 90deg clockwise
         x1 = (drawing_width - 1) - y;
         y1 = x;
@@ -31,40 +138,53 @@ void BaseDisplay::drawPixel(int16_t x, int16_t y, uint16_t color) {
         y1 = (drawing_height - 1) - x;
         break;
     }
-    x = x1;
-    y = y1;
 
-    // Handle flip
     if (imgflip & Flip::HORIZONTAL) {
         if (rotation % 2)   // If landscape
-        y = (drawing_height - 1) - y;
+        y1 = (drawing_height - 1) - y1;
         else                    // If portrait
-        x = (drawing_width - 1) - x;
+        x1 = (drawing_width - 1) - x1;
     }
     if (imgflip & Flip::VERTICAL) {
         if (rotation % 2)   // If landscape
-        x = (drawing_width - 1) - x;
+        x1 = (drawing_width - 1) - x1;
         else                    // If portrait
-        y = (drawing_height - 1) - y;
+        y1 = (drawing_height - 1) - y1;
     }
 
-    // Check if pixel falls in our page
-    if((uint16_t) x >= winrot_left && (uint16_t) y >= page_top && (uint16_t) y <= page_bottom && (uint16_t) x <= winrot_right) {
+    x = x1;
+    y = y1;
+}
 
-        uint16_t byte_offset;
-        uint8_t bit_offset;
-        calculatePixelPageOffset(x, y, byte_offset, bit_offset);    // Position of pixel within the page files. Overriden if no "partial window" support
+// Set every pixel of a rectangle (panel coords, already clipped) to the value's bits
+// Rows are located with calculatePixelPageOffset(), so displays without "partial window" support get their own layout
+void BaseDisplay::fillPageRect(uint8_t *page, uint8_t value, uint16_t left, uint16_t top, uint16_t right, uint16_t bottom) {
+    uint16_t first, last, next;
+    uint8_t bit_offset;
+    calculatePixelPageOffset(left, top, first, bit_offset);
+    calculatePixelPageOffset(right, top, last, bit_offset);
+
+    // Distance between rows
+    uint16_t stride = 0;
+    if (bottom > top) {
+        calculatePixelPageOffset(left, top + 1, next, bit_offset);
+        stride = next - first;
+    }
 
-        // Insert the correct color values into the appropriate location
-        uint8_t bitmask = ~(1 << bit_offset);
-        page_black[byte_offset] &= bitmask;
-        page_black[byte_offset] |= (color & WHITE) << bit_offset;
+    // Partial bytes at either end of a row. MSB is the leftmost pixel
+    uint8_t mask_first = 0xFF >> (left % 8);
+    uint8_t mask_last = 0xFF << (7 - (right % 8));
+    if (first == last)
+        mask_first = mask_last = mask_first & mask_last;
 
-        // Red, if display supports
-        if (supportsColor(RED)) {
-            page_red[byte_offset] &= bitmask;
-            page_red[byte_offset] |= (color >> 1) << bit_offset;
+    for (uint16_t row = top; row <= bottom; row++) {
+        page[first] = (page[first] & ~mask_first) | (value & mask_first);
+        if (last != first) {
+            memset(page + first + 1, value, last - first - 1);
+            page[last] = (page[last] & ~mask_last) | (value & mask_last);
         }
+        first += stride;
+        last += stride;
     }
 }
 
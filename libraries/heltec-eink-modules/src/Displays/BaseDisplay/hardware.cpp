@@ -12,6 +12,10 @@ void BaseDisplay::grabPageMemory() {
 
     if (supportsColor(RED))     // Only if 3-color display
         page_red = new uint8_t[page_bytecount];
+
+    // writePage() sends these, unless an async update has swapped in its copy
+    tx_black = page_black;
+    tx_red = page_red;
 }
 
 // Free pagefile memory
@@ -44,6 +48,67 @@ void BaseDisplay::sendData(uint8_t data) {
     display_spi->endTransaction();
 }
 
+// Send a span of data: one transaction, D/C and CS set once, rather than once per byte
+void BaseDisplay::sendData(const uint8_t *data, uint16_t length) {
+    display_spi->beginTransaction(spi_settings);
+    digitalWrite(pin_dc, HIGH);
+    digitalWrite(pin_cs, LOW);
+
+    #if CAN_WRITE_BYTES
+        display_spi->writeBytes(data, length);      // Bulk write, leaves the pagefile intact
+    #else
+        for (uint16_t i = 0; i < length; i++)
+            display_spi->transfer(data[i]);
+    #endif
+
+    digitalWrite(pin_cs, HIGH);
+    display_spi->endTransaction();
+}
+
+// Send a span of data from PROGMEM (LUTs), as one transaction
+void BaseDisplay::sendData_P(const uint8_t *data, uint16_t length) {
+    display_spi->beginTransaction(spi_settings);
+    digitalWrite(pin_dc, HIGH);
+    digitalWrite(pin_cs, LOW);
+
+    uint8_t chunk[16];
+    for (uint16_t i = 0; i < length; i += sizeof(chunk)) {
+        uint16_t n = min((uint16_t)(length - i), (uint16_t)sizeof(chunk));
+        for (uint16_t j = 0; j < n; j++)
+            chunk[j] = pgm_read_byte_near(data + i + j);
+
+        #if CAN_WRITE_BYTES
+            display_spi->writeBytes(chunk, n);
+        #else
+            for (uint16_t j = 0; j < n; j++)
+                display_spi->transfer(chunk[j]);
+        #endif
+    }
+
+    digitalWrite(pin_cs, HIGH);
+    display_spi->endTransaction();
+}
+
+// Send the same byte `count` times, as one transaction (blank image data)
+void BaseDisplay::sendDataFill(uint8_t value, uint16_t count) {
+    display_spi->beginTransaction(spi_settings);
+    digitalWrite(pin_dc, HIGH);
+    digitalWrite(pin_cs, LOW);
+
+    #if CAN_WRITE_BYTES
+        uint8_t chunk[32];
+        memset(chunk, value, sizeof(chunk));
+        for (uint16_t i = 0; i < count; i += sizeof(chunk))
+            display_spi->writeBytes(chunk, min((uint16_t)(count - i), (uint16_t)sizeof(chunk)));
+    #else
+        for (uint16_t i = 0; i < count; i++)
+            display_spi->transfer(value);
+    #endif
+
+    digitalWrite(pin_cs, HIGH);
+    display_spi->endTransaction();
+}
+
 // Reset the display
 void BaseDisplay::reset() {
     // On all-in-one platforms: ensure peripheral power is on, then briefly pull the display's reset pin to ground
@@ -59,13 +124,79 @@ void BaseDisplay::reset() {
     wait();
 }
 
+// Is the display hardware busy? Commands sent now would be discarded
+bool BaseDisplay::isBusy() {
+    return digitalRead(pin_busy) == busy_level;
+}
+
 // Wait until the display hardware is idle. Important as any commands made while "busy" will be discarded.
 void BaseDisplay::wait() {
-    while(digitalRead(pin_busy) == HIGH) {      // Pin is HIGH when busy
+    busy_timed_out = false;
+    if (!isBusy())
+        return;
+
+    #if CAN_WAIT_ON_INTERRUPT
+        // Block on a semaphore, given by the BUSY edge. Meanwhile the core runs other tasks, or idles (light sleep, if power management allows)
+        if (!busy_signal)
+            busy_signal = xSemaphoreCreateBinary();
+
+        if (busy_signal) {
+            xSemaphoreTake(busy_signal, 0);     // Discard any stale edge
+            attachInterruptArg(digitalPinToInterrupt(pin_busy), busyISR, this, (busy_level == HIGH) ? FALLING : RISING);
+
+            // Re-check: display may have finished before the interrupt was armed
+            bool idle = !isBusy() || xSemaphoreTake(busy_signal, busy_timeout ? pdMS_TO_TICKS(busy_timeout) : portMAX_DELAY) == pdTRUE;
+
+            detachInterrupt(digitalPinToInterrupt(pin_busy));
+            if (!idle && isBusy())
+                busy_timed_out = true;
+            return;
+        }
+    #endif
+
+    // Poll the pin
+    uint32_t start = millis();
+    while (isBusy()) {
+        if (busy_timeout && millis() - start >= busy_timeout) {
+            busy_timed_out = true;
+            return;
+        }
         yield();
     }
 }
 
+#if CAN_WAIT_ON_INTERRUPT
+    void IRAM_ATTR BaseDisplay::busyISR(void *display) {
+        BaseDisplay *self = (BaseDisplay*) display;
+        BaseType_t woken = pdFALSE;
+        xSemaphoreGiveFromISR(self->busy_signal, &woken);
+        if (woken)
+            portYIELD_FROM_ISR();
+    }
+#endif
+
+void BaseDisplay::setBusyTimeout(uint32_t ms) {
+    busy_timeout = ms;
+}
+
+// Did the last wait() give up on the display? The display (or its wiring) has likely failed
+bool BaseDisplay::busyTimedOut() {
+    return busy_timed_out;
+}
+
+// Set a function to call after every refresh: update(), clear(), DRAW() loops, and SD card images
+void BaseDisplay::onRefreshComplete(UpdateCallback on_refresh, void *context) {
+    refresh_done = on_refresh;
+    refresh_context = context;
+}
+
+// Refresh the display, then notify
+void BaseDisplay::refresh() {
+    activate();
+    if (refresh_done)
+        refresh_done(refresh_context);
+}
+
 // Write one page to the panel memory
 void BaseDisplay::writePage() {
 
@@ -101,19 +232,17 @@ void BaseDisplay::setMemoryArea(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t
     sendData(0x03);
 
     // Inform the panel hardware of our chosen memory location
+    const uint8_t x_range[] = {(uint8_t) sx, (uint8_t) ex};
+    const uint8_t y_range[] = {sy1, sy2, ey1, ey2};
+    const uint8_t y_cursor[] = {sy1, sy2};
     sendCommand(0x44);  // Memory X start - end
-    sendData(sx);
-    sendData(ex);
+    sendData(x_range, sizeof(x_range));
     sendCommand(0x45);  // Memory Y start - end
-    sendData(sy1);
-    sendData(sy2);
-    sendData(ey1);
-    sendData(ey2);
+    sendData(y_range, sizeof(y_range));
     sendCommand(0x4E);  // Memory cursor X
     sendData(sx);
     sendCommand(0x4F);  // Memory cursor y
-    sendData(sy1);
-    sendData(sy2);
+    sendData(y_cursor, sizeof(y_cursor));
 }
 
 // Prepare display controller to receive image data, then transfer
@@ -125,21 +254,18 @@ void BaseDisplay::sendImageData() {
 
         // Send black
         sendCommand(0x24);   // Write "BLACK" memory
-        for (uint16_t i = 0; i < pagefile_length; i++)
-            sendData(page_black[i]);
+        sendData(tx_black, pagefile_length);
 
         // If supports red, send red
         if ( supportsColor(RED) ) {   // If 3-Color red display
             sendCommand(0x26);          // Write memory for red(1)/white (0)
-            for (uint16_t i = 0; i < pagefile_length; i++)
-                sendData(page_red[i]);
+            sendData(tx_red, pagefile_length);
         }
 
         // If mono, send black data to red memory, for future partial refresh (differential update)
         else {
-            sendCommand(0x26);   
-                for (uint16_t i = 0; i < pagefile_length; i++)
-                    sendData(page_black[i]);            
+            sendCommand(0x26);
+            sendData(tx_black, pagefile_length);
         }
     }
 
@@ -149,8 +275,7 @@ void BaseDisplay::sendImageData() {
     else if (!fastmode_secondpass) {
         // Send black
         sendCommand(0x24);   // Write "BLACK" memory
-        for (uint16_t i = 0; i < pagefile_length; i++)
-            sendData(page_black[i]);
+        sendData(tx_black, pagefile_length);
     }
 
     // IF Fastmode OFF - second pass
@@ -158,8 +283,7 @@ void BaseDisplay::sendImageData() {
     else {
         // Send black data to red memory, for differential update
         sendCommand(0x26);
-        for (uint16_t i = 0; i < pagefile_length; i++)
-            sendData(page_black[i]);
+        sendData(tx_black, pagefile_length);
     }
 }
 
@@ -178,14 +302,12 @@ void BaseDisplay::sendBlankImageData() {
 
     // Write the data
     sendCommand(0x24);   // Write "BLACK" memory
-    for (uint16_t i = 0; i < pagefile_size; i++)
-        sendData(black_byte);
+    sendDataFill(black_byte, pagefile_size);
 
     // Also write the RED memory, so long as we're not clearing in fastmode (breaks differential update)
     if (fastmode_state == OFF || fastmode_state == NOT_SET) {
         sendCommand(0x26);  // Write "RED" memory
-        for (uint16_t i = 0; i < pagefile_size; i++)
-            sendData(red_byte);
+        sendDataFill(red_byte, pagefile_size);
     }
 }
 
@@ -213,7 +335,7 @@ void BaseDisplay::clear() {
         fastmodeOff();
 
     // Trigger the display changes
-    activate();
+    refresh();
 
     // If we *didn't* want to be in Fastmode::OFF, return to original state
     if (original_state == ON)
@@ -249,13 +371,16 @@ void BaseDisplay::clearAllMemories() {
     // Manually update display, drawing on-top of existing contents
     void BaseDisplay::update() {
 
+        // Let an async update finish first
+        awaitUpdate();
+
         // Init display, if needed
         if (fastmode_state == NOT_SET)
             fastmodeOff();
 
         // Copy the local image data to the display memory, then update
         writePage();
-        activate(); 
+        refresh(); 
 
         // If fastmode setting requires, repeat
         if (fastmode_state == ON) {
@@ -314,6 +439,9 @@ void BaseDisplay::clearAllMemories() {
 
     // Send power-on signal to your custom power switching circuit, then re-init display
     void BaseDisplay::customPowerOn() {
+        // Let an async update finish first
+        awaitUpdate();
+
         // We set this to OUTPUT in customPowerOff() to prevent current leakage
         pinMode(pin_busy, INPUT);
 
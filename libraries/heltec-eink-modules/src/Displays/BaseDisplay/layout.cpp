@@ -35,6 +35,7 @@ void BaseDisplay::setRotation(int16_t r) {
     }
 
     GFX::setRotation((uint8_t) r);    // Base class method
+    selectPixelSetter();              // Rotation is fixed for drawPixel() until the next call
 
     // Re-calculate window locations, for give accurate bounds info
     setWindow(  bounds.window.left(), 
@@ -51,6 +52,7 @@ void BaseDisplay::setFlip(Flip flip) {
 
     // Store the flip property, for later internal use by GFX methods
     this->imgflip = (Flip)(flip & (Flip::HORIZONTAL | Flip::VERTICAL));
+    selectPixelSetter();
 
     // If flipping the whole screen, not within a window, recalculate bounds
     if (flip == Flip::HORIZONTAL || flip == Flip::VERTICAL)
@@ -82,6 +84,9 @@ void BaseDisplay::setWindow(uint16_t left, uint16_t top, uint16_t width, uint16_
 
 // Window update code, with exposed clear_page argument. Prevents image clear during setRotation, with PRESERVE_IMAGE
 void BaseDisplay::setWindow(uint16_t left, uint16_t top, uint16_t width, uint16_t height, bool clear_page) {
+    // An async update reads the window: let it finish first
+    awaitUpdate();
+
     uint16_t right = left + (width - 1);
     uint16_t bottom = top + (height - 1);
     window_left = left;
@@ -17,6 +17,9 @@ bool BaseDisplay::calculating() {
     // --------------------------------------
     if (page_cursor == 0) {
 
+        // Let an async update finish first
+        awaitUpdate();
+
         // Init display, if needed
         if (fastmode_state == NOT_SET) {
             fastmodeOff();
@@ -78,7 +81,7 @@ bool BaseDisplay::calculating() {
         // ----------------------------------
         if (fastmode_state == OFF || fastmode_state == TURBO) {
             if(!saving_to_sd)
-                activate(); 
+                refresh(); 
                 
             return false;
         }
@@ -91,7 +94,7 @@ bool BaseDisplay::calculating() {
 
             if (PRESERVE_IMAGE && pagefile_height == panel_height) {
                 if (!saving_to_sd) {
-                    activate();
+                    refresh();
                     fastmode_secondpass = true;
 
                     writePage();
@@ -108,7 +111,7 @@ bool BaseDisplay::calculating() {
             // First pass
             if (fastmode_secondpass == false) {
                 if (!saving_to_sd)
-                    activate(); 
+                    refresh(); 
          
                 fastmode_secondpass = true;
                 return true; // Re-calculate the whole display again
@@ -26,6 +26,9 @@ BaseDisplay::BaseDisplay(   uint8_t pin_dc,
 
 void BaseDisplay::begin() {
 
+    // Called before any other use of the display hardware: let an async update finish first
+    awaitUpdate();
+
     // Only begin() once
     if (begun)
         return;
@@ -0,0 +1,158 @@
+/*
+    File: upload.cpp
+
+        - Async update: the image is copied to a second pagefile, which a task sends and refreshes while drawing continues
+*/
+
+#include "base.h"
+
+// Upload task config
+#ifndef UPLOAD_TASK_STACK
+    #define UPLOAD_TASK_STACK       4096        // Also runs the user's on_complete callback
+#endif
+#ifndef UPLOAD_TASK_PRIORITY
+    #define UPLOAD_TASK_PRIORITY    1
+#endif
+
+#if CAN_UPLOAD_ASYNC
+
+    // Is an async update still running?
+    bool BaseDisplay::updating() {
+        return upload_busy;
+    }
+
+    // Block until the async update (if any) has finished
+    // Called before anything else reaches the display hardware, or changes what the upload task reads
+    void BaseDisplay::awaitUpdate() {
+        while (upload_busy)
+            delay(1);
+    }
+
+    // Allocate the copy of the image, once
+    bool BaseDisplay::grabUploadMemory() {
+        if (!upload_black)
+            upload_black = new uint8_t[page_bytecount];
+
+        if (supportsColor(RED) && !upload_red)     // Only if 3-color display
+            upload_red = new uint8_t[page_bytecount];
+
+        return upload_black && (upload_red || !supportsColor(RED));
+    }
+
+    // Release the copy of the image
+    void BaseDisplay::freeUploadMemory() {
+        delete[] upload_black;
+        delete[] upload_red;
+        upload_black = nullptr;
+        upload_red = nullptr;
+    }
+
+    // Create the upload task, once. It stays parked on its queue between updates
+    bool BaseDisplay::startUploadTask() {
+        if (upload_queue)
+            return true;
+
+        upload_queue = xQueueCreate(1, sizeof(uint8_t));
+        if (!upload_queue)
+            return false;
+
+        if (xTaskCreatePinnedToCore(uploadTask, "eink_upload", UPLOAD_TASK_STACK, this, UPLOAD_TASK_PRIORITY, nullptr, tskNO_AFFINITY) != pdPASS) {
+            vQueueDelete(upload_queue);
+            upload_queue = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    void BaseDisplay::uploadTask(void *display) {
+        BaseDisplay *self = (BaseDisplay*) display;
+        uint8_t job;
+        while (true) {
+            if (xQueueReceive(self->upload_queue, &job, portMAX_DELAY) == pdTRUE)
+                self->runUpload();
+        }
+    }
+
+    // Same steps as update(), but from the copy of the image
+    void BaseDisplay::runUpload() {
+        tx_black = upload_black;
+        tx_red = upload_red;
+
+        writePage();
+        refresh();
+
+        // If fastmode setting requires, repeat
+        if (fastmode_state == ON) {
+            fastmode_secondpass = true;
+            writePage();
+            endImageTxQuiet();
+            fastmode_secondpass = false;
+        }
+
+        tx_black = page_black;
+        tx_red = page_red;
+
+        // Finished: the callback may start the next update
+        UpdateCallback done = upload_done;
+        void *context = upload_context;
+        upload_busy = false;
+        if (done)
+            done(context);
+    }
+
+    #if PRESERVE_IMAGE
+        // Copy the image, hand it to the upload task, and return. The pagefile is free for drawing straight away
+        void BaseDisplay::update(UpdateCallback on_complete, void *context) {
+
+            // One async update at a time
+            awaitUpdate();
+
+            // Init display, if needed
+            if (fastmode_state == NOT_SET)
+                fastmodeOff();
+
+            // Paged, or no memory for the copy: update in the foreground
+            if (pagefile_height < panel_height || !grabUploadMemory() || !startUploadTask()) {
+                update();
+                if (on_complete)
+                    on_complete(context);
+                return;
+            }
+
+            memcpy(upload_black, page_black, page_bytecount);
+            if (supportsColor(RED))
+                memcpy(upload_red, page_red, page_bytecount);
+
+            upload_done = on_complete;
+            upload_context = context;
+            upload_busy = true;
+
+            // Track state of display memory (re:customPowerOn)
+            display_cleared = false;
+            just_restarted = false;
+
+            uint8_t job = 0;
+            xQueueSend(upload_queue, &job, portMAX_DELAY);
+        }
+    #endif
+
+#else
+
+    // No upload task on this platform: update(callback) has already finished when it returns
+    bool BaseDisplay::updating() {
+        return false;
+    }
+
+    void BaseDisplay::awaitUpdate() {}
+
+    void BaseDisplay::freeUploadMemory() {}
+
+    #if PRESERVE_IMAGE
+        void BaseDisplay::update(UpdateCallback on_complete, void *context) {
+            update();
+            if (on_complete)
+                on_complete(context);
+        }
+    #endif
+
+#endif
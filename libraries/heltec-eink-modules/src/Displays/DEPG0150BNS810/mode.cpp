@@ -8,8 +8,7 @@ void DEPG0150BNS810::configPartial() {
 
     // Load the fastmode lut
     sendCommand(0x32);
-    for(uint8_t i=0;i < sizeof(lut_partial); i++) 
-        sendData(pgm_read_byte_near(lut_partial+i));
+    sendData_P(lut_partial, sizeof(lut_partial));
     
     wait();
 
@@ -6,8 +6,7 @@ PROGMEM constexpr uint8_t DEPG0154BNS800::lut_partial[];
 void DEPG0154BNS800::configPartial() {
     // Load the fastmode LUT
     sendCommand(0x32);
-    for(uint8_t i=0;i < sizeof(lut_partial); i++) 
-        sendData(pgm_read_byte_near(lut_partial+i));
+    sendData_P(lut_partial, sizeof(lut_partial));
 
     wait();
 
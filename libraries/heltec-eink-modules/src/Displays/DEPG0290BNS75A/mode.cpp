@@ -44,8 +44,7 @@ void DEPG0290BNS75A::configPartial() {
 
     // Load the fastmode lut
     sendCommand(0x32);
-    for(uint8_t i=0;i < sizeof(lut_partial); i++) 
-        sendData(pgm_read_byte_near(lut_partial+i));
+    sendData_P(lut_partial, sizeof(lut_partial));
 
     wait();
 }
@@ -19,8 +19,7 @@ void DEPG0290BNS800::configPartial() {
 
     // Send custom LUT for partial refresh
     sendCommand(0x32);
-    for(uint8_t i=0;i < sizeof(lut_partial); i++) 
-        sendData(pgm_read_byte_near(lut_partial+i));
+    sendData_P(lut_partial, sizeof(lut_partial));
 
     wait();
 }
@@ -31,8 +31,7 @@ void GDE029A1::configFull() {
 
     // Load the Look Up Table (LUT) for full update
     sendCommand(0x32);
-    for(uint8_t i=0;i < sizeof(lut_full); i++) 
-        sendData(pgm_read_byte_near(lut_full + i));
+    sendData_P(lut_full, sizeof(lut_full));
 
     wait();
 }
@@ -64,8 +63,7 @@ void GDE029A1::configPartial() {
 
     // Load the LUT for partial update
     sendCommand(0x32);
-    for(uint8_t i=0;i < sizeof(lut_partial); i++) 
-        sendData(pgm_read_byte_near(lut_partial + i));
+    sendData_P(lut_partial, sizeof(lut_partial));
     
     wait();
 }
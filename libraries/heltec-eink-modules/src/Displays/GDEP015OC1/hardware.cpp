@@ -36,12 +36,10 @@ void GDEP015OC1::sendImageData() {
 
         // Send black
         sendCommand(0x24);   // Write "NEW" memory
-        for (uint16_t i = 0; i < pagefile_length; i++)
-            sendData(page_black[i]);
+        sendData(tx_black, pagefile_length);
 
         sendCommand(0x26);   // Write "OLD" memory
-        for (uint16_t i = 0; i < pagefile_length; i++)
-            sendData(page_black[i]);            
+        sendData(tx_black, pagefile_length);
         
     }
 
@@ -51,8 +49,7 @@ void GDEP015OC1::sendImageData() {
     else if (!fastmode_secondpass) {
         // Send black
         sendCommand(0x24);   // Write "NEW" memory
-        for (uint16_t i = 0; i < pagefile_length; i++)
-            sendData(page_black[i]);
+        sendData(tx_black, pagefile_length);
     }
 
     // IF Fastmode OFF - second pass
@@ -60,13 +57,11 @@ void GDEP015OC1::sendImageData() {
     else {
         // Send black data to "OLD" memory, for differential update
         sendCommand(0x26);
-        for (uint16_t i = 0; i < pagefile_length; i++)
-            sendData(page_black[i]);
+        sendData(tx_black, pagefile_length);
 
         // Display's controller moves NEW mem into OLD at update
         // so we need to refill it now, in case of setWindow() / fastmodeOff()
         sendCommand(0x24);   // Write "NEW" memory, AGAIN
-        for (uint16_t i = 0; i < pagefile_length; i++)
-            sendData(page_black[i]);
+        sendData(tx_black, pagefile_length);
     }
 }
\ No newline at end of file
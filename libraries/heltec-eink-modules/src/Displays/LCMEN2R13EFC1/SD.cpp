@@ -41,13 +41,13 @@ void LCMEN2R13EFC1::loadFullscreenBMP(const char* filename) {
         send24BitBMP(BLACK);
 
         // Display the result
-        activate();
+        refresh();
     }
 
     // If fastmodeON
     else if (fastmode_state == ON) {
         // Update the display first,
-        activate();        
+        refresh();        
 
         // Then send the data again, before final update
         // setMemoryArea(sx, sy, ex, ey);
@@ -50,26 +50,22 @@ void LCMEN2R13EFC1::sendImageData() {
     // Fastmode Off
     if (fastmode_state == OFF) {
         sendCommand(0x10);   // Write "BLACK / OLD" memory
-        for (uint16_t i = 0; i < byte_count; i++)
-            sendData(page_black[i]);
+        sendData(tx_black, byte_count);
 
         sendCommand(0x13);   // Write "RED / NEW" memory
-        for (uint16_t i = 0; i < byte_count; i++)
-            sendData(page_black[i]);
+        sendData(tx_black, byte_count);
     }
 
     // Fastmode - First Pass (new memory)
     else if (!fastmode_secondpass) {
         sendCommand(0x13);   // Write "RED / NEW" memory
-        for (uint16_t i = 0; i < byte_count; i++)
-            sendData(page_black[i]);
+        sendData(tx_black, byte_count);
     }
 
     // Fastmode - Second Pass (old memory)
     else {
         sendCommand(0x10);   // Write "BLACK / OLD" memory
-        for (uint16_t i = 0; i < byte_count; i++)
-            sendData(page_black[i]);
+        sendData(tx_black, byte_count);
     }
 
     wait();
@@ -84,23 +80,15 @@ void LCMEN2R13EFC1::sendBlankImageData() {
     const uint16_t byte_count = panel_height * panel_width / 8;
 
     sendCommand(0x13);   // Write "RED / NEW" memory
-    for (uint16_t i = 0; i < byte_count; i++)
-        sendData(blank_byte);
+    sendDataFill(blank_byte, byte_count);
 
 
     // Also write the OLD memory, so long as we're not clearing in fastmode
     if (fastmode_state == OFF || fastmode_state == NOT_SET) {
         sendCommand(0x10);   // Write "BLACK / OLD" memory
-        for (uint16_t i = 0; i < byte_count; i++)
-            sendData(blank_byte);
+        sendDataFill(blank_byte, byte_count);
     }
     
 
     wait();
-}
-
-// Wait until the display hardware is idle. Inverted on this display
-void LCMEN2R13EFC1::wait() {
-    while(digitalRead(pin_busy) == LOW )      // Pin is LOW when busy - this is different than the SSD display controllers
-        yield();
 }
\ No newline at end of file
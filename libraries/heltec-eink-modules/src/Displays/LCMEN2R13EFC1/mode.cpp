@@ -18,24 +18,19 @@ void LCMEN2R13EFC1::configPartial() {
 
      // Load the various LUTs
     sendCommand(0x20);                                          // VCOM
-    for(uint8_t i=0;i < sizeof(lut_partial_vcom_dc); i++) 
-        sendData(pgm_read_byte_near(lut_partial_vcom_dc + i));
+    sendData_P(lut_partial_vcom_dc, sizeof(lut_partial_vcom_dc));
     
     sendCommand(0x21);                                          // White -> White
-    for(uint8_t i=0;i < sizeof(lut_partial_ww); i++) 
-        sendData(pgm_read_byte_near(lut_partial_ww + i));
+    sendData_P(lut_partial_ww, sizeof(lut_partial_ww));
     
     sendCommand(0x22);                                          // Black -> White
-    for(uint8_t i=0;i < sizeof(lut_partial_bw); i++) 
-        sendData(pgm_read_byte_near(lut_partial_bw + i));
+    sendData_P(lut_partial_bw, sizeof(lut_partial_bw));
     
     sendCommand(0x23);                                          // White -> Black
-    for(uint8_t i=0;i < sizeof(lut_partial_wb); i++) 
-        sendData(pgm_read_byte_near(lut_partial_wb + i));
+    sendData_P(lut_partial_wb, sizeof(lut_partial_wb));
     
     sendCommand(0x24);                                          // Black -> Black
-    for(uint8_t i=0;i < sizeof(lut_partial_bb); i++) 
-        sendData(pgm_read_byte_near(lut_partial_bb + i));
+    sendData_P(lut_partial_bb, sizeof(lut_partial_bb));
 
 }
 
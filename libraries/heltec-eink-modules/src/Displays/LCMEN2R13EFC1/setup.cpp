@@ -10,6 +10,12 @@ void LCMEN2R13EFC1::init() {
 
     BaseDisplay::supported_colors = this->supported_colors;
 
+    // Busy pin is LOW when busy - this is different than the SSD display controllers
+    BaseDisplay::busy_level = LOW;
+
+    // No "partial window" support: window is drawn at its fullscreen location in the pagefile
+    BaseDisplay::window_in_place = true;
+
     // Get the Bounds subclass ready now (in constructor), so that it can be used to init. globals.
     BaseDisplay::instantiateBounds();
     
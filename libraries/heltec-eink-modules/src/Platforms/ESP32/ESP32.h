@@ -14,6 +14,9 @@
 
         // SPI
         #define CAN_MOVE_SPI_PINS       true
+        #define CAN_WRITE_BYTES         true            // SPIClass::writeBytes(): bulk writes, source buffer untouched
+        #define CAN_UPLOAD_ASYNC        true            // update(callback): a FreeRTOS task sends the image while drawing continues
+        #define CAN_WAIT_ON_INTERRUPT   true            // wait(): sleep on a semaphore until the BUSY pin edge interrupt
         #define ALL_IN_ONE              false
         #define DEFAULT_SDI             MOSI
         #define DEFAULT_CLK             SCK
@@ -14,6 +14,9 @@
 
         // SPI
         #define CAN_MOVE_SPI_PINS       false
+        #define CAN_WRITE_BYTES         false           // Bulk writes fall back to transfer() per byte
+        #define CAN_UPLOAD_ASYNC        false           // update(callback) runs synchronously
+        #define CAN_WAIT_ON_INTERRUPT   false           // wait() polls the BUSY pin
         #define ALL_IN_ONE              false
         #define DEFAULT_SDI             MOSI
         #define DEFAULT_CLK             SCK
@@ -4,51 +4,267 @@
 #include "secrets.h"    // for PREFS_NAMESPACE
 #include "app_prefs.h"
 
-Preferences prefs;
+// Blob layout: version byte, then the group's fields in visitGroup()
+// order. Fields are only ever appended, so an older blob just lacks
+// the last ones (they keep their defaults) and a newer one has extra
+// bytes at the end, which are ignored.
+#define CONFIG_VERSION 1
 
-// Read a string from NVS by key
-String readNVS(const char* key) {
-  prefs.begin(PREFS_NAMESPACE, true);  // read-only
-  String value = prefs.getString(key, "");
-  prefs.end();
-  return value;
+enum ConfigGroup {
+  GROUP_CREDENTIALS,
+  GROUP_SESSION,
+  GROUP_STATE,
+  GROUP_COUNT
+};
+
+static const char *const GROUP_KEYS[GROUP_COUNT] = {"cfg_creds", "cfg_session", "cfg_state"};
+
+// Per-key settings written by older firmware
+static const char *const LEGACY_KEYS[] = {
+  "wifi_ssid", "wifi_password", "wifi_ap", "fb_email", "fb_password",
+  "fb_id_token", "fb_uid", "fb_id_exp", "fb_refresh", "q_sync", "q_wm",
+  "ota_dl", "ota_meta", "provisioned",
+};
+
+static Preferences prefs;
+static AppConfig   cfg;
+static bool        loaded = false;
+static uint32_t    storedHash[GROUP_COUNT];   // blob in flash, 0 = none
+
+// Every field of a group, in blob order. New fields go at the end of
+// their group.
+template <typename V>
+static void visitGroup(int group, AppConfig &c, V &v) {
+  switch (group) {
+    case GROUP_CREDENTIALS:
+      v.flag(c.provisioned);
+      v.str(c.wifiSsid);
+      v.str(c.wifiPassword);
+      v.str(c.fbEmail);
+      v.str(c.fbPassword);
+      break;
+    case GROUP_SESSION:
+      v.str(c.fbIdToken);
+      v.str(c.fbUid);
+      v.i64(c.fbIdExpires);
+      v.str(c.fbRefresh);
+      break;
+    case GROUP_STATE:
+      v.str(c.wifiAp);
+      v.i64(c.quoteWatermark);
+      v.str(c.quoteSync);
+      v.str(c.otaDownload);
+      v.str(c.otaManifest);
+      break;
+  }
 }
 
-// Write a string to NVS
-void writeNVS(const char* key, const String& value) {
-  prefs.begin(PREFS_NAMESPACE, false); // read-write
-  prefs.putString(key, value);
-  prefs.end();
+// Appends fields to `buf`, or only counts their bytes when it is null
+struct BlobWriter {
+  uint8_t *buf;
+  size_t   len;
+
+  void bytes(const void *p, size_t n) {
+    if (buf) memcpy(buf + len, p, n);
+    len += n;
+  }
+  void flag(bool &b) { uint8_t v = b; bytes(&v, 1); }
+  void i64(int64_t &x) { bytes(&x, sizeof(x)); }
+  void str(String &s) {
+    uint16_t n = s.length();
+    bytes(&n, sizeof(n));
+    bytes(s.c_str(), n);
+  }
+};
+
+// Reads fields back; a field past the end keeps its value, a field cut
+// in half marks the blob bad
+struct BlobReader {
+  const uint8_t *buf;
+  size_t         len;
+  size_t         pos;
+  bool           ok;
+
+  bool take(void *p, size_t n) {
+    if (pos == len) return false;
+    if (pos + n > len) {
+      ok = false;
+      pos = len;
+      return false;
+    }
+    memcpy(p, buf + pos, n);
+    pos += n;
+    return true;
+  }
+  void flag(bool &b) {
+    uint8_t v;
+    if (take(&v, 1)) b = v != 0;
+  }
+  void i64(int64_t &x) { take(&x, sizeof(x)); }
+  void str(String &s) {
+    uint16_t n;
+    if (!take(&n, sizeof(n))) return;
+    if (pos + n > len) {
+      ok = false;
+      pos = len;
+      return;
+    }
+    s = String();
+    s.concat((const char *)buf + pos, n);
+    pos += n;
+  }
+};
+
+static uint32_t hashBlob(const uint8_t *data, size_t len) {
+  uint32_t h = 2166136261UL;
+  for (size_t i = 0; i < len; i++) {
+    h ^= data[i];
+    h *= 16777619UL;
+  }
+  return h ? h : 1;
 }
 
-// Check if the device is provisioned (Wi-Fi + Firebase creds present)
-bool isProvisioned() {
-  prefs.begin(PREFS_NAMESPACE, true);
+// Caller frees; null if out of memory
+static uint8_t *encodeGroup(int group, size_t &len) {
+  BlobWriter count = {nullptr, 1};
+  visitGroup(group, cfg, count);
+  uint8_t *buf = (uint8_t *)malloc(count.len);
+  if (!buf) return nullptr;
+  buf[0] = CONFIG_VERSION;
+  BlobWriter w = {buf, 1};
+  visitGroup(group, cfg, w);
+  len = w.len;
+  return buf;
+}
 
-  bool wifiOK = prefs.isKey("wifi_ssid") &&
-                prefs.isKey("wifi_password");
+static bool decodeGroup(int group, const uint8_t *buf, size_t len) {
+  if (len < 1 || buf[0] == 0) return false;
+  AppConfig c = cfg;
+  BlobReader r = {buf, len, 1, true};
+  visitGroup(group, c, r);
+  if (!r.ok) return false;
+  cfg = c;
+  return true;
+}
 
-  bool fbOK   = prefs.isKey("fb_email") &&
-                prefs.isKey("fb_password");
+// Not stored yet counts as stored with the defaults, so a group that
+// is never set is never written
+static void assumeDefaults(int group) {
+  size_t len = 0;
+  uint8_t *blob = encodeGroup(group, len);
+  if (blob) storedHash[group] = hashBlob(blob, len);
+  free(blob);
+}
 
-  prefs.end();
-  return wifiOK && fbOK;
+static bool readGroup(int group) {
+  size_t len = prefs.getBytesLength(GROUP_KEYS[group]);
+  if (len == 0) {
+    assumeDefaults(group);
+    return false;
+  }
+  uint8_t *buf = (uint8_t *)malloc(len);
+  bool ok = buf && prefs.getBytes(GROUP_KEYS[group], buf, len) == len &&
+            decodeGroup(group, buf, len);
+  if (ok) storedHash[group] = hashBlob(buf, len);
+  else Serial.printf("[PREFS] %s unreadable, using defaults.\n", GROUP_KEYS[group]);
+  free(buf);
+  return ok;
 }
 
-// Clear all stored credentials and provision flag
-void clearAllCredentials() {
-  prefs.begin(PREFS_NAMESPACE, false);
+static bool hasLegacyKeys() {
+  for (const char *key : LEGACY_KEYS) {
+    if (prefs.isKey(key)) return true;
+  }
+  return false;
+}
 
-  // Wi-Fi credentials
-  prefs.remove("wifi_ssid");
-  prefs.remove("wifi_password");
+static void readLegacyKeys() {
+  cfg.provisioned    = prefs.isKey("wifi_ssid") && prefs.isKey("wifi_password") &&
+                       prefs.isKey("fb_email") && prefs.isKey("fb_password");
+  cfg.wifiSsid       = prefs.getString("wifi_ssid", "");
+  cfg.wifiPassword   = prefs.getString("wifi_password", "");
+  cfg.fbEmail        = prefs.getString("fb_email", "");
+  cfg.fbPassword     = prefs.getString("fb_password", "");
+  cfg.fbIdToken      = prefs.getString("fb_id_token", "");
+  cfg.fbUid          = prefs.getString("fb_uid", "");
+  cfg.fbIdExpires    = strtoll(prefs.getString("fb_id_exp", "").c_str(), nullptr, 10);
+  cfg.fbRefresh      = prefs.getString("fb_refresh", "");
+  cfg.wifiAp         = prefs.getString("wifi_ap", "");
+  cfg.quoteWatermark = strtoll(prefs.getString("q_wm", "").c_str(), nullptr, 10);
+  cfg.quoteSync      = prefs.getString("q_sync", "");
+  cfg.otaDownload    = prefs.getString("ota_dl", "");
+  cfg.otaManifest    = prefs.getString("ota_meta", "");
+}
+
+// One read-only session for every group
+static void load() {
+  loaded = true;
+  cfg = AppConfig();
+  memset(storedHash, 0, sizeof(storedHash));
+
+  bool legacy = false;
+  if (!prefs.begin(PREFS_NAMESPACE, true)) {   // fails until the namespace exists
+    for (int g = 0; g < GROUP_COUNT; g++) assumeDefaults(g);
+  } else {
+    bool found = false;
+    for (int g = 0; g < GROUP_COUNT; g++) {
+      if (readGroup(g)) found = true;
+    }
+    if (!found && hasLegacyKeys()) {
+      readLegacyKeys();
+      legacy = true;
+    }
+    prefs.end();
+  }
+
+  // Move older firmware's keys into the blobs, then drop them
+  if (legacy && configCommit() && prefs.begin(PREFS_NAMESPACE, false)) {
+    for (const char *key : LEGACY_KEYS) prefs.remove(key);
+    prefs.end();
+    Serial.println("[PREFS] Settings moved to the grouped store.");
+  }
+}
 
-  // Firebase credentials
-  prefs.remove("fb_email");
-  prefs.remove("fb_password");
+const AppConfig &config() {
+  if (!loaded) load();
+  return cfg;
+}
 
-  // Optional: any explicit provision flag if you ever set one
-  prefs.remove("provisioned");
+AppConfig &configEdit() {
+  if (!loaded) load();
+  return cfg;
+}
 
-  prefs.end();
+bool configCommit() {
+  if (!loaded) load();
+  bool open = false, ok = true;
+  for (int g = 0; g < GROUP_COUNT; g++) {
+    size_t len = 0;
+    uint8_t *blob = encodeGroup(g, len);
+    if (!blob) {
+      ok = false;
+      continue;
+    }
+    uint32_t h = hashBlob(blob, len);
+    if (h != storedHash[g]) {   // unchanged groups are not rewritten
+      if (!open) open = prefs.begin(PREFS_NAMESPACE, false);
+      if (open && prefs.putBytes(GROUP_KEYS[g], blob, len) == len) storedHash[g] = h;
+      else ok = false;
+    }
+    free(blob);
+  }
+  if (open) prefs.end();
+  if (!ok) Serial.println("[PREFS] Saving settings failed.");
+  return ok;
+}
+
+// Check if the device is provisioned (Wi-Fi + Firebase creds present)
+bool isProvisioned() {
+  return config().provisioned;
+}
+
+// Clear all stored credentials and provision flag
+void clearAllCredentials() {
+  configEdit() = AppConfig();
+  configCommit();
 }
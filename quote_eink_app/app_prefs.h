@@ -1,19 +1,58 @@
 // app_prefs.h
+//
+// Every setting the app keeps in NVS, as one typed struct. It is read
+// once per boot (first call to config()), reads are then served from
+// RAM, and changes made through configEdit() reach flash only on
+// configCommit(): one namespace open, and only the groups that
+// actually changed are written.
+//
+// Settings are stored as three versioned blobs grouped by how often
+// they change (credentials, the Firebase session, cached state and
+// progress), so a sync checkpoint does not rewrite the credentials.
+// Per-key values left by older firmware are moved into the blobs on
+// the first boot that finds them.
 #ifndef APP_PREFS_H
 #define APP_PREFS_H
 
 #include <Arduino.h>
 
-// Read a string from NVS by key
-String readNVS(const char* key);
+struct AppConfig {
+  // Provisioning (set by the setup portal)
+  bool     provisioned;
+  String   wifiSsid;
+  String   wifiPassword;
+  String   fbEmail;
+  String   fbPassword;
 
-// Write a string to NVS
-void writeNVS(const char* key, const String& value);
+  // Firebase session
+  String   fbIdToken;
+  String   fbUid;
+  int64_t  fbIdExpires;     // epoch seconds
+  String   fbRefresh;
+
+  // Cached state and sync/OTA progress
+  String   wifiAp;          // "<BSSID>,<channel>" of the last AP
+  int64_t  quoteWatermark;  // 0 = no cached copy
+  String   quoteSync;       // unfinished full sync, see firebase_client.cpp
+  String   otaDownload;     // unfinished download, see ota_manager.cpp
+  String   otaManifest;     // validators of the last manifest
+};
+
+// Settings, loaded from NVS on the first call
+const AppConfig &config();
+
+// Settings to change; nothing is written until configCommit()
+AppConfig &configEdit();
+
+// Write the groups that differ from flash, in one NVS session.
+// False if a write failed (the RAM copy keeps the change).
+bool configCommit();
 
 // Check if the device is provisioned (Wi-Fi + Firebase creds present)
 bool isProvisioned();
 
-// Clear all stored credentials (Wi-Fi + Firebase + provision flag)
+// Clear all stored credentials (Wi-Fi + Firebase + provision flag),
+// the session and the sync/OTA progress, and commit
 void clearAllCredentials();
 
 #endif
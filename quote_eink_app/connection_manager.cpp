@@ -0,0 +1,209 @@
+// connection_manager.cpp
+
+#include "connection_manager.h"
+
+#include <WiFi.h>
+#include <WiFiClientSecure.h>
+
+#include "profiler.h"
+
+// One slot per host; the least recently used slot is recycled when a
+// new host is needed. Each open TLS connection holds ~30 KB of mbedTLS
+// buffers, so keep this small.
+#ifndef CONN_POOL_SIZE
+#define CONN_POOL_SIZE 3
+#endif
+
+// New TLS connections allowed per wake. Requests beyond the budget
+// fail instead of keeping the radio on.
+#ifndef CONN_MAX_HANDSHAKES_PER_WAKE
+#define CONN_MAX_HANDSHAKES_PER_WAKE 6
+#endif
+
+// Servers drop idle keep-alive sockets without telling us; don't try
+// to reuse a connection that has been idle longer than this.
+#ifndef CONN_IDLE_CLOSE_MS
+#define CONN_IDLE_CLOSE_MS 60000UL
+#endif
+
+struct ConnSlot {
+  WiFiClientSecure client;
+  HTTPClient       http;
+  String           host;
+  uint16_t         port = 0;
+  unsigned long    lastUsedMs = 0;
+
+  // This wake
+  uint16_t handshakes  = 0;
+  uint32_t handshakeMs = 0;
+  uint16_t requests    = 0;
+};
+
+static ConnSlot slots[CONN_POOL_SIZE];
+
+// Totals for this wake
+static uint16_t wakeHandshakes  = 0;
+static uint32_t wakeHandshakeMs = 0;
+static uint16_t wakeRequests    = 0;
+static uint16_t wakeReused      = 0;
+static uint16_t wakeFailures    = 0;
+
+// Split "https://host[:port]/path" into host and port
+static bool parseHost(const String &url, String &host, uint16_t &port) {
+  int schemeEnd = url.indexOf("://");
+  if (schemeEnd < 0) return false;
+
+  int hostStart = schemeEnd + 3;
+  int hostEnd = url.indexOf('/', hostStart);
+  if (hostEnd < 0) hostEnd = url.length();
+
+  String hostPort = url.substring(hostStart, hostEnd);
+  int colon = hostPort.indexOf(':');
+  if (colon >= 0) {
+    host = hostPort.substring(0, colon);
+    port = hostPort.substring(colon + 1).toInt();
+  } else {
+    host = hostPort;
+    port = url.startsWith("https") ? 443 : 80;
+  }
+  return host.length() > 0;
+}
+
+static void closeSlot(ConnSlot &slot) {
+  slot.http.end();
+  slot.client.stop();
+}
+
+// Slot already bound to host:port, else the least recently used one
+static ConnSlot &slotFor(const String &host, uint16_t port) {
+  ConnSlot *lru = &slots[0];
+  for (int i = 0; i < CONN_POOL_SIZE; i++) {
+    if (slots[i].host == host && slots[i].port == port) return slots[i];
+    if (slots[i].lastUsedMs < lru->lastUsedMs) lru = &slots[i];
+  }
+
+  if (lru->host.length() > 0) {
+    Serial.println("[CONN] Recycling connection to " + lru->host);
+  }
+  closeSlot(*lru);
+  lru->host        = host;
+  lru->port        = port;
+  lru->handshakes  = 0;
+  lru->handshakeMs = 0;
+  lru->requests    = 0;
+  return *lru;
+}
+
+HTTPClient *connBegin(const String &url) {
+  String host;
+  uint16_t port = 0;
+  if (!parseHost(url, host, port)) {
+    Serial.println("[CONN] Bad URL: " + url);
+    return nullptr;
+  }
+
+  ConnSlot &slot = slotFor(host, port);
+
+  bool open = slot.client.connected();
+  if (open && millis() - slot.lastUsedMs > CONN_IDLE_CLOSE_MS) {
+    closeSlot(slot);
+    open = false;
+  }
+
+  if (open) {
+    wakeReused++;
+  } else {
+    if (wakeHandshakes >= CONN_MAX_HANDSHAKES_PER_WAKE) {
+      Serial.println("[CONN] Handshake budget used, not connecting to " + host);
+      wakeFailures++;
+      return nullptr;
+    }
+
+    slot.client.setInsecure();   // TODO: load proper root CA
+    unsigned long start = millis();
+    profileEnter(PHASE_TLS);
+    bool ok = slot.client.connect(host.c_str(), port);
+    profileLeave(PHASE_TLS);
+    unsigned long elapsed = millis() - start;
+
+    wakeHandshakes++;
+    wakeHandshakeMs += elapsed;
+    slot.handshakes++;
+    slot.handshakeMs += elapsed;
+
+    Serial.printf("[CONN] TLS connect to %s: %s in %lu ms\n",
+                  host.c_str(), ok ? "OK" : "FAILED", elapsed);
+    if (!ok) {
+      wakeFailures++;
+      slot.client.stop();
+      return nullptr;
+    }
+  }
+
+  if (!slot.http.begin(slot.client, url)) {
+    Serial.println("[CONN] HTTP begin failed for " + host);
+    wakeFailures++;
+    return nullptr;
+  }
+  slot.http.setReuse(true);
+
+  slot.lastUsedMs = millis();
+  slot.requests++;
+  wakeRequests++;
+  return &slot.http;
+}
+
+void connEnd(HTTPClient *http) {
+  if (!http) return;
+  http->end();   // keeps the socket open unless the server said "close"
+
+  for (int i = 0; i < CONN_POOL_SIZE; i++) {
+    if (&slots[i].http == http) {
+      slots[i].lastUsedMs = millis();
+      break;
+    }
+  }
+}
+
+void connClose(HTTPClient *http) {
+  if (!http) return;
+  for (int i = 0; i < CONN_POOL_SIZE; i++) {
+    if (&slots[i].http == http) {
+      closeSlot(slots[i]);
+      return;
+    }
+  }
+  http->end();
+}
+
+void connBeginWake() {
+  wakeHandshakes  = 0;
+  wakeHandshakeMs = 0;
+  wakeRequests    = 0;
+  wakeReused      = 0;
+  wakeFailures    = 0;
+  for (int i = 0; i < CONN_POOL_SIZE; i++) {
+    slots[i].handshakes  = 0;
+    slots[i].handshakeMs = 0;
+    slots[i].requests    = 0;
+  }
+}
+
+void connCloseAll() {
+  for (int i = 0; i < CONN_POOL_SIZE; i++) {
+    closeSlot(slots[i]);
+  }
+}
+
+void connPrintStats() {
+  Serial.printf("[CONN] Wake: %u requests, %u TLS handshakes (%lu ms), %u reused, %u failed\n",
+                wakeRequests, wakeHandshakes, (unsigned long)wakeHandshakeMs,
+                wakeReused, wakeFailures);
+  for (int i = 0; i < CONN_POOL_SIZE; i++) {
+    const ConnSlot &slot = slots[i];
+    if (slot.requests == 0 && slot.handshakes == 0) continue;
+    Serial.printf("[CONN]   %s: %u requests, %u handshakes (%lu ms)\n",
+                  slot.host.c_str(), slot.requests, slot.handshakes,
+                  (unsigned long)slot.handshakeMs);
+  }
+}
@@ -0,0 +1,35 @@
+// connection_manager.h
+//
+// Shared keep-alive HTTPS connections, one per host (identitytoolkit,
+// firestore, raw.githubusercontent, ...). Every request in a wake goes
+// through here, so each host costs at most one TLS handshake per wake.
+#ifndef CONNECTION_MANAGER_H
+#define CONNECTION_MANAGER_H
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+
+// Begin a request to `url` on the pooled connection for its host,
+// opening (and timing) a new TLS connection if needed.
+// Returns nullptr if the connection fails or the per-wake handshake
+// budget is used up.
+HTTPClient *connBegin(const String &url);
+
+// Finish the request started by connBegin(). The connection stays
+// open for the next request to the same host.
+void connEnd(HTTPClient *http);
+
+// Finish the request and drop its connection. Use when the response
+// body was not read to the end, so the socket can't be reused.
+void connClose(HTTPClient *http);
+
+// Start of a wake/cycle: reset the handshake budget and counters
+void connBeginWake();
+
+// Close every pooled connection (end of a wake, before Wi-Fi goes down)
+void connCloseAll();
+
+// Log handshake count, handshake time and reuse per host for this wake
+void connPrintStats();
+
+#endif
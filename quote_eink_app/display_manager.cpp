@@ -1,7 +1,165 @@
 #include "display_manager.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/event_groups.h>
+#include "profiler.h"
+#include "text_layout.h"
+
+// Frames waiting for the panel. A frame posted while the queue is full
+// waits for the render task to take one.
+#ifndef DISPLAY_QUEUE_DEPTH
+#define DISPLAY_QUEUE_DEPTH 2
+#endif
+
+// The sketch (network side) runs on ARDUINO_RUNNING_CORE, core 1
+#ifndef DISPLAY_TASK_CORE
+#define DISPLAY_TASK_CORE 0
+#endif
+
+#define DISPLAY_TASK_STACK    4096
+#define DISPLAY_TASK_PRIORITY 1
+
+// A status screen followed by another frame within this long is
+// never refreshed
+#ifndef DISPLAY_COALESCE_MS
+#define DISPLAY_COALESCE_MS 1000
+#endif
+
+// A status screen replacing another status screen gets a partial
+// refresh when at most this many of the DISPLAY_BANDS bands of the
+// frame buffer changed...
+#ifndef DISPLAY_PARTIAL_MAX_BANDS
+#define DISPLAY_PARTIAL_MAX_BANDS 12
+#endif
+
+// ...and fewer than this many partial refreshes ran in a row (a full
+// refresh clears their ghosting)
+#ifndef DISPLAY_MAX_PARTIALS
+#define DISPLAY_MAX_PARTIALS 4
+#endif
+
+// Quote layouts kept (in RTC memory, about 150 bytes each)
+#ifndef DISPLAY_LAYOUT_CACHE
+#define DISPLAY_LAYOUT_CACHE 4
+#endif
+
+// Compose the next quote on the wake before it is due
+#ifndef DISPLAY_RENDER_AHEAD
+#define DISPLAY_RENDER_AHEAD 1
+#endif
+
+// Hand each frame to the driver's upload task, which sends and
+// refreshes it from a copy while the render task composes the next
+#ifndef DISPLAY_ASYNC_UPDATE
+#define DISPLAY_ASYNC_UPDATE 1
+#endif
+
+// A refresh takes 2-3 s; BUSY held much longer means a hung panel or
+// a loose cable, so stop waiting on it
+#ifndef DISPLAY_BUSY_TIMEOUT_MS
+#define DISPLAY_BUSY_TIMEOUT_MS 10000
+#endif
+
+#define DISPLAY_BANDS         16
+#define DISPLAY_FULL_MS_GUESS 2000          // until a full refresh is timed
+#define DISPLAY_RTC_MAGIC     0x44535032UL  // "DSP2"
+#define DISPLAY_SPARE_MAGIC   0x53505231UL  // "SPR1"
+#define DISPLAY_FRAME_BYTES   (LAYOUT_WIDTH * LAYOUT_HEIGHT / 8)
+
+#define DISPLAY_BIT_DONE BIT0   // a frame was handled or a refresh finished
 
 // Global display instance
-EInkDisplay_VisionMasterE290 display;
+QuoteDisplay display;
+
+enum FrameKind : uint8_t {
+  FRAME_INIT,     // begin(), landscape, optional blank refresh
+  FRAME_STATUS,
+  FRAME_QUOTE,
+  FRAME_PREPARE,  // quote composed into the spare frame, no refresh
+};
+
+// Owned by whoever holds it: the sketch until posted, then the render task
+struct Frame {
+  FrameKind kind;
+  bool      clearPanel;
+  String    id;           // quote ID, keys the layout cache
+  String    text;
+  String    author;
+  String    tagsLine;
+};
+
+static QueueHandle_t      frameQueue    = nullptr;   // Frame *
+static EventGroupHandle_t displayEvents = nullptr;
+static uint32_t           framesPosted  = 0;         // sketch side only
+static volatile uint32_t  framesDone    = 0;         // render task only
+static volatile bool      flushing      = false;     // stop holding frames back
+static volatile uint32_t  refreshesStarted = 0;      // render task only
+static volatile uint32_t  refreshesDone    = 0;      // upload task only
+
+// Survives deep sleep (the panel keeps its image); reset by power-on
+// and software restart
+struct CachedLayout {
+  uint32_t    idHash;        // 0 = empty slot
+  uint32_t    contentHash;   // text, author and tags it was made for
+  QuoteLayout layout;
+};
+
+struct DisplayRtc {
+  uint32_t     magic;
+  uint32_t     frameHash;   // frame on the panel, 0 = unknown
+  uint32_t     fullMs;      // last full refresh
+  uint8_t      nextLayout;  // slot to replace next
+  CachedLayout layouts[DISPLAY_LAYOUT_CACHE];
+};
+
+RTC_DATA_ATTR static DisplayRtc rtcDisplay;
+
+// A quote frame composed ahead of its wake. 4.7 KB: too big for RTC
+// slow memory next to the rest, so it goes in RTC fast memory, which
+// the S3 also keeps through deep sleep. Reset by power-on and software
+// restart; `bufferHash` catches anything else that wrote over it.
+struct SpareFrame {
+  uint32_t magic;
+  uint32_t idHash;
+  uint32_t contentHash;
+  uint32_t bufferHash;
+  uint32_t composeUs;   // what composing it cost, for the log
+  uint8_t  buffer[DISPLAY_FRAME_BYTES];
+};
+
+RTC_FAST_ATTR static SpareFrame spare;
+
+// The controller holds the last frame for a partial refresh only until
+// the panel loses power, so this is per boot
+static uint32_t bandHash[DISPLAY_BANDS];
+static bool     bandsValid    = false;
+static bool     statusShown   = false;   // last refresh was a status screen
+static bool     partialMode   = false;
+static uint8_t  partialsInRow = 0;
+
+// This wake, for displayPrintStats()
+static uint16_t fullCount      = 0;
+static uint16_t partialCount   = 0;
+static uint16_t identicalCount = 0;
+static uint16_t coalescedCount = 0;
+static uint16_t spareCount     = 0;   // quote frames sent from the spare
+static uint16_t timeoutCount   = 0;   // refreshes the panel never finished
+static uint32_t fullTotalMs    = 0;   // from update() to the panel going idle
+static uint32_t partialTotalMs = 0;
+
+// One refresh, as its refreshDone() sees it. The driver marks an update
+// finished before calling back, so a callback can still be running
+// when the next update starts; each update gets its own slot. Two are
+// enough: the upload task has finished the callback of update n
+// before update n + 1 finishes, and slot n is only reused at n + 2.
+struct RefreshInfo {
+  unsigned long startMs;
+  bool          partial;
+  uint32_t      hash;      // frame being refreshed
+};
+static RefreshInfo refreshInfo[2];
+static uint8_t     refreshSlot = 0;
 
 // Draw small version text (e.g. "v1.0.3") bottom-right
 static void drawVersionBadge() {
@@ -26,154 +184,439 @@ static void drawVersionBadge() {
   display.println(versionStr);
 }
 
-void displayInit() {
-  display.begin();
-  display.setRotation(1); // landscape
-  display.clearMemory();
-  display.update();
-}
-
 // Generic status screen (small text, top-left) + version badge
-void displayStatus(const String &msg) {
-  Serial.println("[DISPLAY] " + msg);
-  display.clearMemory();
+static void drawStatus(const String &msg) {
+  display.clearFrame();
+  display.setFont(nullptr);
   display.setCursor(0, 0);
   display.setTextSize(1);
   display.println(msg);
 
   // Version badge in corner
   drawVersionBadge();
-
-  display.update();
 }
 
-void displayError(const String& msg) {
-  displayStatus("Error:\n" + msg);
+static uint32_t fnv1a(uint32_t h, const uint8_t *data, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    h ^= data[i];
+    h *= 16777619UL;
+  }
+  return h;
 }
 
-// Wrap + center multiline text.
-// Uses display.width() so it respects rotation.
-static void printWrappedCentered(const String &text,
-                                 int maxCharsPerLine,
-                                 int &cursorY,
-                                 int lineHeight,
-                                 uint8_t textSize) {
-  display.setTextSize(textSize);
+static uint32_t hashString(uint32_t h, const String &s) {
+  return fnv1a(h, (const uint8_t *)s.c_str(), s.length() + 1);   // with the NUL
+}
 
-  int len = text.length();
-  int start = 0;
-  int screenWidthPx = display.width();
+static uint16_t badgeWidth() {
+  return (1 + strlen(FW_VERSION)) * 6 + 4;   // "v" + version, built-in font
+}
 
-  while (start < len) {
-    int end = start + maxCharsPerLine;
-    if (end > len) end = len;
+// Keys a quote by ID (0 = none) and by what is drawn
+static uint32_t quoteIdHash(const Frame &q) {
+  if (q.id.length() == 0) return 0;
+  uint32_t h = hashString(2166136261UL, q.id);
+  return h ? h : 1;
+}
 
-    int breakPos = end;
+static uint32_t quoteContentHash(const Frame &q) {
+  return hashString(hashString(hashString(2166136261UL, q.text), q.author), q.tagsLine);
+}
 
-    if (end < len) {
-      breakPos = text.lastIndexOf(' ', end);
-      if (breakPos <= start) {
-        breakPos = end;
-      }
+// Layout for this quote: from the cache when it was shown recently,
+// else computed and cached
+static const QuoteLayout &quoteLayout(const Frame &q) {
+  uint32_t idHash  = quoteIdHash(q);
+  uint32_t content = quoteContentHash(q);
+
+  for (int i = 0; i < DISPLAY_LAYOUT_CACHE; i++) {
+    CachedLayout &c = rtcDisplay.layouts[i];
+    if (idHash && c.idHash == idHash && c.contentHash == content) {
+      Serial.println("[DISPLAY] Layout from cache.");
+      return c.layout;
     }
+  }
 
-    String line = text.substring(start, breakPos);
-    line.trim();
+  CachedLayout &c = rtcDisplay.layouts[rtcDisplay.nextLayout];
+  rtcDisplay.nextLayout = (rtcDisplay.nextLayout + 1) % DISPLAY_LAYOUT_CACHE;
+  unsigned long start = micros();
+  layoutQuote(q.text.c_str(), q.text.length(), q.author.c_str(), q.author.length(),
+              q.tagsLine.c_str(), q.tagsLine.length(), badgeWidth(), c.layout);
+  c.idHash      = idHash;   // no ID, no reuse
+  c.contentHash = content;
+  Serial.printf("[DISPLAY] Layout: font %u, %u lines%s, %lu us\n",
+                c.layout.textFont, c.layout.lineCount,
+                c.layout.truncated ? " (cut short)" : "", micros() - start);
+  return c.layout;
+}
 
-    if (line.length() > 0) {
-      int lineLen    = line.length();
-      int charWidth  = 6 * textSize;  // approx built-in font width
-      int lineWidthPx = lineLen * charWidth;
+static void drawLine(const LayoutFont &font, const String &s, const LayoutLine &line,
+                     const char *prefix) {
+  display.setFont(font.gfx);
+  display.setTextSize(font.size);
+  display.setCursor(line.x, line.y);
+  if (prefix) display.print(prefix);
+  display.print(s.substring(line.start, line.start + line.len));
+  if (line.ellipsis) display.print("...");
+}
 
-      int startX = 0;
-      if (lineWidthPx < screenWidthPx) {
-        startX = (screenWidthPx - lineWidthPx) / 2;
-      }
+// Quote, author and tags as text_layout.h placed them (landscape)
+static void drawQuote(const Frame &q) {
+  const QuoteLayout &layout = quoteLayout(q);
+  display.clearFrame();
+  display.setTextWrap(false);
 
-      display.setCursor(startX, cursorY);
-      display.println(line);
-      cursorY += lineHeight;
-    }
+  const LayoutFont &font = layoutTextFonts[layout.textFont];
+  for (int i = 0; i < layout.lineCount; i++) {
+    drawLine(font, q.text, layout.lines[i], nullptr);
+  }
+  if (layout.author.len > 0 || layout.author.ellipsis) {
+    drawLine(layoutAuthorFonts[layout.authorFont], q.author, layout.author, "- ");
+  }
+  if (layout.tags.len > 0 || layout.tags.ellipsis) {
+    drawLine(layoutTagsFont, q.tagsLine, layout.tags, nullptr);
+  }
+
+  display.setFont(nullptr);
+  display.setTextWrap(true);
 
-    start = breakPos;
-    while (start < len && text[start] == ' ') start++;
+  // Version badge bottom-right
+  drawVersionBadge();
+}
+
+// ----------------------------------------
+// Spare frame
+// ----------------------------------------
+
+// The driver's buffer is the full frame (PRESERVE_IMAGE, unpaged) only
+// when it is the size the spare was built for
+static bool spareUsable() {
+  return DISPLAY_RENDER_AHEAD && display.frameBytes() == sizeof(spare.buffer);
+}
+
+// Compose the quote and keep the frame, leaving the panel as it is
+static void prepareQuote(const Frame &q) {
+  if (!spareUsable() || quoteIdHash(q) == 0) return;
+  uint32_t idHash  = quoteIdHash(q);
+  uint32_t content = quoteContentHash(q);
+  if (spare.magic == DISPLAY_SPARE_MAGIC && spare.idHash == idHash &&
+      spare.contentHash == content) {
+    return;   // already composed
   }
+
+  bool overlapped = display.updating();
+  unsigned long start = micros();
+  drawQuote(q);
+  uint32_t us = micros() - start;
+  memcpy(spare.buffer, display.frameBuffer(), sizeof(spare.buffer));
+  spare.idHash      = idHash;
+  spare.contentHash = content;
+  spare.bufferHash  = fnv1a(2166136261UL, spare.buffer, sizeof(spare.buffer));
+  spare.composeUs   = us;
+  spare.magic       = DISPLAY_SPARE_MAGIC;
+  Serial.printf("[DISPLAY] Next quote composed ahead (%lu us%s).\n", (unsigned long)us,
+                overlapped ? ", during the refresh" : "");
 }
 
-// Main formatted quote renderer in landscape
-void displayQuote(const String& text,
-                  const String& author,
-                  const String& tagsLine) {
-  Serial.println("[DISPLAY] Rendering formatted quote...");
-  display.clearMemory();
+// Put the spare frame in the driver's buffer if it holds this quote
+static bool takeSpare(const Frame &q) {
+  if (!spareUsable() || spare.magic != DISPLAY_SPARE_MAGIC) return false;
+  uint32_t idHash = quoteIdHash(q);
+  if (idHash == 0 || spare.idHash != idHash || spare.contentHash != quoteContentHash(q)) {
+    return false;
+  }
+  if (fnv1a(2166136261UL, spare.buffer, sizeof(spare.buffer)) != spare.bufferHash) {
+    Serial.println("[DISPLAY] Spare frame corrupt, composing.");
+    spare.magic = 0;
+    return false;
+  }
+  memcpy(display.frameBuffer(), spare.buffer, sizeof(spare.buffer));
+  spareCount++;
+  Serial.printf("[DISPLAY] Quote composed ahead, ~%lu us of drawing skipped.\n",
+                (unsigned long)spare.composeUs);
+  return true;
+}
 
-  int screenWidth  = display.width();
-  int screenHeight = display.height();
+// ----------------------------------------
+// Render task
+// ----------------------------------------
+
+// Hash the composed frame buffer in bands; returns the whole-frame hash
+static uint32_t hashFrame(uint32_t bands[DISPLAY_BANDS]) {
+  const uint8_t *buf = display.frameBuffer();
+  size_t len  = display.frameBytes();
+  size_t step = (len + DISPLAY_BANDS - 1) / DISPLAY_BANDS;
+  for (int i = 0; i < DISPLAY_BANDS; i++) {
+    size_t from = i * step < len ? i * step : len;
+    size_t to   = from + step < len ? from + step : len;
+    bands[i] = fnv1a(2166136261UL, buf + from, to - from);
+  }
+  uint32_t h = fnv1a(2166136261UL, (const uint8_t *)bands, DISPLAY_BANDS * sizeof(uint32_t));
+  return h ? h : 1;
+}
+
+static int changedBands(const uint32_t bands[DISPLAY_BANDS]) {
+  int n = 0;
+  for (int i = 0; i < DISPLAY_BANDS; i++) {
+    if (bands[i] != bandHash[i]) n++;
+  }
+  return n;
+}
+
+static uint32_t fullRefreshMs() {
+  return rtcDisplay.fullMs ? rtcDisplay.fullMs : DISPLAY_FULL_MS_GUESS;
+}
+
+// Called once the panel has the frame (on the driver's upload task)
+static void refreshDone(void *context) {
+  const RefreshInfo *info = static_cast<const RefreshInfo *>(context);
+  uint32_t ms = millis() - info->startMs;
+  if (display.busyTimedOut()) {
+    // Not a timing worth keeping, and the panel may not show the frame
+    timeoutCount++;
+    if (rtcDisplay.frameHash == info->hash) rtcDisplay.frameHash = 0;
+    Serial.printf("[DISPLAY] Panel still busy after %lu ms, gave up waiting.\n", (unsigned long)ms);
+  } else if (info->partial) {
+    partialTotalMs += ms;
+  } else {
+    fullTotalMs += ms;
+    rtcDisplay.fullMs = ms;
+  }
+  refreshesDone = refreshesDone + 1;
+  xEventGroupSetBits(displayEvents, DISPLAY_BIT_DONE);
+}
 
-  int y = 6;  // top padding
+// Refresh the panel with the composed frame, unless it already shows
+// it. `status`: small text that may take a partial refresh. Returns
+// once the frame is copied; the buffer is free for the next one.
+static void present(bool status) {
+  uint32_t bands[DISPLAY_BANDS];
+  uint32_t hash = hashFrame(bands);
+  if (hash == rtcDisplay.frameHash) {
+    identicalCount++;
+    Serial.println("[DISPLAY] Frame already on the panel, refresh skipped.");
+    return;
+  }
 
-  // 1) Quote text (big, centered, wrapped)
-  const int maxQuoteChars   = 24;   // for textSize=2
-  const int quoteLineHeight = 20;
-  printWrappedCentered(text, maxQuoteChars, y, quoteLineHeight, 2);
+  bool partial = status && statusShown && bandsValid &&
+                 partialsInRow < DISPLAY_MAX_PARTIALS &&
+                 changedBands(bands) <= DISPLAY_PARTIAL_MAX_BANDS;
+  if (partial != partialMode) {
+    if (partial) display.fastmodeOn(false);
+    else display.fastmodeOff();
+    partialMode = partial;
+  }
 
-  // Extra spacing before author
-  y += 4;
+  if (partial) {
+    partialCount++;
+    partialsInRow++;
+  } else {
+    fullCount++;
+    partialsInRow = 0;
+  }
 
-  // 2) Author (small, centered)
-  if (author.length() > 0) {
-    String authorLine = "- " + author;
+  // Timed from when the previous update is out of the way
+  display.awaitUpdate();
+  RefreshInfo *info = &refreshInfo[refreshSlot];
+  refreshSlot ^= 1;
+  info->startMs = millis();
+  info->partial = partial;
+  info->hash    = hash;
+  refreshesStarted = refreshesStarted + 1;
+  rtcDisplay.frameHash = hash;   // before refreshDone() can run
+  if (DISPLAY_ASYNC_UPDATE) {
+    display.update(refreshDone, info);
+  } else {
+    display.update();
+    refreshDone(info);
+  }
 
-    const int authorTextSize   = 1;
-    const int authorLineHeight = 12;
-    const int maxAuthorChars   = 36;
+  memcpy(bandHash, bands, sizeof(bandHash));
+  bandsValid = true;
+  statusShown = status;
+}
 
-    if (authorLine.length() > maxAuthorChars) {
-      authorLine = authorLine.substring(0, maxAuthorChars);
-    }
+// Frames that put something on the panel
+static bool shown(const Frame *frame) {
+  return frame->kind != FRAME_PREPARE;
+}
 
-    display.setTextSize(authorTextSize);
+// Screens only worth showing if nothing replaces them straight away
+static bool transient(const Frame *frame) {
+  return frame->kind == FRAME_STATUS ||
+         (frame->kind == FRAME_INIT && frame->clearPanel);
+}
 
-    int lineLen     = authorLine.length();
-    int charWidth   = 6 * authorTextSize;
-    int lineWidthPx = lineLen * charWidth;
-    int startX      = 0;
-    if (lineWidthPx < screenWidth) {
-      startX = (screenWidth - lineWidthPx) / 2;
-    }
+// The frame posted next, if it comes within DISPLAY_COALESCE_MS (and no
+// flush is waiting)
+static Frame *nextFrameSoon() {
+  Frame *next;
+  unsigned long start = millis();
+  while (true) {
+    TickType_t wait = flushing ? 0 : pdMS_TO_TICKS(10);
+    if (xQueueReceive(frameQueue, &next, wait) == pdTRUE) return next;
+    if (flushing || millis() - start >= DISPLAY_COALESCE_MS) return nullptr;
+  }
+}
+
+static void frameDone(Frame *frame) {
+  delete frame;
+  framesDone = framesDone + 1;
+  xEventGroupSetBits(displayEvents, DISPLAY_BIT_DONE);
+}
 
-    display.setCursor(startX, y);
-    display.println(authorLine);
-    y += authorLineHeight;
+// The only code that touches `display` once the task is running. Each
+// refresh runs on the driver's upload task, so this composes the next
+// frame meanwhile and only waits at the next update().
+static void renderTask(void *) {
+  if (rtcDisplay.magic != DISPLAY_RTC_MAGIC) {
+    memset(&rtcDisplay, 0, sizeof(rtcDisplay));
+    rtcDisplay.magic = DISPLAY_RTC_MAGIC;
   }
 
-  // 3) Tags line (bottom, small, centered)
-  if (tagsLine.length() > 0) {
-    const int tagsTextSize = 1;
-    display.setTextSize(tagsTextSize);
+  Frame *frame;
+  Frame *pending = nullptr;   // came in while a status screen waited
+  xQueueReceive(frameQueue, &frame, portMAX_DELAY);
+  while (true) {
+    if (frame->kind == FRAME_INIT) {
+      display.begin();
+      display.setBusyTimeout(DISPLAY_BUSY_TIMEOUT_MS);
+      display.setRotation(1); // landscape
+      if (frame->clearPanel) rtcDisplay.frameHash = 0;   // whatever is up, blank it
+    }
 
-    String t = tagsLine;
-    const int maxTagChars = 45;
-    if (t.length() > maxTagChars) {
-      t = t.substring(0, maxTagChars - 3) + "...";
+    // Superseded status screens are dropped unseen (composing ahead
+    // does not supersede anything)
+    if (transient(frame) && pending == nullptr) {
+      Frame *next = nextFrameSoon();
+      if (next && !shown(next)) {
+        pending = next;
+      } else if (next) {
+        coalescedCount++;
+        Serial.println("[DISPLAY] Superseded, not shown: " +
+                       (frame->kind == FRAME_STATUS ? frame->text : String("blank panel")));
+        frameDone(frame);
+        frame = next;
+        continue;
+      }
     }
 
-    int lineLen     = t.length();
-    int charWidth   = 6 * tagsTextSize;
-    int lineWidthPx = lineLen * charWidth;
-    int yTags       = screenHeight - 14;
+    switch (frame->kind) {
+      case FRAME_INIT:
+        if (frame->clearPanel) {
+          display.clearMemory();
+          present(false);
+        }
+        break;
+      case FRAME_STATUS:
+        drawStatus(frame->text);
+        present(true);
+        break;
+      case FRAME_QUOTE:
+        if (!takeSpare(*frame)) drawQuote(*frame);
+        present(false);
+        break;
+      case FRAME_PREPARE:
+        prepareQuote(*frame);
+        break;
+    }
+    frameDone(frame);
 
-    int startX = 0;
-    if (lineWidthPx < screenWidth) {
-      startX = (screenWidth - lineWidthPx) / 2;
+    if (pending) {
+      frame = pending;
+      pending = nullptr;
+    } else {
+      xQueueReceive(frameQueue, &frame, portMAX_DELAY);
     }
+  }
+}
 
-    display.setCursor(startX, yTags);
-    display.println(t);
+// Hand a frame to the render task; only waits while the queue is full
+static void postFrame(Frame *frame) {
+  if (frameQueue == nullptr) {
+    Serial.println("[DISPLAY] Not initialised, frame dropped.");
+    delete frame;
+    return;
   }
+  framesPosted++;
+  xQueueSend(frameQueue, &frame, portMAX_DELAY);
+}
 
-  // Version badge bottom-right
-  drawVersionBadge();
+void displayInit(bool clearPanel) {
+  PROFILE_SCOPE(PHASE_DISPLAY_INIT);
+  if (frameQueue == nullptr) {
+    frameQueue    = xQueueCreate(DISPLAY_QUEUE_DEPTH, sizeof(Frame *));
+    displayEvents = xEventGroupCreate();
+    xTaskCreatePinnedToCore(renderTask, "render", DISPLAY_TASK_STACK, nullptr,
+                            DISPLAY_TASK_PRIORITY, nullptr, DISPLAY_TASK_CORE);
+  }
+
+  Frame *frame = new Frame();
+  frame->kind       = FRAME_INIT;
+  frame->clearPanel = clearPanel;
+  postFrame(frame);
+}
+
+void displayFlush() {
+  if (frameQueue == nullptr) return;
+  PROFILE_SCOPE(PHASE_DISPLAY);
+  flushing = true;
+  while (framesDone != framesPosted || refreshesDone != refreshesStarted) {
+    xEventGroupWaitBits(displayEvents, DISPLAY_BIT_DONE, pdTRUE, pdFALSE, portMAX_DELAY);
+  }
+  flushing = false;
+}
+
+void displayPrintStats() {
+  if (frameQueue == nullptr) return;
+  // Each skipped or partial refresh would have been a full one
+  uint32_t spared = (identicalCount + coalescedCount + partialCount) * fullRefreshMs();
+  Serial.printf("[DISPLAY] Wake: %u full + %u partial refreshes (%lu ms), "
+                "%u unchanged, %u superseded, ~%lu ms saved, %u composed ahead, "
+                "%u timed out\n",
+                fullCount, partialCount, (unsigned long)(fullTotalMs + partialTotalMs),
+                identicalCount, coalescedCount,
+                (unsigned long)(spared > partialTotalMs ? spared - partialTotalMs : 0),
+                spareCount, timeoutCount);
+}
+
+void displayPowerOff() {
+  displayFlush();
+  Platform::VExtOff();
+}
+
+void displayStatus(const String &msg) {
+  PROFILE_SCOPE(PHASE_DISPLAY);
+  Serial.println("[DISPLAY] " + msg);
+  Frame *frame = new Frame();
+  frame->kind = FRAME_STATUS;
+  frame->text = msg;
+  postFrame(frame);
+}
+
+void displayError(const String& msg) {
+  displayStatus("Error:\n" + msg);
+}
+
+void displayQuote(const Quote &quote) {
+  PROFILE_SCOPE(PHASE_DISPLAY);
+  Serial.println("[DISPLAY] Rendering formatted quote...");
+  Frame *frame = new Frame();
+  frame->kind     = FRAME_QUOTE;
+  frame->id       = quote.id;
+  frame->text     = quote.text;
+  frame->author   = quote.author;
+  frame->tagsLine = quote.tagsLine;
+  postFrame(frame);
+}
 
-  display.update();
+void displayPrepareQuote(const Quote &quote) {
+  if (!DISPLAY_RENDER_AHEAD) return;
+  Frame *frame = new Frame();
+  frame->kind     = FRAME_PREPARE;
+  frame->id       = quote.id;
+  frame->text     = quote.text;
+  frame->author   = quote.author;
+  frame->tagsLine = quote.tagsLine;
+  postFrame(frame);
 }
@@ -1,15 +1,66 @@
+// display_manager.h
+//
+// The panel is driven by a render task on the other core. The calls
+// below only queue a frame (DISPLAY_QUEUE_DEPTH deep) and return, so
+// Wi-Fi, TLS and the sync run while the panel refreshes; a call waits
+// only when the queue is full. displayFlush() waits for the panel.
+// The render task in turn hands each refresh to the driver's upload
+// task (update() with a callback), which sends a copy of the frame,
+// so the next frame is composed while the panel refreshes. That task
+// sleeps on the BUSY pin's interrupt until the refresh ends, and gives
+// up after DISPLAY_BUSY_TIMEOUT_MS (the frame then counts as unknown).
+//
+// The render task refreshes as little as it can: a status screen that
+// another frame replaces within DISPLAY_COALESCE_MS is dropped, a
+// frame whose buffer hashes the same as the panel's image is skipped
+// (across deep sleep too), and small status-to-status changes take a
+// partial refresh.
+//
+// displayPrepareQuote() composes the quote due on the next wake into a
+// spare frame kept in RTC memory; when that quote comes up, its frame
+// is copied into the driver's buffer and sent, with no layout or
+// drawing on the wake.
 #ifndef DISPLAY_MANAGER_H
 #define DISPLAY_MANAGER_H
 
 #include <Arduino.h>
 #include <heltec-eink-modules.h>
 #include "secrets.h"
+#include "quote_stream.h"   // Quote
 
-// Global display object (defined in display_manager.cpp)
-extern EInkDisplay_VisionMasterE290 display;
+// The panel driver, with the composed frame buffer open so the render
+// task can tell whether a frame changes anything, and swap in a frame
+// composed earlier
+class QuoteDisplay : public EInkDisplay_VisionMasterE290 {
+public:
+  // Blank the frame buffer only. clearMemory() also blanks the
+  // controller's RAM, which waits for a refresh in progress; update()
+  // rewrites that RAM anyway.
+  void clearFrame() { clearPageWindow(); }
+  uint8_t *frameBuffer() { return page_black; }
+  const uint8_t *frameBuffer() const { return page_black; }
+  size_t frameBytes() const { return page_bytecount; }
+};
 
-// Initialize E-Ink display (landscape, cleared)
-void displayInit();
+// Global display object (defined in display_manager.cpp); only the
+// render task may touch it after displayInit()
+extern QuoteDisplay display;
+
+// Start the render task and initialize E-Ink display (landscape).
+// `clearPanel` blanks the panel; skip it on a deep-sleep wake so the
+// last quote stays up.
+void displayInit(bool clearPanel = true);
+
+// Block until every queued frame is on the panel (before a restart)
+void displayFlush();
+
+// Log this wake's full/partial refreshes, skipped frames and the
+// refresh time they saved (after a flush)
+void displayPrintStats();
+
+// Flush, then cut power to the panel before deep sleep (the image is
+// retained)
+void displayPowerOff();
 
 // Generic status screen (small text, top-left) with version badge
 void displayStatus(const String &msg);
@@ -17,9 +68,12 @@ void displayStatus(const String &msg);
 // Show error message in a consistent way
 void displayError(const String &msg);
 
-// Render a nicely formatted quote + author + tags
-void displayQuote(const String &text,
-                  const String &author,
-                  const String &tagsLine);
+// Render a quote + author + tags, laid out by text_layout.h in the
+// largest font that fits. Layouts are cached by quote ID.
+void displayQuote(const Quote &quote);
+
+// Compose `quote` ahead of time, without refreshing, for a later
+// displayQuote() of the same quote (the next one in the rotation)
+void displayPrepareQuote(const Quote &quote);
 
 #endif
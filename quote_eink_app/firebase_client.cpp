@@ -3,7 +3,6 @@
 #include "firebase_client.h"
 
 #include <WiFi.h>
-#include <WiFiClientSecure.h>
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
 
@@ -11,27 +10,77 @@
 #include "app_prefs.h"
 #include "provisioning.h"    // 🔹 Needed for startProvisioning()
 #include "display_manager.h" // displayStatus, displayError, displayQuote
-
-// Firebase Auth state (REST-based)
-static String firebaseIdToken;          // ID token (Authorization: Bearer ...)
-static String firebaseRefreshToken;     // Not used yet
-static unsigned long firebaseTokenExpiryMs = 0;  // millis() when token expires
-static String firebaseUserUid;          // localId returned by signInWithPassword
-
-// Clear saved Firebase creds in NVS and in-memory state
+#include "quote_stream.h"    // parseQuoteList
+#include "quote_cache.h"     // sync target
+#include "connection_manager.h" // connBegin, connEnd
+#include "token_manager.h"   // AuthTokens, cached across sleep/reboot
+#include "rtc_clock.h"       // clockSetFromHttpDate, clockNow
+#include "profiler.h"
+
+// Firebase Auth state (REST-based), loaded from the token cache on first use
+static AuthTokens auth;
+static bool authLoaded = false;
+
+// Clear saved Firebase creds in NVS and in-memory state (one commit,
+// with the session)
 static void clearFirebaseCredentials() {
   Serial.println("[FIREBASE] Clearing saved credentials from NVS");
-  writeNVS("fb_email", "");
-  writeNVS("fb_password", "");
-  firebaseIdToken = "";
-  firebaseUserUid = "";
-  firebaseTokenExpiryMs = 0;
+  AppConfig &cfg = configEdit();
+  cfg.fbEmail    = "";
+  cfg.fbPassword = "";
+  tokensClear();
+  auth = AuthTokens();
+}
+
+// Take the tokens from a signInWithPassword / securetoken response and
+// persist them. The response Date header sets the clock, so the expiry
+// is absolute and survives deep sleep.
+static bool storeTokenResponse(const String &date, const String &resp,
+                               const char *idKey, const char *refreshKey,
+                               const char *uidKey, const char *expiresKey) {
+  clockSetFromHttpDate(date);
+
+  JsonDocument respDoc;
+  DeserializationError jsonErr = deserializeJson(respDoc, resp);
+  if (jsonErr) {
+    String err = "JSON error: ";
+    err += jsonErr.c_str();
+    Serial.println("[FIREBASE] " + err);
+    return false;
+  }
+
+  AuthTokens tokens;
+  tokens.idToken      = respDoc[idKey].as<String>();
+  tokens.refreshToken = respDoc[refreshKey].as<String>();
+  tokens.uid          = respDoc[uidKey].as<String>();
+  String expiresInStr = respDoc[expiresKey].as<String>();
+
+  if (tokens.idToken.isEmpty() || tokens.uid.isEmpty()) {
+    Serial.println("[FIREBASE] Missing ID token or UID.");
+    return false;
+  }
+
+  unsigned long expiresSec = expiresInStr.toInt();
+  if (expiresSec == 0) {
+    expiresSec = 3600;
+  }
+  tokens.expiresAt = clockNow() + expiresSec;
+
+  auth = tokens;
+  tokensSave(auth);
+
+  Serial.print("[FIREBASE] UID: ");
+  Serial.println(auth.uid);
+  Serial.print("[FIREBASE] Token expires in ~");
+  Serial.print(expiresSec);
+  Serial.println(" seconds.");
+  return true;
 }
 
 // Perform REST sign-in with email/password stored in NVS
 static bool firebaseSignIn() {
-  String fbEmail    = readNVS("fb_email");
-  String fbPassword = readNVS("fb_password");
+  String fbEmail    = config().fbEmail;
+  String fbPassword = config().fbPassword;
 
   if (fbEmail.isEmpty() || fbPassword.isEmpty()) {
     Serial.println("[FIREBASE] No email/password stored. Starting provisioning...");
@@ -52,17 +101,14 @@ static bool firebaseSignIn() {
     String("https://identitytoolkit.googleapis.com/v1/accounts:signInWithPassword?key=") +
     FIREBASE_API_KEY;
 
-  WiFiClientSecure client;
-  client.setInsecure();   // TODO: load proper root CA
-
-  HTTPClient http;
-  if (!http.begin(client, url)) {
+  HTTPClient *http = connBegin(url);
+  if (!http) {
     Serial.println("[FIREBASE] HTTP begin failed");
     displayError("Firebase HTTP init failed");
     return false;
   }
 
-  DynamicJsonDocument payloadDoc(512);
+  JsonDocument payloadDoc;
   payloadDoc["email"] = fbEmail;
   payloadDoc["password"] = fbPassword;
   payloadDoc["returnSecureToken"] = true;
@@ -70,17 +116,19 @@ static bool firebaseSignIn() {
   String body;
   serializeJson(payloadDoc, body);
 
-  http.addHeader("Content-Type", "application/json");
+  const char *headerKeys[] = {"Date"};
+  http->collectHeaders(headerKeys, 1);
+  http->addHeader("Content-Type", "application/json");
   Serial.println("[FIREBASE] POST signInWithPassword...");
-  int httpCode = http.POST(body);
+  int httpCode = http->POST(body);
 
   if (httpCode != HTTP_CODE_OK) {
     String err = "[FIREBASE] HTTP error: " + String(httpCode);
     Serial.println(err);
-    String resp = http.getString();
+    String resp = http->getString();
     Serial.println("[FIREBASE] Response:");
     Serial.println(resp);
-    http.end();
+    connEnd(http);
 
     displayError("Firebase login failed.\nRe-enter credentials.");
     clearFirebaseCredentials();
@@ -88,177 +136,694 @@ static bool firebaseSignIn() {
     startProvisioning();  // never returns (new credentials)
   }
 
-  String resp = http.getString();
-  http.end();
-
-  Serial.println("[FIREBASE] Response payload:");
-  Serial.println(resp);
+  String resp = http->getString();
+  String date = http->header("Date");
+  connEnd(http);
 
-  DynamicJsonDocument respDoc(2048);
-  DeserializationError jsonErr = deserializeJson(respDoc, resp);
-  if (jsonErr) {
-    String err = "JSON error: ";
-    err += jsonErr.c_str();
-    Serial.println("[FIREBASE] " + err);
-    displayError("Firebase JSON error.");
+  if (!storeTokenResponse(date, resp, "idToken", "refreshToken", "localId", "expiresIn")) {
+    displayError("Firebase login invalid.");
     return false;
   }
 
-  firebaseIdToken      = respDoc["idToken"].as<String>();
-  firebaseRefreshToken = respDoc["refreshToken"].as<String>();
-  firebaseUserUid      = respDoc["localId"].as<String>();
-  String expiresInStr  = respDoc["expiresIn"].as<String>();
+  Serial.println("[FIREBASE] Sign-in OK.");
+  return true;
+}
+
+// Exchange the refresh token for a new ID token (securetoken endpoint).
+// Sets `rejected` if the refresh token itself is no longer valid.
+static bool firebaseRefresh(bool &rejected) {
+  rejected = false;
 
-  if (firebaseIdToken.isEmpty() || firebaseUserUid.isEmpty()) {
-    Serial.println("[FIREBASE] Missing idToken or localId.");
-    displayError("Firebase login invalid.");
+  String url =
+    String("https://securetoken.googleapis.com/v1/token?key=") + FIREBASE_API_KEY;
+
+  HTTPClient *http = connBegin(url);
+  if (!http) {
+    Serial.println("[FIREBASE] HTTP begin failed");
     return false;
   }
 
-  unsigned long expiresSec = expiresInStr.toInt();
-  if (expiresSec == 0) {
-    expiresSec = 3600;
-  }
+  String body = "grant_type=refresh_token&refresh_token=" + auth.refreshToken;
 
-  firebaseTokenExpiryMs = millis() + (expiresSec - 60) * 1000UL;
+  const char *headerKeys[] = {"Date"};
+  http->collectHeaders(headerKeys, 1);
+  http->addHeader("Content-Type", "application/x-www-form-urlencoded");
+  Serial.println("[FIREBASE] POST token refresh...");
+  int httpCode = http->POST(body);
 
-  Serial.println("[FIREBASE] Sign-in OK.");
-  Serial.print("[FIREBASE] UID: ");
-  Serial.println(firebaseUserUid);
-  Serial.print("[FIREBASE] Token expires in ~");
-  Serial.print(expiresSec);
-  Serial.println(" seconds.");
+  String resp = http->getString();
+  String date = http->header("Date");
+  connEnd(http);
 
+  if (httpCode != HTTP_CODE_OK) {
+    Serial.println("[FIREBASE] Refresh HTTP error: " + String(httpCode));
+    Serial.println(resp);
+    // 400: token revoked/expired, user disabled or deleted
+    rejected = httpCode == 400 || httpCode == 401 || httpCode == 403;
+    return false;
+  }
+
+  if (!storeTokenResponse(date, resp, "id_token", "refresh_token", "user_id", "expires_in")) {
+    return false;
+  }
+
+  Serial.println("[FIREBASE] Token refreshed.");
   return true;
 }
 
 // Public API: ensure valid token (refresh if expired / missing)
 bool ensureFirebaseAuth() {
-  if (firebaseIdToken.isEmpty() || firebaseUserUid.isEmpty() ||
-      millis() > firebaseTokenExpiryMs) {
-    Serial.println("[FIREBASE] Token missing/expired. Signing in...");
-    displayStatus("Logging in to Firebase...");
-    return firebaseSignIn();
+  PROFILE_SCOPE(PHASE_AUTH);
+  if (!authLoaded) {
+    tokensLoad(auth);
+    authLoaded = true;
   }
-  return true;
-}
 
-// Build Firestore listDocuments URL for users/<UID>/quotes
-static String buildFirestoreListUrl() {
-  String url =
-    "https://firestore.googleapis.com/v1/projects/";
-  url += FIREBASE_PROJECT_ID;
-  url += "/databases/(default)/documents/users/";
-  url += firebaseUserUid;
-  url += "/quotes?pageSize=50";
-  return url;
-}
+  if (tokensFresh(auth)) {
+    return true;
+  }
 
-// Public API: fetch one random quote and display it
-void fetchAndDisplayQuote() {
-  if (WiFi.status() != WL_CONNECTED) {
-    displayError("Wi-Fi not connected.");
-    Serial.println("[QUOTE] Wi-Fi not connected.");
-    return;
+  if (auth.refreshToken.length() > 0) {
+    Serial.println("[FIREBASE] Token missing/expired. Refreshing...");
+    bool rejected = false;
+    if (firebaseRefresh(rejected)) {
+      return true;
+    }
+    if (!rejected) {
+      return false;   // network trouble: keep the refresh token for next time
+    }
+    Serial.println("[FIREBASE] Refresh token rejected.");
+    tokensClear();
+    auth = AuthTokens();
   }
 
-  if (!ensureFirebaseAuth()) {
-    Serial.println("[QUOTE] Auth failed, cannot fetch quotes.");
-    return;
+  Serial.println("[FIREBASE] No usable session. Signing in...");
+  displayStatus("Logging in to Firebase...");
+  return firebaseSignIn();
+}
+
+// ----------------------------------------
+// Quote sync
+// ----------------------------------------
+//
+// The collection is copied into the local quote cache (quote_cache.h).
+//
+// Full sync (empty cache): listDocuments pages of QUOTE_PAGE_SIZE
+// quotes are staged within a time/byte budget per wake. An unfinished
+// sync saves its resume point in NVS ("q_sync") and continues on a
+// later wake; the staged copy replaces the cache once the last page is
+// in.
+//
+// Delta sync (afterwards): Firestore cannot filter a query on a
+// document's updateTime, so the collection is listed names-only (a
+// field mask with no real fields, ~150 bytes per quote) and compared
+// against the cache and the watermark in NVS ("q_wm"). Only quotes
+// added or updated since the watermark are fetched in full (batchGet);
+// quotes missing from the listing are dropped. When nothing changed,
+// nothing is written.
+//
+// The watermark is the sync start time minus a margin, so a quote
+// edited while a sync runs is fetched again next time rather than
+// missed.
+
+#ifndef QUOTE_PAGE_SIZE
+#define QUOTE_PAGE_SIZE 50
+#endif
+
+// Names-only listing pages are small, so ask for more per page
+#ifndef QUOTE_META_PAGE_SIZE
+#define QUOTE_META_PAGE_SIZE 300
+#endif
+
+// Per-wake budget for a full sync
+#ifndef QUOTE_SYNC_BUDGET_MS
+#define QUOTE_SYNC_BUDGET_MS 15000UL
+#endif
+#ifndef QUOTE_SYNC_BUDGET_BYTES
+#define QUOTE_SYNC_BUDGET_BYTES 262144UL
+#endif
+
+// Above this many changed quotes a full sync is cheaper than batchGet
+#ifndef QUOTE_DELTA_MAX_CHANGES
+#define QUOTE_DELTA_MAX_CHANGES 200
+#endif
+
+// Allowance for clock skew and in-flight writes when setting the watermark
+#ifndef QUOTE_WATERMARK_MARGIN_S
+#define QUOTE_WATERMARK_MARGIN_S 120
+#endif
+
+// Percent-encode a query parameter value
+static String urlEncode(const String &value) {
+  static const char hex[] = "0123456789ABCDEF";
+  String out;
+  out.reserve(value.length() + 16);
+  for (unsigned int i = 0; i < value.length(); i++) {
+    char c = value[i];
+    if (isalnum((unsigned char)c) || c == '-' || c == '_' || c == '.' || c == '~') {
+      out += c;
+    } else {
+      out += '%';
+      out += hex[(c >> 4) & 0x0F];
+      out += hex[c & 0x0F];
+    }
   }
+  return out;
+}
 
-  if (firebaseUserUid.isEmpty()) {
-    displayError("No Firebase UID.");
-    Serial.println("[QUOTE] firebaseUserUid empty.");
-    return;
+// projects/<id>/databases/(default)/documents
+static String firestoreDatabasePath() {
+  String path = "projects/";
+  path += FIREBASE_PROJECT_ID;
+  path += "/databases/(default)/documents";
+  return path;
+}
+
+// Build Firestore listDocuments URL for users/<UID>/quotes.
+// `namesOnly` masks out every field ("__name__" is not a field).
+static String buildFirestoreListUrl(const String &pageToken, bool namesOnly) {
+  String url = "https://firestore.googleapis.com/v1/";
+  url += firestoreDatabasePath();
+  url += "/users/";
+  url += auth.uid;
+  url += "/quotes?pageSize=";
+  url += namesOnly ? QUOTE_META_PAGE_SIZE : QUOTE_PAGE_SIZE;
+  if (namesOnly) {
+    url += "&mask.fieldPaths=__name__";
   }
+  if (pageToken.length() > 0) {
+    url += "&pageToken=";
+    url += urlEncode(pageToken);
+  }
+  return url;
+}
+
+// Send a Firestore request (GET, or POST when `body` is given) and
+// stream its documents to `parse`. The pooled connection stays open
+// between requests, so the whole body is consumed before returning.
+typedef bool (*FirestoreParser)(Stream &in, void *parseCtx, String &err);
 
-  String url = buildFirestoreListUrl();
+static bool firestoreRequest(const String &url, const String *body,
+                             FirestoreParser parse, void *parseCtx,
+                             size_t &bytes, String &err) {
   Serial.print("[QUOTE] Requesting: ");
   Serial.println(url);
-  displayStatus("Fetching quote\nfrom Firestore...");
-
-  WiFiClientSecure client;
-  client.setInsecure();
 
-  HTTPClient http;
-  if (!http.begin(client, url)) {
-    displayError("HTTP begin failed");
-    Serial.println("[QUOTE] HTTP begin failed");
-    return;
+  HTTPClient *http = connBegin(url);
+  if (!http) {
+    err = "HTTP begin failed";
+    return false;
   }
 
-  String authHeader = "Bearer " + firebaseIdToken;
-  http.addHeader("Authorization", authHeader);
+  String authHeader = "Bearer " + auth.idToken;
+  http->addHeader("Authorization", authHeader);
+
+  const char *headerKeys[] = {"Transfer-Encoding"};
+  http->collectHeaders(headerKeys, 1);
+
+  int httpCode;
+  if (body) {
+    http->addHeader("Content-Type", "application/json");
+    httpCode = http->POST(*body);
+  } else {
+    httpCode = http->GET();
+  }
 
-  int httpCode = http.GET();
   if (httpCode != HTTP_CODE_OK) {
-    String err = "[QUOTE] HTTP error: " + String(httpCode);
-    displayError(err);
-    Serial.println(err);
-    String payload = http.getString();
+    err = "HTTP error: " + String(httpCode);
+    if (httpCode == HTTP_CODE_UNAUTHORIZED) {
+      auth.expiresAt = 0;   // revoked early: refresh on the next attempt
+    }
+    String payload = http->getString();
     Serial.println("[QUOTE] Response body:");
     Serial.println(payload);
-    http.end();
-    return;
+    connEnd(http);
+    return false;
   }
 
-  String payload = http.getString();
-  http.end();
+  bool chunked = http->header("Transfer-Encoding").equalsIgnoreCase("chunked");
+  HttpBodyStream stream(http->getStream(), http->getSize(), chunked);
 
-  Serial.println("[QUOTE] Response payload:");
-  Serial.println(payload);
+  String parseErr;
+  bool parsed = parse(stream, parseCtx, parseErr);
+  stream.drain();   // leave the connection clean for the next request
+  bytes += stream.consumed();
+  connEnd(http);
 
-  DynamicJsonDocument doc(16384);
-  DeserializationError jsonErr = deserializeJson(doc, payload);
-  if (jsonErr) {
-    String err = "JSON error: ";
-    err += jsonErr.c_str();
-    displayError(err);
-    Serial.println("[QUOTE] " + err);
-    return;
+  if (!parsed) {
+    err = "JSON error: " + parseErr;
+    return false;
   }
+  return true;
+}
 
-  JsonArray docs = doc["documents"].as<JsonArray>();
-  if (!docs || docs.size() == 0) {
-    displayError("No quotes found.");
-    Serial.println("[QUOTE] No documents found.");
-    return;
+// A listDocuments page: documents go to `visit`, the next page token
+// to `nextPageToken`
+struct ListPage {
+  QuoteVisitor visit;
+  void        *ctx;
+  String       nextPageToken;
+};
+
+static bool parseListPage(Stream &in, void *parseCtx, String &err) {
+  ListPage *page = static_cast<ListPage *>(parseCtx);
+  return parseQuoteList(in, page->visit, page->ctx, &page->nextPageToken, err);
+}
+
+struct BatchResult {
+  QuoteVisitor visit;
+  void        *ctx;
+};
+
+static bool parseBatchResult(Stream &in, void *parseCtx, String &err) {
+  BatchResult *result = static_cast<BatchResult *>(parseCtx);
+  return parseBatchGet(in, result->visit, result->ctx, err);
+}
+
+// GET one listDocuments page and stream its documents to `visit`
+static bool fetchQuotePage(const String &pageToken, bool namesOnly,
+                           QuoteVisitor visit, void *ctx,
+                           String &nextPageToken, size_t &bytes,
+                           String &err) {
+  ListPage page = {visit, ctx, String()};
+  if (!firestoreRequest(buildFirestoreListUrl(pageToken, namesOnly), nullptr,
+                        parseListPage, &page, bytes, err)) {
+    return false;
+  }
+  nextPageToken = page.nextPageToken;
+  return true;
+}
+
+// batchGet the quotes with the given IDs ('\n'-separated) and stream
+// them to `visit`
+static bool fetchQuotesById(const String &ids, QuoteVisitor visit, void *ctx,
+                            size_t &bytes, String &err) {
+  String prefix = firestoreDatabasePath() + "/users/" + auth.uid + "/quotes/";
+
+  JsonDocument req;
+  JsonArray docs = req["documents"].to<JsonArray>();
+  int start = 0;
+  while (start < (int)ids.length()) {
+    int end = ids.indexOf('\n', start);
+    if (end < 0) end = ids.length();
+    docs.add(prefix + ids.substring(start, end));
+    start = end + 1;
+  }
+  JsonArray mask = req["mask"]["fieldPaths"].to<JsonArray>();
+  mask.add("text");
+  mask.add("author");
+  mask.add("tagNames");
+
+  String body;
+  serializeJson(req, body);
+
+  String url = "https://firestore.googleapis.com/v1/" + firestoreDatabasePath() + ":batchGet";
+  BatchResult result = {visit, ctx};
+  return firestoreRequest(url, &body, parseBatchResult, &result, bytes, err);
+}
+
+// Stage every quote of a page; counts failed writes
+struct StageCtx {
+  uint32_t added  = 0;
+  uint32_t failed = 0;
+};
+
+static void visitStage(const Quote &quote, void *ctx) {
+  StageCtx *stage = static_cast<StageCtx *>(ctx);
+  if (quoteCacheStageAdd(quote)) {
+    stage->added++;
+  } else {
+    stage->failed++;
+  }
+}
+
+// Watermark of the cached copy (0 = none)
+static time_t loadWatermark() {
+  return (time_t)config().quoteWatermark;
+}
+
+static void saveWatermark(time_t wm) {
+  configEdit().quoteWatermark = wm;
+  configCommit();
+}
+
+// Watermark for a sync starting now
+static time_t syncStartWatermark() {
+  return clockIsSet() ? clockNow() - QUOTE_WATERMARK_MARGIN_S : 0;
+}
+
+// Resume point of an unfinished full sync:
+// "<staged bytes>,<pages>,<watermark>,<token>"
+static bool loadSyncState(uint32_t &stagedBytes, uint32_t &pages,
+                          time_t &wm, String &token) {
+  const String &s = config().quoteSync;
+  int c1 = s.indexOf(',');
+  int c2 = c1 < 0 ? -1 : s.indexOf(',', c1 + 1);
+  int c3 = c2 < 0 ? -1 : s.indexOf(',', c2 + 1);
+  if (c3 < 0) return false;
+  stagedBytes = s.substring(0, c1).toInt();
+  pages       = s.substring(c1 + 1, c2).toInt();
+  wm          = (time_t)atoll(s.substring(c2 + 1, c3).c_str());
+  token       = s.substring(c3 + 1);
+  return stagedBytes > 0 && token.length() > 0;
+}
+
+static void saveSyncState(uint32_t stagedBytes, uint32_t pages,
+                          time_t wm, const String &token) {
+  configEdit().quoteSync = String(stagedBytes) + "," + String(pages) + "," +
+                           String((long long)wm) + "," + token;
+  configCommit();
+}
+
+static void clearSyncState() {
+  configEdit().quoteSync = "";
+  configCommit();
+}
+
+static bool fullSync(String &err) {
+  uint32_t stagedBytes = 0, pages = 0;
+  time_t wm = 0;
+  String token;
+  bool resumed = loadSyncState(stagedBytes, pages, wm, token) &&
+                 quoteCacheStageBegin(stagedBytes);
+  if (!resumed) {
+    pages = 0;
+    token = "";
+    wm = syncStartWatermark();
+    if (!quoteCacheStageBegin(0)) {
+      err = "Cannot write quote cache.";
+      return false;
+    }
+  }
+
+  Serial.print("[QUOTE] Full sync from page ");
+  Serial.println(pages);
+
+  unsigned long start = millis();
+  size_t bytes = 0;
+  StageCtx stage;
+
+  while (true) {
+    String next;
+    if (!fetchQuotePage(token, false, visitStage, &stage, next, bytes, err)) {
+      // The page may be half staged, or the token expired: start over
+      quoteCacheStageDiscard();
+      clearSyncState();
+      return false;
+    }
+    if (stage.failed > 0) {
+      quoteCacheStageDiscard();
+      clearSyncState();
+      err = "Quote cache write failed.";
+      return false;
+    }
+    pages++;
+
+    if (next.isEmpty()) break;
+    token = next;
+
+    if (millis() - start >= QUOTE_SYNC_BUDGET_MS ||
+        bytes >= QUOTE_SYNC_BUDGET_BYTES) {
+      saveSyncState(quoteCacheStageBytes(), pages, wm, token);
+      quoteCacheStageClose();
+      Serial.printf("[QUOTE] Sync budget used after %lu pages, resuming next wake.\n",
+                    (unsigned long)pages);
+      err = "Quote sync incomplete.";
+      return false;
+    }
+  }
+
+  clearSyncState();
+  if (!quoteCacheStageCommit()) {
+    err = "Cannot write quote cache.";
+    return false;
   }
+  // Only after the commit: a stale watermark merely re-fetches
+  saveWatermark(wm);
+
+  Serial.printf("[QUOTE] Synced %lu quotes in %lu pages, %lu bytes in %lu ms\n",
+                (unsigned long)quoteCacheCount(), (unsigned long)pages,
+                (unsigned long)bytes, millis() - start);
+  return true;
+}
+
+// Cached quote, looked up by a hash of its document ID. Hashes can
+// collide, so a hit is confirmed against the ID itself.
+struct CachedId {
+  uint32_t hash;
+  uint32_t index;
+  uint32_t idAt;   // offset of the ID in DeltaCtx::cachedIds
+};
+
+// FNV-1a
+static uint32_t hashId(const String &id) {
+  uint32_t h = 2166136261UL;
+  for (unsigned int i = 0; i < id.length(); i++) {
+    h = (h ^ (uint8_t)id[i]) * 16777619UL;
+  }
+  return h;
+}
 
-  int count = docs.size();
-  int randomIndex = random(count);
-  JsonObject randomDoc = docs[randomIndex];
-
-  JsonObject fields = randomDoc["fields"];
-  String text   = fields["text"]["stringValue"]   | "";
-  String author = fields["author"]["stringValue"] | "";
-
-  String tagsLine = "";
-  if (fields.containsKey("tagNames")) {
-    JsonVariant tagsVariant = fields["tagNames"]["arrayValue"]["values"];
-    if (!tagsVariant.isNull() && tagsVariant.is<JsonArray>()) {
-      JsonArray tagArray = tagsVariant.as<JsonArray>();
-      for (JsonVariant v : tagArray) {
-        String tag = v["stringValue"].as<String>();
-        if (tag.length() > 0) {
-          if (tagsLine.length() > 0) tagsLine += "   ";
-          tagsLine += "#";
-          tagsLine += tag;
-        }
-      }
+static int compareCachedId(const void *a, const void *b) {
+  uint32_t ha = static_cast<const CachedId *>(a)->hash;
+  uint32_t hb = static_cast<const CachedId *>(b)->hash;
+  return ha < hb ? -1 : ha > hb ? 1 : 0;
+}
+
+struct DeltaCtx {
+  CachedId *ids;          // sorted by hash
+  uint32_t  cached;
+  String    cachedIds;    // cached document IDs, each ended by '\n'
+  uint8_t  *keep;         // bit per cached quote: listed and unchanged
+  time_t    since;        // watermark
+  String    changed;      // IDs to fetch, '\n'-separated
+  uint32_t  changedCount = 0;
+  uint32_t  updated      = 0;   // changed and already cached
+  uint32_t  kept         = 0;
+  uint32_t  listed       = 0;
+};
+
+static void visitCachedId(uint32_t i, const String &id, void *ctx) {
+  DeltaCtx *delta = static_cast<DeltaCtx *>(ctx);
+  delta->ids[i].hash  = hashId(id);
+  delta->ids[i].index = i;
+  delta->ids[i].idAt  = delta->cachedIds.length();
+  delta->cachedIds += id;
+  delta->cachedIds += '\n';
+}
+
+// The cached quote with document ID `id`, or nullptr
+static const CachedId *findCached(const DeltaCtx *delta, const String &id) {
+  CachedId key = {hashId(id), 0, 0};
+  const CachedId *hit = (const CachedId *)bsearch(&key, delta->ids, delta->cached,
+                                                  sizeof(CachedId), compareCachedId);
+  if (!hit) return nullptr;
+
+  // Entries with the same hash sit next to each other
+  while (hit > delta->ids && hit[-1].hash == key.hash) hit--;
+  const CachedId *end = delta->ids + delta->cached;
+  for (; hit < end && hit->hash == key.hash; hit++) {
+    const char *cachedId = delta->cachedIds.c_str() + hit->idAt;
+    if (strncmp(cachedId, id.c_str(), id.length()) == 0 && cachedId[id.length()] == '\n') {
+      return hit;
     }
   }
+  return nullptr;
+}
+
+static void visitDelta(const Quote &quote, void *ctx) {
+  DeltaCtx *delta = static_cast<DeltaCtx *>(ctx);
+  delta->listed++;
 
-  Serial.println("[QUOTE] Selected quote:");
-  Serial.println("TEXT: " + text);
-  Serial.println("AUTHOR: " + author);
-  Serial.println("TAGS: " + tagsLine);
+  const CachedId *hit = findCached(delta, quote.id);
+  time_t updated = clockParseTimestamp(quote.updateTime);
 
-  if (text.length() == 0) {
-    displayError("Quote missing text");
+  if (hit && updated != 0 && updated < delta->since) {
+    uint32_t i = hit->index;
+    if (!(delta->keep[i / 8] & (1 << (i % 8)))) {
+      delta->keep[i / 8] |= 1 << (i % 8);
+      delta->kept++;
+    }
     return;
   }
 
-  displayQuote(text, author, tagsLine);
+  // New, or updated since the watermark
+  if (hit) delta->updated++;
+  delta->changedCount++;
+  if (delta->changedCount <= QUOTE_DELTA_MAX_CHANGES) {
+    if (delta->changed.length() > 0) delta->changed += '\n';
+    delta->changed += quote.id;
+  }
+}
+
+// Returns false with an empty `err` if a full sync should be done instead
+static bool deltaSync(time_t since, String &err) {
+  unsigned long start = millis();
+  time_t wm = syncStartWatermark();
+  uint32_t cached = quoteCacheCount();
+
+  DeltaCtx delta;
+  delta.cached = cached;
+  delta.since  = since;
+  delta.ids    = (CachedId *)malloc(cached * sizeof(CachedId));
+  delta.keep   = (uint8_t *)calloc((cached + 7) / 8, 1);
+  // Firestore auto IDs are 20 characters
+  if (!delta.ids || !delta.keep || !delta.cachedIds.reserve(cached * 21)) {
+    free(delta.ids);
+    free(delta.keep);
+    Serial.println("[QUOTE] Not enough memory for a delta sync.");
+    return false;
+  }
+
+  bool ok = quoteCacheForEachId(visitCachedId, &delta);
+  qsort(delta.ids, cached, sizeof(CachedId), compareCachedId);
+
+  // 1) Names and update times of the whole collection
+  size_t bytes = 0;
+  String token;
+  while (ok) {
+    String next;
+    ok = fetchQuotePage(token, true, visitDelta, &delta, next, bytes, err);
+    if (next.isEmpty()) break;
+    token = next;
+  }
+  free(delta.ids);
+  delta.cachedIds = String();
+
+  uint32_t removed = cached - delta.kept;
+  if (ok) {
+    Serial.printf("[QUOTE] Delta: %lu listed, %lu new, %lu updated, %lu deleted, %lu bytes\n",
+                  (unsigned long)delta.listed,
+                  (unsigned long)(delta.changedCount - delta.updated),
+                  (unsigned long)delta.updated,
+                  (unsigned long)(removed - delta.updated), (unsigned long)bytes);
+  }
+
+  if (!ok || delta.changedCount > QUOTE_DELTA_MAX_CHANGES) {
+    free(delta.keep);
+    if (ok) Serial.println("[QUOTE] Too many changes, doing a full sync.");
+    return false;
+  }
+
+  // 2) Nothing changed: the cache is current
+  if (delta.changedCount == 0 && removed == 0) {
+    free(delta.keep);
+    saveWatermark(wm);
+    Serial.printf("[QUOTE] Cache up to date (%lu ms)\n", millis() - start);
+    return true;
+  }
+
+  // 3) Unchanged quotes are copied over, changed ones fetched
+  ok = quoteCacheStageBegin(0) && quoteCacheStageCopy(delta.keep);
+  free(delta.keep);
+  if (!ok) {
+    quoteCacheStageDiscard();
+    err = "Quote cache write failed.";
+    return false;
+  }
+
+  StageCtx stage;
+  String batch;
+  uint32_t inBatch = 0;
+  int pos = 0;
+  int len = delta.changed.length();
+  while (ok && pos < len) {
+    int end = delta.changed.indexOf('\n', pos);
+    if (end < 0) end = len;
+    if (batch.length() > 0) batch += '\n';
+    batch += delta.changed.substring(pos, end);
+    pos = end + 1;
+
+    if (++inBatch == QUOTE_PAGE_SIZE || pos >= len) {
+      ok = fetchQuotesById(batch, visitStage, &stage, bytes, err);
+      batch = "";
+      inBatch = 0;
+    }
+  }
+
+  if (!ok || stage.failed > 0) {
+    quoteCacheStageDiscard();
+    if (ok) err = "Quote cache write failed.";
+    return false;
+  }
+  if (!quoteCacheStageCommit()) {
+    err = "Cannot write quote cache.";
+    return false;
+  }
+  saveWatermark(wm);
+
+  Serial.printf("[QUOTE] Delta applied: %lu fetched, %lu deleted, %lu quotes, %lu bytes in %lu ms\n",
+                (unsigned long)stage.added, (unsigned long)(removed - delta.updated),
+                (unsigned long)quoteCacheCount(), (unsigned long)bytes,
+                millis() - start);
+  return true;
+}
+
+// Public API: bring the local quote cache up to date
+bool syncQuotes(String &err) {
+  PROFILE_SCOPE(PHASE_SYNC);
+  if (WiFi.status() != WL_CONNECTED) {
+    err = "Wi-Fi not connected.";
+    return false;
+  }
+
+  if (auth.uid.isEmpty()) {
+    err = "No Firebase UID.";
+    return false;
+  }
+
+  // A full sync in progress, or nothing to diff against yet
+  time_t since = loadWatermark();
+  if (quoteCacheCount() == 0 || since == 0 || config().quoteSync.length() > 0) {
+    return fullSync(err);
+  }
+
+  err = "";
+  if (deltaSync(since, err)) return true;
+  if (err.length() > 0) return false;
+  return fullSync(err);
+}
+
+// ----------------------------------------
+// Profile upload
+// ----------------------------------------
+
+// Send the wake timeline to users/<UID>/devices/<MAC> on sync wakes
+#ifndef PROFILE_UPLOAD
+#define PROFILE_UPLOAD 0
+#endif
+
+bool uploadProfileSummary() {
+  if (!PROFILE_UPLOAD || auth.uid.isEmpty()) return false;
+
+  String summary = profileSummaryJson();
+  if (summary.isEmpty()) return false;
+
+  String deviceId = WiFi.macAddress();
+  deviceId.replace(":", "");
+
+  String url = "https://firestore.googleapis.com/v1/" + firestoreDatabasePath() +
+               "/users/" + auth.uid + "/devices/" + deviceId +
+               "?updateMask.fieldPaths=fw&updateMask.fieldPaths=profile";
+
+  JsonDocument doc;
+  doc["fields"]["fw"]["stringValue"]      = FW_VERSION;
+  doc["fields"]["profile"]["stringValue"] = summary;
+  String body;
+  serializeJson(doc, body);
+
+  HTTPClient *http = connBegin(url);
+  if (!http) return false;
+  http->addHeader("Authorization", "Bearer " + auth.idToken);
+  http->addHeader("Content-Type", "application/json");
+
+  int httpCode = http->sendRequest("PATCH", body);
+  http->getString();   // drain, keep the connection reusable
+  connEnd(http);
+
+  Serial.printf("[PROF] Uploaded %u bytes of profile: HTTP %d\n", body.length(), httpCode);
+  if (httpCode != HTTP_CODE_OK) return false;
+
+  profileMarkUploaded();
+  return true;
 }
@@ -6,7 +6,13 @@
 // Ensure Firebase auth token is valid; logs in again if needed.
 bool ensureFirebaseAuth();
 
-// Fetch a random quote for the current logged-in user and display it.
-void fetchAndDisplayQuote();
+// Copy the logged-in user's quotes into the local quote cache.
+// Large collections take several wakes; returns true once the cache
+// holds the whole collection, false (reason in `err`) otherwise.
+bool syncQuotes(String &err);
+
+// Upload the wake profile summary (profiler.h) to the user's device
+// document, when built with PROFILE_UPLOAD=1. Returns true if sent.
+bool uploadProfileSummary();
 
 #endif
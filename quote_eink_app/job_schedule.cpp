@@ -0,0 +1,74 @@
+// job_schedule.cpp
+
+#include "job_schedule.h"
+
+void scheduleInit(JobSchedule &s, const uint64_t intervalMs[JOB_COUNT]) {
+  for (int i = 0; i < JOB_COUNT; i++) {
+    s.intervalMs[i] = intervalMs[i];
+    s.dueMs[i]      = 0;
+    s.rideWith[i]   = JOB_NONE;
+  }
+  s.retrying = 0;
+}
+
+// Riding jobs wait for their host unless they are being retried
+static bool ridesAlong(const JobSchedule &s, int job) {
+  return s.rideWith[job] != JOB_NONE && !(s.retrying & (1UL << job));
+}
+
+void scheduleRideWith(JobSchedule &s, SchedJob job, int host) {
+  s.rideWith[job] = (host >= 0 && host < JOB_COUNT && host != job) ? host : JOB_NONE;
+}
+
+uint64_t scheduleMsUntil(const JobSchedule &s, SchedJob job, uint64_t nowMs) {
+  return s.dueMs[job] > nowMs ? s.dueMs[job] - nowMs : 0;
+}
+
+uint32_t scheduleJobsToRun(const JobSchedule &s, uint64_t nowMs,
+                           uint64_t slackMs, uint64_t coalesceMs) {
+  uint32_t due = 0;
+  uint32_t soon = 0;
+  for (int i = 0; i < JOB_COUNT; i++) {
+    if (ridesAlong(s, i)) continue;
+    uint64_t until = scheduleMsUntil(s, (SchedJob)i, nowMs);
+    if (until <= slackMs)    due  |= 1UL << i;
+    if (until <= coalesceMs) soon |= 1UL << i;
+  }
+  uint32_t run = due ? (due | soon) : 0;
+
+  uint32_t riders = 0;
+  for (int i = 0; i < JOB_COUNT; i++) {
+    if (run & (1UL << i)) riders |= scheduleRidersOf(s, (SchedJob)i, nowMs, coalesceMs);
+  }
+  return run | riders;
+}
+
+uint32_t scheduleRidersOf(const JobSchedule &s, SchedJob host, uint64_t nowMs,
+                          uint64_t coalesceMs) {
+  uint32_t riders = 0;
+  for (int i = 0; i < JOB_COUNT; i++) {
+    if (!ridesAlong(s, i) || s.rideWith[i] != host) continue;
+    if (scheduleMsUntil(s, (SchedJob)i, nowMs) <= coalesceMs) riders |= 1UL << i;
+  }
+  return riders;
+}
+
+void scheduleMarkRun(JobSchedule &s, SchedJob job, uint64_t nowMs) {
+  s.dueMs[job] = nowMs + s.intervalMs[job];
+  s.retrying &= ~(1UL << job);
+}
+
+void scheduleRetryIn(JobSchedule &s, SchedJob job, uint64_t nowMs, uint64_t delayMs) {
+  s.dueMs[job] = nowMs + delayMs;
+  s.retrying |= 1UL << job;
+}
+
+uint64_t scheduleSleepMs(const JobSchedule &s, uint64_t nowMs, uint64_t minMs) {
+  uint64_t sleepMs = UINT64_MAX;
+  for (int i = 0; i < JOB_COUNT; i++) {
+    if (ridesAlong(s, i)) continue;
+    uint64_t until = scheduleMsUntil(s, (SchedJob)i, nowMs);
+    if (until < sleepMs) sleepMs = until;
+  }
+  return sleepMs < minMs ? minMs : sleepMs;
+}
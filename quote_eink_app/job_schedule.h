@@ -0,0 +1,63 @@
+// job_schedule.h
+//
+// Scheduling decisions for the deep-sleep duty cycle: which jobs run on
+// this wake and how long to sleep afterwards. Pure logic on a
+// caller-supplied "now" (monotonic ms), no hardware access, so it can
+// be driven from a fake clock on the host.
+#ifndef JOB_SCHEDULE_H
+#define JOB_SCHEDULE_H
+
+#include <stdint.h>
+
+enum SchedJob {
+  JOB_QUOTE,       // fetch and show a new quote
+  JOB_OTA_CHECK,   // look for new firmware
+  JOB_SYNC,        // refresh the local quote cache
+  JOB_COUNT
+};
+
+#define JOB_NONE -1
+
+struct JobSchedule {
+  uint64_t intervalMs[JOB_COUNT];
+  uint64_t dueMs[JOB_COUNT];   // 0 = due now
+  int8_t   rideWith[JOB_COUNT];   // job whose wakes this one shares, or JOB_NONE
+  uint32_t retrying;              // bitmask of jobs waiting to be retried
+};
+
+// Set the job intervals; every job is due immediately and wakes by itself
+void scheduleInit(JobSchedule &s, const uint64_t intervalMs[JOB_COUNT]);
+
+// `job` never wakes the device by itself: once due, it runs on the next
+// wake that runs `host` (JOB_NONE: wake for it as usual). A retry
+// (scheduleRetryIn) still wakes for it, so unfinished work is not held
+// back until the host's next run.
+void scheduleRideWith(JobSchedule &s, SchedJob job, int host);
+
+// Milliseconds until `job` is due (0 = due now)
+uint64_t scheduleMsUntil(const JobSchedule &s, SchedJob job, uint64_t nowMs);
+
+// Jobs to run now, as a bitmask of (1 << SchedJob).
+// A job counts as due within `slackMs` of its due time (the RTC timer
+// may wake us slightly early). When anything is due, jobs due within
+// `coalesceMs` run too, saving a separate wake for them. A riding job
+// runs only with its host, if due within `coalesceMs` by then.
+uint32_t scheduleJobsToRun(const JobSchedule &s, uint64_t nowMs,
+                           uint64_t slackMs, uint64_t coalesceMs);
+
+// Riding jobs that run with `host` on this wake: those due within
+// `coalesceMs`. For a host added after scheduleJobsToRun().
+uint32_t scheduleRidersOf(const JobSchedule &s, SchedJob host, uint64_t nowMs,
+                          uint64_t coalesceMs);
+
+// `job` ran: next due one interval from now
+void scheduleMarkRun(JobSchedule &s, SchedJob job, uint64_t nowMs);
+
+// `job` did not finish: due again after `delayMs` instead
+void scheduleRetryIn(JobSchedule &s, SchedJob job, uint64_t nowMs, uint64_t delayMs);
+
+// Time to sleep until the earliest job is due, at least `minMs`.
+// Riding jobs are left out: they wait for their host.
+uint64_t scheduleSleepMs(const JobSchedule &s, uint64_t nowMs, uint64_t minMs);
+
+#endif
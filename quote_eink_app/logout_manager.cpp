@@ -4,6 +4,7 @@
 #include "logout_manager.h"
 #include "app_prefs.h"
 #include "display_manager.h"
+#include "quote_cache.h"
 
 void deviceLogout() {
   Serial.println("[LOGOUT] Clearing all credentials and restarting...");
@@ -11,7 +12,9 @@ void deviceLogout() {
 
   // This clears Wi-Fi + Firebase credentials + "provisioned" flag
   clearAllCredentials();   // from app_prefs.cpp
+  quoteCacheClear();       // the cached quotes belong to this account
 
   delay(500);
+  displayFlush();
   ESP.restart();           // never returns
 }
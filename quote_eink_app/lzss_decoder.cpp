@@ -0,0 +1,131 @@
+// lzss_decoder.cpp
+
+#include "lzss_decoder.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+  LZ_TAG,
+  LZ_LITERAL,
+  LZ_INDEX,
+  LZ_COUNT,
+  LZ_COPY,
+};
+
+bool lzssBegin(LzssDecoder &d, uint8_t windowBits, uint8_t lookaheadBits,
+               uint32_t blockSize) {
+  memset(&d, 0, sizeof(d));
+  if (windowBits < 4 || windowBits > 15 || lookaheadBits < 2 ||
+      lookaheadBits >= windowBits || blockSize == 0) {
+    return false;
+  }
+  d.window = (uint8_t *)malloc(1UL << windowBits);
+  if (!d.window) return false;
+  d.windowMask    = (1UL << windowBits) - 1;
+  d.windowBits    = windowBits;
+  d.lookaheadBits = lookaheadBits;
+  d.blockSize     = blockSize;
+  d.state         = LZ_TAG;
+  return true;
+}
+
+void lzssEnd(LzssDecoder &d) {
+  free(d.window);
+  d.window = nullptr;
+}
+
+void lzssResume(LzssDecoder &d, uint32_t outPos, const uint8_t *history, size_t len) {
+  if (len > d.windowMask + 1) {
+    history += len - (d.windowMask + 1);
+    len = d.windowMask + 1;
+  }
+  for (size_t i = 0; i < len; i++) {
+    d.window[(outPos - len + i) & d.windowMask] = history[i];
+  }
+  d.outPos   = outPos;
+  d.bitsLeft = 0;
+  d.state    = LZ_TAG;
+  d.acc      = 0;
+  d.accBits  = 0;
+  d.copyLeft = 0;
+  d.error    = false;
+}
+
+// Collect `n` bits of the current field into d.acc. False if the input
+// ran out first; the bits read so far are kept for the next call.
+static bool takeBits(LzssDecoder &d, uint8_t n, const uint8_t *in, size_t inLen, size_t &pos) {
+  while (d.accBits < n) {
+    if (d.bitsLeft == 0) {
+      if (pos == inLen) return false;
+      d.bitByte  = in[pos++];
+      d.bitsLeft = 8;
+    }
+    uint8_t take = n - d.accBits;
+    if (take > d.bitsLeft) take = d.bitsLeft;
+    uint8_t shift = d.bitsLeft - take;
+    d.acc = (d.acc << take) | ((d.bitByte >> shift) & ((1 << take) - 1));
+    d.bitsLeft -= take;
+    d.accBits  += take;
+  }
+  return true;
+}
+
+static void emit(LzssDecoder &d, uint8_t b, uint8_t *out, size_t &outLen) {
+  d.window[d.outPos & d.windowMask] = b;
+  out[outLen++] = b;
+  d.outPos++;
+}
+
+// A token just ended: at a block boundary the rest of the byte is padding
+static void tokenDone(LzssDecoder &d) {
+  d.state = LZ_TAG;
+  if (d.outPos % d.blockSize == 0) d.bitsLeft = 0;
+}
+
+size_t lzssDecode(LzssDecoder &d, const uint8_t *in, size_t inLen, size_t &consumed,
+                  uint8_t *out, size_t outMax) {
+  size_t pos = 0;
+  size_t outLen = 0;
+
+  while (outLen < outMax && !d.error) {
+    if (d.state == LZ_COPY) {
+      while (d.copyLeft > 0 && outLen < outMax) {
+        emit(d, d.window[(d.outPos - d.copyBack) & d.windowMask], out, outLen);
+        d.copyLeft--;
+      }
+      if (d.copyLeft == 0) tokenDone(d);
+      continue;
+    }
+
+    uint8_t need = d.state == LZ_TAG     ? 1 :
+                   d.state == LZ_LITERAL ? 8 :
+                   d.state == LZ_INDEX   ? d.windowBits : d.lookaheadBits;
+    if (!takeBits(d, need, in, inLen, pos)) break;
+    uint16_t value = d.acc;
+    d.acc = 0;
+    d.accBits = 0;
+
+    switch (d.state) {
+      case LZ_TAG:
+        d.state = value ? LZ_LITERAL : LZ_INDEX;
+        break;
+      case LZ_LITERAL:
+        emit(d, (uint8_t)value, out, outLen);
+        tokenDone(d);
+        break;
+      case LZ_INDEX:
+        d.copyBack = value + 1;
+        if (d.copyBack > d.outPos) d.error = true;
+        d.state = LZ_COUNT;
+        break;
+      case LZ_COUNT:
+        d.copyLeft = value + 1;
+        d.state = LZ_COPY;
+        break;
+    }
+  }
+
+  consumed = pos;
+  return outLen;
+}
@@ -0,0 +1,59 @@
+// lzss_decoder.h
+//
+// Streaming decoder for compressed OTA images (heatshrink-style LZSS,
+// written by tools/ota_pack.py). Bits are read MSB first:
+//
+//   1 + 8 bits               literal byte
+//   0 + W bits + L bits      copy (count - 1 + 1) bytes from
+//                            (index + 1) bytes back in the output
+//
+// W and L are the window and lookahead bits (window of 2^W bytes,
+// copies of up to 2^L bytes). At every `blockSize` bytes of output the
+// stream ends a token and pads to a byte boundary, so a download can
+// resume there from a byte offset, with the window refilled from the
+// output already written.
+//
+// Pure logic on caller buffers, no hardware access; the only
+// allocation is the window.
+#ifndef LZSS_DECODER_H
+#define LZSS_DECODER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+struct LzssDecoder {
+  uint8_t  *window;
+  uint32_t  windowMask;
+  uint8_t   windowBits;
+  uint8_t   lookaheadBits;
+  uint32_t  blockSize;
+  uint32_t  outPos;       // bytes produced since the start of the image
+
+  uint8_t   bitByte;      // input byte being read
+  uint8_t   bitsLeft;     // unread bits in bitByte
+  uint8_t   state;
+  uint16_t  acc;          // bits of the current field so far
+  uint8_t   accBits;
+  uint16_t  copyBack;
+  uint16_t  copyLeft;
+  bool      error;        // copy from before the start of the output
+};
+
+// Allocate the window. `blockSize` must match the encoder.
+bool lzssBegin(LzssDecoder &d, uint8_t windowBits, uint8_t lookaheadBits,
+               uint32_t blockSize);
+
+// Free the window
+void lzssEnd(LzssDecoder &d);
+
+// Continue at block boundary `outPos`, with `history` holding the
+// output bytes just before it (up to the window size)
+void lzssResume(LzssDecoder &d, uint32_t outPos, const uint8_t *history, size_t len);
+
+// Decode from `in` into `out` until the input is used up or `outMax`
+// bytes are produced. Returns the bytes produced; `consumed` is the
+// input bytes taken, all of which may be dropped by the caller.
+size_t lzssDecode(LzssDecoder &d, const uint8_t *in, size_t inLen, size_t &consumed,
+                  uint8_t *out, size_t outMax);
+
+#endif
@@ -1,17 +1,49 @@
 #include "ota_manager.h"
 
 #include <WiFi.h>
-#include <WiFiClientSecure.h>
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
-#include <Update.h>
+#include "mbedtls/sha256.h"
 
 extern "C" {
   #include "esp_ota_ops.h"
 }
 
 #include "secrets.h"
+#include "app_prefs.h"
 #include "display_manager.h"
+#include "connection_manager.h"
+#include "lzss_decoder.h"
+#include "profiler.h"
+
+// The image is downloaded in chunks; the offset reached is saved in
+// NVS after each one, so a dropped connection (or a reset) resumes
+// with a Range request instead of starting over. Must be a multiple
+// of the 4 KB flash sector.
+#ifndef OTA_CHUNK_SIZE
+#define OTA_CHUNK_SIZE (64UL * 1024UL)
+#endif
+
+// Download attempts per check before giving up until the next one
+#ifndef OTA_MAX_ATTEMPTS
+#define OTA_MAX_ATTEMPTS 4
+#endif
+
+// Wait before retry n is n times this
+#ifndef OTA_RETRY_DELAY_MS
+#define OTA_RETRY_DELAY_MS 2000UL
+#endif
+
+#define OTA_SECTOR_SIZE 4096UL
+#define OTA_BUF_SIZE    4096
+
+// Compressed bytes read from the stream at a time when decoding
+#ifndef OTA_PACKED_READ
+#define OTA_PACKED_READ 512
+#endif
+
+#define PACKED_MAGIC       0x31534851UL   // "QHS1"
+#define PACKED_HEADER_SIZE 16
 
 // Compare "1.2.3" style semantic versions
 static bool isNewerVersion(const String &remote, const String &current) {
@@ -26,131 +58,804 @@ static bool isNewerVersion(const String &remote, const String &current) {
   return rPatch > cPatch;
 }
 
-// Actual flash to other OTA partition
-static bool performOTA(const String &binUrl) {
-  if (WiFi.status() != WL_CONNECTED) {
-    Serial.println("[OTA] Wi-Fi not connected.");
+static bool isSha256Hex(const String &s) {
+  if (s.length() != 64) return false;
+  for (unsigned int i = 0; i < s.length(); i++) {
+    if (!isxdigit((unsigned char)s[i])) return false;
+  }
+  return true;
+}
+
+static String toHex(const uint8_t *data, size_t len) {
+  static const char digits[] = "0123456789abcdef";
+  String out;
+  out.reserve(len * 2);
+  for (size_t i = 0; i < len; i++) {
+    out += digits[data[i] >> 4];
+    out += digits[data[i] & 0x0F];
+  }
+  return out;
+}
+
+// An image being downloaded: what it should be and how far we got
+struct OtaDownload {
+  const esp_partition_t *part;
+  String   url;
+  String   sha256;       // expected, lowercase hex
+  uint32_t size;
+  uint32_t offset;       // bytes written (and hashed) so far
+  uint32_t erasedTo;     // flash erased up to here, sector aligned
+  mbedtls_sha256_context hash;
+
+  // Compressed download (tools/ota_pack.py); null for the raw image
+  LzssDecoder *lz;
+  uint32_t srcSize;      // compressed bytes in the response
+  uint32_t srcOffset;    // compressed bytes decoded so far
+  bool     broken;       // bad compressed data, retrying will not help
+};
+
+// Compressed image listed in the manifest
+struct OtaPacked {
+  String   url;
+  uint32_t size;
+  uint8_t  windowBits;
+  uint8_t  lookaheadBits;
+  uint32_t blockSize;
+};
+
+// Saved progress: "<sha256>,<size>,<offset>,<srcOffset>", srcOffset
+// being 0 for the raw image. Only trusted for the same image.
+static void loadDownloadState(OtaDownload &dl) {
+  dl.offset = 0;
+  dl.srcOffset = 0;
+  const String &s = config().otaDownload;
+  int c1 = s.indexOf(',');
+  int c2 = c1 < 0 ? -1 : s.indexOf(',', c1 + 1);
+  if (c2 < 0) return;
+  if (!s.substring(0, c1).equalsIgnoreCase(dl.sha256) ||
+      (uint32_t)s.substring(c1 + 1, c2).toInt() != dl.size) {
+    return;
+  }
+  int c3 = s.indexOf(',', c2 + 1);
+  uint32_t offset = s.substring(c2 + 1, c3 < 0 ? s.length() : c3).toInt();
+  if (offset >= dl.size || offset % OTA_CHUNK_SIZE != 0) return;
+  dl.offset = offset;
+  if (c3 >= 0 && offset > 0) dl.srcOffset = s.substring(c3 + 1).toInt();
+}
+
+static void saveDownloadOffset(const OtaDownload &dl) {
+  configEdit().otaDownload = dl.sha256 + "," + String(dl.size) + "," + String(dl.offset) +
+                             "," + String(dl.lz ? dl.srcOffset : 0);
+  configCommit();
+}
+
+static void clearDownloadState() {
+  configEdit().otaDownload = "";
+  configCommit();
+}
+
+static void restartHash(OtaDownload &dl) {
+  mbedtls_sha256_free(&dl.hash);
+  mbedtls_sha256_init(&dl.hash);
+  mbedtls_sha256_starts(&dl.hash, 0);
+}
+
+// Hash what an earlier wake already wrote, so the final check still
+// covers the whole image as it is in flash
+static bool rehashWritten(OtaDownload &dl, uint8_t *buf) {
+  for (uint32_t pos = 0; pos < dl.offset; pos += OTA_BUF_SIZE) {
+    uint32_t n = min((uint32_t)OTA_BUF_SIZE, dl.offset - pos);
+    if (esp_partition_read(dl.part, pos, buf, n) != ESP_OK) return false;
+    mbedtls_sha256_update(&dl.hash, buf, n);
+  }
+  return true;
+}
+
+static bool writeFlash(OtaDownload &dl, const uint8_t *data, uint32_t len) {
+  uint32_t end = dl.offset + len;
+  if (end > dl.erasedTo) {
+    uint32_t eraseEnd = (end + OTA_SECTOR_SIZE - 1) / OTA_SECTOR_SIZE * OTA_SECTOR_SIZE;
+    if (esp_partition_erase_range(dl.part, dl.erasedTo, eraseEnd - dl.erasedTo) != ESP_OK) {
+      Serial.println("[OTA] Flash erase failed");
+      return false;
+    }
+    dl.erasedTo = eraseEnd;
+  }
+  if (esp_partition_write(dl.part, dl.offset, data, len) != ESP_OK) {
+    Serial.println("[OTA] Flash write failed");
+    return false;
+  }
+  mbedtls_sha256_update(&dl.hash, data, len);
+  dl.offset = end;
+  return true;
+}
+
+static void resetDownload(OtaDownload &dl) {
+  dl.offset = 0;
+  dl.srcOffset = 0;
+  dl.erasedTo = 0;
+  if (dl.lz) lzssResume(*dl.lz, 0, nullptr, 0);
+  restartHash(dl);
+}
+
+// Log progress and save the resume point at each chunk boundary
+static void chunkProgress(OtaDownload &dl, unsigned long &chunkStart, uint32_t &chunkFrom) {
+  if (dl.offset % OTA_CHUNK_SIZE != 0 && dl.offset != dl.size) return;
+
+  unsigned long ms = millis() - chunkStart;
+  uint32_t bytes = dl.offset - chunkFrom;
+  Serial.printf("[OTA] %lu / %lu bytes, chunk %lu bytes in %lu ms (%lu KB/s)\n",
+                (unsigned long)dl.offset, (unsigned long)dl.size,
+                (unsigned long)bytes, ms,
+                (unsigned long)(ms > 0 ? bytes / ms : 0));
+  if (dl.offset < dl.size) saveDownloadOffset(dl);
+  chunkStart = millis();
+  chunkFrom = dl.offset;
+}
+
+static bool readRaw(OtaDownload &dl, WiFiClient *stream, uint8_t *buf) {
+  unsigned long chunkStart = millis();
+  uint32_t chunkFrom = dl.offset;
+
+  while (dl.offset < dl.size) {
+    // Stop reads at chunk boundaries so the saved offset is exact
+    uint32_t chunkEnd = (dl.offset / OTA_CHUNK_SIZE + 1) * OTA_CHUNK_SIZE;
+    uint32_t want = min((uint32_t)OTA_BUF_SIZE, min(dl.size, chunkEnd) - dl.offset);
+
+    size_t got = stream->readBytes((char *)buf, want);
+    if (got > 0 && !writeFlash(dl, buf, got)) return false;
+    if (got < want) {
+      Serial.printf("[OTA] Connection dropped at %lu of %lu bytes\n",
+                    (unsigned long)dl.offset, (unsigned long)dl.size);
+      return false;
+    }
+    chunkProgress(dl, chunkStart, chunkFrom);
+  }
+  return true;
+}
+
+// The header must describe the image the manifest promised
+static bool readPackedHeader(OtaDownload &dl, WiFiClient *stream) {
+  uint8_t h[PACKED_HEADER_SIZE];
+  if (stream->readBytes((char *)h, sizeof(h)) != sizeof(h)) {
+    Serial.println("[OTA] Connection dropped in the compressed image header");
     return false;
   }
+  uint32_t magic = h[0] | (h[1] << 8) | (h[2] << 16) | ((uint32_t)h[3] << 24);
+  uint32_t size  = h[8] | (h[9] << 8) | (h[10] << 16) | ((uint32_t)h[11] << 24);
+  uint32_t block = h[12] | (h[13] << 8) | (h[14] << 16) | ((uint32_t)h[15] << 24);
+  if (magic != PACKED_MAGIC || h[4] != dl.lz->windowBits || h[5] != dl.lz->lookaheadBits ||
+      size != dl.size || block != dl.lz->blockSize) {
+    Serial.println("[OTA] Compressed image header does not match the manifest");
+    dl.broken = true;
+    return false;
+  }
+  dl.srcOffset = PACKED_HEADER_SIZE;
+  return true;
+}
+
+// Decode the compressed body into flash. The decoder keeps its state
+// across a drop, so a retry in the same wake continues from the exact
+// compressed byte; chunk boundaries are also block boundaries, where
+// the stream is byte aligned, so those are the points saved in NVS.
+static bool readPacked(OtaDownload &dl, WiFiClient *stream, uint8_t *buf) {
+  if (dl.srcOffset == 0 && !readPackedHeader(dl, stream)) return false;
+
+  uint8_t in[OTA_PACKED_READ];
+  size_t inPos = 0, inLen = 0;
+  unsigned long chunkStart = millis();
+  uint32_t chunkFrom = dl.offset;
+
+  while (dl.offset < dl.size) {
+    if (inPos == inLen) {
+      uint32_t want = min((uint32_t)sizeof(in), dl.srcSize - dl.srcOffset);
+      if (want == 0) {
+        Serial.println("[OTA] Compressed image ends early");
+        dl.broken = true;
+        return false;
+      }
+      inLen = stream->readBytes((char *)in, want);
+      inPos = 0;
+      if (inLen == 0) {
+        Serial.printf("[OTA] Connection dropped at %lu of %lu bytes (%lu compressed)\n",
+                      (unsigned long)dl.offset, (unsigned long)dl.size,
+                      (unsigned long)dl.srcOffset);
+        return false;
+      }
+    }
 
-  Serial.print("[OTA] Starting OTA from URL: ");
-  Serial.println(binUrl);
+    uint32_t chunkEnd = (dl.offset / OTA_CHUNK_SIZE + 1) * OTA_CHUNK_SIZE;
+    uint32_t outMax = min((uint32_t)OTA_BUF_SIZE, min(dl.size, chunkEnd) - dl.offset);
+    size_t used;
+    size_t n = lzssDecode(*dl.lz, in + inPos, inLen - inPos, used, buf, outMax);
+    inPos += used;
+    dl.srcOffset += used;
+    if (dl.lz->error) {
+      Serial.printf("[OTA] Corrupt compressed image at %lu bytes\n", (unsigned long)dl.offset);
+      dl.broken = true;
+      return false;
+    }
+    // The decoder is already past these bytes, so a failed write
+    // cannot be retried from here
+    if (n > 0 && !writeFlash(dl, buf, n)) {
+      dl.broken = true;
+      return false;
+    }
+    chunkProgress(dl, chunkStart, chunkFrom);
+  }
 
-  WiFiClientSecure client;
-  client.setInsecure();
+  if (dl.srcOffset != dl.srcSize) {
+    Serial.println("[OTA] Compressed image has trailing data");
+    dl.broken = true;
+    return false;
+  }
+  return true;
+}
 
-  HTTPClient http;
-  if (!http.begin(client, binUrl)) {
+// One GET from the current offset to the end of the image (a Range
+// request when resuming). Returns true once the whole image is
+// written; on a drop, dl.offset tells how far it got.
+static bool downloadFrom(OtaDownload &dl, uint8_t *buf) {
+  HTTPClient *http = connBegin(dl.url);
+  if (!http) {
     Serial.println("[OTA] HTTP begin failed");
     return false;
   }
 
-  int httpCode = http.GET();
-  if (httpCode != HTTP_CODE_OK) {
+  // Offsets in the response body: compressed bytes for a packed image
+  uint32_t from  = dl.lz ? dl.srcOffset : dl.offset;
+  uint32_t total = dl.lz ? dl.srcSize : dl.size;
+
+  const char *headerKeys[] = {"Content-Range"};
+  http->collectHeaders(headerKeys, 1);
+  if (from > 0) {
+    http->addHeader("Range", "bytes=" + String(from) + "-");
+  }
+
+  int httpCode = http->GET();
+  if (httpCode == HTTP_CODE_OK && from > 0) {
+    // Server ignored the Range header: take the image from the start
+    Serial.println("[OTA] Server sent the whole image, restarting download.");
+    resetDownload(dl);
+    from = 0;
+  } else if (httpCode == HTTP_CODE_PARTIAL_CONTENT) {
+    String range = http->header("Content-Range");   // "bytes a-b/total"
+    if (!range.startsWith("bytes " + String(from) + "-")) {
+      Serial.println("[OTA] Unexpected Content-Range: " + range);
+      connClose(http);
+      return false;
+    }
+  } else if (httpCode != HTTP_CODE_OK) {
     Serial.print("[OTA] HTTP error: ");
     Serial.println(httpCode);
-    http.end();
+    connClose(http);
     return false;
   }
 
-  int contentLength = http.getSize();
-  Serial.print("[OTA] Content-Length: ");
-  Serial.println(contentLength);
+  int contentLength = http->getSize();
+  if (contentLength >= 0 && (uint32_t)contentLength != total - from) {
+    Serial.printf("[OTA] Content-Length %d, expected %lu\n",
+                  contentLength, (unsigned long)(total - from));
+    connClose(http);
+    return false;
+  }
+
+  WiFiClient *stream = http->getStreamPtr();
+  bool ok = dl.lz ? readPacked(dl, stream, buf) : readRaw(dl, stream, buf);
+  if (!ok) {
+    connClose(http);
+    return false;
+  }
+  connEnd(http);
+  return true;
+}
 
-  if (contentLength <= 0) {
-    Serial.println("[OTA] Invalid content length");
-    http.end();
+// Finish the hash of what is in the slot and compare it with the
+// manifest. Either way the slot holds a complete image, so there is
+// nothing left to resume.
+static bool hashMatches(OtaDownload &dl) {
+  uint8_t digest[32];
+  mbedtls_sha256_finish(&dl.hash, digest);
+  mbedtls_sha256_free(&dl.hash);
+  clearDownloadState();
+
+  String actual = toHex(digest, sizeof(digest));
+  if (actual != dl.sha256) {
+    Serial.println("[OTA] SHA-256 mismatch: got " + actual);
     return false;
   }
+  Serial.println("[OTA] SHA-256 verified.");
+  return true;
+}
 
-  if (!Update.begin(contentLength)) {  // writes to next OTA slot
-    Serial.print("[OTA] Update.begin failed. Error: ");
-    Serial.println(Update.errorString());
-    http.end();
+// --- Delta updates ---
+//
+// A patch rebuilds the new image from the running one; the format is
+// described in tools/ota_delta.py. It is small, so it is not resumed:
+// any failure falls back to the full image.
+
+#define PATCH_MAGIC     0x31504451UL   // "QDP1"
+#define PATCH_OP_END    0
+#define PATCH_OP_COPY   1
+#define PATCH_OP_INSERT 2
+#define PATCH_PIECE     256
+
+struct OtaPatch {
+  String   url;
+  uint32_t size;
+  uint32_t baseSize;
+  String   baseSha256;
+};
+
+// Buffered reader over the patch response body
+struct PatchReader {
+  WiFiClient *stream;
+  uint32_t    left;          // body bytes not read from the stream yet
+  uint8_t     buf[PATCH_PIECE];
+  uint16_t    pos;
+  uint16_t    len;
+  bool        failed;
+};
+
+static bool patchFill(PatchReader &in) {
+  if (in.left == 0) {
+    in.failed = true;
+    return false;
+  }
+  size_t got = in.stream->readBytes((char *)in.buf, min((uint32_t)sizeof(in.buf), in.left));
+  if (got == 0) {
+    in.failed = true;
     return false;
   }
+  in.pos = 0;
+  in.len = got;
+  in.left -= got;
+  return true;
+}
+
+static bool patchRead(PatchReader &in, uint8_t *dst, uint32_t n) {
+  while (n > 0) {
+    if (in.pos == in.len && !patchFill(in)) return false;
+    uint32_t k = min(n, (uint32_t)(in.len - in.pos));
+    memcpy(dst, in.buf + in.pos, k);
+    in.pos += k;
+    dst += k;
+    n -= k;
+  }
+  return true;
+}
+
+static uint32_t patchVarint(PatchReader &in) {
+  uint32_t v = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    uint8_t b;
+    if (!patchRead(in, &b, 1)) return 0;
+    v |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) return v;
+  }
+  in.failed = true;
+  return 0;
+}
+
+// Rebuilt bytes are collected in `out` and written a buffer at a time
+static bool patchEmit(OtaDownload &dl, uint8_t *out, uint32_t &outLen,
+                      const uint8_t *data, uint32_t n) {
+  if (dl.offset + outLen + n > dl.size) return false;
+  while (n > 0) {
+    uint32_t k = min(n, (uint32_t)OTA_BUF_SIZE - outLen);
+    memcpy(out + outLen, data, k);
+    outLen += k;
+    data += k;
+    n -= k;
+    if (outLen == OTA_BUF_SIZE) {
+      if (!writeFlash(dl, out, outLen)) return false;
+      outLen = 0;
+    }
+  }
+  return true;
+}
 
-  WiFiClient *stream = http.getStreamPtr();
-  size_t written = Update.writeStream(*stream);
+// Copy `n` bytes of the running image from `src`, adding patch bytes
+// to each if `addDiff`
+static bool patchCopy(OtaDownload &dl, uint8_t *out, uint32_t &outLen,
+                      const esp_partition_t *base, uint32_t src, uint32_t n,
+                      PatchReader &in, bool addDiff) {
+  uint8_t piece[PATCH_PIECE];
+  uint8_t diff[PATCH_PIECE];
+  while (n > 0) {
+    uint32_t k = min(n, (uint32_t)PATCH_PIECE);
+    if (esp_partition_read(base, src, piece, k) != ESP_OK) return false;
+    if (addDiff) {
+      if (!patchRead(in, diff, k)) return false;
+      for (uint32_t i = 0; i < k; i++) piece[i] += diff[i];
+    }
+    if (!patchEmit(dl, out, outLen, piece, k)) return false;
+    src += k;
+    n -= k;
+  }
+  return true;
+}
 
-  Serial.print("[OTA] Written: ");
-  Serial.print(written);
-  Serial.print(" / ");
-  Serial.println(contentLength);
+// The patch only applies to the exact image it was made from
+static bool baseMatches(const esp_partition_t *base, const OtaPatch &patch, uint8_t *buf) {
+  if (patch.baseSize > base->size) return false;
+
+  mbedtls_sha256_context ctx;
+  mbedtls_sha256_init(&ctx);
+  mbedtls_sha256_starts(&ctx, 0);
+  bool ok = true;
+  for (uint32_t pos = 0; pos < patch.baseSize && ok; pos += OTA_BUF_SIZE) {
+    uint32_t n = min((uint32_t)OTA_BUF_SIZE, patch.baseSize - pos);
+    ok = esp_partition_read(base, pos, buf, n) == ESP_OK;
+    if (ok) mbedtls_sha256_update(&ctx, buf, n);
+  }
+  uint8_t digest[32];
+  mbedtls_sha256_finish(&ctx, digest);
+  mbedtls_sha256_free(&ctx);
+  return ok && toHex(digest, sizeof(digest)).equalsIgnoreCase(patch.baseSha256);
+}
 
-  if (written != (size_t)contentLength) {
-    Serial.println("[OTA] Written size mismatch");
-    http.end();
-    Update.end();
+static bool applyPatchOps(OtaDownload &dl, uint8_t *out, const esp_partition_t *base,
+                          const OtaPatch &patch, PatchReader &in) {
+  uint8_t header[12];
+  if (!patchRead(in, header, sizeof(header))) return false;
+  uint32_t magic    = header[0] | (header[1] << 8) | (header[2] << 16) | ((uint32_t)header[3] << 24);
+  uint32_t baseSize = header[4] | (header[5] << 8) | (header[6] << 16) | ((uint32_t)header[7] << 24);
+  uint32_t newSize  = header[8] | (header[9] << 8) | (header[10] << 16) | ((uint32_t)header[11] << 24);
+  if (magic != PATCH_MAGIC || baseSize != patch.baseSize || newSize != dl.size) {
+    Serial.println("[OTA] Patch header does not match the manifest");
     return false;
   }
 
-  if (!Update.end()) {
-    Serial.print("[OTA] Update.end failed. Error: ");
-    Serial.println(Update.errorString());
-    http.end();
+  uint32_t outLen = 0;
+  uint32_t srcEnd = 0;
+  while (true) {
+    uint8_t op;
+    if (!patchRead(in, &op, 1)) return false;
+
+    if (op == PATCH_OP_END) {
+      break;
+    } else if (op == PATCH_OP_INSERT) {
+      uint32_t n = patchVarint(in);
+      uint8_t piece[PATCH_PIECE];
+      while (n > 0 && !in.failed) {
+        uint32_t k = min(n, (uint32_t)PATCH_PIECE);
+        if (!patchRead(in, piece, k) || !patchEmit(dl, out, outLen, piece, k)) return false;
+        n -= k;
+      }
+    } else if (op == PATCH_OP_COPY) {
+      uint32_t zz  = patchVarint(in);
+      int32_t  rel = (zz & 1) ? -(int32_t)((zz + 1) >> 1) : (int32_t)(zz >> 1);
+      uint32_t src = srcEnd + rel;
+      uint32_t len = patchVarint(in);
+      if (in.failed || (int64_t)srcEnd + rel < 0 || src + len > baseSize) return false;
+
+      for (uint32_t k = 0; k < len;) {
+        uint32_t same = patchVarint(in);
+        uint32_t run  = patchVarint(in);
+        if (in.failed || k + same + run > len) return false;
+        if (!patchCopy(dl, out, outLen, base, src + k, same, in, false) ||
+            !patchCopy(dl, out, outLen, base, src + k + same, run, in, true)) {
+          return false;
+        }
+        k += same + run;
+      }
+      srcEnd = src + len;
+    } else {
+      return false;
+    }
+    if (in.failed) return false;
+  }
+
+  if (outLen > 0 && !writeFlash(dl, out, outLen)) return false;
+  return dl.offset == dl.size && in.left == 0 && in.pos == in.len;
+}
+
+// Download the patch and rebuild the new image into the slot
+static bool applyDelta(OtaDownload &dl, uint8_t *buf, const OtaPatch &patch) {
+  const esp_partition_t *base = esp_ota_get_running_partition();
+  if (!base || !baseMatches(base, patch, buf)) {
+    Serial.println("[OTA] Running image is not the patch base.");
+    return false;
+  }
+
+  Serial.print("[OTA] Applying delta from URL: ");
+  Serial.println(patch.url);
+  unsigned long start = millis();
+
+  HTTPClient *http = connBegin(patch.url);
+  if (!http) {
+    Serial.println("[OTA] HTTP begin failed");
+    return false;
+  }
+  int httpCode = http->GET();
+  int contentLength = http->getSize();
+  if (httpCode != HTTP_CODE_OK ||
+      (contentLength >= 0 && (uint32_t)contentLength != patch.size)) {
+    Serial.printf("[OTA] Patch download failed: HTTP %d, %d bytes\n", httpCode, contentLength);
+    connClose(http);
+    return false;
+  }
+
+  PatchReader in = {};
+  in.stream = http->getStreamPtr();
+  in.left   = patch.size;
+  bool ok = applyPatchOps(dl, buf, base, patch, in);
+
+  if (!ok) {
+    Serial.printf("[OTA] Patch failed at %lu of %lu bytes\n",
+                  (unsigned long)dl.offset, (unsigned long)dl.size);
+    connClose(http);
+    return false;
+  }
+  connEnd(http);
+  Serial.printf("[OTA] Patched %lu bytes from a %lu byte delta in %lu ms\n",
+                (unsigned long)dl.size, (unsigned long)patch.size, millis() - start);
+  return true;
+}
+
+// Download (with retries) the rest of the image, raw or compressed
+static bool downloadImage(OtaDownload &dl, uint8_t *buf) {
+  Serial.print(dl.lz ? "[OTA] Downloading compressed image from URL: "
+                     : "[OTA] Downloading from URL: ");
+  Serial.println(dl.url);
+
+  unsigned long start = millis();
+  uint32_t startOffset = dl.offset;
+  uint32_t startSrc = dl.srcOffset;
+  for (int attempt = 1; attempt <= OTA_MAX_ATTEMPTS && !dl.broken; attempt++) {
+    if (attempt > 1) {
+      Serial.printf("[OTA] Retry %d/%d from %lu bytes\n", attempt - 1,
+                    OTA_MAX_ATTEMPTS - 1, (unsigned long)dl.offset);
+      delay(OTA_RETRY_DELAY_MS * (attempt - 1));
+    }
+    if (downloadFrom(dl, buf)) {
+      if (dl.lz) {
+        Serial.printf("[OTA] Downloaded %lu bytes (%lu compressed) in %lu ms\n",
+                      (unsigned long)(dl.size - startOffset),
+                      (unsigned long)(dl.srcSize - startSrc), millis() - start);
+      } else {
+        Serial.printf("[OTA] Downloaded %lu bytes in %lu ms\n",
+                      (unsigned long)(dl.size - startOffset), millis() - start);
+      }
+      return true;
+    }
+  }
+
+  if (dl.broken) return false;
+  // Keep what is in flash; the next check resumes from the last chunk
+  Serial.printf("[OTA] Giving up for now at %lu of %lu bytes\n",
+                (unsigned long)dl.offset, (unsigned long)dl.size);
+  return false;
+}
+
+// Switch dl to the compressed image. When resuming one, the decoder
+// window is refilled from the flash just before the saved offset.
+static bool startPacked(OtaDownload &dl, LzssDecoder &lz, const OtaPacked &packed,
+                        uint8_t *buf) {
+  if (!lzssBegin(lz, packed.windowBits, packed.lookaheadBits, packed.blockSize)) {
+    Serial.println("[OTA] Cannot decode the compressed image here.");
+    return false;
+  }
+  uint32_t window = lz.windowMask + 1;
+  if (window > OTA_BUF_SIZE) {
+    Serial.println("[OTA] Compressed image window too large.");
+    lzssEnd(lz);
+    return false;
+  }
+  dl.lz = &lz;
+  dl.url = packed.url;
+  dl.srcSize = packed.size;
+
+  if (dl.srcOffset > 0) {
+    uint32_t n = min(dl.offset, window);
+    if (dl.srcOffset >= dl.srcSize ||
+        esp_partition_read(dl.part, dl.offset - n, buf, n) != ESP_OK) {
+      Serial.println("[OTA] Cannot resume the compressed image, restarting.");
+      resetDownload(dl);
+    } else {
+      lzssResume(lz, dl.offset, buf, n);
+    }
+  }
+  return true;
+}
+
+// Download into the other OTA slot, verify and boot into it. With a
+// patch for the running version, try the delta first, then the
+// compressed image, then the raw one.
+static bool performOTA(const String &binUrl, const String &sha256, uint32_t size,
+                       const OtaPatch *patch, const OtaPacked *packed) {
+  if (WiFi.status() != WL_CONNECTED) {
+    Serial.println("[OTA] Wi-Fi not connected.");
+    return false;
+  }
+
+  OtaDownload dl;
+  dl.part = esp_ota_get_next_update_partition(NULL);
+  if (!dl.part) {
+    Serial.println("[OTA] No OTA partition");
+    return false;
+  }
+  if (size == 0 || size > dl.part->size) {
+    Serial.printf("[OTA] Image size %lu does not fit partition (%lu)\n",
+                  (unsigned long)size, (unsigned long)dl.part->size);
     return false;
   }
 
-  if (!Update.isFinished()) {
-    Serial.println("[OTA] Update not finished");
-    http.end();
+  uint8_t *buf = (uint8_t *)malloc(OTA_BUF_SIZE);
+  if (!buf) {
+    Serial.println("[OTA] Not enough memory for download buffer");
+    return false;
+  }
+
+  dl.url      = binUrl;
+  dl.sha256   = sha256;
+  dl.sha256.toLowerCase();
+  dl.size     = size;
+  dl.lz       = nullptr;
+  dl.srcSize  = 0;
+  dl.broken   = false;
+  loadDownloadState(dl);
+  if (dl.srcOffset > 0 && !packed) {
+    // Compressed download under way, but no longer published
+    dl.offset = 0;
+    dl.srcOffset = 0;
+  }
+  dl.erasedTo = dl.offset;
+  mbedtls_sha256_init(&dl.hash);
+  mbedtls_sha256_starts(&dl.hash, 0);
+
+  if (dl.offset > 0) {
+    Serial.printf("[OTA] Resuming at %lu of %lu bytes\n",
+                  (unsigned long)dl.offset, (unsigned long)size);
+    if (!rehashWritten(dl, buf)) {
+      Serial.println("[OTA] Cannot read back partial image, restarting.");
+      resetDownload(dl);
+    }
+  }
+
+  // A download already under way is finished in the same form
+  bool verified = false;
+  if (patch && dl.offset == 0) {
+    verified = applyDelta(dl, buf, *patch) && hashMatches(dl);
+    if (!verified) {
+      Serial.println("[OTA] Delta update failed, downloading the full image.");
+      resetDownload(dl);
+    }
+  }
+
+  if (!verified && packed && (dl.offset == 0 || dl.srcOffset > 0)) {
+    LzssDecoder lz;
+    if (startPacked(dl, lz, *packed, buf)) {
+      if (downloadImage(dl, buf)) {
+        verified = hashMatches(dl);
+      } else if (!dl.broken) {
+        lzssEnd(lz);
+        free(buf);
+        mbedtls_sha256_free(&dl.hash);
+        return false;
+      }
+      lzssEnd(lz);
+      dl.lz = nullptr;
+    }
+    if (!verified) {
+      Serial.println("[OTA] Compressed update failed, downloading the raw image.");
+      clearDownloadState();
+      dl.url = binUrl;
+      dl.broken = false;
+      resetDownload(dl);
+    }
+  }
+
+  if (!verified) {
+    if (!downloadImage(dl, buf)) {
+      free(buf);
+      mbedtls_sha256_free(&dl.hash);
+      return false;
+    }
+    verified = hashMatches(dl);
+  }
+  free(buf);
+  if (!verified) return false;
+
+  esp_err_t err = esp_ota_set_boot_partition(dl.part);
+  if (err != ESP_OK) {
+    Serial.print("[OTA] esp_ota_set_boot_partition failed: ");
+    Serial.println((int)err);
     return false;
   }
 
   Serial.println("[OTA] Update successful, restarting into test image...");
-  http.end();
   displayStatus("Firmware updated.\nRebooting...");
   delay(2000);
+  displayFlush();
   ESP.restart();
   return true; // not really reached
 }
 
+// Validators of the last manifest that needed no update, saved as
+// "<FW_VERSION>\n<ETag>\n<Last-Modified>". A 304 against them means
+// nothing changed for this firmware, so the manifest is not fetched
+// again until it does.
+static void loadManifestValidators(String &etag, String &lastModified) {
+  const String &s = config().otaManifest;
+  int n1 = s.indexOf('\n');
+  int n2 = n1 < 0 ? -1 : s.indexOf('\n', n1 + 1);
+  if (n2 < 0 || s.substring(0, n1) != FW_VERSION) return;
+  etag = s.substring(n1 + 1, n2);
+  lastModified = s.substring(n2 + 1);
+}
+
+static void saveManifestValidators(const String &etag, const String &lastModified) {
+  if (etag.length() == 0 && lastModified.length() == 0) return;
+  configEdit().otaManifest = String(FW_VERSION) + "\n" + etag + "\n" + lastModified;
+  configCommit();
+}
+
+static void clearManifestValidators() {
+  configEdit().otaManifest = "";
+  configCommit();
+}
+
 // Check GitHub meta JSON and decide whether to OTA
-void checkForUpdate() {
+bool checkForUpdate() {
+  PROFILE_SCOPE(PHASE_OTA);
   Serial.println("[OTA] checkForUpdate()...");
 
   if (WiFi.status() != WL_CONNECTED) {
     Serial.println("[OTA] Wi-Fi not connected, skipping.");
-    return;
+    return false;
   }
 
-  WiFiClientSecure client;
-  client.setInsecure();
-
-  HTTPClient http;
-  if (!http.begin(client, GITHUB_OTA_META_URL)) {
+  HTTPClient *http = connBegin(GITHUB_OTA_META_URL);
+  if (!http) {
     Serial.println("[OTA] HTTP begin failed for meta URL");
-    return;
+    return false;
   }
 
-  int httpCode = http.GET();
+  String etag, lastModified;
+  loadManifestValidators(etag, lastModified);
+  const char *headerKeys[] = {"ETag", "Last-Modified"};
+  http->collectHeaders(headerKeys, 2);
+  if (etag.length() > 0) http->addHeader("If-None-Match", etag);
+  if (lastModified.length() > 0) http->addHeader("If-Modified-Since", lastModified);
+
+  int httpCode = http->GET();
+  if (httpCode == HTTP_CODE_NOT_MODIFIED) {
+    connEnd(http);
+    Serial.println("[OTA] Manifest not modified, firmware up to date.");
+    return true;
+  }
   if (httpCode != HTTP_CODE_OK) {
     Serial.print("[OTA] HTTP error: ");
     Serial.println(httpCode);
-    String body = http.getString();
+    String body = http->getString();
     Serial.println("[OTA] Body:");
     Serial.println(body);
-    http.end();
-    return;
+    connEnd(http);
+    return false;
   }
 
-  String body = http.getString();
-  http.end();
+  etag = http->header("ETag");
+  lastModified = http->header("Last-Modified");
+  String body = http->getString();
+  connEnd(http);
 
   Serial.println("[OTA] Meta JSON:");
   Serial.println(body);
 
-  DynamicJsonDocument doc(1024);
+  JsonDocument doc;
   DeserializationError err = deserializeJson(doc, body);
   if (err) {
     Serial.print("[OTA] JSON parse error: ");
     Serial.println(err.c_str());
-    return;
+    return false;
   }
 
   String remoteVersion = doc["version"].as<String>();
   String binUrl        = doc["binUrl"].as<String>();
+  String sha256        = doc["sha256"] | "";
+  uint32_t size        = doc["size"] | 0;
 
   Serial.print("[OTA] Current FW: ");
   Serial.println(FW_VERSION);
@@ -159,16 +864,51 @@ void checkForUpdate() {
 
   if (!isNewerVersion(remoteVersion, FW_VERSION)) {
     Serial.println("[OTA] Firmware up to date.");
-    return;
+    clearDownloadState();
+    saveManifestValidators(etag, lastModified);
+    return true;
   }
 
+  if (!isSha256Hex(sha256) || size == 0) {
+    Serial.println("[OTA] Manifest has no sha256/size, not updating.");
+    saveManifestValidators(etag, lastModified);
+    return true;   // nothing to retry until the manifest changes
+  }
+
+  // An update that does not finish must see the manifest again
+  clearManifestValidators();
+
+  // Delta from the running version, if published
+  OtaPatch patch;
+  JsonObjectConst p = doc["patches"][FW_VERSION];
+  patch.url        = p["url"] | "";
+  patch.size       = p["size"] | 0;
+  patch.baseSize   = p["baseSize"] | 0;
+  patch.baseSha256 = p["baseSha256"] | "";
+  bool hasPatch = patch.url.length() > 0 && patch.size > 0 &&
+                  patch.baseSize > 0 && isSha256Hex(patch.baseSha256);
+
+  // Compressed image; its blocks must line up with the resume chunks
+  OtaPacked packed;
+  JsonObjectConst c = doc["compressed"];
+  packed.url           = c["url"] | "";
+  packed.size          = c["size"] | 0;
+  packed.windowBits    = c["windowBits"] | 0;
+  packed.lookaheadBits = c["lookaheadBits"] | 0;
+  packed.blockSize     = c["blockSize"] | 0;
+  bool hasPacked = packed.url.length() > 0 && packed.size > PACKED_HEADER_SIZE &&
+                   packed.blockSize > 0 && OTA_CHUNK_SIZE % packed.blockSize == 0;
+
   Serial.println("[OTA] New firmware available. Updating...");
   displayStatus("Updating firmware to\nv" + remoteVersion + "...");
 
-  if (!performOTA(binUrl)) {
+  if (!performOTA(binUrl, sha256, size, hasPatch ? &patch : nullptr,
+                  hasPacked ? &packed : nullptr)) {
     Serial.println("[OTA] OTA failed.");
     displayError("Update failed.");
+    return false;
   }
+  return true;
 }
 
 // After rebooting into a new OTA slot, the bootloader
@@ -177,6 +917,7 @@ void checkForUpdate() {
 // device reboots/crashes, the bootloader can roll back
 // to the previous image (when rollback is enabled).
 void finalizeOtaIfPending() {
+  PROFILE_SCOPE(PHASE_OTA);
   const esp_partition_t* running = esp_ota_get_running_partition();
   if (!running) {
     Serial.println("[OTA] No running partition info.");
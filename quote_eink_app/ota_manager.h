@@ -3,7 +3,11 @@
 
 #include <Arduino.h>
 
-void checkForUpdate();
+// Fetch the OTA manifest and, if it lists a newer version, download,
+// verify and boot into it (does not return on success). A download cut
+// short is resumed on the next call. Returns false if the check or the
+// update failed and should be retried soon.
+bool checkForUpdate();
 void finalizeOtaIfPending();
 
 #endif
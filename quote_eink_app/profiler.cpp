@@ -0,0 +1,209 @@
+// profiler.cpp
+
+#include "profiler.h"
+
+// Wakes kept in RTC memory (about 250 bytes each)
+#ifndef PROFILE_CYCLES
+#define PROFILE_CYCLES 6
+#endif
+
+#define PROFILE_MAX_DEPTH 8
+#define PROFILE_RTC_MAGIC 0x50524F31UL   // "PRO1"
+
+static const char *const phaseNames[PHASE_COUNT] = {
+  "display_init", "display", "cache", "wifi", "tls",
+  "auth", "sync", "ota", "shutdown",
+};
+
+static const char *const wakeNames[] = {"cold", "timer", "button"};
+
+struct PhaseStats {
+  uint32_t firstUs;      // first entry, us since boot
+  uint32_t totalUs;      // own time, nested phases excluded
+  uint32_t heapBefore;   // free heap at first entry
+  uint32_t heapAfter;    // free heap at last exit
+  uint32_t minLargest;   // smallest largest-free-block seen
+  uint16_t count;
+};
+
+struct CycleRecord {
+  uint32_t   seq;         // 1, 2, ... since power-on
+  uint32_t   wake;
+  uint8_t    reason;
+  uint32_t   bootUs;      // reset to profileBeginCycle()
+  uint32_t   awakeUs;     // reset to profileEndCycle()
+  uint32_t   minFreeHeap;
+  PhaseStats phases[PHASE_COUNT];
+};
+
+struct ProfileRtc {
+  uint32_t    magic;
+  uint32_t    head;           // next slot to write
+  uint32_t    stored;
+  uint32_t    nextSeq;
+  uint32_t    uploadedSeq;    // newest record already uploaded
+  CycleRecord cycles[PROFILE_CYCLES];
+};
+
+RTC_DATA_ATTR static ProfileRtc rtcProfile;
+
+static CycleRecord current;
+static bool        active = false;
+static uint8_t     stack[PROFILE_MAX_DEPTH];
+static uint8_t     depth = 0;
+static uint32_t    markUs = 0;       // last time the running phase changed
+static uint32_t    summarySeq = 0;   // newest record in the last summary
+
+static void sampleHeap(PhaseStats &p, bool entering) {
+  uint32_t freeHeap = ESP.getFreeHeap();
+  uint32_t largest  = ESP.getMaxAllocHeap();
+  if (entering && p.count == 0) p.heapBefore = freeHeap;
+  if (!entering) p.heapAfter = freeHeap;
+  if (p.minLargest == 0 || largest < p.minLargest) p.minLargest = largest;
+  if (current.minFreeHeap == 0 || freeHeap < current.minFreeHeap) {
+    current.minFreeHeap = freeHeap;
+  }
+}
+
+void profileBeginCycle(uint32_t wake, uint8_t wakeReason) {
+  if (rtcProfile.magic != PROFILE_RTC_MAGIC) {
+    memset(&rtcProfile, 0, sizeof(rtcProfile));
+    rtcProfile.magic = PROFILE_RTC_MAGIC;
+  }
+
+  memset(&current, 0, sizeof(current));
+  current.seq    = ++rtcProfile.nextSeq;
+  current.wake   = wake;
+  current.reason = wakeReason;
+  current.bootUs = micros();
+  depth  = 0;
+  active = true;
+}
+
+void profileEnter(ProfilePhase phase) {
+  if (!active) return;
+  uint32_t now = micros();
+  if (depth > 0) {
+    current.phases[stack[depth - 1]].totalUs += now - markUs;
+  }
+  if (depth < PROFILE_MAX_DEPTH) {
+    stack[depth++] = phase;
+  }
+  markUs = now;
+
+  PhaseStats &p = current.phases[phase];
+  if (p.count == 0) p.firstUs = now;
+  sampleHeap(p, true);
+  p.count++;
+}
+
+void profileLeave(ProfilePhase phase) {
+  if (!active || depth == 0 || stack[depth - 1] != phase) return;
+  uint32_t now = micros();
+  PhaseStats &p = current.phases[phase];
+  p.totalUs += now - markUs;
+  depth--;
+  markUs = now;
+  sampleHeap(p, false);
+}
+
+void profileEndCycle() {
+  if (!active) return;
+  current.awakeUs = micros();
+  active = false;
+
+  rtcProfile.cycles[rtcProfile.head] = current;
+  rtcProfile.head = (rtcProfile.head + 1) % PROFILE_CYCLES;
+  if (rtcProfile.stored < PROFILE_CYCLES) rtcProfile.stored++;
+
+  // One line per wake: where the time went
+  String line = "[PROF] Wake #" + String(current.wake) + " " +
+                String(current.awakeUs / 1000) + " ms:";
+  for (int i = 0; i < PHASE_COUNT; i++) {
+    if (current.phases[i].count == 0) continue;
+    line += " ";
+    line += phaseNames[i];
+    line += "=";
+    line += current.phases[i].totalUs / 1000;
+  }
+  Serial.println(line);
+}
+
+// Stored wakes, oldest first
+static const CycleRecord &storedCycle(uint32_t i) {
+  uint32_t oldest = (rtcProfile.head + PROFILE_CYCLES - rtcProfile.stored) % PROFILE_CYCLES;
+  return rtcProfile.cycles[(oldest + i) % PROFILE_CYCLES];
+}
+
+static const char *wakeName(uint8_t reason) {
+  return reason < sizeof(wakeNames) / sizeof(wakeNames[0]) ? wakeNames[reason] : "?";
+}
+
+void profileDump() {
+  if (rtcProfile.magic != PROFILE_RTC_MAGIC || rtcProfile.stored == 0) {
+    Serial.println("[PROF] No wakes recorded yet.");
+    return;
+  }
+
+  for (uint32_t c = 0; c < rtcProfile.stored; c++) {
+    const CycleRecord &rec = storedCycle(c);
+    Serial.printf("[PROF] Wake #%lu (%s): boot %lu us, awake %lu us, min free heap %lu\n",
+                  (unsigned long)rec.wake, wakeName(rec.reason),
+                  (unsigned long)rec.bootUs, (unsigned long)rec.awakeUs,
+                  (unsigned long)rec.minFreeHeap);
+    Serial.println("[PROF]   phase         start_us    self_us  n  heap_before  heap_after  min_largest");
+    for (int i = 0; i < PHASE_COUNT; i++) {
+      const PhaseStats &p = rec.phases[i];
+      if (p.count == 0) continue;
+      Serial.printf("[PROF]   %-12s %9lu %10lu %2u %12lu %11lu %12lu\n",
+                    phaseNames[i], (unsigned long)p.firstUs, (unsigned long)p.totalUs,
+                    p.count, (unsigned long)p.heapBefore, (unsigned long)p.heapAfter,
+                    (unsigned long)p.minLargest);
+    }
+  }
+}
+
+void profilePollSerial() {
+  while (Serial.available() > 0) {
+    if (Serial.read() == 'p') profileDump();
+  }
+}
+
+// {"cycles":[{"wake":3,"why":"timer","ms":2079,"heap":181000,
+//   "phases":{"display":[ms,n],...}},...]}
+String profileSummaryJson() {
+  summarySeq = 0;
+  if (rtcProfile.magic != PROFILE_RTC_MAGIC) return "";
+
+  String json = "{\"cycles\":[";
+  bool any = false;
+  for (uint32_t c = 0; c < rtcProfile.stored; c++) {
+    const CycleRecord &rec = storedCycle(c);
+    if (rec.seq <= rtcProfile.uploadedSeq) continue;
+
+    if (any) json += ",";
+    any = true;
+    json += "{\"wake\":" + String(rec.wake) +
+            ",\"why\":\"" + wakeName(rec.reason) + "\"" +
+            ",\"ms\":" + String(rec.awakeUs / 1000) +
+            ",\"heap\":" + String(rec.minFreeHeap) +
+            ",\"phases\":{";
+    bool first = true;
+    for (int i = 0; i < PHASE_COUNT; i++) {
+      const PhaseStats &p = rec.phases[i];
+      if (p.count == 0) continue;
+      if (!first) json += ",";
+      first = false;
+      json += "\"" + String(phaseNames[i]) + "\":[" +
+              String(p.totalUs / 1000) + "," + String(p.count) + "]";
+    }
+    json += "}}";
+    summarySeq = rec.seq;
+  }
+  json += "]}";
+  return any ? json : String();
+}
+
+void profileMarkUploaded() {
+  if (summarySeq != 0) rtcProfile.uploadedSeq = summarySeq;
+}
@@ -0,0 +1,63 @@
+// profiler.h
+//
+// Per-wake phase timing. Modules mark their phases with PROFILE_SCOPE;
+// each phase records its own time (nested phases are not counted
+// twice), how often it ran, and the free heap and largest free block
+// around it. The last PROFILE_CYCLES wakes are kept in RTC memory, so
+// the timeline survives deep sleep; it is printed over Serial on
+// request ('p') and can be uploaded with a sync.
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+
+enum ProfilePhase {
+  PHASE_DISPLAY_INIT,
+  PHASE_DISPLAY,    // waiting on the panel: frame queue full, flushes
+  PHASE_CACHE,      // quote cache mount and reads
+  PHASE_WIFI,
+  PHASE_TLS,        // TLS handshakes
+  PHASE_AUTH,
+  PHASE_SYNC,
+  PHASE_OTA,
+  PHASE_SHUTDOWN,   // radio and panel power-down before sleep
+  PHASE_COUNT
+};
+
+// Start recording this wake. `wakeReason` is a WakeReason.
+void profileBeginCycle(uint32_t wake, uint8_t wakeReason);
+
+// Close this wake's record and store it in the RTC ring buffer
+void profileEndCycle();
+
+// Phase markers; prefer PROFILE_SCOPE
+void profileEnter(ProfilePhase phase);
+void profileLeave(ProfilePhase phase);
+
+// Print every stored wake over Serial
+void profileDump();
+
+// Dump if 'p' was sent over Serial
+void profilePollSerial();
+
+// Compact JSON of the wakes not uploaded yet ("" if none)
+String profileSummaryJson();
+
+// The wakes in the last profileSummaryJson() were uploaded
+void profileMarkUploaded();
+
+// Marks a phase for the rest of the enclosing block
+class ProfileScope {
+public:
+  explicit ProfileScope(ProfilePhase phase) : _phase(phase) { profileEnter(phase); }
+  ~ProfileScope() { profileLeave(_phase); }
+
+private:
+  ProfilePhase _phase;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b)  PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(phase)  ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(phase)
+
+#endif
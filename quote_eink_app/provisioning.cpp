@@ -7,8 +7,9 @@
 #include <WebServer.h>
 #include <DNSServer.h>
 
-// Implemented in quote_eink_app.ino
+// Implemented in display_manager.cpp
 extern void displayStatus(const String &msg);
+extern void displayFlush();
 
 WebServer server(80);
 DNSServer dnsServer;
@@ -60,10 +61,13 @@ void handleRoot() {
 
 void handleSave() {
   if (server.hasArg("wifi_ssid")) {
-    writeNVS("wifi_ssid",     server.arg("wifi_ssid"));
-    writeNVS("wifi_password", server.arg("wifi_password"));
-    writeNVS("fb_email",      server.arg("fb_email"));
-    writeNVS("fb_password",   server.arg("fb_password"));
+    AppConfig &cfg = configEdit();
+    cfg.wifiSsid     = server.arg("wifi_ssid");
+    cfg.wifiPassword = server.arg("wifi_password");
+    cfg.fbEmail      = server.arg("fb_email");
+    cfg.fbPassword   = server.arg("fb_password");
+    cfg.provisioned  = true;
+    configCommit();
 
     String response = F(
       "<html><body><h2>Saved!</h2>"
@@ -74,6 +78,7 @@ void handleSave() {
     displayStatus("Setup saved.\nRebooting...");
 
     delay(2000);
+    displayFlush();
     ESP.restart();
   } else {
     server.send(400, "text/plain", "Bad Request");
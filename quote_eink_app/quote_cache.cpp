@@ -0,0 +1,310 @@
+// quote_cache.cpp
+
+#include "quote_cache.h"
+
+#include <LittleFS.h>
+
+#include "profiler.h"
+
+#define CACHE_DATA_PATH  "/quotes.dat"
+#define CACHE_INDEX_PATH "/quotes.idx"
+#define CACHE_STAGE_PATH "/quotes.tmp"
+
+#define CACHE_INDEX_MAGIC   0x31495151UL   // "QQI1"
+#define CACHE_INDEX_HEADER  12             // magic, count, data size
+#define CACHE_RECORD_HEADER 6
+
+static bool     mounted    = false;
+static uint32_t quoteCount = 0;
+static File     stageFile;
+
+static void putU16(uint8_t *p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+static void putU32(uint8_t *p, uint32_t v) {
+  for (int i = 0; i < 4; i++) p[i] = (v >> (8 * i)) & 0xFF;
+}
+
+static uint16_t getU16(const uint8_t *p) {
+  return p[0] | (p[1] << 8);
+}
+
+static uint32_t getU32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+         ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Read `len` bytes into a String
+static bool readString(File &f, uint32_t len, String &out) {
+  out = "";
+  if (len == 0) return true;
+  if (!out.reserve(len)) return false;
+  char buf[64];
+  while (len > 0) {
+    size_t n = f.read((uint8_t *)buf, len < sizeof(buf) ? len : sizeof(buf));
+    if (n == 0) return false;
+    out.concat(buf, n);
+    len -= n;
+  }
+  return true;
+}
+
+static uint32_t recordLength(const uint8_t *rec) {
+  return CACHE_RECORD_HEADER + rec[0] + getU16(rec + 1) + rec[3] + getU16(rec + 4);
+}
+
+// Walk the data file and write a fresh offset index for it.
+// A truncated last record (power cut mid-write) is dropped.
+static bool rebuildIndex() {
+  quoteCount = 0;
+  LittleFS.remove(CACHE_INDEX_PATH);
+
+  File data = LittleFS.open(CACHE_DATA_PATH, FILE_READ);
+  if (!data) return true;   // nothing cached yet
+
+  File index = LittleFS.open(CACHE_INDEX_PATH, FILE_WRITE);
+  if (!index) {
+    Serial.println("[CACHE] Cannot write index.");
+    return false;
+  }
+
+  uint8_t header[CACHE_INDEX_HEADER] = {0};
+  index.write(header, sizeof(header));   // filled in at the end
+
+  uint32_t size   = data.size();
+  uint32_t offset = 0;
+  uint32_t count  = 0;
+  uint8_t  rec[CACHE_RECORD_HEADER];
+
+  while (offset + CACHE_RECORD_HEADER <= size) {
+    data.seek(offset);
+    if (data.read(rec, sizeof(rec)) != sizeof(rec)) break;
+    uint32_t len = recordLength(rec);
+    if (offset + len > size) break;
+
+    uint8_t off[4];
+    putU32(off, offset);
+    index.write(off, sizeof(off));
+    offset += len;
+    count++;
+  }
+
+  putU32(header, CACHE_INDEX_MAGIC);
+  putU32(header + 4, count);
+  putU32(header + 8, offset);
+  index.seek(0);
+  index.write(header, sizeof(header));
+  index.close();
+  data.close();
+
+  quoteCount = count;
+  Serial.printf("[CACHE] Indexed %lu quotes (%lu bytes)\n",
+                (unsigned long)count, (unsigned long)offset);
+  return true;
+}
+
+// The index must describe the data file exactly
+static bool indexValid() {
+  File index = LittleFS.open(CACHE_INDEX_PATH, FILE_READ);
+  if (!index) return false;
+
+  uint8_t header[CACHE_INDEX_HEADER];
+  if (index.read(header, sizeof(header)) != sizeof(header) ||
+      getU32(header) != CACHE_INDEX_MAGIC) {
+    return false;
+  }
+  uint32_t count    = getU32(header + 4);
+  uint32_t dataSize = getU32(header + 8);
+  if (index.size() != CACHE_INDEX_HEADER + 4UL * count) return false;
+
+  File data = LittleFS.open(CACHE_DATA_PATH, FILE_READ);
+  if (!data || data.size() != dataSize) return false;
+
+  quoteCount = count;
+  return true;
+}
+
+bool quoteCacheBegin() {
+  if (mounted) return true;
+  PROFILE_SCOPE(PHASE_CACHE);
+
+  if (!LittleFS.begin(true)) {   // format on first use
+    Serial.println("[CACHE] LittleFS mount failed.");
+    return false;
+  }
+  mounted = true;
+
+  if (LittleFS.exists(CACHE_DATA_PATH) && !indexValid()) {
+    Serial.println("[CACHE] Index missing or stale, rebuilding.");
+    if (!rebuildIndex()) return false;
+  }
+
+  Serial.printf("[CACHE] %lu quotes cached\n", (unsigned long)quoteCount);
+  return true;
+}
+
+uint32_t quoteCacheCount() {
+  return quoteCount;
+}
+
+// Open the data file positioned after the header of record `i`
+static bool openRecord(uint32_t i, File &data, uint8_t *rec) {
+  if (!mounted || i >= quoteCount) return false;
+
+  File index = LittleFS.open(CACHE_INDEX_PATH, FILE_READ);
+  uint8_t off[4];
+  if (!index || !index.seek(CACHE_INDEX_HEADER + 4UL * i) ||
+      index.read(off, sizeof(off)) != sizeof(off)) {
+    return false;
+  }
+
+  data = LittleFS.open(CACHE_DATA_PATH, FILE_READ);
+  return data && data.seek(getU32(off)) &&
+         data.read(rec, CACHE_RECORD_HEADER) == CACHE_RECORD_HEADER;
+}
+
+bool quoteCacheGet(uint32_t i, Quote &out) {
+  PROFILE_SCOPE(PHASE_CACHE);
+  File data;
+  uint8_t rec[CACHE_RECORD_HEADER];
+  if (!openRecord(i, data, rec)) return false;
+
+  return readString(data, rec[0], out.id) &&
+         readString(data, getU16(rec + 1), out.text) &&
+         readString(data, rec[3], out.author) &&
+         readString(data, getU16(rec + 4), out.tagsLine);
+}
+
+bool quoteCacheRandom(Quote &out) {
+  if (quoteCount == 0) return false;
+  return quoteCacheGet(random(quoteCount), out);
+}
+
+bool quoteCacheForEachId(QuoteIdVisitor visit, void *ctx) {
+  if (!mounted) return false;
+  if (quoteCount == 0) return true;
+
+  File data = LittleFS.open(CACHE_DATA_PATH, FILE_READ);
+  if (!data) return false;
+
+  uint32_t offset = 0;
+  uint8_t rec[CACHE_RECORD_HEADER];
+  String id;
+  for (uint32_t i = 0; i < quoteCount; i++) {
+    if (!data.seek(offset) || data.read(rec, sizeof(rec)) != sizeof(rec) ||
+        !readString(data, rec[0], id)) {
+      return false;
+    }
+    visit(i, id, ctx);
+    offset += recordLength(rec);
+  }
+  return true;
+}
+
+void quoteCacheClear() {
+  if (!quoteCacheBegin()) return;
+  stageFile.close();
+  LittleFS.remove(CACHE_STAGE_PATH);
+  LittleFS.remove(CACHE_INDEX_PATH);
+  LittleFS.remove(CACHE_DATA_PATH);
+  quoteCount = 0;
+  Serial.println("[CACHE] Cleared.");
+}
+
+bool quoteCacheStageBegin(uint32_t resumeBytes) {
+  if (!mounted) return false;
+  stageFile.close();
+
+  if (resumeBytes > 0) {
+    File staged = LittleFS.open(CACHE_STAGE_PATH, FILE_READ);
+    if (!staged || staged.size() != resumeBytes) return false;
+    staged.close();
+    stageFile = LittleFS.open(CACHE_STAGE_PATH, FILE_APPEND);
+  } else {
+    stageFile = LittleFS.open(CACHE_STAGE_PATH, FILE_WRITE);
+  }
+  return (bool)stageFile;
+}
+
+bool quoteCacheStageAdd(const Quote &quote) {
+  if (!stageFile) return false;
+
+  // Field lengths are clipped to what the record header can hold
+  uint8_t  idLen     = min(quote.id.length(), 255U);
+  uint16_t textLen   = min(quote.text.length(), 65535U);
+  uint8_t  authorLen = min(quote.author.length(), 255U);
+  uint16_t tagsLen   = min(quote.tagsLine.length(), 65535U);
+
+  uint8_t rec[CACHE_RECORD_HEADER];
+  rec[0] = idLen;
+  putU16(rec + 1, textLen);
+  rec[3] = authorLen;
+  putU16(rec + 4, tagsLen);
+
+  size_t want = sizeof(rec) + idLen + textLen + authorLen + tagsLen;
+  size_t wrote = stageFile.write(rec, sizeof(rec));
+  wrote += stageFile.write((const uint8_t *)quote.id.c_str(), idLen);
+  wrote += stageFile.write((const uint8_t *)quote.text.c_str(), textLen);
+  wrote += stageFile.write((const uint8_t *)quote.author.c_str(), authorLen);
+  wrote += stageFile.write((const uint8_t *)quote.tagsLine.c_str(), tagsLen);
+  return wrote == want;
+}
+
+bool quoteCacheStageCopy(const uint8_t *keep) {
+  if (!stageFile) return false;
+  if (quoteCount == 0) return true;
+
+  File data = LittleFS.open(CACHE_DATA_PATH, FILE_READ);
+  if (!data) return false;
+
+  uint8_t rec[CACHE_RECORD_HEADER];
+  uint8_t buf[128];
+  for (uint32_t i = 0; i < quoteCount; i++) {
+    if (data.read(rec, sizeof(rec)) != sizeof(rec)) return false;
+    uint32_t left = recordLength(rec) - CACHE_RECORD_HEADER;
+
+    if (!(keep[i / 8] & (1 << (i % 8)))) {
+      if (!data.seek(left, SeekCur)) return false;
+      continue;
+    }
+
+    if (stageFile.write(rec, sizeof(rec)) != sizeof(rec)) return false;
+    while (left > 0) {
+      size_t n = data.read(buf, left < sizeof(buf) ? left : sizeof(buf));
+      if (n == 0 || stageFile.write(buf, n) != n) return false;
+      left -= n;
+    }
+  }
+  return true;
+}
+
+uint32_t quoteCacheStageBytes() {
+  return stageFile ? stageFile.size() : 0;
+}
+
+void quoteCacheStageClose() {
+  stageFile.close();
+}
+
+bool quoteCacheStageCommit() {
+  stageFile.close();
+
+  // Drop the old index first: a power cut before the new one is
+  // written leaves no index, which quoteCacheBegin() rebuilds. The
+  // rename replaces the old data atomically, so there is always a
+  // complete quotes.dat, old or new.
+  LittleFS.remove(CACHE_INDEX_PATH);
+  if (!LittleFS.rename(CACHE_STAGE_PATH, CACHE_DATA_PATH)) {
+    Serial.println("[CACHE] Cannot replace cache, keeping the old one.");
+    rebuildIndex();
+    return false;
+  }
+  return rebuildIndex();
+}
+
+void quoteCacheStageDiscard() {
+  stageFile.close();
+  LittleFS.remove(CACHE_STAGE_PATH);
+}
@@ -0,0 +1,69 @@
+// quote_cache.h
+//
+// Local copy of the user's quotes in LittleFS, so most wakes can show
+// a quote with the radio off. Quotes are packed records with an offset
+// index, so picking one reads only that record:
+//
+//   /quotes.dat  records back to back, each a 6-byte header
+//                (u8 idLen, u16 textLen, u8 authorLen, u16 tagsLen,
+//                little-endian) followed by the id, text, author and
+//                tags bytes
+//   /quotes.idx  u32 magic, u32 count, u32 data size, then one u32
+//                record offset per quote
+//
+// A sync stages the new copy in /quotes.tmp and swaps it in once it
+// is complete, so an interrupted sync leaves the old cache usable.
+#ifndef QUOTE_CACHE_H
+#define QUOTE_CACHE_H
+
+#include <Arduino.h>
+#include "quote_stream.h"   // Quote
+
+// Mount the filesystem (formatting it on first use) and check the
+// index, rebuilding it from the data file if it is missing or stale
+bool quoteCacheBegin();
+
+// Number of cached quotes (0 before the first sync)
+uint32_t quoteCacheCount();
+
+// Read quote `i` (0-based)
+bool quoteCacheGet(uint32_t i, Quote &out);
+
+// Read a uniformly random quote
+bool quoteCacheRandom(Quote &out);
+
+// Call `visit` with the position and document ID of every cached
+// quote, in order, in one pass over the data file
+typedef void (*QuoteIdVisitor)(uint32_t i, const String &id, void *ctx);
+bool quoteCacheForEachId(QuoteIdVisitor visit, void *ctx);
+
+// Delete the cache and any staged copy (on logout)
+void quoteCacheClear();
+
+// --- Staging a new copy ---
+
+// Open the staged copy. With `resumeBytes` > 0, continue a copy staged
+// on an earlier wake; fails if the staged file is not exactly that
+// size, and the caller should start over with 0.
+bool quoteCacheStageBegin(uint32_t resumeBytes);
+
+// Append one quote to the staged copy
+bool quoteCacheStageAdd(const Quote &quote);
+
+// Append the cached quotes whose bit is set in `keep` (bit i of
+// keep[i / 8]) to the staged copy unchanged, in one pass
+bool quoteCacheStageCopy(const uint8_t *keep);
+
+// Size of the staged copy so far, to resume from later
+uint32_t quoteCacheStageBytes();
+
+// Close the staged copy, keeping it for a later wake
+void quoteCacheStageClose();
+
+// Replace the cache with the staged copy and index it
+bool quoteCacheStageCommit();
+
+// Throw the staged copy away
+void quoteCacheStageDiscard();
+
+#endif
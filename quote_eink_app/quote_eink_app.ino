@@ -2,10 +2,18 @@
 //
 // Main orchestration for the Quote E-Ink App.
 // All logic lives in the modules:
-//  - display_manager.*
+//  - display_manager.*, text_layout.*
 //  - wifi_manager.*
 //  - firebase_client.*
-//  - ota_manager.*
+//  - quote_stream.*
+//  - quote_cache.*
+//  - quote_rotation.*, quote_queue.*
+//  - connection_manager.*
+//  - token_manager.*
+//  - rtc_clock.*
+//  - scheduler.*, job_schedule.*
+//  - profiler.*
+//  - ota_manager.*, lzss_decoder.*
 //  - app_prefs.*
 //  - provisioning.*
 //  - logout_manager.*
@@ -19,7 +27,12 @@
 #include "display_manager.h"
 #include "wifi_manager.h"
 #include "firebase_client.h"
+#include "quote_cache.h"
+#include "quote_rotation.h"
 #include "ota_manager.h"
+#include "connection_manager.h"
+#include "scheduler.h"
+#include "profiler.h"
 #include "app_prefs.h"
 #include "provisioning.h"
 #include "logout_manager.h"
@@ -31,38 +44,113 @@
 #define LOGOUT_BUTTON_PIN 21
 const unsigned long LOGOUT_LONG_PRESS_MS = 3000;  // 3 seconds
 
-bool logoutBtnPressed = false;
-unsigned long logoutBtnPressStart = 0;
+// Woken by the button: a long press logs out, a short one is ignored
+static void handleLogoutButton() {
+  unsigned long pressStart = millis();
+  while (digitalRead(LOGOUT_BUTTON_PIN) == LOW) {  // button pulls pin to GND
+    if (millis() - pressStart >= LOGOUT_LONG_PRESS_MS) {
+      displayInit(false);
+      deviceLogout();  // implemented in logout_manager.cpp (clears creds + restart)
+    }
+    delay(20);
+  }
+  Serial.println("[BOOT] Short button press, ignoring.");
+}
+
+// ----------------------------------------
+// QUOTE
+// ----------------------------------------
+
+// Show the next queued quote from the local cache (no network needed)
+static bool showCachedQuote() {
+  Quote quote;
+  if (!rotationNext(quote)) {
+    return false;
+  }
+
+  Serial.println("[QUOTE] Selected quote:");
+  Serial.println("TEXT: " + quote.text);
+  Serial.println("AUTHOR: " + quote.author);
+  Serial.println("TAGS: " + quote.tagsLine);
+
+  if (quote.text.length() == 0) {
+    displayError("Quote missing text");
+    return true;
+  }
+
+  displayQuote(quote);
+
+  // Compose the next one while the panel refreshes, so its wake only
+  // has to send it
+  Quote next;
+  if (rotationPeek(next) && next.text.length() > 0) {
+    displayPrepareQuote(next);
+  }
+  return true;
+}
 
 // ----------------------------------------
-// TIMERS
+// SLEEP
 // ----------------------------------------
 
-unsigned long lastQuoteUpdate = 0;
-unsigned long lastUpdateCheck = 0;
+// Power everything down and deep-sleep until the next job is due
+static void goToSleep() {
+  {
+    PROFILE_SCOPE(PHASE_SHUTDOWN);
+    connCloseAll();
+    WiFi.disconnect(true);
+    WiFi.mode(WIFI_OFF);
+    displayPowerOff();
+  }
+  displayPrintStats();
+  profileEndCycle();
+  profilePollSerial();                // 'p' dumps the timeline
+  schedulerSleep(LOGOUT_BUTTON_PIN);  // never returns
+}
 
 // ----------------------------------------
 // SETUP
 // ----------------------------------------
+//
+// Every wake from deep sleep starts here: run the jobs that are due,
+// then sleep again. loop() is never reached.
 
 void setup() {
   Serial.begin(115200);
-  delay(1500);
+
+  WakeReason wake = schedulerBegin(LOGOUT_BUTTON_PIN);
+  profileBeginCycle(schedulerWakeCount(), wake);
+  bool coldBoot = (wake == WAKE_COLD_BOOT);
+  if (coldBoot) {
+    delay(1500);  // time to open the serial monitor
+  }
 
   Serial.println();
   Serial.print("==== Quote E-Ink App FW ");
   Serial.print(FW_VERSION);
   Serial.println(" ====");
+  profilePollSerial();
 
-  // Init E-Ink screen (landscape)
-  displayInit();
+  // Setup logout button
+  pinMode(LOGOUT_BUTTON_PIN, INPUT_PULLUP);
+
+  if (wake == WAKE_BUTTON) {
+    handleLogoutButton();
+  }
+
+  bool runOta   = schedulerShouldRun(JOB_OTA_CHECK);
+  bool runQuote = schedulerShouldRun(JOB_QUOTE);
+  bool runSync  = schedulerShouldRun(JOB_SYNC);
+  if (!runOta && !runQuote && !runSync) {
+    goToSleep();
+  }
+
+  // Init E-Ink screen (landscape); keep the last quote up on a wake
+  displayInit(coldBoot);
 
   // Seed RNG for random quote selection
   randomSeed(esp_random());
 
-  // Setup logout button
-  pinMode(LOGOUT_BUTTON_PIN, INPUT_PULLUP);
-
   // FIRST BOOT → NO CREDS → start provisioning portal
   if (!isProvisioned()) {
     Serial.println("[BOOT] Device not provisioned. Starting provisioning...");
@@ -70,22 +158,77 @@ void setup() {
     startProvisioning();             // Will reboot after successful provisioning
   }
 
-  // Connect to Wi-Fi (or return to provisioning inside wifi_manager if needed)
-  connectWiFi();
+  // Nothing cached yet (first boot, or after logout), or the queued
+  // quotes ran out: sync now, and bring along an OTA check due soon
+  quoteCacheBegin();
+  if (runQuote && !runSync && (quoteCacheCount() == 0 || rotationWantsSync())) {
+    schedulerRunNow(JOB_SYNC);
+    runSync = true;
+    runOta  = schedulerShouldRun(JOB_OTA_CHECK);
+  }
 
-  // Check GitHub OTA immediately at boot
-  checkForUpdate();
+  // Most wakes only show a cached quote and never turn the radio on.
+  // With the network down, the jobs that need it are retried at the
+  // next quote interval and a cached quote goes back up meanwhile.
+  String syncErr;
+  if ((runOta || runSync) && !connectWiFi()) {
+    syncErr = "Wi-Fi connection failed.";
+    if (runOta)  schedulerRetryIn(JOB_OTA_CHECK, QUOTE_INTERVAL_MS);
+    if (runSync) schedulerRetryIn(JOB_SYNC, QUOTE_INTERVAL_MS);
+    runOta   = false;
+    runSync  = false;
+    runQuote = true;   // over the "Connecting" screen
+  }
 
-  // Authenticate to Firebase (REST, your custom module)
-  if (ensureFirebaseAuth()) {
-    fetchAndDisplayQuote();
+  if (runOta || runSync) {
+    // All requests of this wake share one connection per host
+    connBeginWake();
+
+    // Check GitHub OTA (at boot, then with the first sync of each day;
+    // usually a 304). A failed check or an interrupted download is
+    // retried at the next quote interval.
+    if (runOta) {
+      if (checkForUpdate()) {
+        schedulerMarkRun(JOB_OTA_CHECK);
+      } else {
+        schedulerRetryIn(JOB_OTA_CHECK, QUOTE_INTERVAL_MS);
+      }
+    }
+
+    // Refresh the quote cache. Failures and unfinished syncs are
+    // retried at the next quote interval, not in a tight loop.
+    if (runSync) {
+      bool synced = false;
+      if (ensureFirebaseAuth()) {
+        synced = syncQuotes(syncErr);
+      } else {
+        syncErr = "Firebase login failed.";
+      }
+      if (synced) {
+        schedulerMarkRun(JOB_SYNC);
+        rotationRefill();
+        uploadProfileSummary();
+      } else {
+        Serial.println("[QUOTE] Sync: " + syncErr);
+        schedulerRetryIn(JOB_SYNC, QUOTE_INTERVAL_MS);
+      }
+    }
+
+    connPrintStats();
+  }
+
+  // Offline-first: a failed sync still shows a cached quote
+  if (runQuote) {
+    if (!showCachedQuote()) {
+      displayError(syncErr.length() > 0 ? syncErr : String("No quotes found."));
+    }
+    schedulerMarkRun(JOB_QUOTE);
   }
 
   // OTA rollback: if running new firmware in PENDING_VERIFY → mark as valid
   finalizeOtaIfPending();
 
-  lastQuoteUpdate = millis();
-  lastUpdateCheck = millis();
+  goToSleep();
 }
 
 // ----------------------------------------
@@ -93,49 +236,5 @@ void setup() {
 // ----------------------------------------
 
 void loop() {
-
-  // -----------------------
-  // 1. LOGOUT BUTTON LOGIC
-  // -----------------------
-  int rawState = digitalRead(LOGOUT_BUTTON_PIN);
-  bool isPressed = (rawState == LOW);  // button pulls pin to GND
-
-  if (isPressed && !logoutBtnPressed) {
-    // Button newly pressed
-    logoutBtnPressed = true;
-    logoutBtnPressStart = millis();
-  }
-  else if (!isPressed && logoutBtnPressed) {
-    // Released early → cancel
-    logoutBtnPressed = false;
-  }
-
-  if (logoutBtnPressed &&
-      (millis() - logoutBtnPressStart >= LOGOUT_LONG_PRESS_MS)) {
-    // Long press → LOGOUT
-    deviceLogout();  // implemented in logout_manager.cpp (clears creds + restart)
-  }
-
-  // -----------------------
-  // 2. PERIODIC QUOTE UPDATE
-  // -----------------------
-  if (millis() - lastQuoteUpdate >= QUOTE_INTERVAL_MS) {
-    if (WiFi.status() == WL_CONNECTED) {
-      fetchAndDisplayQuote();
-    } else {
-      displayError("Wi-Fi lost.\nReconnecting...");
-      WiFi.reconnect();
-    }
-    lastQuoteUpdate = millis();
-  }
-
-  // -----------------------
-  // 3. DAILY OTA CHECK
-  // -----------------------
-  if (millis() - lastUpdateCheck >= 86400000UL) { // 24 hours
-    checkForUpdate();
-    lastUpdateCheck = millis();
-  }
-
-  delay(100);
+  // Not reached: setup() ends in deep sleep
 }
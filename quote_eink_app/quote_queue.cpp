@@ -0,0 +1,73 @@
+// quote_queue.cpp
+
+#include "quote_queue.h"
+
+#define QUEUE_NONE 0xFFFFFFFFUL
+
+void queueClear(QuoteQueue &q) {
+  q.size       = 0;
+  q.next       = 0;
+  q.cacheCount = 0;
+  q.last       = QUEUE_NONE;
+  q.filledMs   = 0;
+}
+
+static bool picked(const QuoteQueue &q, uint16_t n, uint32_t pos) {
+  for (uint16_t i = 0; i < n; i++) {
+    if (q.pick[i] == pos) return true;
+  }
+  return false;
+}
+
+void queueFill(QuoteQueue &q, uint32_t cacheCount, uint16_t k,
+               QueueRandom randomBelow, uint64_t nowMs) {
+  if (k > QUOTE_QUEUE_MAX) k = QUOTE_QUEUE_MAX;
+  if (k > cacheCount) k = cacheCount;
+
+  // Floyd's sampling: k distinct positions in k random draws
+  uint16_t n = 0;
+  for (uint32_t j = cacheCount - k; j < cacheCount; j++) {
+    uint32_t t = randomBelow(j + 1);
+    if (picked(q, n, t)) t = j;
+    q.pick[n++] = t;
+  }
+
+  // ...which are not in random order, so shuffle them
+  for (uint16_t i = n; i > 1; i--) {
+    uint16_t j = randomBelow(i);
+    uint32_t tmp = q.pick[i - 1];
+    q.pick[i - 1] = q.pick[j];
+    q.pick[j] = tmp;
+  }
+
+  if (n > 1 && q.pick[0] == q.last) {
+    q.pick[0] = q.pick[n - 1];
+    q.pick[n - 1] = q.last;
+  }
+
+  q.size       = n;
+  q.next       = 0;
+  q.cacheCount = cacheCount;
+  q.filledMs   = nowMs;
+}
+
+bool queueTake(QuoteQueue &q, uint32_t cacheCount, uint32_t &pos) {
+  if (q.next >= q.size || q.cacheCount != cacheCount) return false;
+  pos = q.pick[q.next++];
+  q.last = pos;
+  return true;
+}
+
+bool queuePeek(const QuoteQueue &q, uint32_t cacheCount, uint32_t &pos) {
+  if (q.next >= q.size || q.cacheCount != cacheCount) return false;
+  pos = q.pick[q.next];
+  return true;
+}
+
+uint16_t queueLeft(const QuoteQueue &q) {
+  return q.next < q.size ? q.size - q.next : 0;
+}
+
+bool queueWantsSync(const QuoteQueue &q, uint64_t nowMs, uint64_t maxAgeMs) {
+  return queueLeft(q) == 0 || nowMs - q.filledMs >= maxAgeMs;
+}
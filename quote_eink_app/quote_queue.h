@@ -0,0 +1,50 @@
+// quote_queue.h
+//
+// Quotes to show between syncs. A fill picks K distinct random quotes
+// from the cache; each quote wake takes the next one with the radio
+// off, and the queue asks for a sync once it is drained or too old.
+// Pure logic on a caller-supplied "now" (monotonic ms) and random
+// source, no hardware access, so it can be driven from a fake clock on
+// the host.
+#ifndef QUOTE_QUEUE_H
+#define QUOTE_QUEUE_H
+
+#include <stdint.h>
+
+#define QUOTE_QUEUE_MAX 32
+
+struct QuoteQueue {
+  uint32_t pick[QUOTE_QUEUE_MAX];   // cache positions, in showing order
+  uint16_t size;                    // picks in this fill
+  uint16_t next;                    // next pick to show
+  uint32_t cacheCount;              // cache size the picks came from
+  uint32_t last;                    // position shown last
+  uint64_t filledMs;
+};
+
+// Uniform random number in [0, bound)
+typedef uint32_t (*QueueRandom)(uint32_t bound);
+
+// Empty queue; the next take fails
+void queueClear(QuoteQueue &q);
+
+// Pick min(k, QUOTE_QUEUE_MAX, cacheCount) distinct positions out of
+// `cacheCount`, in random order. The quote shown last is not picked
+// first, so a refill never repeats it straight away.
+void queueFill(QuoteQueue &q, uint32_t cacheCount, uint16_t k,
+               QueueRandom randomBelow, uint64_t nowMs);
+
+// Next position to show. False when drained, or when the cache no
+// longer has `cacheCount` quotes (the picks would point elsewhere).
+bool queueTake(QuoteQueue &q, uint32_t cacheCount, uint32_t &pos);
+
+// The position the next take would return, without taking it
+bool queuePeek(const QuoteQueue &q, uint32_t cacheCount, uint32_t &pos);
+
+// Picks not shown yet
+uint16_t queueLeft(const QuoteQueue &q);
+
+// True when the queue is drained or was filled `maxAgeMs` or more ago
+bool queueWantsSync(const QuoteQueue &q, uint64_t nowMs, uint64_t maxAgeMs);
+
+#endif
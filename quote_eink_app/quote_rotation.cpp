@@ -0,0 +1,70 @@
+// quote_rotation.cpp
+
+#include "quote_rotation.h"
+
+#include "quote_queue.h"
+#include "quote_cache.h"
+#include "scheduler.h"   // schedulerNowMs
+
+// Quotes picked per sync. At the default 30 min quote interval, 12
+// last until the next scheduled sync.
+#ifndef QUOTE_QUEUE_SIZE
+#define QUOTE_QUEUE_SIZE 12
+#endif
+
+// A queue this old asks for a sync even if not drained
+#ifndef QUOTE_QUEUE_MAX_AGE_MS
+#define QUOTE_QUEUE_MAX_AGE_MS 21600000ULL  // 6 hours
+#endif
+
+#define ROTATION_RTC_MAGIC 0x51554531UL   // "QUE1"
+
+// Survives deep sleep; reset by power-on and software restart
+struct RotationRtc {
+  uint32_t   magic;
+  QuoteQueue queue;
+};
+
+RTC_DATA_ATTR static RotationRtc rtcRotation;
+
+static uint32_t randomBelow(uint32_t bound) {
+  return (uint32_t)random((long)bound);
+}
+
+static QuoteQueue &queue() {
+  if (rtcRotation.magic != ROTATION_RTC_MAGIC) {
+    queueClear(rtcRotation.queue);
+    rtcRotation.magic = ROTATION_RTC_MAGIC;
+  }
+  return rtcRotation.queue;
+}
+
+void rotationRefill() {
+  QuoteQueue &q = queue();
+  queueFill(q, quoteCacheCount(), QUOTE_QUEUE_SIZE, randomBelow, schedulerNowMs());
+  Serial.printf("[QUOTE] Queued %u of %lu quotes\n",
+                q.size, (unsigned long)q.cacheCount);
+}
+
+bool rotationWantsSync() {
+  return queueWantsSync(queue(), schedulerNowMs(), QUOTE_QUEUE_MAX_AGE_MS);
+}
+
+bool rotationPeek(Quote &out) {
+  uint32_t pos;
+  if (!queuePeek(queue(), quoteCacheCount(), pos)) return false;
+  return quoteCacheGet(pos, out);
+}
+
+bool rotationNext(Quote &out) {
+  QuoteQueue &q = queue();
+  uint32_t pos;
+  if (!queueTake(q, quoteCacheCount(), pos)) {
+    Serial.println("[QUOTE] Queue empty, refilling from the cache.");
+    rotationRefill();
+    if (!queueTake(q, quoteCacheCount(), pos)) return false;
+  }
+  Serial.printf("[QUOTE] Showing queued quote %lu (%u left)\n",
+                (unsigned long)pos, queueLeft(q));
+  return quoteCacheGet(pos, out);
+}
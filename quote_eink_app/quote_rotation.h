@@ -0,0 +1,30 @@
+// quote_rotation.h
+//
+// Which cached quote each wake shows. A queue of QUOTE_QUEUE_SIZE
+// distinct random picks (quote_queue.h) lives in RTC memory; it is
+// refilled after every sync, and each quote wake takes the next pick
+// and reads just that record from the cache, with the radio off. Once
+// the queue drains (or gets old) the next wake syncs again.
+#ifndef QUOTE_ROTATION_H
+#define QUOTE_ROTATION_H
+
+#include <Arduino.h>
+#include "quote_stream.h"   // Quote
+
+// Draw a new queue from the cache (after a sync)
+void rotationRefill();
+
+// True when the queue is drained or older than QUOTE_QUEUE_MAX_AGE_MS,
+// so this wake should sync before showing a quote
+bool rotationWantsSync();
+
+// Read the quote the next rotationNext() will return, without taking
+// it (to render it ahead). False when the queue is drained, since the
+// next wake syncs and refills it.
+bool rotationPeek(Quote &out);
+
+// Read the next quote to show. A drained queue (no sync possible) is
+// refilled from the cache as it is.
+bool rotationNext(Quote &out);
+
+#endif
@@ -0,0 +1,333 @@
+// quote_stream.cpp
+
+#include "quote_stream.h"
+
+#include <ArduinoJson.h>
+
+// ----------------------------------------
+// HttpBodyStream
+// ----------------------------------------
+
+HttpBodyStream::HttpBodyStream(Stream &inner, long contentLength, bool chunked)
+  : _inner(inner),
+    _remaining(chunked ? 0 : contentLength),
+    _chunked(chunked),
+    _done(!chunked && contentLength == 0),
+    _firstChunk(true),
+    _consumed(0) {
+  setTimeout(inner.getTimeout());
+}
+
+// Read the next chunk header ("<hex>[;ext]\r\n").
+// Returns false after the terminating zero-length chunk.
+bool HttpBodyStream::nextChunk() {
+  if (!_firstChunk) {
+    _inner.readStringUntil('\n');  // CRLF closing the previous chunk
+  }
+  _firstChunk = false;
+
+  String line = _inner.readStringUntil('\n');
+  long size = strtol(line.c_str(), nullptr, 16);
+  if (size > 0) {
+    _remaining = size;
+    return true;
+  }
+
+  // Last chunk: skip trailers up to the empty line
+  while (true) {
+    String trailer = _inner.readStringUntil('\n');
+    trailer.trim();
+    if (trailer.length() == 0) break;
+  }
+  return false;
+}
+
+int HttpBodyStream::available() {
+  if (_done) return 0;
+  int n = _inner.available();
+  if (_remaining >= 0 && n > _remaining) n = _remaining;
+  return n;
+}
+
+int HttpBodyStream::read() {
+  char c;
+  return readBytes(&c, 1) ? (unsigned char)c : -1;
+}
+
+// Waits up to the inner stream timeout for the next byte
+int HttpBodyStream::peek() {
+  if (_done) return -1;
+  if (_chunked && _remaining == 0 && !nextChunk()) {
+    _done = true;
+    return -1;
+  }
+  unsigned long start = millis();
+  do {
+    int c = _inner.peek();
+    if (c >= 0) return c;
+    delay(1);
+  } while (millis() - start < _timeout);
+  return -1;
+}
+
+size_t HttpBodyStream::readBytes(char *buffer, size_t length) {
+  if (_done) return 0;
+  if (_chunked && _remaining == 0 && !nextChunk()) {
+    _done = true;
+    return 0;
+  }
+  if (_remaining >= 0 && length > (size_t)_remaining) length = _remaining;
+
+  size_t n = _inner.readBytes(buffer, length);
+  _consumed += n;
+  if (_remaining >= 0) {
+    _remaining -= n;
+    if (_remaining == 0 && !_chunked) _done = true;
+  }
+  if (n == 0) _done = true;   // peer closed or timed out
+  return n;
+}
+
+void HttpBodyStream::drain() {
+  char buf[128];
+  while (readBytes(buf, sizeof(buf)) > 0) {
+  }
+}
+
+// ----------------------------------------
+// listDocuments parser
+// ----------------------------------------
+
+// Next non-whitespace character, without consuming it
+static int peekToken(Stream &in) {
+  int c = in.peek();
+  while (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+    in.read();
+    c = in.peek();
+  }
+  return c;
+}
+
+// Keep only the fields we cache and render
+static void documentFilter(JsonObject filter) {
+  filter["name"] = true;
+  filter["updateTime"] = true;
+  filter["fields"]["text"]["stringValue"] = true;
+  filter["fields"]["author"]["stringValue"] = true;
+  filter["fields"]["tagNames"]["arrayValue"]["values"][0]["stringValue"] = true;
+}
+
+static void quoteFromDocument(JsonObjectConst doc, Quote &out) {
+  // name: projects/<p>/databases/(default)/documents/users/<uid>/quotes/<id>
+  const char *name = doc["name"] | "";
+  const char *slash = strrchr(name, '/');
+  out.id = slash ? slash + 1 : name;
+  out.updateTime = doc["updateTime"] | "";
+
+  JsonObjectConst fields = doc["fields"];
+  out.text   = fields["text"]["stringValue"]   | "";
+  out.author = fields["author"]["stringValue"] | "";
+
+  out.tagsLine = "";
+  JsonArrayConst tagArray = fields["tagNames"]["arrayValue"]["values"];
+  for (JsonVariantConst v : tagArray) {
+    const char *tag = v["stringValue"] | "";
+    if (tag[0] != '\0') {
+      if (out.tagsLine.length() > 0) out.tagsLine += "   ";
+      out.tagsLine += "#";
+      out.tagsLine += tag;
+    }
+  }
+}
+
+// A top-level string member, e.g. nextPageToken
+static bool parseString(Stream &in, String &out, const char *what, String &err) {
+  JsonDocument doc;
+  DeserializationError jsonErr = deserializeJson(doc, in);
+  if (jsonErr) {
+    err = jsonErr.c_str();
+    return false;
+  }
+  if (!doc.is<const char *>()) {
+    err = String("malformed ") + what;
+    return false;
+  }
+  out = doc.as<String>();
+  return true;
+}
+
+// Skip a member we do not use. ArduinoJson stops at the closing
+// character of a string, object or array, but reads one past the end of
+// a bare number or literal, so those are skipped here.
+static bool skipValue(Stream &in, String &err) {
+  int c = peekToken(in);
+  if (c == '"' || c == '{' || c == '[') {
+    JsonDocument none;
+    none.set(false);
+    JsonDocument doc;
+    DeserializationError jsonErr = deserializeJson(doc, in, DeserializationOption::Filter(none));
+    if (jsonErr) {
+      err = jsonErr.c_str();
+      return false;
+    }
+    return true;
+  }
+  size_t len = 0;
+  while (c > 0 && strchr(",}] \t\r\n", c) == nullptr) {
+    in.read();
+    c = in.peek();
+    len++;
+  }
+  if (len == 0) {
+    err = c < 0 ? "truncated response" : "missing value";
+    return false;
+  }
+  return true;
+}
+
+// The documents array, one document at a time
+static bool parseDocuments(Stream &in, QuoteVisitor visit, void *ctx, String &err) {
+  if (peekToken(in) != '[') {
+    err = "documents is not an array";
+    return false;
+  }
+  in.read();
+  if (peekToken(in) == ']') {
+    in.read();
+    return true;
+  }
+
+  JsonDocument filter;
+  documentFilter(filter.to<JsonObject>());
+
+  // Reused for every document: sized by the largest single quote
+  JsonDocument doc;
+  Quote quote;
+
+  while (true) {
+    DeserializationError jsonErr =
+      deserializeJson(doc, in, DeserializationOption::Filter(filter));
+    if (jsonErr) {
+      err = jsonErr.c_str();
+      return false;
+    }
+
+    quoteFromDocument(doc.as<JsonObjectConst>(), quote);
+    visit(quote, ctx);
+
+    int sep = peekToken(in);
+    in.read();
+    if (sep == ']') return true;
+    if (sep != ',') {
+      err = sep < 0 ? "truncated response" : "unexpected character after document";
+      return false;
+    }
+  }
+}
+
+// The top-level members may come in any order; the token is only
+// returned once the closing brace is read, so a body that ends early is
+// an error, not the last page.
+bool parseQuoteList(Stream &in, QuoteVisitor visit, void *ctx,
+                    String *nextPageToken, String &err) {
+  if (nextPageToken) *nextPageToken = "";
+  String token;
+
+  int c = peekToken(in);
+  if (c != '{') {
+    err = c < 0 ? "truncated response" : "response is not an object";
+    return false;
+  }
+  in.read();
+
+  // An empty collection is returned as "{}" without a documents key
+  if (peekToken(in) == '}') {
+    in.read();
+    return true;
+  }
+
+  while (true) {
+    c = peekToken(in);
+    if (c != '"') {
+      err = c < 0 ? "truncated response" : "expected a member name";
+      return false;
+    }
+    String key;
+    if (!parseString(in, key, "member name", err)) return false;
+    c = peekToken(in);
+    if (c != ':') {
+      err = c < 0 ? "truncated response" : String("expected ':' after ") + key;
+      return false;
+    }
+    in.read();
+
+    bool ok;
+    if (key == "documents") {
+      ok = parseDocuments(in, visit, ctx, err);
+    } else if (key == "nextPageToken") {
+      ok = parseString(in, token, "nextPageToken", err);
+    } else {
+      ok = skipValue(in, err);
+    }
+    if (!ok) return false;
+
+    int sep = peekToken(in);
+    in.read();
+    if (sep == '}') break;
+    if (sep != ',') {
+      err = sep < 0 ? "truncated response" : String("unexpected character after ") + key;
+      return false;
+    }
+  }
+
+  if (nextPageToken) *nextPageToken = token;
+  return true;
+}
+
+// ----------------------------------------
+// batchGet parser
+// ----------------------------------------
+
+bool parseBatchGet(Stream &in, QuoteVisitor visit, void *ctx, String &err) {
+  // [{"found": {...}, "readTime": ...}, {"missing": "...", ...}, ...]
+  int c = peekToken(in);
+  if (c != '[') {
+    err = c < 0 ? "truncated response" : "batchGet response is not an array";
+    return false;
+  }
+  in.read();
+
+  JsonDocument filter;
+  documentFilter(filter["found"].to<JsonObject>());
+
+  JsonDocument doc;
+  Quote quote;
+
+  if (peekToken(in) == ']') {
+    in.read();
+    return true;
+  }
+
+  while (true) {
+    DeserializationError jsonErr =
+      deserializeJson(doc, in, DeserializationOption::Filter(filter));
+    if (jsonErr) {
+      err = jsonErr.c_str();
+      return false;
+    }
+
+    JsonObjectConst found = doc["found"];
+    if (!found.isNull()) {
+      quoteFromDocument(found, quote);
+      visit(quote, ctx);
+    }
+
+    int sep = peekToken(in);
+    in.read();
+    if (sep == ']') return true;
+    if (sep != ',') {
+      err = sep < 0 ? "truncated response" : "unexpected character after batchGet result";
+      return false;
+    }
+  }
+}
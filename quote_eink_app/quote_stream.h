@@ -0,0 +1,70 @@
+// quote_stream.h
+//
+// Streaming parser for Firestore listDocuments responses.
+// Documents are decoded one at a time straight off the HTTP stream,
+// so peak RAM depends on the largest single quote, not on the
+// number of quotes in the collection.
+#ifndef QUOTE_STREAM_H
+#define QUOTE_STREAM_H
+
+#include <Arduino.h>
+
+// One quote, as shown on the panel
+struct Quote {
+  String id;         // Firestore document ID
+  String text;
+  String author;
+  String tagsLine;   // "#tag1   #tag2"
+  String updateTime; // Firestore updateTime (RFC 3339)
+};
+
+// Called once per parsed document
+typedef void (*QuoteVisitor)(const Quote &quote, void *ctx);
+
+// View of one HTTP response body: stops after Content-Length bytes
+// or after the last chunk of a chunked body, so the connection can be
+// reused for the next request and reads at the end return at once
+// instead of waiting for the socket timeout. With no length and no
+// chunking it reads until the peer closes.
+class HttpBodyStream : public Stream {
+public:
+  HttpBodyStream(Stream &inner, long contentLength, bool chunked);
+
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t readBytes(char *buffer, size_t length) override;
+  size_t write(uint8_t) override { return 0; }
+  void flush() override {}
+
+  // Body bytes consumed so far
+  size_t consumed() const { return _consumed; }
+
+  // Discard whatever is left of the body
+  void drain();
+
+private:
+  bool nextChunk();
+
+  Stream &_inner;
+  long    _remaining;   // bytes left in the body / current chunk, -1 = unknown
+  bool    _chunked;
+  bool    _done;
+  bool    _firstChunk;
+  size_t  _consumed;
+};
+
+// Parse a listDocuments body, calling `visit` for every document.
+// Only the document ID, updateTime, text, author and tagNames are kept.
+// `nextPageToken` (optional) receives the token of the next page,
+// or "" on the last page. Other top-level members are skipped, and the
+// members may come in any order.
+// Returns false on a malformed or truncated body (reason in `err`).
+bool parseQuoteList(Stream &in, QuoteVisitor visit, void *ctx,
+                    String *nextPageToken, String &err);
+
+// Parse a batchGet body, calling `visit` for every found document.
+// Missing (deleted) documents are skipped.
+bool parseBatchGet(Stream &in, QuoteVisitor visit, void *ctx, String &err);
+
+#endif
@@ -0,0 +1,63 @@
+// rtc_clock.cpp
+
+#include "rtc_clock.h"
+
+#include <sys/time.h>
+
+// Anything before 2024-01-01 means the clock was never set
+static const time_t CLOCK_VALID_AFTER = 1704067200;
+
+bool clockIsSet() {
+  return time(nullptr) >= CLOCK_VALID_AFTER;
+}
+
+time_t clockNow() {
+  return time(nullptr);
+}
+
+// Days since 1970-01-01 for a proleptic Gregorian date
+static long daysFromCivil(int y, int m, int d) {
+  y -= m <= 2;
+  long era = (y >= 0 ? y : y - 399) / 400;
+  long yoe = y - era * 400;
+  long doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+bool clockSetFromHttpDate(const String &date) {
+  static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+  int day, year, hour, minute, second;
+  char mon[4] = {0};
+  if (sscanf(date.c_str(), "%*3s, %d %3s %d %d:%d:%d",
+             &day, mon, &year, &hour, &minute, &second) != 6) {
+    return false;
+  }
+
+  const char *m = strstr(months, mon);
+  if (m == nullptr || (m - months) % 3 != 0) return false;
+  int month = (m - months) / 3 + 1;
+
+  struct timeval tv;
+  tv.tv_sec  = (time_t)daysFromCivil(year, month, day) * 86400L +
+               hour * 3600L + minute * 60L + second;
+  tv.tv_usec = 0;
+  if (tv.tv_sec < CLOCK_VALID_AFTER) return false;
+
+  if (!clockIsSet()) {
+    Serial.println("[CLOCK] Set from server: " + date);
+  }
+  settimeofday(&tv, nullptr);
+  return true;
+}
+
+time_t clockParseTimestamp(const String &ts) {
+  int year, month, day, hour, minute, second;
+  if (sscanf(ts.c_str(), "%d-%d-%dT%d:%d:%d",
+             &year, &month, &day, &hour, &minute, &second) != 6) {
+    return 0;
+  }
+  return (time_t)daysFromCivil(year, month, day) * 86400L +
+         hour * 3600L + minute * 60L + second;
+}
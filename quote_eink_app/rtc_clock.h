@@ -0,0 +1,28 @@
+// rtc_clock.h
+//
+// Wall-clock time that survives deep sleep. The ESP32 system time is
+// kept by the RTC timer across deep sleep and software resets, but
+// starts from 0 after power-on, so it is only trusted once it has been
+// set from a server (the Date header of an HTTPS response).
+#ifndef RTC_CLOCK_H
+#define RTC_CLOCK_H
+
+#include <Arduino.h>
+#include <time.h>
+
+// True once the clock holds real time
+bool clockIsSet();
+
+// Seconds since the Unix epoch (meaningless until clockIsSet())
+time_t clockNow();
+
+// Set the clock from an HTTP Date header,
+// e.g. "Sun, 06 Nov 1994 08:49:37 GMT". Returns false if unparseable.
+bool clockSetFromHttpDate(const String &date);
+
+// Seconds since the Unix epoch for an RFC 3339 UTC timestamp as used by
+// Firestore, e.g. "2025-01-01T12:00:00.123456Z" (fraction dropped).
+// Returns 0 if unparseable.
+time_t clockParseTimestamp(const String &ts);
+
+#endif
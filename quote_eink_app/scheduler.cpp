@@ -0,0 +1,160 @@
+// scheduler.cpp
+
+#include "scheduler.h"
+
+#include <sys/time.h>
+#include <esp_sleep.h>
+#include <driver/rtc_io.h>
+
+#include "secrets.h"   // QUOTE_INTERVAL_MS
+
+#ifndef OTA_CHECK_INTERVAL_MS
+#define OTA_CHECK_INTERVAL_MS 86400000ULL   // 24 hours
+#endif
+
+// Quotes are shown from the local cache; the cache is refreshed this often
+#ifndef QUOTE_SYNC_INTERVAL_MS
+#define QUOTE_SYNC_INTERVAL_MS 21600000ULL  // 6 hours
+#endif
+
+// The RTC slow clock drifts by a few percent, so a timer wake can come
+// a little early; jobs due within this window run anyway.
+#ifndef SCHED_WAKE_SLACK_MS
+#define SCHED_WAKE_SLACK_MS 30000ULL
+#endif
+
+// When a wake happens anyway, also run jobs due within this window
+#ifndef SCHED_COALESCE_MS
+#define SCHED_COALESCE_MS 600000ULL
+#endif
+
+// Never arm the timer for less than this
+#ifndef SCHED_MIN_SLEEP_MS
+#define SCHED_MIN_SLEEP_MS 5000ULL
+#endif
+
+#define SCHED_RTC_MAGIC 0x53434833UL   // "SCH3"
+
+// Survives deep sleep; reset by power-on and software restart
+struct SchedulerRtc {
+  uint32_t    magic;
+  uint64_t    sleepStartMs;   // schedulerNowMs() when we went to sleep
+  int64_t     sleepStartUs;   // system time when we went to sleep
+  uint32_t    wakes;
+  JobSchedule jobs;
+};
+
+RTC_DATA_ATTR static SchedulerRtc rtcSched;
+
+static uint64_t bootBaseMs = 0;   // schedulerNowMs() at millis() == 0
+static uint32_t runMask = 0;      // jobs selected for this wake
+
+// System time keeps counting through deep sleep, so it measures how
+// long we actually slept (timer or button)
+static int64_t systemTimeUs() {
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  return (int64_t)tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+WakeReason schedulerBegin(uint8_t buttonPin) {
+  esp_sleep_wakeup_cause_t cause = esp_sleep_get_wakeup_cause();
+  if (cause == ESP_SLEEP_WAKEUP_EXT0) {
+    rtc_gpio_deinit((gpio_num_t)buttonPin);   // back to a digital GPIO
+  }
+  bool fromSleep = (cause == ESP_SLEEP_WAKEUP_TIMER || cause == ESP_SLEEP_WAKEUP_EXT0) &&
+                   rtcSched.magic == SCHED_RTC_MAGIC;
+
+  const uint64_t intervals[JOB_COUNT] = {
+    (uint64_t)QUOTE_INTERVAL_MS,   // JOB_QUOTE
+    OTA_CHECK_INTERVAL_MS,         // JOB_OTA_CHECK
+    QUOTE_SYNC_INTERVAL_MS,        // JOB_SYNC
+  };
+
+  WakeReason reason;
+  if (fromSleep) {
+    int64_t sleptUs = systemTimeUs() - rtcSched.sleepStartUs;
+    if (sleptUs < 0) sleptUs = 0;
+    bootBaseMs = rtcSched.sleepStartMs + sleptUs / 1000 - millis();
+    rtcSched.wakes++;
+    // Intervals come from the firmware, not from RTC memory
+    for (int i = 0; i < JOB_COUNT; i++) rtcSched.jobs.intervalMs[i] = intervals[i];
+    reason = cause == ESP_SLEEP_WAKEUP_EXT0 ? WAKE_BUTTON : WAKE_TIMER;
+  } else {
+    memset(&rtcSched, 0, sizeof(rtcSched));
+    rtcSched.magic = SCHED_RTC_MAGIC;
+    scheduleInit(rtcSched.jobs, intervals);
+    bootBaseMs = 0;
+    reason = WAKE_COLD_BOOT;
+  }
+
+  // The OTA check needs the radio, so it waits for a sync wake instead
+  // of turning it on by itself once a day
+  scheduleRideWith(rtcSched.jobs, JOB_OTA_CHECK, JOB_SYNC);
+
+  runMask = scheduleJobsToRun(rtcSched.jobs, schedulerNowMs(),
+                              SCHED_WAKE_SLACK_MS, SCHED_COALESCE_MS);
+
+  Serial.printf("[SCHED] Wake #%lu (%s), jobs due: %s%s%s\n",
+                (unsigned long)rtcSched.wakes,
+                reason == WAKE_COLD_BOOT ? "cold boot" :
+                reason == WAKE_TIMER ? "timer" : "button",
+                (runMask & (1UL << JOB_QUOTE)) ? "quote " : "",
+                (runMask & (1UL << JOB_OTA_CHECK)) ? "ota " : "",
+                (runMask & (1UL << JOB_SYNC)) ? "sync" : "");
+  return reason;
+}
+
+void schedulerRunNow(SchedJob job) {
+  uint32_t add = (1UL << job) |
+                 scheduleRidersOf(rtcSched.jobs, job, schedulerNowMs(), SCHED_COALESCE_MS);
+  add &= ~runMask;
+  runMask |= add;
+  if (add) {
+    Serial.printf("[SCHED] Also running: %s%s%s\n",
+                  (add & (1UL << JOB_QUOTE)) ? "quote " : "",
+                  (add & (1UL << JOB_OTA_CHECK)) ? "ota " : "",
+                  (add & (1UL << JOB_SYNC)) ? "sync" : "");
+  }
+}
+
+uint32_t schedulerWakeCount() {
+  return rtcSched.wakes;
+}
+
+uint64_t schedulerNowMs() {
+  return bootBaseMs + millis();
+}
+
+bool schedulerShouldRun(SchedJob job) {
+  return runMask & (1UL << job);
+}
+
+void schedulerMarkRun(SchedJob job) {
+  scheduleMarkRun(rtcSched.jobs, job, schedulerNowMs());
+}
+
+void schedulerRetryIn(SchedJob job, uint64_t delayMs) {
+  scheduleRetryIn(rtcSched.jobs, job, schedulerNowMs(), delayMs);
+}
+
+void schedulerSleep(uint8_t buttonPin) {
+  uint64_t nowMs   = schedulerNowMs();
+  uint64_t sleepMs = scheduleSleepMs(rtcSched.jobs, nowMs, SCHED_MIN_SLEEP_MS);
+
+  Serial.printf("[SCHED] Awake %lu ms, sleeping %lu s\n",
+                millis(), (unsigned long)(sleepMs / 1000ULL));
+  Serial.flush();
+
+  rtcSched.sleepStartMs = nowMs;
+  rtcSched.sleepStartUs = systemTimeUs();
+
+  esp_sleep_enable_timer_wakeup(sleepMs * 1000ULL);
+
+  // Button pulls the pin to GND; keep the pull-up alive while asleep
+  rtc_gpio_pullup_en((gpio_num_t)buttonPin);
+  rtc_gpio_pulldown_dis((gpio_num_t)buttonPin);
+  esp_sleep_enable_ext0_wakeup((gpio_num_t)buttonPin, 0);
+
+  esp_deep_sleep_start();
+}
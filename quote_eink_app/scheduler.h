@@ -0,0 +1,46 @@
+// scheduler.h
+//
+// Deep-sleep duty cycle. Each wake runs the jobs that are due (see
+// job_schedule.h) and then deep-sleeps until the next one, or until the
+// logout button (GPIO21, ext0) is pressed. Job state and a monotonic
+// clock live in RTC memory, so they carry across deep sleep.
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include "job_schedule.h"
+
+enum WakeReason {
+  WAKE_COLD_BOOT,   // power-on or reset: all jobs due
+  WAKE_TIMER,       // next job due
+  WAKE_BUTTON       // logout button pressed during sleep
+};
+
+// Restore job state after a deep-sleep wake, or start fresh.
+// `buttonPin` is the wake-up button armed by schedulerSleep().
+WakeReason schedulerBegin(uint8_t buttonPin);
+
+// Wakes since power-on (0 on a cold boot)
+uint32_t schedulerWakeCount();
+
+// Milliseconds since power-on, continuous across deep sleep
+uint64_t schedulerNowMs();
+
+// True if `job` should run on this wake
+bool schedulerShouldRun(SchedJob job);
+
+// Run `job` on this wake even though it is not due, and the jobs
+// riding on it that are due within the coalescing window
+void schedulerRunNow(SchedJob job);
+
+// Record that `job` ran (successfully or not) on this wake
+void schedulerMarkRun(SchedJob job);
+
+// `job` could not finish on this wake: run it again after `delayMs`
+void schedulerRetryIn(SchedJob job, uint64_t delayMs);
+
+// Deep sleep until the next job is due or the button is pressed.
+// Wi-Fi and the display should be powered down first. Never returns.
+void schedulerSleep(uint8_t buttonPin);
+
+#endif
@@ -0,0 +1,281 @@
+// text_layout.cpp
+
+#include "text_layout.h"
+
+#include <pgmspace.h>
+#include "Fonts/FreeSans18pt7b.h"
+#include "Fonts/FreeSans12pt7b.h"
+#include "Fonts/FreeSans9pt7b.h"
+#include "Fonts/FreeSansOblique9pt7b.h"
+
+#define LAYOUT_MARGIN     4
+#define LAYOUT_AUTHOR_GAP 4    // between the text and the author line
+#define LAYOUT_BOTTOM_Y   (LAYOUT_HEIGHT - 8)   // top of the tags / badge line
+
+const LayoutFont layoutTextFonts[] = {
+  {&FreeSans18pt7b, 1},
+  {&FreeSans12pt7b, 1},
+  {&FreeSans9pt7b,  1},
+  {nullptr,         1},   // 6x8, 48 characters a line
+};
+const uint8_t layoutTextFontCount = sizeof(layoutTextFonts) / sizeof(layoutTextFonts[0]);
+
+const LayoutFont layoutAuthorFonts[] = {
+  {&FreeSansOblique9pt7b, 1},
+  {nullptr,               1},
+};
+const uint8_t layoutAuthorFontCount = sizeof(layoutAuthorFonts) / sizeof(layoutAuthorFonts[0]);
+
+const LayoutFont layoutTagsFont = {nullptr, 1};
+
+static const char AUTHOR_PREFIX[] = "- ";
+static const char ELLIPSIS[]      = "...";
+
+// ----------------------------------------
+// Measuring
+// ----------------------------------------
+
+static uint8_t advance(const LayoutFont &font, char c) {
+  if (font.gfx == nullptr) return 6 * font.size;
+  uint8_t u = (uint8_t)c;
+  if (u < font.gfx->first || u > font.gfx->last) return 0;
+  return font.gfx->glyph[u - font.gfx->first].xAdvance * font.size;
+}
+
+uint16_t layoutMeasure(const LayoutFont &font, const char *s, size_t len) {
+  uint16_t w = 0;
+  for (size_t i = 0; i < len; i++) w += advance(font, s[i]);
+  return w;
+}
+
+struct LineMetrics {
+  int16_t ascent;    // baseline below the top of the line
+  int16_t height;    // line pitch
+};
+
+// From the letters and digits, so a stray '|' or '{' does not push
+// every line apart
+static LineMetrics metrics(const LayoutFont &font) {
+  LineMetrics m;
+  if (font.gfx == nullptr) {
+    m.ascent = 0;                  // the built-in font draws from the top
+    m.height = 9 * font.size;
+    return m;
+  }
+  static const char sample[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+  int16_t ascent = 0, descent = 0;
+  for (const char *p = sample; *p; p++) {
+    uint8_t u = (uint8_t)*p;
+    if (u < font.gfx->first || u > font.gfx->last) continue;
+    const GFXglyph &g = font.gfx->glyph[u - font.gfx->first];
+    if (-g.yOffset > ascent) ascent = -g.yOffset;
+    if (g.yOffset + g.height > descent) descent = g.yOffset + g.height;
+  }
+  int16_t gap = (ascent + descent) / 6;
+  if (gap < 2) gap = 2;
+  m.ascent = ascent * font.size;
+  m.height = (ascent + descent + gap) * font.size;
+  return m;
+}
+
+// ----------------------------------------
+// Line breaking
+// ----------------------------------------
+
+// Greedy breaks at spaces (and at '\n'), splitting only a word that is
+// wider than a line on its own. Fills up to `maxLines` of `lines` (if
+// not null) and returns the line count, stopping early once it passes
+// `maxLines`.
+static int breakLines(const LayoutFont &font, const char *s, size_t len,
+                      uint16_t width, LayoutLine *lines, int maxLines) {
+  int n = 0;
+  size_t pos = 0;
+  while (pos < len) {
+    while (pos < len && s[pos] == ' ') pos++;
+    if (pos >= len) break;
+
+    size_t start = pos, end = len, next = len;
+    bool haveBreak = false;
+    uint32_t w = 0;
+    for (size_t i = start; i < len; i++) {
+      char c = s[i];
+      if (c == '\n') {
+        end = i;
+        next = i + 1;
+        break;
+      }
+      if (c == ' ' && s[i - 1] != ' ') {   // a word ends here
+        end = i;
+        next = i + 1;
+        haveBreak = true;
+      }
+      uint8_t a = advance(font, c);
+      if (c != ' ' && w + a > width) {
+        if (!haveBreak) {   // one word wider than the line
+          end = i > start ? i : i + 1;
+          next = end;
+        }
+        break;
+      }
+      w += a;
+      if (i == len - 1) {
+        end = len;
+        next = len;
+      }
+    }
+    while (end > start && s[end - 1] == ' ') end--;
+
+    if (lines && n < maxLines) {
+      lines[n].start = (uint16_t)start;
+      lines[n].len   = (uint16_t)(end - start);
+      lines[n].ellipsis = 0;
+    }
+    if (++n > maxLines) return n;
+    pos = next;
+  }
+  return n;
+}
+
+// Narrowest width (down to the widest word) that still breaks into
+// `n` lines, so the lines come out even rather than one long line and
+// a short last one
+static uint16_t balancedWidth(const LayoutFont &font, const char *s, size_t len,
+                              uint16_t width, int n) {
+  uint16_t lo = 1, hi = width;
+  while (lo < hi) {
+    uint16_t mid = lo + (hi - lo) / 2;
+    if (breakLines(font, s, len, mid, nullptr, n) <= n) hi = mid;
+    else lo = mid + 1;
+  }
+  return hi;
+}
+
+// Cut `line` back until it fits `width` with "..." after it
+static void addEllipsis(const LayoutFont &font, const char *s, uint16_t width,
+                        LayoutLine &line) {
+  uint16_t dots = layoutMeasure(font, ELLIPSIS, sizeof(ELLIPSIS) - 1);
+  while (line.len > 0 && layoutMeasure(font, s + line.start, line.len) + dots > width) {
+    line.len--;
+  }
+  while (line.len > 0 && s[line.start + line.len - 1] == ' ') line.len--;
+  line.ellipsis = 1;
+}
+
+// ----------------------------------------
+// Screen
+// ----------------------------------------
+
+static void layoutAuthor(const char *author, size_t authorLen, uint16_t width,
+                         QuoteLayout &out) {
+  out.author = LayoutLine{0, 0, 0, 0, 0};
+  out.authorFont = 0;
+  if (authorLen == 0) return;
+
+  uint8_t f = 0;
+  for (; f < layoutAuthorFontCount; f++) {
+    const LayoutFont &font = layoutAuthorFonts[f];
+    uint16_t w = layoutMeasure(font, AUTHOR_PREFIX, sizeof(AUTHOR_PREFIX) - 1) +
+                 layoutMeasure(font, author, authorLen);
+    if (w <= width) break;
+  }
+  out.author.len = (uint16_t)authorLen;
+  if (f == layoutAuthorFontCount) {
+    f = layoutAuthorFontCount - 1;
+    const LayoutFont &font = layoutAuthorFonts[f];
+    addEllipsis(font, author,
+                width - layoutMeasure(font, AUTHOR_PREFIX, sizeof(AUTHOR_PREFIX) - 1),
+                out.author);
+  }
+  out.authorFont = f;
+}
+
+static void layoutTags(const char *tags, size_t tagsLen, uint16_t reserveRight,
+                       QuoteLayout &out) {
+  out.tags = LayoutLine{0, 0, 0, 0, 0};
+  if (tagsLen == 0) return;
+
+  // Centered, and clear of the badge on the right
+  uint16_t width = LAYOUT_WIDTH - 2 * (reserveRight + LAYOUT_MARGIN);
+  out.tags.len = (uint16_t)tagsLen;
+  if (layoutMeasure(layoutTagsFont, tags, tagsLen) > width) {
+    addEllipsis(layoutTagsFont, tags, width, out.tags);
+  }
+  uint16_t w = layoutMeasure(layoutTagsFont, tags, out.tags.len) +
+               (out.tags.ellipsis ? layoutMeasure(layoutTagsFont, ELLIPSIS, 3) : 0);
+  out.tags.x = (LAYOUT_WIDTH - w) / 2;
+  out.tags.y = LAYOUT_BOTTOM_Y;
+}
+
+void layoutQuote(const char *text, size_t textLen,
+                 const char *author, size_t authorLen,
+                 const char *tags, size_t tagsLen,
+                 uint16_t reserveRight, QuoteLayout &out) {
+  const uint16_t width = LAYOUT_WIDTH - 2 * LAYOUT_MARGIN;
+  const int16_t  top   = LAYOUT_MARGIN;
+  const int16_t  bottom = LAYOUT_BOTTOM_Y - LAYOUT_MARGIN;
+
+  layoutAuthor(author, authorLen, width, out);
+  layoutTags(tags, tagsLen, reserveRight, out);
+
+  int16_t authorH = 0;
+  LineMetrics am = metrics(layoutAuthorFonts[out.authorFont]);
+  if (out.author.len > 0 || out.author.ellipsis) authorH = LAYOUT_AUTHOR_GAP + am.height;
+  int16_t textH = bottom - top - authorH;
+
+  // Largest font whose lines fit
+  out.truncated = 0;
+  int n = 0;
+  uint8_t f = 0;
+  LineMetrics m;
+  for (; f < layoutTextFontCount; f++) {
+    m = metrics(layoutTextFonts[f]);
+    int maxLines = textH / m.height;
+    if (maxLines > LAYOUT_MAX_LINES) maxLines = LAYOUT_MAX_LINES;
+    if (maxLines < 1) continue;
+    n = breakLines(layoutTextFonts[f], text, textLen, width, nullptr, maxLines);
+    if (n <= maxLines) break;
+  }
+
+  const LayoutFont *font;
+  if (f < layoutTextFontCount) {
+    font = &layoutTextFonts[f];
+    uint16_t w = n > 1 ? balancedWidth(*font, text, textLen, width, n) : width;
+    n = breakLines(*font, text, textLen, w, out.lines, n);
+  } else {
+    // Too long for every font: as much as fits in the smallest
+    f = layoutTextFontCount - 1;
+    font = &layoutTextFonts[f];
+    m = metrics(*font);
+    int maxLines = textH / m.height;
+    if (maxLines > LAYOUT_MAX_LINES) maxLines = LAYOUT_MAX_LINES;
+    breakLines(*font, text, textLen, width, out.lines, maxLines);
+    n = maxLines;
+    addEllipsis(*font, text, width, out.lines[n - 1]);
+    out.truncated = 1;
+  }
+  out.textFont  = f;
+  out.lineCount = (uint8_t)n;
+
+  // Text and author as one block, centered vertically
+  int16_t blockH = n * m.height + authorH;
+  int16_t y = top + (bottom - top - blockH) / 2;
+  uint16_t dots = layoutMeasure(*font, ELLIPSIS, sizeof(ELLIPSIS) - 1);
+  for (int i = 0; i < n; i++) {
+    LayoutLine &line = out.lines[i];
+    uint16_t w = layoutMeasure(*font, text + line.start, line.len) +
+                 (line.ellipsis ? dots : 0);
+    line.x = (LAYOUT_WIDTH - w) / 2;
+    line.y = y + m.ascent;
+    y += m.height;
+  }
+  out.usedHeight = blockH;
+
+  if (authorH > 0) {
+    const LayoutFont &af = layoutAuthorFonts[out.authorFont];
+    uint16_t w = layoutMeasure(af, AUTHOR_PREFIX, sizeof(AUTHOR_PREFIX) - 1) +
+                 layoutMeasure(af, author + out.author.start, out.author.len) +
+                 (out.author.ellipsis ? layoutMeasure(af, ELLIPSIS, 3) : 0);
+    out.author.x = (LAYOUT_WIDTH - w) / 2;
+    out.author.y = y + LAYOUT_AUTHOR_GAP + am.ascent;
+  }
+}
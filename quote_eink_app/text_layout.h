@@ -0,0 +1,72 @@
+// text_layout.h
+//
+// Where every line of a quote screen goes, measured with the glyph
+// advances of the GFX fonts the panel draws with. The quote is tried
+// in each font of a ladder, largest first, and the first one whose
+// lines fit above the author and tags lines wins; its lines are then
+// rebalanced (narrowest width that still gives the same number of
+// lines) and centered. Text that does not fit even in the smallest
+// font is cut short with "...".
+//
+// Pure logic on byte strings, no display access, so it can be run
+// and benchmarked on the host. Bytes outside a font's range measure
+// zero, as GFX skips them.
+#ifndef TEXT_LAYOUT_H
+#define TEXT_LAYOUT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "GFX_Root/gfxfont.h"
+
+// Landscape panel
+#define LAYOUT_WIDTH     296
+#define LAYOUT_HEIGHT    128
+#define LAYOUT_MAX_LINES 12
+
+// A font: a GFX font, or the built-in 6x8 one (gfx == nullptr) at
+// `size`
+struct LayoutFont {
+  const GFXfont *gfx;
+  uint8_t        size;
+};
+
+// Fonts for the quote text, largest first, and for the author line
+extern const LayoutFont layoutTextFonts[];
+extern const uint8_t    layoutTextFontCount;
+extern const LayoutFont layoutAuthorFonts[];
+extern const uint8_t    layoutAuthorFontCount;
+extern const LayoutFont layoutTagsFont;
+
+// One line: bytes [start, start + len) of its string, drawn with the
+// cursor at (x, y) (the baseline for a GFX font, the top for the
+// built-in one), followed by "..." if `ellipsis`
+struct LayoutLine {
+  uint16_t start;
+  uint16_t len;
+  int16_t  x;
+  int16_t  y;
+  uint8_t  ellipsis;
+};
+
+struct QuoteLayout {
+  uint8_t    textFont;     // index into layoutTextFonts
+  uint8_t    authorFont;   // index into layoutAuthorFonts
+  uint8_t    lineCount;
+  uint8_t    truncated;    // the text did not fit and was cut short
+  LayoutLine lines[LAYOUT_MAX_LINES];
+  LayoutLine author;       // drawn after "- "; len 0 = no author line
+  LayoutLine tags;         // len 0 = no tags line
+  uint16_t   usedHeight;   // text block plus author, for fit statistics
+};
+
+// Width in pixels of `len` bytes of `s` in `font`
+uint16_t layoutMeasure(const LayoutFont &font, const char *s, size_t len);
+
+// Lay out a quote screen. `reserveRight` keeps that many pixels at the
+// right of the bottom line free (the version badge).
+void layoutQuote(const char *text, size_t textLen,
+                 const char *author, size_t authorLen,
+                 const char *tags, size_t tagsLen,
+                 uint16_t reserveRight, QuoteLayout &out);
+
+#endif
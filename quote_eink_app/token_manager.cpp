@@ -0,0 +1,85 @@
+// token_manager.cpp
+
+#include "token_manager.h"
+
+#include "app_prefs.h"
+#include "rtc_clock.h"
+
+// Refresh this long before the token actually expires
+#ifndef TOKEN_EXPIRY_MARGIN_S
+#define TOKEN_EXPIRY_MARGIN_S 60
+#endif
+
+// Firebase ID tokens are ~1 KB JWTs; larger ones are cached in NVS only
+#define RTC_ID_TOKEN_MAX 1400
+#define RTC_UID_MAX      48
+#define RTC_TOKENS_MAGIC 0x544F4B31UL   // "TOK1"
+
+// Survives deep sleep; reset by power-on and software restart
+struct RtcTokens {
+  uint32_t magic;
+  int64_t  expiresAt;
+  char     uid[RTC_UID_MAX];
+  char     idToken[RTC_ID_TOKEN_MAX];
+};
+
+RTC_DATA_ATTR static RtcTokens rtcTokens;
+
+static void saveRtcTokens(const AuthTokens &tokens) {
+  if (tokens.idToken.length() >= RTC_ID_TOKEN_MAX ||
+      tokens.uid.length() >= RTC_UID_MAX) {
+    rtcTokens.magic = 0;
+    return;
+  }
+  strcpy(rtcTokens.idToken, tokens.idToken.c_str());
+  strcpy(rtcTokens.uid, tokens.uid.c_str());
+  rtcTokens.expiresAt = tokens.expiresAt;
+  rtcTokens.magic = RTC_TOKENS_MAGIC;
+}
+
+void tokensLoad(AuthTokens &tokens) {
+  const AppConfig &cfg = config();
+  tokens.refreshToken = cfg.fbRefresh;
+
+  if (rtcTokens.magic == RTC_TOKENS_MAGIC) {
+    tokens.idToken   = rtcTokens.idToken;
+    tokens.uid       = rtcTokens.uid;
+    tokens.expiresAt = (time_t)rtcTokens.expiresAt;
+    Serial.println("[AUTH] Session restored from RTC memory.");
+    return;
+  }
+
+  tokens.idToken   = cfg.fbIdToken;
+  tokens.uid       = cfg.fbUid;
+  tokens.expiresAt = (time_t)cfg.fbIdExpires;
+  if (tokens.idToken.length() > 0 || tokens.refreshToken.length() > 0) {
+    Serial.println("[AUTH] Session restored from NVS.");
+    saveRtcTokens(tokens);
+  }
+}
+
+void tokensSave(const AuthTokens &tokens) {
+  saveRtcTokens(tokens);
+  AppConfig &cfg = configEdit();
+  cfg.fbIdToken   = tokens.idToken;
+  cfg.fbUid       = tokens.uid;
+  cfg.fbIdExpires = tokens.expiresAt;
+  cfg.fbRefresh   = tokens.refreshToken;
+  configCommit();
+}
+
+bool tokensFresh(const AuthTokens &tokens) {
+  if (tokens.idToken.isEmpty() || tokens.uid.isEmpty()) return false;
+  if (!clockIsSet()) return false;   // can't tell; refresh to be safe
+  return clockNow() + TOKEN_EXPIRY_MARGIN_S < tokens.expiresAt;
+}
+
+void tokensClear() {
+  rtcTokens.magic = 0;
+  AppConfig &cfg = configEdit();
+  cfg.fbIdToken   = "";
+  cfg.fbUid       = "";
+  cfg.fbIdExpires = 0;
+  cfg.fbRefresh   = "";
+  configCommit();
+}
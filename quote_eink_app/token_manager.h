@@ -0,0 +1,32 @@
+// token_manager.h
+//
+// Cached Firebase session. The ID token, UID and absolute expiry are
+// kept in RTC memory (deep-sleep wakes) and NVS (reboots); the refresh
+// token lives in NVS only. Expiry is wall-clock time (rtc_clock), so a
+// token obtained before deep sleep is still usable after it.
+#ifndef TOKEN_MANAGER_H
+#define TOKEN_MANAGER_H
+
+#include <Arduino.h>
+#include <time.h>
+
+struct AuthTokens {
+  String idToken;
+  String refreshToken;
+  String uid;
+  time_t expiresAt = 0;   // seconds since epoch
+};
+
+// Load the cached session (RTC copy if present, else NVS)
+void tokensLoad(AuthTokens &tokens);
+
+// Persist a new session to RTC memory and NVS
+void tokensSave(const AuthTokens &tokens);
+
+// True if the ID token can be used now without refreshing
+bool tokensFresh(const AuthTokens &tokens);
+
+// Forget the cached session (RTC memory and NVS)
+void tokensClear();
+
+#endif
@@ -1,15 +1,157 @@
 #include "wifi_manager.h"
 
 #include <WiFi.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
 
 #include "app_prefs.h"
 #include "provisioning.h"
 #include "display_manager.h"
 #include "secrets.h"
+#include "profiler.h"
+#include "scheduler.h"
 
-void connectWiFi() {
-  String ssid = readNVS("wifi_ssid");
-  String pass = readNVS("wifi_password");
+// Give up on the cached AP after this and do a full scan
+#ifndef WIFI_FAST_CONNECT_TIMEOUT_MS
+#define WIFI_FAST_CONNECT_TIMEOUT_MS 3000UL
+#endif
+
+// Reuse the last DHCP lease as a static config (skipping DHCP) only
+// while it is safely inside a typical lease time
+#ifndef WIFI_LEASE_REUSE_MAX_S
+#define WIFI_LEASE_REUSE_MAX_S (6UL * 3600UL)
+#endif
+
+#define WIFI_CACHE_MAGIC 0x57494632UL   // "WIF2"
+
+// Last good association. Kept in RTC memory for deep-sleep wakes; the
+// AP (BSSID + channel) is also saved to NVS ("wifi_ap") for cold boots.
+struct WiFiCache {
+  uint32_t magic;
+  uint32_t ssidHash;
+  uint8_t  bssid[6];
+  uint8_t  channel;
+  uint32_t ip, gateway, subnet, dns;
+  uint64_t leaseAtMs;  // schedulerNowMs() when the lease was obtained
+};
+
+RTC_DATA_ATTR static WiFiCache wifiCache;
+
+// Connection progress, set from the Wi-Fi event task
+#define WIFI_BIT_CONNECTED    BIT0
+#define WIFI_BIT_GOT_IP       BIT1
+#define WIFI_BIT_DISCONNECTED BIT2
+
+static EventGroupHandle_t wifiEvents = nullptr;
+static volatile unsigned long connectedAtMs = 0;
+static volatile unsigned long gotIpAtMs = 0;
+
+static void onWiFiEvent(arduino_event_id_t event, arduino_event_info_t info) {
+  switch (event) {
+    case ARDUINO_EVENT_WIFI_STA_CONNECTED:
+      connectedAtMs = millis();
+      xEventGroupSetBits(wifiEvents, WIFI_BIT_CONNECTED);
+      break;
+    case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+      gotIpAtMs = millis();
+      xEventGroupSetBits(wifiEvents, WIFI_BIT_GOT_IP);
+      break;
+    case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+      xEventGroupSetBits(wifiEvents, WIFI_BIT_DISCONNECTED);
+      break;
+    default:
+      break;
+  }
+}
+
+// FNV-1a, to tell whether the cache belongs to the stored SSID
+static uint32_t hashSsid(const String &ssid) {
+  uint32_t h = 2166136261UL;
+  for (unsigned int i = 0; i < ssid.length(); i++) {
+    h = (h ^ (uint8_t)ssid[i]) * 16777619UL;
+  }
+  return h;
+}
+
+static String apToString(const uint8_t *bssid, uint8_t channel) {
+  char buf[24];
+  snprintf(buf, sizeof(buf), "%02X%02X%02X%02X%02X%02X,%u",
+           bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5], channel);
+  return String(buf);
+}
+
+// Cached AP for `ssid`: RTC copy after deep sleep, else the NVS copy
+static bool loadWiFiCache(const String &ssid) {
+  uint32_t h = hashSsid(ssid);
+  if (wifiCache.magic == WIFI_CACHE_MAGIC && wifiCache.ssidHash == h) return true;
+
+  memset(&wifiCache, 0, sizeof(wifiCache));
+  const String &saved = config().wifiAp;
+  unsigned int b[6], channel;
+  if (sscanf(saved.c_str(), "%2x%2x%2x%2x%2x%2x,%u",
+             &b[0], &b[1], &b[2], &b[3], &b[4], &b[5], &channel) != 7 ||
+      channel == 0 || channel > 14) {
+    return false;
+  }
+  for (int i = 0; i < 6; i++) wifiCache.bssid[i] = b[i];
+  wifiCache.channel  = channel;
+  wifiCache.ssidHash = h;
+  wifiCache.magic    = WIFI_CACHE_MAGIC;
+  return true;
+}
+
+static void saveWiFiCache(const String &ssid, bool leaseReused) {
+  String oldAp = wifiCache.magic == WIFI_CACHE_MAGIC
+                   ? apToString(wifiCache.bssid, wifiCache.channel) : String();
+
+  wifiCache.magic    = WIFI_CACHE_MAGIC;
+  wifiCache.ssidHash = hashSsid(ssid);
+  memcpy(wifiCache.bssid, WiFi.BSSID(), 6);
+  wifiCache.channel  = WiFi.channel();
+  wifiCache.ip       = (uint32_t)WiFi.localIP();
+  wifiCache.gateway  = (uint32_t)WiFi.gatewayIP();
+  wifiCache.subnet   = (uint32_t)WiFi.subnetMask();
+  wifiCache.dns      = (uint32_t)WiFi.dnsIP();
+  if (!leaseReused) wifiCache.leaseAtMs = schedulerNowMs();
+
+  // Flash is only written when the AP actually changed
+  String ap = apToString(wifiCache.bssid, wifiCache.channel);
+  if (ap != oldAp && ap != config().wifiAp) {
+    configEdit().wifiAp = ap;
+    configCommit();
+  }
+}
+
+// The lease is reusable on a deep-sleep wake if it is not too old. Its
+// age is taken on the scheduler clock, which runs from power-on through
+// deep sleep; the system time is only valid once an HTTP Date has set
+// it, after the lease was obtained on a cold boot. A cold boot always
+// connects and records a new lease on the new clock.
+static bool leaseReusable() {
+  if (wifiCache.ip == 0 || schedulerWakeCount() == 0) return false;
+  uint64_t nowMs = schedulerNowMs();
+  return wifiCache.leaseAtMs <= nowMs &&
+         nowMs - wifiCache.leaseAtMs < WIFI_LEASE_REUSE_MAX_S * 1000ULL;
+}
+
+// Wait for an IP. With `failFast`, a disconnect ends the wait at once.
+static bool waitForIp(unsigned long timeoutMs, bool failFast) {
+  EventBits_t waitFor = WIFI_BIT_GOT_IP | (failFast ? WIFI_BIT_DISCONNECTED : 0);
+  EventBits_t bits = xEventGroupWaitBits(wifiEvents, waitFor, pdFALSE, pdFALSE,
+                                         pdMS_TO_TICKS(timeoutMs));
+  return bits & WIFI_BIT_GOT_IP;
+}
+
+static void startAttempt() {
+  xEventGroupClearBits(wifiEvents, WIFI_BIT_CONNECTED | WIFI_BIT_GOT_IP | WIFI_BIT_DISCONNECTED);
+  connectedAtMs = 0;
+  gotIpAtMs = 0;
+}
+
+bool connectWiFi() {
+  PROFILE_SCOPE(PHASE_WIFI);
+  String ssid = config().wifiSsid;
+  String pass = config().wifiPassword;
 
   if (ssid.length() == 0) {
     Serial.println("[WIFI] No SSID stored. Starting provisioning...");
@@ -17,28 +159,73 @@ void connectWiFi() {
     startProvisioning(); // never returns
   }
 
+  if (wifiEvents == nullptr) {
+    wifiEvents = xEventGroupCreate();
+    WiFi.onEvent(onWiFiEvent);
+  }
+
   Serial.println("[WIFI] Connecting to " + ssid);
   displayStatus("Connecting to Wi-Fi:\n" + ssid);
 
+  unsigned long start = millis();
+  WiFi.persistent(false);   // credentials live in our own NVS keys
   WiFi.mode(WIFI_STA);
-  WiFi.begin(ssid.c_str(), pass.c_str());
 
-  unsigned long startAttempt = millis();
-  while (WiFi.status() != WL_CONNECTED &&
-         millis() - startAttempt < WIFI_CONNECT_TIMEOUT_MS) {
-    Serial.print(".");
-    delay(500);
+  bool connected = false;
+  bool fast = false;
+  bool leaseReused = false;
+
+  // Fast path: straight to the cached AP/channel, no scan
+  if (loadWiFiCache(ssid)) {
+    leaseReused = leaseReusable();
+    if (leaseReused) {
+      WiFi.config(IPAddress(wifiCache.ip), IPAddress(wifiCache.gateway),
+                  IPAddress(wifiCache.subnet), IPAddress(wifiCache.dns));
+    }
+    Serial.printf("[WIFI] Trying cached AP on channel %u%s\n",
+                  wifiCache.channel, leaseReused ? ", cached lease" : "");
+
+    startAttempt();
+    WiFi.begin(ssid.c_str(), pass.c_str(), wifiCache.channel, wifiCache.bssid);
+    connected = waitForIp(WIFI_FAST_CONNECT_TIMEOUT_MS, true);
+    fast = connected;
+
+    if (!connected) {
+      Serial.println("[WIFI] Fast connect failed, scanning...");
+      WiFi.disconnect();
+      if (leaseReused) {
+        WiFi.config(IPAddress(), IPAddress(), IPAddress());   // back to DHCP
+        leaseReused = false;
+      }
+      wifiCache.magic = 0;
+    }
+  }
+
+  // Full scan and DHCP
+  if (!connected) {
+    startAttempt();
+    WiFi.begin(ssid.c_str(), pass.c_str());
+    unsigned long elapsed = millis() - start;
+    unsigned long left = elapsed < WIFI_CONNECT_TIMEOUT_MS ? WIFI_CONNECT_TIMEOUT_MS - elapsed : 0;
+    connected = waitForIp(left, false);
   }
-  Serial.println();
 
-  if (WiFi.status() == WL_CONNECTED) {
+  unsigned long total = millis() - start;
+
+  if (connected) {
     IPAddress ip = WiFi.localIP();
     Serial.print("[WIFI] Connected. IP: ");
     Serial.println(ip);
+    Serial.printf("[WIFI] %s connect: associated %lu ms, IP %lu ms, total %lu ms\n",
+                  fast ? "Fast" : "Full",
+                  connectedAtMs ? connectedAtMs - start : 0UL,
+                  gotIpAtMs ? gotIpAtMs - start : 0UL,
+                  total);
+    saveWiFiCache(ssid, leaseReused);
     displayStatus("Wi-Fi connected:\n" + ssid + "\nIP: " + ip.toString());
   } else {
-    Serial.println("[WIFI] Failed. Starting provisioning...");
-    displayStatus("Wi-Fi failed.\nStarting setup...");
-    startProvisioning();
+    // Router down or out of range: not a reason to forget the settings
+    Serial.printf("[WIFI] Failed after %lu ms.\n", total);
   }
+  return connected;
 }
@@ -4,7 +4,9 @@
 #include <Arduino.h>
 
 // Connects to Wi-Fi using credentials from NVS.
-// If no credentials or connection fails, starts provisioning.
-void connectWiFi();
+// With no credentials stored, starts provisioning (never returns).
+// Returns false if the network cannot be reached; the credentials are
+// kept and the caller retries on a later wake.
+bool connectWiFi();
 
 #endif
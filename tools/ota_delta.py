@@ -0,0 +1,355 @@
+#!/usr/bin/env python3
+"""Binary delta patches between firmware images for OTA.
+
+Most releases change a few functions, but the linker shifts everything
+after them, so the new image is the old one with blocks moved and
+pointers adjusted. A patch describes the new image as copies of old
+blocks (plus a sparse byte-wise difference for the adjusted pointers)
+and literal inserts. ota_manager.cpp applies it while streaming, reading
+the old image from the running partition.
+
+Patch format (integers little-endian, varints LEB128):
+
+    "QDP1"  u32 base size  u32 new size
+    ops until the new image is complete:
+      0x01 COPY    varint zigzag(src - end of previous copy), varint len,
+                   then runs covering len: varint same, varint diffLen,
+                   diffLen bytes added (mod 256) to the old bytes
+      0x02 INSERT  varint len, len bytes
+      0x00 END
+
+Usage:
+
+    ota_delta.py diff OLD.bin NEW.bin PATCH.qdp
+    ota_delta.py apply OLD.bin PATCH.qdp OUT.bin
+    ota_delta.py verify            round-trip every consecutive pair in bin/
+    ota_delta.py release           patches from every older image to the
+                                   newest, listed in ota/firmware.json
+"""
+
+import hashlib
+import json
+import os
+import re
+import struct
+import sys
+
+MAGIC = b"QDP1"
+OP_END, OP_COPY, OP_INSERT = 0, 1, 2
+
+KEY = 8           # bytes hashed to find candidate matches
+MIN_MATCH = 12    # shorter exact matches are sent as literals
+MAX_CANDIDATES = 16
+GAP = 1           # equal bytes folded into a diff run to save run headers
+
+REPO = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+
+
+# --- Encoding ----------------------------------------------------------
+
+def varint(v):
+    out = bytearray()
+    while True:
+        b = v & 0x7F
+        v >>= 7
+        if v:
+            out.append(b | 0x80)
+        else:
+            out.append(b)
+            return bytes(out)
+
+
+def zigzag(v):
+    return (v << 1) if v >= 0 else ((-v << 1) - 1)
+
+
+def build_index(old):
+    index = {}
+    for i in range(len(old) - KEY + 1):
+        key = old[i:i + KEY]
+        hits = index.get(key)
+        if hits is None:
+            index[key] = [i]
+        elif len(hits) < MAX_CANDIDATES:
+            hits.append(i)
+    return index
+
+
+def exact_len(old, i, new, j, cap):
+    n = 0
+    limit = min(len(old) - i, len(new) - j, cap)
+    while n < limit and old[i + n] == new[j + n]:
+        n += 1
+    return n
+
+
+def approx_len(old, i, new, j):
+    """Extend a match past mismatches while equal bytes dominate."""
+    limit = min(len(old) - i, len(new) - j)
+    score = best = best_len = 0
+    for k in range(limit):
+        score += 1 if old[i + k] == new[j + k] else -1
+        if score > best:
+            best, best_len = score, k + 1
+        elif score < best - 32:
+            break
+    return best_len
+
+
+def match_ops(old, new):
+    """Greedy cover of `new` by ("copy", src, len) and ("insert", bytes)."""
+    index = build_index(old)
+    ops = []
+    literal = bytearray()
+    j = 0
+    shift = 0   # src - dst of the last copy; most blocks keep it
+    while j < len(new):
+        best_i, best_len = -1, 0
+        i = j + shift
+        if 0 <= i < len(old):
+            best_len = exact_len(old, i, new, j, 64)
+            best_i = i
+        if best_len < 64:
+            for i in index.get(new[j:j + KEY], ()):
+                n = exact_len(old, i, new, j, 4096)
+                if n > best_len:
+                    best_i, best_len = i, n
+        if best_len >= MIN_MATCH:
+            if literal:
+                ops.append(("insert", bytes(literal)))
+                literal = bytearray()
+            n = approx_len(old, best_i, new, j)
+            ops.append(("copy", best_i, n))
+            shift = best_i - j
+            j += n
+        else:
+            literal.append(new[j])
+            j += 1
+    if literal:
+        ops.append(("insert", bytes(literal)))
+    return ops
+
+
+def encode_copy(old, src, new, dst, length):
+    out = bytearray()
+    k = 0
+    while k < length:
+        same = 0
+        while k + same < length and old[src + k + same] == new[dst + k + same]:
+            same += 1
+        k += same
+        run = 0
+        while k + run < length:
+            if old[src + k + run] != new[dst + k + run]:
+                run += 1
+                continue
+            gap = 0
+            while (k + run + gap < length and gap <= GAP and
+                   old[src + k + run + gap] == new[dst + k + run + gap]):
+                gap += 1
+            if gap <= GAP and k + run + gap < length:
+                run += gap
+            else:
+                break
+        out += varint(same) + varint(run)
+        out += bytes((new[dst + k + t] - old[src + k + t]) & 0xFF for t in range(run))
+        k += run
+    return out
+
+
+def diff(old, new):
+    out = bytearray(MAGIC + struct.pack("<II", len(old), len(new)))
+    dst = 0
+    src_end = 0
+    for op in match_ops(old, new):
+        if op[0] == "insert":
+            data = op[1]
+            out += bytes([OP_INSERT]) + varint(len(data)) + data
+            dst += len(data)
+        else:
+            _, src, length = op
+            out += bytes([OP_COPY]) + varint(zigzag(src - src_end)) + varint(length)
+            out += encode_copy(old, src, new, dst, length)
+            dst += length
+            src_end = src + length
+    out.append(OP_END)
+    return bytes(out)
+
+
+# --- Decoding (mirrors the firmware) ------------------------------------
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def byte(self):
+        if self.pos >= len(self.data):
+            raise ValueError("patch truncated")
+        b = self.data[self.pos]
+        self.pos += 1
+        return b
+
+    def varint(self):
+        v = shift = 0
+        while True:
+            b = self.byte()
+            v |= (b & 0x7F) << shift
+            if not b & 0x80:
+                return v
+            shift += 7
+
+    def take(self, n):
+        if self.pos + n > len(self.data):
+            raise ValueError("patch truncated")
+        out = self.data[self.pos:self.pos + n]
+        self.pos += n
+        return out
+
+
+def apply(old, patch):
+    r = Reader(patch)
+    if r.take(4) != MAGIC:
+        raise ValueError("not a QDP1 patch")
+    base_size, new_size = struct.unpack("<II", r.take(8))
+    if base_size != len(old):
+        raise ValueError("base is %d bytes, patch expects %d" % (len(old), base_size))
+    out = bytearray()
+    src_end = 0
+    while True:
+        op = r.byte()
+        if op == OP_END:
+            break
+        if op == OP_INSERT:
+            out += r.take(r.varint())
+        elif op == OP_COPY:
+            z = r.varint()
+            src = src_end + ((z >> 1) if not z & 1 else -((z + 1) >> 1))
+            length = r.varint()
+            if src < 0 or src + length > len(old):
+                raise ValueError("copy outside the base image")
+            k = 0
+            while k < length:
+                same = r.varint()
+                run = r.varint()
+                if k + same + run > length:
+                    raise ValueError("diff run past end of copy")
+                out += old[src + k:src + k + same]
+                k += same
+                delta = r.take(run)
+                out += bytes((old[src + k + t] + delta[t]) & 0xFF for t in range(run))
+                k += run
+            src_end = src + length
+        else:
+            raise ValueError("bad op %d" % op)
+    if len(out) != new_size:
+        raise ValueError("patch produced %d bytes, expected %d" % (len(out), new_size))
+    return bytes(out)
+
+
+# --- Release helpers ---------------------------------------------------
+
+def images():
+    """(version, path) of bin/quote_eink_app_X_Y_Z.bin, oldest first."""
+    found = []
+    for name in os.listdir(os.path.join(REPO, "bin")):
+        m = re.match(r"quote_eink_app_(\d+)_(\d+)_(\d+)\.bin$", name)
+        if m:
+            ver = tuple(int(x) for x in m.groups())
+            found.append((ver, os.path.join(REPO, "bin", name)))
+    return sorted(found)
+
+
+def dotted(ver):
+    return ".".join(str(x) for x in ver)
+
+
+def underscored(ver):
+    return "_".join(str(x) for x in ver)
+
+
+def read(path):
+    with open(path, "rb") as f:
+        return f.read()
+
+
+def cmd_verify():
+    imgs = images()
+    ok = True
+    for (va, pa), (vb, pb) in zip(imgs, imgs[1:]):
+        old, new = read(pa), read(pb)
+        patch = diff(old, new)
+        exact = apply(old, patch) == new
+        ok = ok and exact
+        print("%s -> %s: %7d bytes patch for %7d bytes image (%.1f%%) %s" % (
+            dotted(va), dotted(vb), len(patch), len(new),
+            100.0 * len(patch) / len(new), "OK" if exact else "MISMATCH"))
+    return 0 if ok else 1
+
+
+def cmd_release():
+    imgs = images()
+    if len(imgs) < 2:
+        print("need at least two images in bin/")
+        return 1
+    new_ver, new_path = imgs[-1]
+    new = read(new_path)
+
+    manifest_path = os.path.join(REPO, "ota", "firmware.json")
+    with open(manifest_path) as f:
+        manifest = json.load(f)
+    if manifest.get("version") != dotted(new_ver):
+        print("ota/firmware.json is for %s, newest image is %s" % (
+            manifest.get("version"), dotted(new_ver)))
+        return 1
+
+    base_url = manifest["binUrl"].rsplit("/bin/", 1)[0]
+    os.makedirs(os.path.join(REPO, "ota", "patches"), exist_ok=True)
+    patches = {}
+    for ver, path in imgs[:-1]:
+        old = read(path)
+        patch = diff(old, new)
+        if apply(old, patch) != new:
+            print("%s: patch does not reproduce the image" % dotted(ver))
+            return 1
+        name = "%s_to_%s.qdp" % (underscored(ver), underscored(new_ver))
+        with open(os.path.join(REPO, "ota", "patches", name), "wb") as f:
+            f.write(patch)
+        patches[dotted(ver)] = {
+            "url": "%s/ota/patches/%s" % (base_url, name),
+            "size": len(patch),
+            "baseSize": len(old),
+            "baseSha256": hashlib.sha256(old).hexdigest(),
+        }
+        print("%s -> %s: %d bytes" % (dotted(ver), dotted(new_ver), len(patch)))
+
+    manifest["size"] = len(new)
+    manifest["sha256"] = hashlib.sha256(new).hexdigest()
+    manifest["patches"] = patches
+    with open(manifest_path, "w") as f:
+        json.dump(manifest, f, indent=2)
+        f.write("\n")
+    return 0
+
+
+def main(argv):
+    if len(argv) == 4 and argv[0] == "diff":
+        patch = diff(read(argv[1]), read(argv[2]))
+        with open(argv[3], "wb") as f:
+            f.write(patch)
+        print("%d bytes" % len(patch))
+        return 0
+    if len(argv) == 4 and argv[0] == "apply":
+        with open(argv[3], "wb") as f:
+            f.write(apply(read(argv[1]), read(argv[2])))
+        return 0
+    if argv == ["verify"]:
+        return cmd_verify()
+    if argv == ["release"]:
+        return cmd_release()
+    print(__doc__)
+    return 2
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+"""Compressed firmware images for OTA.
+
+Images are packed with a heatshrink-style LZSS whose window is small
+enough for the device to decode while streaming into the update
+partition (lzss_decoder.cpp), with no more RAM than the window itself.
+
+File format (integers little-endian):
+
+    "QHS1"  u8 window bits W  u8 lookahead bits L  u16 0
+    u32 uncompressed size  u32 block size
+    bitstream, most significant bit first:
+      1, 8 bits              literal byte
+      0, W bits, L bits      copy (count + 1) bytes from (index + 1)
+                             bytes back in the output
+
+No copy crosses a multiple of the block size in the output, and the
+bitstream is padded to a byte boundary there. A download can then be
+resumed at a block: the device refills the window from what it already
+wrote to flash and continues from the byte offset it saved.
+
+Usage:
+
+    ota_pack.py compress IMAGE.bin PACKED.hs
+    ota_pack.py decompress PACKED.hs IMAGE.bin
+    ota_pack.py release    pack the newest image in bin/ and list it
+                           in ota/firmware.json
+"""
+
+import json
+import os
+import re
+import struct
+import sys
+
+MAGIC = b"QHS1"
+WINDOW_BITS = 12        # 4 KB window on the device
+LOOKAHEAD_BITS = 4      # copies of up to 16 bytes
+BLOCK_SIZE = 64 * 1024  # resume granularity, divides OTA_CHUNK_SIZE
+
+KEY = 3                 # bytes hashed to find candidate matches
+MAX_CANDIDATES = 16
+
+REPO = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+
+
+class BitWriter:
+    def __init__(self):
+        self.out = bytearray()
+        self.acc = 0
+        self.nbits = 0
+
+    def put(self, value, nbits):
+        self.acc = (self.acc << nbits) | value
+        self.nbits += nbits
+        while self.nbits >= 8:
+            self.nbits -= 8
+            self.out.append((self.acc >> self.nbits) & 0xFF)
+        self.acc &= (1 << self.nbits) - 1
+
+    def align(self):
+        if self.nbits:
+            self.put(0, 8 - self.nbits)
+
+
+def compress(data, wbits=WINDOW_BITS, lbits=LOOKAHEAD_BITS, block=BLOCK_SIZE):
+    window = 1 << wbits
+    max_len = 1 << lbits
+    # A copy must be shorter in bits than the literals it replaces
+    min_len = (1 + wbits + lbits) // 9 + 1
+
+    w = BitWriter()
+    heads = {}
+    i, n = 0, len(data)
+    while i < n:
+        block_end = (i // block + 1) * block
+        limit = min(max_len, n - i, block_end - i)
+        best_len = best_dist = 0
+        if limit >= min_len:
+            for p in reversed(heads.get(data[i:i + KEY], ())):
+                dist = i - p
+                if dist > window:
+                    break
+                k = 0
+                while k < limit and data[p + k] == data[i + k]:
+                    k += 1
+                if k > best_len:
+                    best_len, best_dist = k, dist
+                    if k == limit:
+                        break
+        if best_len >= min_len:
+            w.put(0, 1)
+            w.put(best_dist - 1, wbits)
+            w.put(best_len - 1, lbits)
+            step = best_len
+        else:
+            w.put(1, 1)
+            w.put(data[i], 8)
+            step = 1
+        for k in range(i, i + step):
+            hits = heads.setdefault(data[k:k + KEY], [])
+            hits.append(k)
+            if len(hits) > MAX_CANDIDATES:
+                del hits[0]
+        i += step
+        if i % block == 0:
+            w.align()
+    w.align()
+
+    header = MAGIC + struct.pack("<BBHII", wbits, lbits, 0, n, block)
+    return header + bytes(w.out)
+
+
+def decompress(packed):
+    if packed[:4] != MAGIC:
+        raise ValueError("not a QHS1 image")
+    wbits, lbits, _, size, block = struct.unpack("<BBHII", packed[4:16])
+    out = bytearray()
+    pos, bit = 16, 0
+
+    def take(nbits):
+        nonlocal pos, bit
+        v = 0
+        for _ in range(nbits):
+            if pos >= len(packed):
+                raise ValueError("image truncated")
+            v = (v << 1) | ((packed[pos] >> (7 - bit)) & 1)
+            bit += 1
+            if bit == 8:
+                pos, bit = pos + 1, 0
+        return v
+
+    while len(out) < size:
+        if take(1):
+            out.append(take(8))
+        else:
+            dist = take(wbits) + 1
+            count = take(lbits) + 1
+            if dist > len(out):
+                raise ValueError("copy before the start at %d" % len(out))
+            for _ in range(count):
+                out.append(out[-dist])
+        if len(out) % block == 0 and bit:
+            pos, bit = pos + 1, 0
+    if len(out) != size or pos + (1 if bit else 0) != len(packed):
+        raise ValueError("image size does not match the header")
+    return bytes(out)
+
+
+# --- Release helpers ---------------------------------------------------
+
+def images():
+    """(version, path) of bin/quote_eink_app_X_Y_Z.bin, oldest first."""
+    found = []
+    for name in os.listdir(os.path.join(REPO, "bin")):
+        m = re.match(r"quote_eink_app_(\d+)_(\d+)_(\d+)\.bin$", name)
+        if m:
+            ver = tuple(int(x) for x in m.groups())
+            found.append((ver, os.path.join(REPO, "bin", name)))
+    return sorted(found)
+
+
+def read(path):
+    with open(path, "rb") as f:
+        return f.read()
+
+
+def cmd_release():
+    imgs = images()
+    if not imgs:
+        print("no images in bin/")
+        return 1
+    ver, path = imgs[-1]
+    dotted = ".".join(str(x) for x in ver)
+
+    manifest_path = os.path.join(REPO, "ota", "firmware.json")
+    with open(manifest_path) as f:
+        manifest = json.load(f)
+    if manifest.get("version") != dotted:
+        print("ota/firmware.json is for %s, newest image is %s" % (
+            manifest.get("version"), dotted))
+        return 1
+
+    data = read(path)
+    packed = compress(data)
+    if decompress(packed) != data:
+        print("%s: packed image does not round-trip" % path)
+        return 1
+    packed_path = path[:-len(".bin")] + ".hs"
+    with open(packed_path, "wb") as f:
+        f.write(packed)
+
+    base_url = manifest["binUrl"].rsplit("/", 1)[0]
+    manifest["compressed"] = {
+        "url": "%s/%s" % (base_url, os.path.basename(packed_path)),
+        "size": len(packed),
+        "windowBits": WINDOW_BITS,
+        "lookaheadBits": LOOKAHEAD_BITS,
+        "blockSize": BLOCK_SIZE,
+    }
+    with open(manifest_path, "w") as f:
+        json.dump(manifest, f, indent=2)
+        f.write("\n")
+    print("%s: %d -> %d bytes (%.1f%%)" % (
+        os.path.basename(packed_path), len(data), len(packed),
+        100.0 * len(packed) / len(data)))
+    return 0
+
+
+def main(argv):
+    if len(argv) == 3 and argv[0] == "compress":
+        data = read(argv[1])
+        packed = compress(data)
+        with open(argv[2], "wb") as f:
+            f.write(packed)
+        print("%d -> %d bytes (%.1f%%)" % (
+            len(data), len(packed), 100.0 * len(packed) / len(data)))
+        return 0
+    if len(argv) == 3 and argv[0] == "decompress":
+        with open(argv[2], "wb") as f:
+            f.write(decompress(read(argv[1])))
+        return 0
+    if argv == ["release"]:
+        return cmd_release()
+    print(__doc__)
+    return 2
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))